@@ -90,6 +90,8 @@ FIND_G2O_LIBRARY(G2O_SOLVER_PCG solver_pcg)
 FIND_G2O_LIBRARY(G2O_SOLVER_SLAM2D_LINEAR solver_slam2d_linear)
 FIND_G2O_LIBRARY(G2O_SOLVER_STRUCTURE_ONLY solver_structure_only)
 FIND_G2O_LIBRARY(G2O_SOLVER_EIGEN solver_eigen)
+FIND_G2O_LIBRARY(G2O_SOLVER_BLOCK_CHOLESKY solver_block_cholesky)
+FIND_G2O_LIBRARY(G2O_SOLVER_INCREMENTAL solver_incremental)
 
 # Find the predefined types
 FIND_G2O_LIBRARY(G2O_TYPES_DATA types_data)
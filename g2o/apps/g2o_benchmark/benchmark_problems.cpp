@@ -0,0 +1,531 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "benchmark_problems.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <random>
+#include <tuple>
+
+#include "g2o/core/sparse_optimizer.h"
+#include "g2o/stuff/sampler.h"
+#include "g2o/types/icp/types_icp.h"
+#include "g2o/types/sba/types_six_dof_expmap.h"
+#include "g2o/types/sim3/types_seven_dof_expmap.h"
+#include "g2o/types/slam2d/edge_se2.h"
+#include "g2o/types/slam2d/vertex_se2.h"
+#include "g2o/types/slam3d/edge_se3.h"
+#include "g2o/types/slam3d/vertex_se3.h"
+
+using namespace std;
+
+namespace g2o {
+
+  namespace {
+
+    Vector3 sampleGaussian3(number_t sigma, std::mt19937& generator)
+    {
+      return Vector3(sigma * sampleGaussian(&generator), sigma * sampleGaussian(&generator), sigma * sampleGaussian(&generator));
+    }
+
+    //! a random rigid body motion with the given standard deviation of the translation and the rotation angles
+    Isometry3 sampleIsometry3(number_t sigmaTranslation, number_t sigmaRotation, std::mt19937& generator)
+    {
+      Vector3 rotation = sampleGaussian3(sigmaRotation, generator);
+      Isometry3 noise = Isometry3::Identity();
+      if (rotation.norm() > 0)
+        noise.linear() = AngleAxis(rotation.norm(), rotation.normalized()).toRotationMatrix();
+      noise.translation() = sampleGaussian3(sigmaTranslation, generator);
+      return noise;
+    }
+
+    /**
+     * \brief random walk of a robot on a grid
+     *
+     * The robot moves by one cell per step and turns at random, it turns
+     * around at the border of the world. Revisiting a cell results in a loop
+     * closure to the latest earlier visit of the cell.
+     */
+    class GridWalk
+    {
+      public:
+        GridWalk(int worldSize, int worldHeight) :
+          _worldSize(worldSize), _worldHeight(worldHeight), _x(0), _y(0), _z(0), _direction(0), _step(0)
+        {
+          _lastVisit[std::make_tuple(0, 0, 0)] = 0;
+        }
+
+        /**
+         * move to the next cell, returns the step of an earlier visit of the
+         * new cell or -1 if the cell was not visited recently
+         */
+        int move(std::mt19937& generator)
+        {
+          static const int dx[] = {1, 0, -1, 0};
+          static const int dy[] = {0, 1, 0, -1};
+          number_t turn = sampleUniform(0., 1., &generator);
+          if (turn < 0.15)
+            _direction = (_direction + 1) % 4;
+          else if (turn < 0.3)
+            _direction = (_direction + 3) % 4;
+          if (std::abs(_x + dx[_direction]) > _worldSize || std::abs(_y + dy[_direction]) > _worldSize)
+            _direction = (_direction + 2) % 4;
+          _x += dx[_direction];
+          _y += dy[_direction];
+          if (_worldHeight > 0 && sampleUniform(0., 1., &generator) < 0.1) {
+            int dz = sampleUniform(0., 1., &generator) < 0.5 ? -1 : 1;
+            if (std::abs(_z + dz) > _worldHeight)
+              dz = -dz;
+            _z += dz;
+          }
+          ++_step;
+
+          int& lastVisit = _lastVisit.insert(std::make_pair(std::make_tuple(_x, _y, _z), -1)).first->second;
+          int loopClosure = lastVisit >= 0 && _step - lastVisit > 10 ? lastVisit : -1;
+          lastVisit = _step;
+          return loopClosure;
+        }
+
+        int x() const { return _x;}
+        int y() const { return _y;}
+        int z() const { return _z;}
+        number_t heading() const { return _direction * M_PI / 2;}
+
+      protected:
+        int _worldSize;
+        int _worldHeight;
+        int _x, _y, _z;
+        int _direction;
+        int _step;
+        std::map<std::tuple<int, int, int>, int> _lastVisit;
+    };
+
+    /**
+     * \brief 2D pose graph of a robot moving on a grid
+     */
+    class Pose2DProblem : public BenchmarkProblem
+    {
+      public:
+        const char* name() const { return "pose2d";}
+        const char* description() const { return "2D pose graph (SE2) of a random walk on a grid with loop closures";}
+
+        void generate(SparseOptimizer& optimizer, int numEdges, unsigned int seed) const
+        {
+          std::mt19937 generator(seed);
+          const number_t sigmaTranslation = 0.05;
+          const number_t sigmaRotation = 0.01;
+          Matrix3 information = Vector3(1. / (sigmaTranslation * sigmaTranslation),
+              1. / (sigmaTranslation * sigmaTranslation), 1. / (sigmaRotation * sigmaRotation)).asDiagonal();
+
+          // about one odometry and one loop closure per pose
+          int worldSize = std::max(3, static_cast<int>(std::sqrt(numEdges / 2.) / 4));
+          GridWalk walk(worldSize, 0);
+          std::vector<SE2> truePoses;
+          std::vector<VertexSE2*> vertices;
+
+          truePoses.push_back(SE2());
+          VertexSE2* first = new VertexSE2;
+          first->setId(0);
+          first->setFixed(true);
+          optimizer.addVertex(first);
+          vertices.push_back(first);
+
+          int edges = 0;
+          while (edges < numEdges) {
+            int loopClosure = walk.move(generator);
+            int current = static_cast<int>(truePoses.size());
+            truePoses.push_back(SE2(walk.x(), walk.y(), walk.heading()));
+
+            // the initial guess is obtained by accumulating the odometry
+            SE2 odometry = truePoses[current - 1].inverse() * truePoses[current] * noise(sigmaTranslation, sigmaRotation, generator);
+            VertexSE2* v = new VertexSE2;
+            v->setId(current);
+            v->setEstimate(vertices.back()->estimate() * odometry);
+            optimizer.addVertex(v);
+            vertices.push_back(v);
+            addEdge(optimizer, vertices[current - 1], v, odometry, information);
+            ++edges;
+
+            if (loopClosure >= 0 && edges < numEdges) {
+              SE2 measurement = truePoses[loopClosure].inverse() * truePoses[current] * noise(sigmaTranslation, sigmaRotation, generator);
+              addEdge(optimizer, vertices[loopClosure], v, measurement, information);
+              ++edges;
+            }
+          }
+        }
+
+      protected:
+        static SE2 noise(number_t sigmaTranslation, number_t sigmaRotation, std::mt19937& generator)
+        {
+          return SE2(sigmaTranslation * sampleGaussian(&generator), sigmaTranslation * sampleGaussian(&generator),
+              sigmaRotation * sampleGaussian(&generator));
+        }
+
+        static void addEdge(SparseOptimizer& optimizer, VertexSE2* from, VertexSE2* to, const SE2& measurement, const Matrix3& information)
+        {
+          EdgeSE2* e = new EdgeSE2;
+          e->setVertex(0, from);
+          e->setVertex(1, to);
+          e->setMeasurement(measurement);
+          e->setInformation(information);
+          optimizer.addEdge(e);
+        }
+    };
+
+    /**
+     * \brief 3D pose graph of a robot moving on a grid of several levels
+     */
+    class Pose3DProblem : public BenchmarkProblem
+    {
+      public:
+        const char* name() const { return "pose3d";}
+        const char* description() const { return "3D pose graph (SE3) of a random walk on a grid with loop closures";}
+
+        void generate(SparseOptimizer& optimizer, int numEdges, unsigned int seed) const
+        {
+          std::mt19937 generator(seed);
+          const number_t sigmaTranslation = 0.05;
+          const number_t sigmaRotation = 0.01;
+          EdgeSE3::InformationType information = EdgeSE3::InformationType::Identity();
+          information.topLeftCorner<3,3>() *= 1. / (sigmaTranslation * sigmaTranslation);
+          information.bottomRightCorner<3,3>() *= 1. / (sigmaRotation * sigmaRotation);
+
+          const int worldHeight = 2;
+          int worldSize = std::max(3, static_cast<int>(std::sqrt(numEdges / 2. / (2 * worldHeight + 1)) / 4));
+          GridWalk walk(worldSize, worldHeight);
+          std::vector<Isometry3, Eigen::aligned_allocator<Isometry3> > truePoses;
+          std::vector<VertexSE3*> vertices;
+
+          truePoses.push_back(Isometry3::Identity());
+          VertexSE3* first = new VertexSE3;
+          first->setId(0);
+          first->setFixed(true);
+          optimizer.addVertex(first);
+          vertices.push_back(first);
+
+          int edges = 0;
+          while (edges < numEdges) {
+            int loopClosure = walk.move(generator);
+            int current = static_cast<int>(truePoses.size());
+            Isometry3 pose = Isometry3::Identity();
+            pose.linear() = AngleAxis(walk.heading(), Vector3::UnitZ()).toRotationMatrix();
+            pose.translation() = Vector3(walk.x(), walk.y(), walk.z());
+            truePoses.push_back(pose);
+
+            Isometry3 odometry = truePoses[current - 1].inverse() * truePoses[current] * sampleIsometry3(sigmaTranslation, sigmaRotation, generator);
+            VertexSE3* v = new VertexSE3;
+            v->setId(current);
+            v->setEstimate(vertices.back()->estimate() * odometry);
+            optimizer.addVertex(v);
+            vertices.push_back(v);
+            addEdge(optimizer, vertices[current - 1], v, odometry, information);
+            ++edges;
+
+            if (loopClosure >= 0 && edges < numEdges) {
+              Isometry3 measurement = truePoses[loopClosure].inverse() * truePoses[current] * sampleIsometry3(sigmaTranslation, sigmaRotation, generator);
+              addEdge(optimizer, vertices[loopClosure], v, measurement, information);
+              ++edges;
+            }
+          }
+        }
+
+      protected:
+        static void addEdge(SparseOptimizer& optimizer, VertexSE3* from, VertexSE3* to, const Isometry3& measurement, const EdgeSE3::InformationType& information)
+        {
+          EdgeSE3* e = new EdgeSE3;
+          e->setVertex(0, from);
+          e->setVertex(1, to);
+          e->setMeasurement(measurement);
+          e->setInformation(information);
+          optimizer.addEdge(e);
+        }
+    };
+
+    /**
+     * \brief bundle adjustment with a layout similar to the BAL datasets
+     *
+     * The cameras are placed on a ring around a cube of points and look at
+     * its center, each point is observed by a few randomly selected cameras.
+     */
+    class BundleAdjustmentProblem : public BenchmarkProblem
+    {
+      public:
+        const char* name() const { return "ba";}
+        const char* description() const { return "bundle adjustment (SE3Quat cameras, marginalized XYZ points) with a BAL like layout";}
+
+        void generate(SparseOptimizer& optimizer, int numEdges, unsigned int seed) const
+        {
+          std::mt19937 generator(seed);
+          const int observationsPerPoint = 5;
+          const number_t sigmaPixel = 1.;
+          const number_t focalLength = 500.;
+          const number_t principalPoint = 320.;
+          const number_t cubeSize = 10.;
+          const number_t ringRadius = 40.;
+
+          int numCameras = std::max(observationsPerPoint, numEdges / 2000);
+          int numPoints = std::max(1, numEdges / observationsPerPoint);
+
+          std::vector<SE3Quat, Eigen::aligned_allocator<SE3Quat> > trueCameras;
+          std::vector<VertexSE3Expmap*> cameras;
+          for (int i = 0; i < numCameras; ++i) {
+            number_t angle = 2 * M_PI * i / numCameras;
+            Vector3 center(ringRadius * std::cos(angle), ringRadius * std::sin(angle), sampleUniform(-2., 2., &generator));
+            // the camera looks at the origin, z is the viewing direction
+            Vector3 z = -center.normalized();
+            Vector3 x = z.cross(Vector3::UnitZ()).normalized();
+            Vector3 y = z.cross(x);
+            Matrix3 worldToCamera;
+            worldToCamera << x.transpose(), y.transpose(), z.transpose();
+            SE3Quat trueCamera(worldToCamera, -worldToCamera * center);
+            trueCameras.push_back(trueCamera);
+
+            VertexSE3Expmap* v = new VertexSE3Expmap;
+            v->setId(i);
+            Vector6 perturbation;
+            perturbation << sampleGaussian3(0.01, generator), sampleGaussian3(0.1, generator);
+            v->setEstimate(SE3Quat::exp(perturbation) * trueCamera);
+            // two fixed cameras define the gauge including the scale
+            v->setFixed(i < 2);
+            optimizer.addVertex(v);
+            cameras.push_back(v);
+          }
+
+          std::vector<int> cameraIndices(numCameras);
+          for (int i = 0; i < numCameras; ++i)
+            cameraIndices[i] = i;
+          for (int j = 0; j < numPoints; ++j) {
+            Vector3 truePoint(sampleUniform(-cubeSize, cubeSize, &generator), sampleUniform(-cubeSize, cubeSize, &generator),
+                sampleUniform(-cubeSize, cubeSize, &generator));
+            VertexSBAPointXYZ* point = new VertexSBAPointXYZ;
+            point->setId(numCameras + j);
+            point->setMarginalized(true);
+            point->setEstimate(truePoint + sampleGaussian3(0.2, generator));
+            optimizer.addVertex(point);
+
+            // partial shuffle to select the observing cameras
+            for (int k = 0; k < observationsPerPoint; ++k) {
+              int selected = k + static_cast<int>(sampleUniform(0., 1., &generator) * (numCameras - k));
+              std::swap(cameraIndices[k], cameraIndices[std::min(selected, numCameras - 1)]);
+              int i = cameraIndices[k];
+              Vector3 pointInCamera = trueCameras[i].map(truePoint);
+              Vector2 observation(focalLength * pointInCamera(0) / pointInCamera(2) + principalPoint + sigmaPixel * sampleGaussian(&generator),
+                  focalLength * pointInCamera(1) / pointInCamera(2) + principalPoint + sigmaPixel * sampleGaussian(&generator));
+              EdgeSE3ProjectXYZ* e = new EdgeSE3ProjectXYZ;
+              e->setVertex(0, point);
+              e->setVertex(1, cameras[i]);
+              e->setMeasurement(observation);
+              e->setInformation(Matrix2::Identity() / (sigmaPixel * sigmaPixel));
+              e->fx = focalLength;
+              e->fy = focalLength;
+              e->cx = principalPoint;
+              e->cy = principalPoint;
+              optimizer.addEdge(e);
+            }
+          }
+        }
+    };
+
+    /**
+     * \brief registration of a sequence of point clouds
+     *
+     * Each cloud is registered to the two following clouds by point to plane
+     * correspondences (Edge_V_V_GICP).
+     */
+    class ICPProblem : public BenchmarkProblem
+    {
+      public:
+        const char* name() const { return "icp";}
+        const char* description() const { return "registration of a sequence of point clouds (VertexSE3, Edge_V_V_GICP)";}
+
+        void generate(SparseOptimizer& optimizer, int numEdges, unsigned int seed) const
+        {
+          std::mt19937 generator(seed);
+          const int correspondencesPerPair = 100;
+          const number_t sigmaPoint = 0.01;
+          int numPairs = std::max(1, numEdges / correspondencesPerPair);
+          int numPoses = numPairs / 2 + 3;
+
+          std::vector<Isometry3, Eigen::aligned_allocator<Isometry3> > truePoses;
+          std::vector<VertexSE3*> vertices;
+          for (int i = 0; i < numPoses; ++i) {
+            Isometry3 pose = Isometry3::Identity();
+            pose.linear() = AngleAxis(0.1 * std::sin(0.1 * i), Vector3::UnitZ()).toRotationMatrix();
+            pose.translation() = Vector3(0.5 * i, std::sin(0.05 * i), 0.);
+            truePoses.push_back(pose);
+
+            VertexSE3* v = new VertexSE3;
+            v->setId(i);
+            v->setEstimate(i == 0 ? pose : pose * sampleIsometry3(0.05, 0.01, generator));
+            v->setFixed(i == 0);
+            optimizer.addVertex(v);
+            vertices.push_back(v);
+          }
+
+          int edges = 0;
+          for (int pair = 0; edges < numEdges; ++pair) {
+            int i = (pair / 2) % (numPoses - 2);
+            int j = i + 1 + pair % 2;
+            for (int k = 0; k < correspondencesPerPair && edges < numEdges; ++k, ++edges) {
+              // a point on a random plane in front of the first cloud
+              Vector3 truePoint = truePoses[i] * Vector3(sampleUniform(1., 6., &generator), sampleUniform(-3., 3., &generator),
+                  sampleUniform(-1., 1., &generator));
+              Vector3 normal = sampleGaussian3(1., generator).normalized();
+
+              EdgeGICP measurement;
+              measurement.pos0 = truePoses[i].inverse() * truePoint + sampleGaussian3(sigmaPoint, generator);
+              measurement.pos1 = truePoses[j].inverse() * truePoint + sampleGaussian3(sigmaPoint, generator);
+              measurement.normal0 = truePoses[i].linear().transpose() * normal;
+              measurement.normal1 = truePoses[j].linear().transpose() * normal;
+
+              Edge_V_V_GICP* e = new Edge_V_V_GICP;
+              e->setVertex(0, vertices[i]);
+              e->setVertex(1, vertices[j]);
+              e->setMeasurement(measurement);
+              e->information() = measurement.prec0(0.01);
+              optimizer.addEdge(e);
+            }
+          }
+        }
+    };
+
+    /**
+     * \brief pose graph of keyframes with a drift in scale (Sim3)
+     *
+     * The keyframes follow a helix, each keyframe is connected to its
+     * successor and to the keyframe of the previous turn.
+     */
+    class Sim3Problem : public BenchmarkProblem
+    {
+      public:
+        const char* name() const { return "sim3";}
+        const char* description() const { return "Sim3 pose graph (VertexSim3Expmap, EdgeSim3) of keyframes with scale drift";}
+
+        void generate(SparseOptimizer& optimizer, int numEdges, unsigned int seed) const
+        {
+          std::mt19937 generator(seed);
+          // about one odometry and one loop closure per keyframe
+          int posesPerTurn = std::max(10, static_cast<int>(std::sqrt(numEdges / 2.)));
+          Vector7 sigma;
+          sigma << 0.005, 0.005, 0.005, 0.02, 0.02, 0.02, 0.01;
+          EdgeSim3::InformationType information = sigma.cwiseInverse().cwiseAbs2().asDiagonal();
+
+          std::vector<Sim3, Eigen::aligned_allocator<Sim3> > truePoses;
+          std::vector<VertexSim3Expmap*> vertices;
+          int edges = 0;
+          for (int i = 0; i == 0 || edges < numEdges; ++i) {
+            number_t angle = 2 * M_PI * i / posesPerTurn;
+            Vector3 center(10. * std::cos(angle), 10. * std::sin(angle), 0.5 * i / posesPerTurn);
+            Matrix3 cameraToWorld = AngleAxis(angle, Vector3::UnitZ()).toRotationMatrix();
+            // the estimate is the transformation from the world to the keyframe
+            truePoses.push_back(Sim3(cameraToWorld.transpose(), -cameraToWorld.transpose() * center, 1.));
+
+            VertexSim3Expmap* v = new VertexSim3Expmap;
+            v->setId(i);
+            v->setFixed(i == 0);
+            Sim3 odometry;
+            if (i == 0) {
+              v->setEstimate(truePoses[0]);
+            } else {
+              // the initial guess is obtained by accumulating the relative measurements
+              odometry = relative(truePoses[i - 1], truePoses[i], sigma, generator);
+              v->setEstimate(odometry * vertices.back()->estimate());
+            }
+            optimizer.addVertex(v);
+            if (i > 0) {
+              addEdge(optimizer, vertices.back(), v, odometry, information);
+              ++edges;
+            }
+            vertices.push_back(v);
+
+            if (i >= posesPerTurn && edges < numEdges) {
+              int j = i - posesPerTurn;
+              addEdge(optimizer, vertices[j], v, relative(truePoses[j], truePoses[i], sigma, generator), information);
+              ++edges;
+            }
+          }
+        }
+
+      protected:
+        //! the noisy measurement of the transformation from the keyframe from to the keyframe to
+        static Sim3 relative(const Sim3& from, const Sim3& to, const Vector7& sigma, std::mt19937& generator)
+        {
+          Vector7 noise;
+          for (int k = 0; k < 7; ++k)
+            noise(k) = sigma(k) * sampleGaussian(&generator);
+          return Sim3(noise) * to * from.inverse();
+        }
+
+        static void addEdge(SparseOptimizer& optimizer, VertexSim3Expmap* from, VertexSim3Expmap* to, const Sim3& measurement, const EdgeSim3::InformationType& information)
+        {
+          EdgeSim3* e = new EdgeSim3;
+          e->setVertex(0, from);
+          e->setVertex(1, to);
+          e->setMeasurement(measurement);
+          e->setInformation(information);
+          optimizer.addEdge(e);
+        }
+    };
+
+  } // end anonymous namespace
+
+  BenchmarkProblem::~BenchmarkProblem()
+  {
+  }
+
+  BenchmarkProblems::BenchmarkProblems()
+  {
+    _problems.push_back(new Pose2DProblem);
+    _problems.push_back(new Pose3DProblem);
+    _problems.push_back(new BundleAdjustmentProblem);
+    _problems.push_back(new ICPProblem);
+    _problems.push_back(new Sim3Problem);
+  }
+
+  BenchmarkProblems::~BenchmarkProblems()
+  {
+    for (size_t i = 0; i < _problems.size(); ++i)
+      delete _problems[i];
+  }
+
+  const BenchmarkProblem* BenchmarkProblems::problem(const std::string& name) const
+  {
+    for (size_t i = 0; i < _problems.size(); ++i)
+      if (name == _problems[i]->name())
+        return _problems[i];
+    return 0;
+  }
+
+  void BenchmarkProblems::listProblems(std::ostream& os) const
+  {
+    for (size_t i = 0; i < _problems.size(); ++i)
+      os << _problems[i]->name() << "\t" << _problems[i]->description() << endl;
+  }
+
+} // end namespace
@@ -0,0 +1,83 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_BENCHMARK_PROBLEMS_H
+#define G2O_BENCHMARK_PROBLEMS_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace g2o {
+
+  class SparseOptimizer;
+
+  /**
+   * \brief synthetic problem for benchmarking the optimizer
+   *
+   * A problem generates its ground truth, the measurements and a perturbed
+   * initial guess from the given seed only, hence the same seed results in
+   * the same problem on each machine and for each commit.
+   */
+  class BenchmarkProblem
+  {
+    public:
+      virtual ~BenchmarkProblem();
+
+      //! the name by which the problem is selected
+      virtual const char* name() const = 0;
+      //! a short description of the problem
+      virtual const char* description() const = 0;
+
+      /**
+       * add a problem with about numEdges edges to the optimizer, the gauge
+       * freedom of the problem is fixed
+       */
+      virtual void generate(SparseOptimizer& optimizer, int numEdges, unsigned int seed) const = 0;
+  };
+
+  /**
+   * \brief the problems known to the benchmark
+   */
+  class BenchmarkProblems
+  {
+    public:
+      BenchmarkProblems();
+      ~BenchmarkProblems();
+
+      //! the problem with the given name, 0 if there is none
+      const BenchmarkProblem* problem(const std::string& name) const;
+      const std::vector<BenchmarkProblem*>& problems() const { return _problems;}
+
+      void listProblems(std::ostream& os) const;
+
+    protected:
+      std::vector<BenchmarkProblem*> _problems;
+  };
+
+} // end namespace
+
+#endif
@@ -0,0 +1,419 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "benchmark_problems.h"
+
+#include "g2o/apps/g2o_cli/dl_wrapper.h"
+#include "g2o/apps/g2o_cli/g2o_common.h"
+#include "g2o/core/batch_stats.h"
+#include "g2o/core/optimization_algorithm_factory.h"
+#include "g2o/core/sparse_optimizer.h"
+#include "g2o/stuff/command_args.h"
+#include "g2o/stuff/string_tools.h"
+#include "g2o/stuff/timeutil.h"
+
+using namespace std;
+using namespace g2o;
+
+// runs the optimization algorithms on synthetic problems of different sizes
+// and writes the timings of the phases of the optimization as CSV, which can
+// be compared to the results of another commit by -baseline
+
+namespace {
+
+  typedef std::vector<std::string> CsvRow;
+
+  //! the phases of the optimization recorded in the G2OBatchStatistics
+  struct Phase {
+    const char* column;
+    number_t G2OBatchStatistics::*time;
+  };
+
+  const Phase phases[] = {
+    {"timeResiduals", &G2OBatchStatistics::timeResiduals},
+    {"timeLinearize", &G2OBatchStatistics::timeLinearize},
+    {"timeQuadraticForm", &G2OBatchStatistics::timeQuadraticForm},
+    {"timeSchurComplement", &G2OBatchStatistics::timeSchurComplement},
+    {"timeSymbolicDecomposition", &G2OBatchStatistics::timeSymbolicDecomposition},
+    {"timeNumericDecomposition", &G2OBatchStatistics::timeNumericDecomposition},
+    {"timeLinearSolution", &G2OBatchStatistics::timeLinearSolution},
+    {"timeUpdate", &G2OBatchStatistics::timeUpdate}
+  };
+  const int numPhases = sizeof(phases) / sizeof(phases[0]);
+
+  //! the columns identifying a benchmark, the repetitions of a benchmark share them
+  const char* keyColumns[] = {"problem", "edges", "solver"};
+
+  CsvRow header()
+  {
+    CsvRow columns = {"label", "problem", "edges", "solver", "seed", "repetition", "vertices", "threads",
+      "iterations", "initialChi2", "finalChi2", "timeGenerate", "timeInitialize", "timeOptimize"};
+    for (int i = 0; i < numPhases; ++i)
+      columns.push_back(phases[i].column);
+    columns.push_back("levenbergIterations");
+    columns.push_back("choleskyNNZ");
+    columns.push_back("memoryGrowthKB");
+    columns.push_back("peakMemoryGrowthKB");
+    return columns;
+  }
+
+  //! the resident memory of the process in KB, 0 if not supported
+  long residentMemory()
+  {
+#if defined(__linux__)
+    ifstream statm("/proc/self/statm");
+    long size, resident;
+    if (statm >> size >> resident)
+      return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#endif
+    return 0;
+  }
+
+  /**
+   * reset the peak resident memory such that peakMemory() reports the peak of
+   * the following benchmark only, false if not supported
+   */
+  bool resetPeakMemory()
+  {
+#if defined(__GLIBC__)
+    // return the memory freed by the previous benchmark to the system, otherwise
+    // it is reused without showing up in the resident memory
+    malloc_trim(0);
+#endif
+#if defined(__linux__)
+    ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5" << flush;
+    return clearRefs.good();
+#else
+    return false;
+#endif
+  }
+
+  //! the peak resident memory since the last resetPeakMemory() in KB, 0 if not supported
+  long peakMemory()
+  {
+#if defined(__linux__)
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line))
+      if (line.compare(0, 6, "VmHWM:") == 0)
+        return atol(line.c_str() + 6);
+#endif
+    return 0;
+  }
+
+  template <typename T>
+  string toString(const T& value)
+  {
+    stringstream ss;
+    ss << setprecision(10) << value;
+    return ss.str();
+  }
+
+  string csvLine(const CsvRow& row)
+  {
+    string line;
+    for (size_t i = 0; i < row.size(); ++i) {
+      if (i > 0)
+        line += ",";
+      line += row[i];
+    }
+    return line;
+  }
+
+  bool readCsv(const string& filename, CsvRow& columns, vector<CsvRow>& rows)
+  {
+    ifstream fin(filename.c_str());
+    if (! fin) {
+      cerr << "unable to read " << filename << endl;
+      return false;
+    }
+    string line;
+    if (! getline(fin, line))
+      return false;
+    columns = strSplit(trim(line), ",");
+    while (getline(fin, line)) {
+      line = trim(line);
+      if (line.empty())
+        continue;
+      rows.push_back(strSplit(line, ","));
+      if (rows.back().size() != columns.size()) {
+        cerr << filename << ": skipping malformed line " << line << endl;
+        rows.pop_back();
+      }
+    }
+    return true;
+  }
+
+  /**
+   * the minimum of each timing column over the repetitions of a benchmark,
+   * the minimum is the least disturbed by other processes
+   */
+  typedef map<string, map<string, double> > TimingsByBenchmark;
+  TimingsByBenchmark minimumTimings(const CsvRow& columns, const vector<CsvRow>& rows)
+  {
+    vector<int> keys;
+    for (size_t k = 0; k < sizeof(keyColumns) / sizeof(keyColumns[0]); ++k)
+      keys.push_back(static_cast<int>(find(columns.begin(), columns.end(), keyColumns[k]) - columns.begin()));
+    TimingsByBenchmark timings;
+    for (size_t r = 0; r < rows.size(); ++r) {
+      string key;
+      for (size_t k = 0; k < keys.size(); ++k)
+        if (keys[k] < static_cast<int>(columns.size()))
+          key += (k > 0 ? " " : "") + rows[r][keys[k]];
+      map<string, double>& benchmarkTimings = timings[key];
+      for (size_t c = 0; c < columns.size(); ++c) {
+        if (columns[c].compare(0, 4, "time") != 0 && columns[c] != "peakMemoryGrowthKB")
+          continue;
+        if (rows[r][c].empty()) // not measured
+          continue;
+        double value = atof(rows[r][c].c_str());
+        map<string, double>::iterator it = benchmarkTimings.find(columns[c]);
+        if (it == benchmarkTimings.end())
+          benchmarkTimings[columns[c]] = value;
+        else
+          it->second = std::min(it->second, value);
+      }
+    }
+    return timings;
+  }
+
+  /**
+   * print the ratio of the timings of the current results to the baseline,
+   * returns the number of regressions, i.e., timings which exceed the
+   * baseline by more than the threshold
+   */
+  int compareResults(const CsvRow& baseColumns, const vector<CsvRow>& baseRows,
+      const CsvRow& columns, const vector<CsvRow>& rows, double threshold, double minTime)
+  {
+    TimingsByBenchmark base = minimumTimings(baseColumns, baseRows);
+    TimingsByBenchmark current = minimumTimings(columns, rows);
+    int regressions = 0;
+    cout << "# benchmark column baseline current ratio" << endl;
+    for (TimingsByBenchmark::const_iterator it = current.begin(); it != current.end(); ++it) {
+      TimingsByBenchmark::const_iterator baseIt = base.find(it->first);
+      if (baseIt == base.end()) {
+        cout << it->first << " not in the baseline" << endl;
+        continue;
+      }
+      for (map<string, double>::const_iterator cit = it->second.begin(); cit != it->second.end(); ++cit) {
+        map<string, double>::const_iterator bit = baseIt->second.find(cit->first);
+        if (bit == baseIt->second.end())
+          continue;
+        bool isTime = cit->first.compare(0, 4, "time") == 0;
+        // short phases are dominated by noise
+        if (isTime && std::max(bit->second, cit->second) < minTime)
+          continue;
+        double ratio = bit->second > 0 ? cit->second / bit->second : 1.;
+        bool regression = ratio > 1. + threshold;
+        regressions += regression ? 1 : 0;
+        cout << it->first << " " << cit->first << " " << bit->second << " " << cit->second
+          << " " << fixed << setprecision(3) << ratio << defaultfloat << setprecision(6)
+          << (regression ? " REGRESSION" : "") << endl;
+      }
+    }
+    return regressions;
+  }
+
+} // end anonymous namespace
+
+int main(int argc, char** argv)
+{
+  OptimizableGraph::initMultiThreading();
+  string problemNames;
+  string solverNames;
+  vector<int> edgeCounts;
+  int maxIterations;
+  int seed;
+  int repetitions;
+  string label;
+  string outputFilename;
+  string baselineFilename;
+  string currentFilename;
+  double threshold;
+  double minTime;
+  bool listProblems;
+  bool listSolvers;
+
+  BenchmarkProblems benchmarkProblems;
+  vector<int> defaultEdgeCounts = {1000, 10000, 100000};
+
+  CommandArgs arg;
+  arg.param("problems", problemNames, "pose2d,pose3d,ba,icp,sim3", "comma separated list of the problems, see -listProblems");
+  arg.param("solvers", solverNames, "gn_var_eigen,lm_var_eigen,lm_var_blockchol", "comma separated list of the solvers, see -listSolvers");
+  arg.param("edges", edgeCounts, defaultEdgeCounts, "comma separated list of the number of edges of the problems");
+  arg.param("i", maxIterations, 10, "perform n iterations");
+  arg.param("seed", seed, 42, "seed of the random number generator creating the problems");
+  arg.param("repeat", repetitions, 1, "number of runs of each benchmark");
+  arg.param("label", label, "", "label of the results, e.g., the commit");
+  arg.param("o", outputFilename, "", "write the results as CSV to this file instead of stdout");
+  arg.param("baseline", baselineFilename, "", "compare the timings to the results in this CSV file");
+  arg.param("current", currentFilename, "", "compare the results in this CSV file to the baseline instead of running the benchmarks");
+  arg.param("threshold", threshold, 0.1, "relative increase of a timing reported as regression");
+  arg.param("minTime", minTime, 1e-3, "timings below this value (in seconds) are not compared");
+  arg.param("listProblems", listProblems, false, "list the available problems");
+  arg.param("listSolvers", listSolvers, false, "list the available solvers");
+  arg.parseArgs(argc, argv);
+
+  if (listProblems) {
+    benchmarkProblems.listProblems(cout);
+    return 0;
+  }
+
+  CsvRow columns = header();
+  vector<CsvRow> rows;
+  if (currentFilename.size() > 0) {
+    if (! readCsv(currentFilename, columns, rows))
+      return 1;
+  } else {
+    DlWrapper dlSolverWrapper;
+    loadStandardSolver(dlSolverWrapper, argc, argv);
+    OptimizationAlgorithmFactory* solverFactory = OptimizationAlgorithmFactory::instance();
+    if (listSolvers) {
+      solverFactory->listSolvers(cout);
+      return 0;
+    }
+
+    ofstream fout;
+    if (outputFilename.size() > 0) {
+      fout.open(outputFilename.c_str());
+      if (! fout) {
+        cerr << "unable to write " << outputFilename << endl;
+        return 1;
+      }
+    }
+    ostream& out = outputFilename.size() > 0 ? fout : cout;
+    out << csvLine(columns) << endl;
+
+    vector<string> problems = strSplit(problemNames, ",");
+    vector<string> solvers = strSplit(solverNames, ",");
+    for (size_t p = 0; p < problems.size(); ++p) {
+      const BenchmarkProblem* problem = benchmarkProblems.problem(problems[p]);
+      if (! problem) {
+        cerr << "unknown problem " << problems[p] << ", see -listProblems" << endl;
+        continue;
+      }
+      for (size_t n = 0; n < edgeCounts.size(); ++n) {
+        for (size_t s = 0; s < solvers.size(); ++s) {
+          for (int r = 0; r < repetitions; ++r) {
+            bool measurePeak = resetPeakMemory();
+            long memoryBefore = residentMemory();
+            SparseOptimizer optimizer;
+            OptimizationAlgorithmProperty solverProperty;
+            OptimizationAlgorithm* algorithm = solverFactory->construct(solvers[s], solverProperty);
+            if (! algorithm) {
+              cerr << "unknown solver " << solvers[s] << ", see -listSolvers" << endl;
+              break;
+            }
+            optimizer.setAlgorithm(algorithm);
+
+            double timeGenerate = get_monotonic_time();
+            problem->generate(optimizer, edgeCounts[n], seed);
+            timeGenerate = get_monotonic_time() - timeGenerate;
+
+            double timeInitialize = get_monotonic_time();
+            optimizer.initializeOptimization();
+            timeInitialize = get_monotonic_time() - timeInitialize;
+            optimizer.computeActiveErrors();
+            double initialChi2 = optimizer.activeChi2();
+
+            optimizer.setComputeBatchStatistics(true);
+            double timeOptimize = get_monotonic_time();
+            int iterations = optimizer.optimize(maxIterations);
+            timeOptimize = get_monotonic_time() - timeOptimize;
+            optimizer.computeActiveErrors();
+            double finalChi2 = optimizer.activeChi2();
+
+            // accumulate the phases over the iterations
+            G2OBatchStatistics total;
+            total.levenbergIterations = 0;
+            total.choleskyNNZ = 0;
+            total.numThreads = 1;
+            for (int i = 0; i < numPhases; ++i)
+              total.*phases[i].time = 0;
+            const BatchStatisticsContainer& stats = optimizer.batchStatistics();
+            for (size_t k = 0; k < stats.size(); ++k) {
+              if (stats[k].iteration < 0)
+                continue;
+              for (int i = 0; i < numPhases; ++i)
+                total.*phases[i].time += stats[k].*phases[i].time;
+              total.levenbergIterations += stats[k].levenbergIterations;
+              total.choleskyNNZ = std::max(total.choleskyNNZ, stats[k].choleskyNNZ);
+              total.numThreads = std::max(total.numThreads, stats[k].numThreads);
+            }
+
+            CsvRow row = {label, problem->name(), toString(edgeCounts[n]), solvers[s], toString(seed), toString(r),
+              toString(optimizer.vertices().size()), toString(total.numThreads), toString(iterations),
+              toString(initialChi2), toString(finalChi2), toString(timeGenerate), toString(timeInitialize), toString(timeOptimize)};
+            for (int i = 0; i < numPhases; ++i)
+              row.push_back(toString(total.*phases[i].time));
+            row.push_back(toString(total.levenbergIterations));
+            row.push_back(toString(total.choleskyNNZ));
+            row.push_back(toString(residentMemory() - memoryBefore));
+            // the peak of the process would hide the benchmarks after the largest one
+            row.push_back(measurePeak ? toString(peakMemory() - memoryBefore) : string());
+            out << csvLine(row) << endl;
+            rows.push_back(row);
+
+            cerr << problem->name() << " edges= " << edgeCounts[n] << " solver= " << solvers[s]
+              << " chi2= " << initialChi2 << " -> " << finalChi2 << " time= " << timeOptimize << endl;
+          }
+        }
+      }
+    }
+  }
+
+  if (baselineFilename.size() > 0) {
+    CsvRow baseColumns;
+    vector<CsvRow> baseRows;
+    if (! readCsv(baselineFilename, baseColumns, baseRows))
+      return 1;
+    int regressions = compareResults(baseColumns, baseRows, columns, rows, threshold, minTime);
+    if (regressions > 0) {
+      cerr << regressions << " timings exceed the baseline by more than " << threshold * 100 << "%" << endl;
+      return 2;
+    }
+  }
+
+  return 0;
+}
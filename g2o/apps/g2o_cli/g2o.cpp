@@ -47,7 +47,9 @@
 #include "g2o/core/batch_stats.h"
 #include "g2o/core/robust_kernel.h"
 #include "g2o/core/robust_kernel_factory.h"
+#include "g2o/core/graduated_non_convexity.h"
 #include "g2o/core/optimization_algorithm.h"
+#include "g2o/core/optimization_algorithm_incremental.h"
 #include "g2o/core/sparse_optimizer_terminate_action.h"
 
 #include "g2o/stuff/macros.h"
@@ -130,6 +132,9 @@ int main(int argc, char** argv)
   string statsFile;
   string summaryFile;
   bool nonSequential;
+  bool batchEvaluation;
+  bool contiguousBackup;
+  bool gnc;
   // command line parsing
   std::vector<int> gaugeList;
   CommandArgs arg;
@@ -150,22 +155,25 @@ int main(int argc, char** argv)
   arg.param("robustKernelWidth", huberWidth, -1., "width for the robust Kernel (only if robustKernel)");
   arg.param("computeMarginals", computeMarginals, false, "computes the marginal covariances of something. FOR TESTING ONLY");
   arg.param("gaugeId", gaugeId, -1, "force the gauge");
-  arg.param("o", outputfilename, "", "output final version of the graph");
+  arg.param("o", outputfilename, "", "output final version of the graph, written in the binary format for the extension .g2ob");
   arg.param("solver", strSolver, "gn_var", "specify which solver to use underneat\n\t {gn_var, lm_fix3_2, gn_fix6_3, lm_fix7_3}");
 #ifndef G2O_DISABLE_DYNAMIC_LOADING_OF_LIBRARIES
   string dummy;
   arg.param("solverlib", dummy, "", "specify a solver library which will be loaded");
   arg.param("typeslib", dummy, "", "specify a types library which will be loaded");
 #endif
-  arg.param("stats", statsFile, "", "specify a file for the statistics");
+  arg.param("stats", statsFile, "", "specify a file for the statistics, written as CSV or JSON for the extensions .csv and .json");
   arg.param("listTypes", listTypes, false, "list the registered types");
   arg.param("listRobustKernels", listRobustKernels, false, "list the registered robust kernels");
   arg.param("listSolvers", listSolvers, false, "list the available solvers");
   arg.param("renameTypes", loadLookup, "", "create a lookup for loading types into other types,\n\t TAG_IN_FILE=INTERNAL_TAG_FOR_TYPE,TAG2=INTERNAL2\n\t e.g., VERTEX_CAM=VERTEX_SE3:EXPMAP");
   arg.param("gaugeList", gaugeList, std::vector<int>(), "set the list of gauges separated by commas without spaces \n  e.g: 1,2,3,4,5 ");
   arg.param("summary", summaryFile, "", "append a summary of this optimization run to the summary file passed as argument");
-  arg.paramLeftOver("graph-input", inputFilename, "", "graph file which will be processed", true);
+  arg.paramLeftOver("graph-input", inputFilename, "", "graph file which will be processed (text or binary format)", true);
   arg.param("nonSequential", nonSequential, false, "apply the robust kernel only on loop closures and not odometries");
+  arg.param("gnc", gnc, false, "anneal the robust kernel by graduated non-convexity, -i iterations per stage");
+  arg.param("batchEval", batchEvaluation, false, "evaluate the edges of one type in batches, if a batch kernel is available for the type");
+  arg.param("contiguousBackup", contiguousBackup, false, "back up the estimates during the trial steps in one contiguous buffer");
   
 
   arg.parseArgs(argc, argv);
@@ -207,6 +215,8 @@ int main(int argc, char** argv)
   SparseOptimizer optimizer;
   optimizer.setVerbose(verbose);
   optimizer.setForceStopFlag(&hasToStop);
+  optimizer.setBatchEvaluation(batchEvaluation);
+  optimizer.setContiguousBackup(contiguousBackup);
 
   SparseOptimizerTerminateAction* terminateAction = 0;
   if (maxIterations < 0) {
@@ -217,6 +227,10 @@ int main(int argc, char** argv)
     terminateAction->setMaxIterations(maxIterationsWithGain);
     optimizer.addPostIterationAction(terminateAction);
   }
+  if (gnc && terminateAction) {
+    cerr << "Error: -gnc needs a fixed number of iterations per stage (-i > 0)" << endl;
+    return 1;
+  }
 
   // allocating the desired solver + testing whether the solver is okay
   OptimizationAlgorithmProperty solverProperty;
@@ -256,7 +270,8 @@ int main(int argc, char** argv)
       cerr << "Failed to open file" << endl;
       return 1;
     }
-    if (!optimizer.load(ifs)) {
+    ifs.close();
+    if (!optimizer.load(inputFilename.c_str())) {
       cerr << "Error loading graph" << endl;
       return 2;
     }
@@ -363,15 +378,18 @@ int main(int argc, char** argv)
   d.shortestPaths(gauge,&f);
   //cerr << PVAR(d.visited().size()) << endl;
 
-  if (d.visited().size()!=optimizer.vertices().size()) {
+  if (d.numVisited()!=(int)optimizer.vertices().size()) {
     cerr << CL_RED("Warning: d.visited().size() != optimizer.vertices().size()") << endl;
-    cerr << "visited: " << d.visited().size() << endl;
+    cerr << "visited: " << d.numVisited() << endl;
     cerr << "vertices: " << optimizer.vertices().size() << endl;
   }
 
   if (incremental) {
-    cerr << CL_RED("# Note: this variant performs batch steps in each time step") << endl;
-    cerr << CL_RED("#       For a variant which updates the Cholesky factor use the binary g2o_incremental") << endl;
+    bool incrementalSolver = dynamic_cast<OptimizationAlgorithmIncremental*>(optimizer.solver()) != 0;
+    if (! incrementalSolver) {
+      cerr << CL_RED("# Note: this variant performs batch steps in each time step") << endl;
+      cerr << CL_RED("#       For a variant which updates the Cholesky factor use -solver gn_incremental") << endl;
+    }
     int incIterations = maxIterations;
     if (! arg.parsedParam("i")) {
       cerr << "# Setting default number of iterations" << endl;
@@ -401,6 +419,17 @@ int main(int argc, char** argv)
 
     // sort the edges in a way that inserting them makes sense
     sort(edges.begin(), edges.end(), IncrementalEdgesCompare());
+
+    // gn_incremental grows the factor from the first edge, fix its vertex such that already the first systems are well posed
+    if (incrementalSolver && gaugeFreedom && edges.size() > 0) {
+      OptimizableGraph::Vertex* first = static_cast<OptimizableGraph::Vertex*>(edges.front()->vertices()[0]);
+      if (first != gauge) {
+        gauge->setFixed(false);
+        first->setFixed(true);
+        gauge = first;
+        cerr << "# incremental: graph is fixed by node " << gauge->id() << endl;
+      }
+    }
     
     double cumTime = 0.;
     int vertexCount=0;
@@ -575,7 +604,15 @@ int main(int argc, char** argv)
     double initChi = optimizer.chi2();
 
     signal(SIGINT, sigquit_handler);
-    int result=optimizer.optimize(maxIterations);
+    int result;
+    if (gnc) {
+      GraduatedNonConvexity gncOptimizer(&optimizer);
+      gncOptimizer.setInnerIterations(maxIterations);
+      result = gncOptimizer.optimize();
+      cerr << "# GNC stages: " << gncOptimizer.stages() << endl;
+    } else {
+      result=optimizer.optimize(maxIterations);
+    }
     if (maxIterations > 0 && result==OptimizationAlgorithm::Fail){
       cerr << "Cholesky failed, result might be invalid" << endl;
     } else if (computeMarginals){
@@ -656,9 +693,15 @@ int main(int argc, char** argv)
       cerr << "writing stats to file \"" << statsFile << "\" ... ";
       ofstream os(statsFile.c_str());
       const BatchStatisticsContainer& bsc = optimizer.batchStatistics();
-      
-      for (int i=0; i<maxIterations; i++) {
-        os << bsc[i] << endl;
+      string statsExtension = getFileExtension(statsFile);
+      if (statsExtension == "csv") {
+        writeBatchStatisticsCSV(os, bsc);
+      } else if (statsExtension == "json") {
+        writeBatchStatisticsJSON(os, bsc);
+      } else {
+        for (size_t i=0; i<bsc.size(); i++) {
+          os << bsc[i] << endl;
+        }
       }
       cerr << "done." << endl;
     }
@@ -0,0 +1,99 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include "dl_wrapper.h"
+#include "g2o_common.h"
+
+#include "g2o/config.h"
+#include "g2o/core/optimizable_graph.h"
+#include "g2o/stuff/command_args.h"
+#include "g2o/stuff/filesys_tools.h"
+#include "g2o/stuff/timeutil.h"
+
+using namespace std;
+using namespace g2o;
+
+/**
+ * convert a graph between the text format (.g2o) and the binary format
+ * (.g2ob). The format of the input is detected from its content, the
+ * format of the output is selected by its extension.
+ */
+int main(int argc, char** argv)
+{
+  string inputFilename;
+  string outputFilename;
+  string loadLookup;
+  string dummy;
+  int level;
+  bool binary;
+
+  CommandArgs arg;
+  arg.param("level", level, 0, "convert the edges of this level");
+  arg.param("binary", binary, false, "write the binary format regardless of the extension of the output");
+  arg.param("renameTypes", loadLookup, "", "create a lookup for loading types into other types,\n\t TAG_IN_FILE=INTERNAL_TAG_FOR_TYPE,TAG2=INTERNAL2\n\t e.g., VERTEX_CAM=VERTEX_SE3:EXPMAP");
+  arg.param("typeslib", dummy, "", "specify a types library which will be loaded");
+  arg.paramLeftOver("graph-input", inputFilename, "", "graph file which will be converted, - for stdin", false);
+  arg.paramLeftOver("graph-output", outputFilename, "", "converted graph file, - for stdout", false);
+  arg.parseArgs(argc, argv);
+
+#ifndef G2O_DISABLE_DYNAMIC_LOADING_OF_LIBRARIES
+  DlWrapper dlTypesWrapper;
+  loadStandardTypes(dlTypesWrapper, argc, argv);
+#endif
+
+  OptimizableGraph graph;
+  if (loadLookup.size() > 0)
+    graph.setRenamedTypesFromString(loadLookup);
+
+  double loadStart = get_monotonic_time();
+  bool loadStatus = inputFilename == "-" ? graph.load(cin) : graph.load(inputFilename.c_str());
+  if (! loadStatus) {
+    cerr << "Error loading graph " << inputFilename << endl;
+    return 2;
+  }
+  cerr << "Loaded " << graph.vertices().size() << " vertices and " << graph.edges().size()
+    << " edges in " << get_monotonic_time() - loadStart << " s" << endl;
+
+  double saveStart = get_monotonic_time();
+  bool writeBinary = binary || getFileExtension(outputFilename) == "g2ob";
+  bool saveStatus;
+  if (outputFilename == "-") {
+    saveStatus = writeBinary ? graph.saveBinary(cout, level) : graph.save(cout, level);
+  } else {
+    saveStatus = writeBinary ? graph.saveBinary(outputFilename.c_str(), level) : graph.save(outputFilename.c_str(), level);
+  }
+  if (! saveStatus) {
+    cerr << "Error saving graph " << outputFilename << endl;
+    return 2;
+  }
+  cerr << "Saved " << outputFilename << (writeBinary ? " (binary)" : " (text)")
+    << " in " << get_monotonic_time() - saveStart << " s" << endl;
+  return 0;
+}
@@ -344,9 +344,9 @@ int main(int argc, char** argv)
   d.shortestPaths(gauge,&f);
   //cerr << PVAR(d.visited().size()) << endl;
 
-  if (d.visited().size()!=optimizer.vertices().size()) {
+  if (d.numVisited()!=(int)optimizer.vertices().size()) {
     cerr << CL_RED("Warning: d.visited().size() != optimizer.vertices().size()") << endl;
-    cerr << "visited: " << d.visited().size() << endl;
+    cerr << "visited: " << d.numVisited() << endl;
     cerr << "vertices: " << optimizer.vertices().size() << endl;
   }
 
@@ -388,7 +388,7 @@ int main(int argc, char** argv)
 
   computeSimpleStars(stars, &optimizer, &labeler, &creator,
       gauge, backboneEdgeType, backboneVertexType, 0, hierarchicalDiameter,
-      1, starIterations, uThreshold, debug);
+      1, starIterations, uThreshold, debug, strSolver);
 
   cerr << "stars computed, stars.size()= " << stars.size() << endl;
 
@@ -28,7 +28,13 @@
 #include "backbone_tree_action.h"
 #include "edge_types_cost_function.h"
 #include "g2o/core/optimization_algorithm_with_hessian.h"
+#include "g2o/core/optimization_algorithm_factory.h"
+#include "g2o/config.h"
 #include <iostream>
+#ifdef G2O_OPENMP
+#include <omp.h>
+#endif
+#include <unordered_map>
 #include <Eigen/LU>
 #include <Eigen/Cholesky>
 #include <Eigen/Eigenvalues>
@@ -131,7 +137,6 @@ void assignHierarchicalEdges(StarSet& stars, EdgeStarMap& esmap, EdgeLabeler* la
           optimizer->addEdge(e);
           s->_starEdges.insert(e);
         } else {
-          cerr << "THERE" << endl;
           cerr << "FATAL, cannot create edge" << endl;
         }
       } else {
@@ -190,6 +195,217 @@ void computeBorder(StarSet& stars, EdgeStarMap& hesmap){
 }
 
 
+namespace {
+
+  //! the state of a star which is kept between the steps of computeSimpleStars()
+  struct SimpleStarState {
+    Star* star;
+    HyperGraph::VertexSet backboneVertices;
+    HyperGraph::EdgeSet backboneEdges;
+    HyperGraph::EdgeSet otherEdges;
+    HyperGraph::VertexSet otherVertices;
+    int optResult;
+    double initialChi;
+    double finalChi;
+    int vKept;
+    int vDropped;
+    bool labelOk;
+  };
+
+  //! the optimizer and the labeler used by one thread for processing the stars
+  struct StarWorker {
+    SparseOptimizer* optimizer;
+    EdgeLabeler* labeler;
+  };
+
+  int starWorkerId()
+  {
+#   ifdef G2O_OPENMP
+    return omp_get_thread_num();
+#   else
+    return 0;
+#   endif
+  }
+
+  /**
+   * greedy first-fit coloring of the stars in the order of the input. Two
+   * stars of the same color do not share a vertex, hence they can be
+   * optimized and labeled concurrently. Returns the number of colors.
+   */
+  int colorStars(std::vector<int>& starColor, const std::vector<SimpleStarState>& states)
+  {
+    std::unordered_map<HyperGraph::Vertex*, std::vector<int> > vertexColors;
+    std::vector<HyperGraph::Vertex*> starVertices;
+    int numColors = 0;
+    starColor.resize(states.size());
+    for (size_t k = 0; k < states.size(); ++k) {
+      const SimpleStarState& st = states[k];
+      starVertices.assign(st.backboneVertices.begin(), st.backboneVertices.end());
+      starVertices.insert(starVertices.end(), st.otherVertices.begin(), st.otherVertices.end());
+
+      std::vector<bool> taken(numColors + 1, false);
+      for (size_t i = 0; i < starVertices.size(); ++i) {
+        const std::vector<int>& colors = vertexColors[starVertices[i]];
+        for (size_t j = 0; j < colors.size(); ++j)
+          taken[colors[j]] = true;
+      }
+      int color = 0;
+      while (taken[color])
+        ++color;
+      for (size_t i = 0; i < starVertices.size(); ++i)
+        vertexColors[starVertices[i]].push_back(color);
+      starColor[k] = color;
+      numColors = std::max(numColors, color + 1);
+    }
+    return numColors;
+  }
+
+  /**
+   * optimizes the backbone of the star, computes an initial guess for the
+   * other vertices, optimizes the whole star and drops the vertices which
+   * are not well constrained. The vertices stay pushed until labelStar().
+   */
+  void optimizeStar(SimpleStarState& st, SparseOptimizer* optimizer,
+                    int backboneIterations, int starIterations, double rejectionThreshold)
+  {
+    Star* s = st.star;
+    st.optResult = 0;
+    st.initialChi = -1.;
+    st.finalChi = -1.;
+    st.vKept = 0;
+    st.vDropped = 0;
+    st.labelOk = false;
+
+    optimizer->push(st.backboneVertices);
+    optimizer->setFixed(s->gauge(),true);
+    optimizer->initializeOptimization(st.backboneEdges);
+    optimizer->computeInitialGuess();
+    optimizer->optimize(backboneIterations);
+    optimizer->setFixed(st.backboneVertices, true);
+
+    // RAINER TODO maybe need a better solution than dynamic casting here??
+    OptimizationAlgorithmWithHessian* solverWithHessian = dynamic_cast<OptimizationAlgorithmWithHessian*>(optimizer->solver());
+    if (solverWithHessian) {
+      optimizer->push(st.otherVertices);
+      optimizer->initializeOptimization(st.otherEdges);
+      optimizer->computeInitialGuess();
+      optimizer->solver()->init();
+      if (!solverWithHessian->buildLinearStructure())
+        cerr << "FATAL: failure while building linear structure" << endl;
+      optimizer->computeActiveErrors();
+      solverWithHessian->updateLinearSystem();
+    } else {
+      cerr << "FATAL: hierarchical thing cannot be used with a solver that does not support the system structure construction" << endl;
+    }
+
+    // then optimize the vertices one at a time to check if a solution is good
+    for (HyperGraph::VertexSet::iterator vit=st.otherVertices.begin(); vit!=st.otherVertices.end(); vit++){
+      OptimizableGraph::Vertex* v=(OptimizableGraph::Vertex*)(*vit);
+      v->solveDirect();
+      // if  a solution is found, add a vertex and all the edges in
+      //othervertices that are pointing to that edge to the star
+      s->_lowLevelVertices.insert(v);
+      for (HyperGraph::EdgeSet::iterator eit=v->edges().begin(); eit!=v->edges().end(); eit++){
+        OptimizableGraph::Edge* e = (OptimizableGraph::Edge*) *eit;
+        if (st.otherEdges.find(e)!=st.otherEdges.end())
+          s->_lowLevelEdges.insert(e);
+      }
+    }
+
+    // relax the backbone and optimize it all
+    optimizer->setFixed(st.backboneVertices, false);
+    optimizer->setFixed(s->gauge(),true);
+
+    optimizer->initializeOptimization(s->_lowLevelEdges);
+    optimizer->computeActiveErrors();
+    st.initialChi = optimizer->activeChi2();
+    st.optResult = optimizer->optimize(starIterations);
+
+    if (!starIterations || st.optResult > 0){
+      optimizer->computeActiveErrors();
+      st.finalChi = optimizer->activeChi2();
+
+      solverWithHessian->updateLinearSystem();
+      HyperGraph::EdgeSet prunedStarEdges = st.backboneEdges;
+      HyperGraph::VertexSet prunedStarVertices = st.backboneVertices;
+      for (HyperGraph::VertexSet::iterator vit=st.otherVertices.begin(); vit!=st.otherVertices.end(); vit++){
+        //discard the vertices whose error is too big
+        OptimizableGraph::Vertex* v=(OptimizableGraph::Vertex*)(*vit);
+        MatrixXd h(v->dimension(), v->dimension());
+        for (int i=0; i<v->dimension(); i++){
+          for (int j=0; j<v->dimension(); j++)
+            h(i,j)=v->hessian(i,j);
+        }
+        EigenSolver<Eigen::MatrixXd> esolver;
+        esolver.compute(h);
+        VectorXcd ev= esolver.eigenvalues();
+        double emin = std::numeric_limits<double>::max();
+        double emax = -std::numeric_limits<double>::max();
+        for (int i=0; i<ev.size(); i++){
+          emin = ev(i).real()>emin ? emin : ev(i).real();
+          emax = ev(i).real()<emax ? emax : ev(i).real();
+        }
+
+        double d=emin/emax;
+        if (d>rejectionThreshold){
+          // if  a solution is found, add a vertex and all the edges in
+          //othervertices that are pointing to that edge to the star
+          prunedStarVertices.insert(v);
+          for (HyperGraph::EdgeSet::iterator eit=v->edges().begin(); eit!=v->edges().end(); eit++){
+            OptimizableGraph::Edge* e = (OptimizableGraph::Edge*) *eit;
+            if (st.otherEdges.find(e)!=st.otherEdges.end())
+              prunedStarEdges.insert(e);
+          }
+          st.vKept++;
+        } else {
+          st.vDropped++;
+        }
+      }
+      s->_lowLevelEdges=prunedStarEdges;
+      s->_lowLevelVertices=prunedStarVertices;
+    }
+
+    // the next star of this thread may share vertices with a star of another thread
+    optimizer->clearIndexMapping();
+  }
+
+  //! adds to the star the hierarchical edges from its gauge to its low level vertices
+  void createStarEdges(SimpleStarState& st, SparseOptimizer* optimizer, EdgeCreator* creator, int level)
+  {
+    Star* s = st.star;
+    std::vector<OptimizableGraph::Vertex*> vertices(2);
+    vertices[0]= (OptimizableGraph::Vertex*) *s->_gauge.begin();
+
+    for (HyperGraph::VertexSet::iterator vit=s->_lowLevelVertices.begin(); vit!=s->_lowLevelVertices.end(); vit++){
+      OptimizableGraph::Vertex* v=(OptimizableGraph::Vertex*)*vit;
+      vertices[1]=v;
+      if (v==vertices[0])
+        continue;
+      OptimizableGraph::Edge* e=creator->createEdge(vertices);
+      if (e) {
+        e->setLevel(level+1);
+        optimizer->addEdge(e);
+        s->_starEdges.insert(e);
+      } else {
+        cerr << "FATAL, cannot create edge" << endl;
+      }
+    }
+  }
+
+  //! labels the hierarchical edges of the star and restores its vertices
+  void labelStar(SimpleStarState& st, const StarWorker& worker, int starIterations)
+  {
+    Star* s = st.star;
+    if (!starIterations || st.optResult > 0)
+      st.labelOk = s->labelStarEdges(0, worker.labeler, worker.optimizer);
+    worker.optimizer->pop(st.otherVertices);
+    worker.optimizer->pop(st.backboneVertices);
+    worker.optimizer->setFixed(s->gauge(),false);
+    worker.optimizer->clearIndexMapping();
+  }
+
+} // end anonymous namespace
+
   void computeSimpleStars(StarSet& stars,
 			  SparseOptimizer* optimizer,
 			  EdgeLabeler* labeler,
@@ -202,7 +418,8 @@ void computeBorder(StarSet& stars, EdgeStarMap& hesmap){
 			  int backboneIterations,
 			  int starIterations,
 			  double rejectionThreshold,
-			  bool debug){
+			  bool debug,
+			  const std::string& starSolver){
 
     cerr << "preforming the tree actions" << endl;
     HyperDijkstra d(optimizer);
@@ -215,7 +432,6 @@ void computeBorder(StarSet& stars, EdgeStarMap& hesmap){
         false,
         std::numeric_limits< double >::max()/2);
 
-    HyperDijkstra::computeTree(d.adjacencyMap());
     // constructs the stars on the backbone
 
     BackBoneTreeAction bact(optimizer, vertexTag, level, step);
@@ -224,7 +440,7 @@ void computeBorder(StarSet& stars, EdgeStarMap& hesmap){
     cerr << "free edges size " << bact.freeEdges().size() << endl;
 
     // perform breadth-first visit of the visit tree and create the stars on the backbone
-    d.visitAdjacencyMap(d.adjacencyMap(),&bact,true);
+    d.visitTree(&bact,true);
     stars.clear();
 
     for (VertexStarMultimap::iterator it=bact.vertexStarMultiMap().begin();
@@ -265,221 +481,144 @@ void computeBorder(StarSet& stars, EdgeStarMap& hesmap){
     //    pop all "vertices" in the backbone
     //    unfix the vertices in the backbone
 
-    int starNum=0;
+    // assign the free edges to the stars. The assignment does not depend on
+    // the optimization, hence it is done once for all the stars in their order.
+    std::vector<SimpleStarState> states;
     for (StarSet::iterator it=stars.begin(); it!=stars.end(); it++){
       Star* s =*it;
-      HyperGraph::VertexSet backboneVertices = s->_lowLevelVertices;
-      HyperGraph::EdgeSet backboneEdges = s->_lowLevelEdges;
-      if (backboneEdges.empty())
+      if (s->_lowLevelEdges.empty())
 	continue;
+      states.push_back(SimpleStarState());
+      SimpleStarState& st = states.back();
+      st.star = s;
+      st.backboneVertices = s->_lowLevelVertices;
+      st.backboneEdges = s->_lowLevelEdges;
 
-
-      // cerr << "optimizing backbone" << endl;
       // one of these  should be the gauge, to be simple we select the fisrt one in the backbone
       OptimizableGraph::VertexSet gauge;
-      gauge.insert(*backboneVertices.begin());
+      gauge.insert(*st.backboneVertices.begin());
       s->gauge()=gauge;
-      s->optimizer()->push(backboneVertices);
-      s->optimizer()->setFixed(gauge,true);
-      s->optimizer()->initializeOptimization(backboneEdges);
-      s->optimizer()->computeInitialGuess();
-      s->optimizer()->optimize(backboneIterations);
-      s->optimizer()->setFixed(backboneVertices, true);
-
-      // cerr << "assignind edges.vertices not in bbone" << endl;
-      HyperGraph::EdgeSet otherEdges;
-      HyperGraph::VertexSet otherVertices;
-      std::multimap<HyperGraph::Vertex*, HyperGraph::Edge*> vemap;
-      for (HyperGraph::VertexSet::iterator bit=backboneVertices.begin(); bit!=backboneVertices.end(); bit++){
+
+      for (HyperGraph::VertexSet::iterator bit=st.backboneVertices.begin(); bit!=st.backboneVertices.end(); bit++){
 	HyperGraph::Vertex* v=*bit;
 	for (HyperGraph::EdgeSet::iterator eit=v->edges().begin(); eit!=v->edges().end(); eit++){
 	  OptimizableGraph::Edge* e = (OptimizableGraph::Edge*) *eit;
 	  HyperGraph::EdgeSet::iterator feit=bact.freeEdges().find(e);
 	  if (feit!=bact.freeEdges().end()){ // edge is admissible
-	    otherEdges.insert(e);
+	    st.otherEdges.insert(e);
 	    bact.freeEdges().erase(feit);
 	    for (size_t i=0; i<e->vertices().size(); i++){
 	      OptimizableGraph::Vertex* ve= (OptimizableGraph::Vertex*)e->vertices()[i];
-	      if (backboneVertices.find(ve)==backboneVertices.end()){
-		otherVertices.insert(ve);
-		vemap.insert(make_pair(ve,e));
-	      }
+	      if (st.backboneVertices.find(ve)==st.backboneVertices.end())
+		st.otherVertices.insert(ve);
 	    }
 	  }
 	}
       }
+    }
 
-      // RAINER TODO maybe need a better solution than dynamic casting here??
-      OptimizationAlgorithmWithHessian* solverWithHessian = dynamic_cast<OptimizationAlgorithmWithHessian*>(s->optimizer()->solver());
-      if (solverWithHessian) {
-        s->optimizer()->push(otherVertices);
-        // cerr << "optimizing vertices out of bbone" << endl;
-        // cerr << "push" << endl;
-        // cerr << "init" << endl;
-        s->optimizer()->initializeOptimization(otherEdges);
-        // cerr << "guess" << endl;
-        s->optimizer()->computeInitialGuess();
-        // cerr << "solver init" << endl;
-        s->optimizer()->solver()->init();
-        // cerr << "structure" << endl;
-        if (!solverWithHessian->buildLinearStructure())
-          cerr << "FATAL: failure while building linear structure" << endl;
-        // cerr << "errors" << endl;
-        s->optimizer()->computeActiveErrors();
-        // cerr << "system" << endl;
-        solverWithHessian->updateLinearSystem();
-        // cerr << "directSolove" << endl;
-      } else {
-        cerr << "FATAL: hierarchical thing cannot be used with a solver that does not support the system structure construction" << endl;
+    // stars sharing a vertex get different colors, the stars of one color are
+    // processed concurrently, each thread with its own optimizer and labeler
+    std::vector<int> starColor;
+    int numColors = colorStars(starColor, states);
+    std::vector<std::vector<int> > colorStates(numColors);
+    for (size_t k = 0; k < states.size(); ++k)
+      colorStates[starColor[k]].push_back(k);
+
+    std::vector<StarWorker> workers;
+    OptimizationAlgorithmFactory* solverFactory = OptimizationAlgorithmFactory::instance();
+    int numWorkers = 1;
+#   ifdef G2O_OPENMP
+    if (! starSolver.empty())
+      numWorkers = omp_get_max_threads();
+#   endif
+    for (int w = 0; w < numWorkers && ! starSolver.empty(); ++w) {
+      OptimizationAlgorithmProperty solverProperty;
+      OptimizationAlgorithm* solver = solverFactory->construct(starSolver, solverProperty);
+      if (! solver) {
+        cerr << "Error allocating star solver \"" << starSolver << "\", using the optimizer of the graph" << endl;
+        break;
       }
+      StarWorker worker;
+      worker.optimizer = new SparseOptimizer;
+      worker.optimizer->setAlgorithm(solver);
+      worker.labeler = new EdgeLabeler(worker.optimizer);
+      workers.push_back(worker);
+    }
+    if (workers.size() != static_cast<size_t>(numWorkers)) {
+      for (size_t w = 0; w < workers.size(); ++w) {
+        delete workers[w].labeler;
+        delete workers[w].optimizer;
+      }
+      workers.clear();
+      StarWorker worker;
+      worker.optimizer = optimizer;
+      worker.labeler = labeler;
+      workers.push_back(worker);
+      numWorkers = 1;
+    }
+    cerr << "star colors: " << numColors << " threads: " << numWorkers << endl;
+
+    for (int c = 0; c < numColors; ++c) {
+      std::vector<int>& cstates = colorStates[c];
+      const int numStates = static_cast<int>(cstates.size());
+
+#     ifdef G2O_OPENMP
+#     pragma omp parallel for default (shared) schedule(dynamic, 1) if (numWorkers > 1 && numStates > 1)
+#     endif
+      for (int k = 0; k < numStates; ++k)
+        optimizeStar(states[cstates[k]], workers[starWorkerId()].optimizer, backboneIterations, starIterations, rejectionThreshold);
+
+      // the hierarchical edges are added to the graph in the order of the stars
+      for (int k = 0; k < numStates; ++k) {
+        SimpleStarState& st = states[cstates[k]];
+        Star* s = st.star;
+        if (!starIterations || st.optResult > 0)
+          createStarEdges(st, optimizer, creator, level);
+
+        cerr <<  "computing star: " << cstates[k] << endl;
+        cerr << " gauge: " << (*s->_gauge.begin())->id()
+             << " kept: " << st.vKept
+             << " dropped: " << st.vDropped
+             << " edges:" << s->_lowLevelEdges.size()
+             << " hedges" << s->_starEdges.size()
+             << " initial chi " << st.initialChi
+             << " final chi " << st.finalChi << endl;
 
-
-      // // then optimize the vertices one at a time to check if a solution is good
-      for (HyperGraph::VertexSet::iterator vit=otherVertices.begin(); vit!=otherVertices.end(); vit++){
-        OptimizableGraph::Vertex* v=(OptimizableGraph::Vertex*)(*vit);
-        v->solveDirect();
-        // cerr << " " << d;
-        // if  a solution is found, add a vertex and all the edges in
-        //othervertices that are pointing to that edge to the star
-        s->_lowLevelVertices.insert(v);
-        for (HyperGraph::EdgeSet::iterator eit=v->edges().begin(); eit!=v->edges().end(); eit++){
-          OptimizableGraph::Edge* e = (OptimizableGraph::Edge*) *eit;
-          if (otherEdges.find(e)!=otherEdges.end())
-            s->_lowLevelEdges.insert(e);
+        if (debug) {
+          char starLowName[100];
+          sprintf(starLowName, "star-%04d-low.g2o", cstates[k]);
+          ofstream starLowStream(starLowName);
+          optimizer->saveSubset(starLowStream, s->_lowLevelEdges);
         }
       }
-      //cerr <<  endl;
-
-      // relax the backbone and optimize it all
-      // cerr << "relax bbone" << endl;
-      s->optimizer()->setFixed(backboneVertices, false);
-      //cerr << "fox gauge bbone" << endl;
-      s->optimizer()->setFixed(s->gauge(),true);
-
-      //cerr << "opt init" << endl;
-      s->optimizer()->initializeOptimization(s->_lowLevelEdges);
-      optimizer->computeActiveErrors();
-      double initialChi = optimizer->activeChi2();
-      int starOptResult = s->optimizer()->optimize(starIterations);
-      //cerr << starOptResult << "(" << starIterations << ")  " << endl;
-      double finalchi=-1.;
-
-      cerr <<  "computing star: " << starNum << endl;
-
-      int vKept=0, vDropped=0;
-      if (!starIterations || starOptResult > 0  ){
-	optimizer->computeActiveErrors();
-	finalchi = optimizer->activeChi2();
-
-#if 1
 
-        s->optimizer()->computeActiveErrors();
-        // cerr << "system" << endl;
-        solverWithHessian->updateLinearSystem();
-        HyperGraph::EdgeSet prunedStarEdges = backboneEdges;
-        HyperGraph::VertexSet prunedStarVertices = backboneVertices;
-        for (HyperGraph::VertexSet::iterator vit=otherVertices.begin(); vit!=otherVertices.end(); vit++){
-
-	  //discard the vertices whose error is too big
-
-
-          OptimizableGraph::Vertex* v=(OptimizableGraph::Vertex*)(*vit);
-          MatrixXd h(v->dimension(), v->dimension());
-          for (int i=0; i<v->dimension(); i++){
-            for (int j=0; j<v->dimension(); j++)
-              h(i,j)=v->hessian(i,j);
-          }
-          EigenSolver<Eigen::MatrixXd> esolver;
-          esolver.compute(h);
-          VectorXcd ev= esolver.eigenvalues();
-          double emin = std::numeric_limits<double>::max();
-          double emax = -std::numeric_limits<double>::max();
-          for (int i=0; i<ev.size(); i++){
-            emin = ev(i).real()>emin ? emin : ev(i).real();
-            emax = ev(i).real()<emax ? emax : ev(i).real();
-          }
-
-          double d=emin/emax;
-
-
-          // cerr << " " << d;
-          if (d>rejectionThreshold){
-	  // if  a solution is found, add a vertex and all the edges in
-	  //othervertices that are pointing to that edge to the star
-            prunedStarVertices.insert(v);
-            for (HyperGraph::EdgeSet::iterator eit=v->edges().begin(); eit!=v->edges().end(); eit++){
-              OptimizableGraph::Edge* e = (OptimizableGraph::Edge*) *eit;
-              if (otherEdges.find(e)!=otherEdges.end())
-                prunedStarEdges.insert(e);
-            }
-            //cerr << "K( " << v->id() << "," << d << ")" ;
-            vKept ++;
-          } else {
-            vDropped++;
-            //cerr << "R( " << v->id() << "," << d << ")" ;
+#     ifdef G2O_OPENMP
+#     pragma omp parallel for default (shared) schedule(dynamic, 1) if (numWorkers > 1 && numStates > 1)
+#     endif
+      for (int k = 0; k < numStates; ++k)
+        labelStar(states[cstates[k]], workers[starWorkerId()], starIterations);
+
+      for (int k = 0; k < numStates; ++k) {
+        SimpleStarState& st = states[cstates[k]];
+        if (st.labelOk) {
+          if (debug) {
+            char starHighName[100];
+            sprintf(starHighName, "star-%04d-high.g2o", cstates[k]);
+            ofstream starHighStream(starHighName);
+            optimizer->saveSubset(starHighStream, st.star->_starEdges);
           }
+        } else {
+          cerr << "FAILURE: " << st.optResult << endl;
         }
-        s->_lowLevelEdges=prunedStarEdges;
-        s->_lowLevelVertices=prunedStarVertices;
-
-#endif
-	//cerr << "addHedges" << endl;
-	//now add to the star the hierarchical edges
-	std::vector<OptimizableGraph::Vertex*> vertices(2);
-	vertices[0]= (OptimizableGraph::Vertex*) *s->_gauge.begin();
-
-	for (HyperGraph::VertexSet::iterator vit=s->_lowLevelVertices.begin(); vit!=s->_lowLevelVertices.end(); vit++){
-	  OptimizableGraph::Vertex* v=(OptimizableGraph::Vertex*)*vit;
-	  vertices[1]=v;
-	  if (v==vertices[0])
-	    continue;
-	  OptimizableGraph::Edge* e=creator->createEdge(vertices);
-	  //rr << "creating edge" << e <<  Factory::instance()->tag(vertices[0]) << "->" <<  Factory::instance()->tag(v) <endl;
-	  if (e) {
-	    e->setLevel(level+1);
-	    optimizer->addEdge(e);
-	    s->_starEdges.insert(e);
-	  } else {
-            cerr << "HERE" << endl;
-	    cerr << "FATAL, cannot create edge" << endl;
-	  }
-	}
-      }
-
-      cerr << " gauge: " << (*s->_gauge.begin())->id()
-           << " kept: " << vKept
-           << " dropped: " << vDropped
-	   << " edges:" << s->_lowLevelEdges.size()
-	   << " hedges" << s->_starEdges.size()
-	   << " initial chi " << initialChi
-	   << " final chi " << finalchi << endl;
-
-      if (debug) {
-	char starLowName[100];
-	sprintf(starLowName, "star-%04d-low.g2o", starNum);
-	ofstream starLowStream(starLowName);
-	optimizer->saveSubset(starLowStream, s->_lowLevelEdges);
       }
-      bool labelOk=false;
-      if (!starIterations || starOptResult > 0)
-        labelOk = s->labelStarEdges(0, labeler);
-      if (labelOk) {
-        if (debug) {
-          char starHighName[100];
-          sprintf(starHighName, "star-%04d-high.g2o", starNum);
-          ofstream starHighStream(starHighName);
-          optimizer->saveSubset(starHighStream, s->_starEdges);
-        }
-      } else {
+    }
 
-        cerr << "FAILURE: " << starOptResult << endl;
+    if (workers[0].optimizer != optimizer) {
+      for (size_t w = 0; w < workers.size(); ++w) {
+        delete workers[w].labeler;
+        delete workers[w].optimizer;
       }
-      starNum++;
-
-      //label each hierarchical edge
-      s->optimizer()->pop(otherVertices);
-      s->optimizer()->pop(backboneVertices);
-      s->optimizer()->setFixed(s->gauge(),false);
     }
 
 
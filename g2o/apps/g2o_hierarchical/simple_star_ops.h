@@ -50,6 +50,16 @@ namespace g2o {
 
   G2O_HIERARCHICAL_API void computeBorder(StarSet& stars, EdgeStarMap& hesmap);
 
+  /**
+   * builds the stars of the given level along the backbone rooted in gauge_
+   * and labels their hierarchical edges. Stars which do not share a vertex
+   * are processed concurrently if starSolver names an optimization algorithm
+   * of the OptimizationAlgorithmFactory. In this case each thread optimizes
+   * its stars with an optimizer and a labeler of its own, whereas the
+   * hierarchical edges are added to the graph in the order of the stars.
+   * Otherwise, the stars are processed one after the other by optimizer and
+   * labeler.
+   */
   G2O_HIERARCHICAL_API void computeSimpleStars(StarSet& stars,
                           SparseOptimizer* optimizer,
                           EdgeLabeler* labeler,
@@ -60,7 +70,8 @@ namespace g2o {
                           int step,
                           int backboneIterations=1,
                           int starIterations=30,
-                          double rejectionThreshold=1e-5, bool debug=false);
+                          double rejectionThreshold=1e-5, bool debug=false,
+                          const std::string& starSolver="");
 
 }
 #endif
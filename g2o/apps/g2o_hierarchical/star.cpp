@@ -33,6 +33,10 @@ namespace g2o {
   Star::Star(int level, SparseOptimizer* optimizer): _level(level), _optimizer(optimizer) {}
 
   bool Star::labelStarEdges(int iterations, EdgeLabeler* labeler){
+    return labelStarEdges(iterations, labeler, _optimizer);
+  }
+
+  bool Star::labelStarEdges(int iterations, EdgeLabeler* labeler, SparseOptimizer* optimizer){
     // mark all vertices in the lowLevelEdges as floating
     bool ok=true;
     std::set<OptimizableGraph::Vertex*> vset;
@@ -58,13 +62,13 @@ namespace g2o {
     }
     //cerr << endl;
     if (iterations>0){
-      _optimizer->initializeOptimization(_lowLevelEdges);
-      _optimizer->computeInitialGuess();
-      int result=_optimizer->optimize(iterations);
+      optimizer->initializeOptimization(_lowLevelEdges);
+      optimizer->computeInitialGuess();
+      int result=optimizer->optimize(iterations);
       if (result<1){
-        cerr << "Vertices num: " << _optimizer->activeVertices().size() << "ids: ";
-        for (size_t i=0; i<_optimizer->indexMapping().size(); i++){
-          cerr << _optimizer->indexMapping()[i]->id() << " " ;
+        cerr << "Vertices num: " << optimizer->activeVertices().size() << "ids: ";
+        for (size_t i=0; i<optimizer->indexMapping().size(); i++){
+          cerr << optimizer->indexMapping()[i]->id() << " " ;
         }
         cerr << endl;
         cerr << "!!! optimization failure" << endl;
@@ -78,17 +82,17 @@ namespace g2o {
         ok=false;
       }
     }  else {
-      optimizer()->initializeOptimization(_lowLevelEdges);
+      optimizer->initializeOptimization(_lowLevelEdges);
       // cerr << "guess" << endl;
-      //optimizer()->computeInitialGuess();
+      //optimizer->computeInitialGuess();
       // cerr << "solver init" << endl;
-      optimizer()->solver()->init();
+      optimizer->solver()->init();
       // cerr << "structure" << endl;
-      OptimizationAlgorithmWithHessian* solverWithHessian = dynamic_cast<OptimizationAlgorithmWithHessian*> (optimizer()->solver());
+      OptimizationAlgorithmWithHessian* solverWithHessian = dynamic_cast<OptimizationAlgorithmWithHessian*> (optimizer->solver());
       if (!solverWithHessian->buildLinearStructure())
         cerr << "FATAL: failure while building linear structure" << endl;
       // cerr << "errors" << endl;
-      optimizer()->computeActiveErrors();
+      optimizer->computeActiveErrors();
       // cerr << "system" << endl;
       solverWithHessian->updateLinearSystem();
     }
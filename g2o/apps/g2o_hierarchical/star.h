@@ -61,6 +61,13 @@ struct Star{
   //! @param labeler: the labeler
   bool labelStarEdges(int iterations, EdgeLabeler* labeler);
 
+  //! same as above but the low level edges are optimized by the optimizer passed as argument,
+  //! which may be different from the one owning the graph. The labeler has to operate on it.
+  //! @param iterations: the number of iterations of the optimizer
+  //! @param labeler: the labeler
+  //! @param optimizer: the optimizer used for the low level edges
+  bool labelStarEdges(int iterations, EdgeLabeler* labeler, SparseOptimizer* optimizer);
+
   //! returns the level of the lower edges in the star
   inline int level() const { return _level; };
   //! returns the optimizer
@@ -56,7 +56,7 @@ MainWindow::~MainWindow()
 
 void MainWindow::on_actionLoad_triggered(bool)
 {
-  QString filename = QFileDialog::getOpenFileName(this, "Load g2o file", "", "g2o files (*.g2o);;All Files (*)");
+  QString filename = QFileDialog::getOpenFileName(this, "Load g2o file", "", "g2o files (*.g2o *.g2ob);;All Files (*)");
   if (! filename.isNull()) {
     loadFromFile(filename);
   }
@@ -64,11 +64,10 @@ void MainWindow::on_actionLoad_triggered(bool)
 
 void MainWindow::on_actionSave_triggered(bool)
 {
-  QString filename = QFileDialog::getSaveFileName(this, "Save g2o file", "", "g2o files (*.g2o)");
+  QString filename = QFileDialog::getSaveFileName(this, "Save g2o file", "", "g2o files (*.g2o);;g2o binary files (*.g2ob)");
   if (! filename.isNull()) {
-    ofstream fout(filename.toStdString().c_str());
-    viewer->graph->save(fout);
-    if (fout.good())
+    // the extension .g2ob selects the binary format
+    if (viewer->graph->save(filename.toStdString().c_str()))
       cerr << "Saved " << filename.toStdString() << endl;
     else
       cerr << "Error while saving file" << endl;
@@ -249,7 +248,8 @@ bool MainWindow::load(const QString& filename)
     ifstream ifs(filename.toStdString().c_str());
     if (! ifs)
       return false;
-    loadStatus = viewer->graph->load(ifs);
+    ifs.close();
+    loadStatus = viewer->graph->load(filename.toStdString().c_str());
   }
   if (! loadStatus)
     return false;
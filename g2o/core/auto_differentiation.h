@@ -0,0 +1,152 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_AUTO_DIFFERENTIATION_H
+#define G2O_AUTO_DIFFERENTIATION_H
+
+#include <Eigen/Core>
+#include <unsupported/Eigen/AutoDiff>
+
+#include "base_unary_edge.h"
+#include "base_binary_edge.h"
+#include "auto_differentiation_traits.h"
+
+namespace g2o {
+
+  /**
+   * \brief linearize an edge by forward-mode automatic differentiation
+   *
+   * Replaces the numeric differentiation of BaseUnaryEdge or
+   * BaseBinaryEdge, which is given as the template parameter BaseEdgeType,
+   * by dual numbers over number_t. The derived edge provides its error as
+   * a templated functor on the estimate data of the vertices, see
+   * OptimizableGraph::Vertex::getEstimateData():
+   *
+   * \code
+   * template <typename T>
+   * bool operator()(const T* xi, const T* xj, T* error) const;  // binary edge
+   * template <typename T>
+   * bool operator()(const T* xi, T* error) const;               // unary edge
+   * \endcode
+   *
+   * Within the functor the math functions have to be called unqualified,
+   * e.g., "using std::sin; sin(x)", to pick up the overloads for the dual
+   * numbers. If the functor returns false, the numeric differentiation of
+   * BaseEdgeType is used for this linearization. The Jacobian is computed with respect to the estimate data,
+   * which is the Jacobian with respect to the increment of oplus() only if
+   * the increment is added to the estimate data. Hence, the vertex types have
+   * to opt in by AutoDiffOplusIsAddition. For the other vertex types the
+   * numeric differentiation of BaseEdgeType is used.
+   *
+   * Usage:
+   * \code
+   * class EdgeFoo : public AutoDiffEdge<EdgeFoo, BaseBinaryEdge<2, Vector2, VertexSE2, VertexPointXY> >
+   * \endcode
+   */
+  template <typename Derived, typename BaseEdgeType>
+  class AutoDiffEdge : public BaseEdgeType
+  {
+    public:
+      using BaseEdgeType::linearizeOplus;
+
+      virtual void linearizeOplus()
+      {
+        linearizeAutoDiff(this);
+      }
+
+    protected:
+      template <int D, typename E, typename VertexXiType>
+      void linearizeAutoDiff(BaseUnaryEdge<D, E, VertexXiType>*)
+      {
+        static_assert(D > 0, "automatic differentiation requires an error of fixed dimension");
+        const int Di = VertexXiType::Dimension;
+        typedef Eigen::AutoDiffScalar<Eigen::Matrix<number_t, Di, 1> > Scalar;
+
+        const VertexXiType* vi = static_cast<const VertexXiType*>(this->_vertices[0]);
+        if (vi->fixed())
+          return;
+        number_t xi[Di];
+        if (! AutoDiffOplusIsAddition<VertexXiType>::value
+            || vi->estimateDimension() != Di || ! vi->getEstimateData(xi)) {
+          BaseEdgeType::linearizeOplus();
+          return;
+        }
+
+        Scalar ai[Di];
+        for (int k = 0; k < Di; ++k)
+          ai[k] = Scalar(xi[k], Di, k);
+        Scalar error[D];
+        if (! static_cast<const Derived*>(this)->operator()(ai, error)) {
+          BaseEdgeType::linearizeOplus();
+          return;
+        }
+        for (int r = 0; r < D; ++r)
+          this->_jacobianOplusXi.row(r) = error[r].derivatives().transpose();
+      }
+
+      template <int D, typename E, typename VertexXiType, typename VertexXjType>
+      void linearizeAutoDiff(BaseBinaryEdge<D, E, VertexXiType, VertexXjType>*)
+      {
+        static_assert(D > 0, "automatic differentiation requires an error of fixed dimension");
+        const int Di = VertexXiType::Dimension;
+        const int Dj = VertexXjType::Dimension;
+        typedef Eigen::AutoDiffScalar<Eigen::Matrix<number_t, Di + Dj, 1> > Scalar;
+
+        const VertexXiType* vi = static_cast<const VertexXiType*>(this->_vertices[0]);
+        const VertexXjType* vj = static_cast<const VertexXjType*>(this->_vertices[1]);
+        if (vi->fixed() && vj->fixed())
+          return;
+        number_t xi[Di];
+        number_t xj[Dj];
+        if (! AutoDiffOplusIsAddition<VertexXiType>::value || ! AutoDiffOplusIsAddition<VertexXjType>::value
+            || vi->estimateDimension() != Di || vj->estimateDimension() != Dj
+            || ! vi->getEstimateData(xi) || ! vj->getEstimateData(xj)) {
+          BaseEdgeType::linearizeOplus();
+          return;
+        }
+
+        // both vertices are differentiated in a single pass
+        Scalar ai[Di];
+        Scalar aj[Dj];
+        for (int k = 0; k < Di; ++k)
+          ai[k] = Scalar(xi[k], Di + Dj, k);
+        for (int k = 0; k < Dj; ++k)
+          aj[k] = Scalar(xj[k], Di + Dj, Di + k);
+        Scalar error[D];
+        if (! static_cast<const Derived*>(this)->operator()(ai, aj, error)) {
+          BaseEdgeType::linearizeOplus();
+          return;
+        }
+        for (int r = 0; r < D; ++r) {
+          this->_jacobianOplusXi.row(r) = error[r].derivatives().template head<Di>().transpose();
+          this->_jacobianOplusXj.row(r) = error[r].derivatives().template tail<Dj>().transpose();
+        }
+      }
+  };
+
+} // end namespace
+
+#endif
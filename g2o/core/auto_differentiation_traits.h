@@ -0,0 +1,56 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_AUTO_DIFFERENTIATION_TRAITS_H
+#define G2O_AUTO_DIFFERENTIATION_TRAITS_H
+
+namespace g2o {
+
+  /**
+   * \brief opt-in of a vertex type to the automatic differentiation of AutoDiffEdge
+   *
+   * Specialize with value = true for a vertex type whose oplus() adds the
+   * increment to the estimate data, e.g., a point whose estimate data is its
+   * coordinates. Only then the derivative with respect to the estimate data
+   * is the derivative with respect to the increment. This does not hold for
+   * a vertex which composes the increment with its estimate, e.g., VertexSE3.
+   *
+   * The specialization is placed next to the definition of the vertex,
+   * e.g., the one of VertexPointXY in vertex_point_xy.h:
+   *
+   * \code
+   * template <> struct AutoDiffOplusIsAddition<VertexPointXY> { static const bool value = true; };
+   * \endcode
+   */
+  template <typename VertexType>
+  struct AutoDiffOplusIsAddition
+  {
+    static const bool value = false;
+  };
+
+} // end namespace
+
+#endif
@@ -90,6 +90,13 @@ namespace g2o {
       //! returns the result of the linearization in the manifold space for the node xj
       const JacobianXjOplusType& jacobianOplusXj() const { return _jacobianOplusXj;}
 
+      /**
+       * maps the Jacobians to external memory which holds the result of the
+       * linearization, e.g., computed by a BatchEdgeKernel. The memory needs
+       * to be aligned like the memory of the JacobianWorkspace.
+       */
+      inline void mapJacobianMemory(number_t* jacobianXi, number_t* jacobianXj);
+
       inline virtual void constructQuadraticForm() ;
 
       inline virtual void mapHessianMemory(number_t* d, int i, int j, bool rowMajor);
@@ -162,6 +162,13 @@ void BaseBinaryEdge<D, E, VertexXiType, VertexXjType>::linearizeOplus(JacobianWo
   linearizeOplus();
 }
 
+template <int D, typename E, typename VertexXiType, typename VertexXjType>
+void BaseBinaryEdge<D, E, VertexXiType, VertexXjType>::mapJacobianMemory(number_t* jacobianXi, number_t* jacobianXj)
+{
+  new (&_jacobianOplusXi) JacobianXiOplusType(jacobianXi, D < 0 ? _dimension : D, Di);
+  new (&_jacobianOplusXj) JacobianXjOplusType(jacobianXj, D < 0 ? _dimension : D, Dj);
+}
+
 template <int D, typename E, typename VertexXiType, typename VertexXjType>
 void BaseBinaryEdge<D, E, VertexXiType, VertexXjType>::linearizeOplus()
 {
@@ -175,59 +182,19 @@ void BaseBinaryEdge<D, E, VertexXiType, VertexXjType>::linearizeOplus()
     return;
 
   const number_t delta = cst(1e-9);
-  const number_t scalar = 1 / (2*delta);
-  ErrorVector errorBak;
   ErrorVector errorBeforeNumeric = _error;
 
   if (iNotFixed) {
     QuadraticFormLock lck(*vi);
     //Xi - estimate the jacobian numerically
-    number_t add_vi[VertexXiType::Dimension] = {};
-
-    // add small step along the unit vector in each dimension
-    for (int d = 0; d < VertexXiType::Dimension; ++d) {
-      vi->push();
-      add_vi[d] = delta;
-      vi->oplus(add_vi);
-      computeError();
-      errorBak = _error;
-      vi->pop();
-      vi->push();
-      add_vi[d] = -delta;
-      vi->oplus(add_vi);
-      computeError();
-      errorBak -= _error;
-      vi->pop();
-      add_vi[d] = 0.0;
-
-      _jacobianOplusXi.col(d) = scalar * errorBak;
-    } // end dimension
+    vi->numericJacobian(this, delta, _jacobianOplusXi.data());
   }
 
   if (jNotFixed) {
     QuadraticFormLock lck(*vj);
     //Xj - estimate the jacobian numerically
-    number_t add_vj[VertexXjType::Dimension] = {};
-
-    // add small step along the unit vector in each dimension
-    for (int d = 0; d < VertexXjType::Dimension; ++d) {
-      vj->push();
-      add_vj[d] = delta;
-      vj->oplus(add_vj);
-      computeError();
-      errorBak = _error;
-      vj->pop();
-      vj->push();
-      add_vj[d] = -delta;
-      vj->oplus(add_vj);
-      computeError();
-      errorBak -= _error;
-      vj->pop();
-      add_vj[d] = 0.0;
-
-      _jacobianOplusXj.col(d) = scalar * errorBak;
-    }
-  } // end dimension
+    vj->numericJacobian(this, delta, _jacobianOplusXj.data());
+  }
 
   _error = errorBeforeNumeric;
 }
@@ -98,29 +98,9 @@ void BaseUnaryEdge<D, E, VertexXiType>::linearizeOplus()
 #endif
 
   const number_t delta = cst(1e-9);
-  const number_t scalar = 1 / (2*delta);
-  ErrorVector error1;
   ErrorVector errorBeforeNumeric = _error;
 
-  number_t add_vi[VertexXiType::Dimension] = {};
-
-  // add small step along the unit vector in each dimension
-  for (int d = 0; d < VertexXiType::Dimension; ++d) {
-    vi->push();
-    add_vi[d] = delta;
-    vi->oplus(add_vi);
-    computeError();
-    error1 = _error;
-    vi->pop();
-    vi->push();
-    add_vi[d] = -delta;
-    vi->oplus(add_vi);
-    computeError();
-    vi->pop();
-    add_vi[d] = 0.0;
-
-    _jacobianOplusXi.col(d) = scalar * (error1 - _error);
-  } // end dimension
+  vi->numericJacobian(this, delta, _jacobianOplusXi.data());
 
   _error = errorBeforeNumeric;
 #ifdef G2O_OPENMP
@@ -35,6 +35,7 @@
 #include <Eigen/Dense>
 #include <Eigen/Cholesky>
 #include <Eigen/StdVector>
+#include <new>
 #include <stack>
 
 namespace g2o {
@@ -90,11 +91,23 @@ namespace g2o {
     HessianBlockType& A() { return _hessian;}
     const HessianBlockType& A() const { return _hessian;}
 
+    virtual void numericJacobian(OptimizableGraph::Edge* edge, number_t delta, number_t* jacobian);
+
     virtual void push() { _backup.push(_estimate);}
     virtual void pop() { assert(!_backup.empty()); _estimate = _backup.top(); _backup.pop(); updateCache();}
     virtual void discardTop() { assert(!_backup.empty()); _backup.pop();}
     virtual int stackSize() const {return _backup.size();}
 
+    virtual size_t estimateCopySize() const { return sizeof(EstimateType);}
+    virtual void saveEstimateCopy(void* d, bool construct) const {
+      if (construct)
+        ::new (d) EstimateType(_estimate);
+      else
+        *static_cast<EstimateType*>(d) = _estimate;
+    }
+    virtual void restoreEstimateCopy(const void* d) { _estimate = *static_cast<const EstimateType*>(d);}
+    virtual void destroyEstimateCopy(void* d) const { static_cast<EstimateType*>(d)->~EstimateType();}
+
     //! return the current estimate of the vertex
     const EstimateType& estimate() const { return _estimate;}
     //! set the estimate for the vertex also calls updateCache()
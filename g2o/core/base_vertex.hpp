@@ -53,3 +53,32 @@ void BaseVertex<D, T>::mapHessianMemory(number_t* d)
 {
   new (&_hessian) HessianBlockType(d, D, D);
 }
+
+template <int D, typename T>
+void BaseVertex<D, T>::numericJacobian(OptimizableGraph::Edge* edge, number_t delta, number_t* jacobian)
+{
+  const int errorDim = edge->dimension();
+  const number_t scalar = 1 / (2*delta);
+  Eigen::Map<Eigen::Matrix<number_t, Eigen::Dynamic, D, Eigen::ColMajor> > J(jacobian, errorDim, D);
+  Eigen::Map<const VectorX> error(edge->errorData(), errorDim);
+
+  const EstimateType estimateBeforeNumeric = _estimate;
+  number_t add[D] = {};
+  for (int d = 0; d < D; ++d) {
+    add[d] = delta;
+    oplusImpl(add);
+    updateCache();
+    edge->computeError();
+    J.col(d) = error;
+    _estimate = estimateBeforeNumeric;
+    add[d] = -delta;
+    oplusImpl(add);
+    updateCache();
+    edge->computeError();
+    J.col(d) -= error;
+    _estimate = estimateBeforeNumeric;
+    add[d] = 0.;
+    J.col(d) *= scalar;
+  }
+  updateCache();
+}
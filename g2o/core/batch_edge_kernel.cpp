@@ -0,0 +1,61 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "batch_edge_kernel.h"
+
+using namespace std;
+
+namespace g2o {
+
+  BatchEdgeKernel::~BatchEdgeKernel()
+  {
+  }
+
+  BatchEdgeKernelFactory* BatchEdgeKernelFactory::instance()
+  {
+    static BatchEdgeKernelFactory factory;
+    return &factory;
+  }
+
+  void BatchEdgeKernelFactory::registerKernel(const std::string& edgeTypeName, Creator c)
+  {
+    _creators[edgeTypeName] = c;
+  }
+
+  void BatchEdgeKernelFactory::unregisterKernel(const std::string& edgeTypeName)
+  {
+    _creators.erase(edgeTypeName);
+  }
+
+  BatchEdgeKernel* BatchEdgeKernelFactory::construct(const std::string& edgeTypeName) const
+  {
+    map<string, Creator>::const_iterator foundIt = _creators.find(edgeTypeName);
+    if (foundIt == _creators.end())
+      return 0;
+    return foundIt->second();
+  }
+
+} // end namespace
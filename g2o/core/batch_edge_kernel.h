@@ -0,0 +1,194 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_BATCH_EDGE_KERNEL_H
+#define G2O_BATCH_EDGE_KERNEL_H
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+
+#include "optimizable_graph.h"
+#include "g2o_core_api.h"
+
+namespace g2o {
+
+  /**
+   * \brief evaluates the errors and the Jacobians of many edges of one type at once
+   *
+   * A kernel is created for each edge type with a registered kernel (see
+   * BatchEdgeKernelFactory) by the SparseOptimizer if batch evaluation is
+   * enabled. The edges are processed in chunks of LaneWidth edges, such that
+   * the arithmetic on the chunk is carried out by the packet math of Eigen on
+   * Lanes arrays. setEdges() only keeps the edges and their vertices, the
+   * estimates of the vertices as well as the measurements and the calibration
+   * of the edges are gathered in each call, such that changing them between
+   * two iterations does not require to rebuild the kernel.
+   */
+  class G2O_CORE_API BatchEdgeKernel
+  {
+    public:
+      //! number of edges evaluated in one chunk
+      enum { LaneWidth = 8 };
+      typedef Eigen::Array<number_t, LaneWidth, 1> Lanes;
+
+    public:
+      virtual ~BatchEdgeKernel();
+
+      /**
+       * pack the edges, which are of the type the kernel is registered for,
+       * and the constant data needed for evaluating them
+       */
+      virtual void setEdges(const std::vector<OptimizableGraph::Edge*>& edges) = 0;
+
+      //! compute the error of all edges and store it in the edges
+      virtual void computeErrors() = 0;
+
+      /**
+       * compute the Jacobians of all edges into the memory of the kernel and
+       * map the Jacobians of the edges to it
+       */
+      virtual void linearizeOplus() = 0;
+
+      //! the Jacobian of the k-th edge of the kernel with respect to its i-th vertex
+      virtual const number_t* jacobianData(int k, int i) const = 0;
+
+      //! number of edges evaluated by the kernel
+      int size() const { return static_cast<int>(_edges.size());}
+      const std::vector<OptimizableGraph::Edge*>& edges() const { return _edges;}
+
+    protected:
+      //! number of chunks needed to evaluate all edges
+      int numChunks() const { return (size() + LaneWidth - 1) / LaneWidth;}
+      //! the edge evaluated by the lane, the last chunk repeats its last edge to fill up the lanes
+      int laneEdge(int chunk, int lane) const { return std::min(chunk * LaneWidth + lane, size() - 1);}
+      //! number of lanes of the chunk which evaluate an edge of their own
+      int validLanes(int chunk) const { return std::min<int>(LaneWidth, size() - chunk * LaneWidth);}
+
+      std::vector<OptimizableGraph::Edge*> _edges;
+  };
+
+  /**
+   * \brief base for the kernels of binary edges, provides the storage of the Jacobians
+   *
+   * The Jacobians of an edge are stored next to each other, each padded
+   * to the alignment of Eigen such that the edge can map its Jacobians to
+   * them.
+   */
+  template <typename E>
+  class BaseBatchEdgeKernel : public BatchEdgeKernel
+  {
+    public:
+      typedef E EdgeType;
+      typedef typename E::VertexXiType VertexXiType;
+      typedef typename E::VertexXjType VertexXjType;
+      static const int D = E::Dimension;
+      static const int Di = E::Di;
+      static const int Dj = E::Dj;
+
+      static const int Alignment = EIGEN_MAX_ALIGN_BYTES > static_cast<int>(sizeof(number_t)) ? EIGEN_MAX_ALIGN_BYTES / static_cast<int>(sizeof(number_t)) : 1;
+      static const int JacobianXiStride = (D * Di + Alignment - 1) / Alignment * Alignment;
+      static const int JacobianXjStride = (D * Dj + Alignment - 1) / Alignment * Alignment;
+
+      virtual void setEdges(const std::vector<OptimizableGraph::Edge*>& edges)
+      {
+        _edges = edges;
+        _vertexXi.resize(edges.size());
+        _vertexXj.resize(edges.size());
+        for (size_t k = 0; k < edges.size(); ++k) {
+          _vertexXi[k] = static_cast<VertexXiType*>(edges[k]->vertex(0));
+          _vertexXj[k] = static_cast<VertexXjType*>(edges[k]->vertex(1));
+        }
+        _jacobians.resize(edges.size() * (JacobianXiStride + JacobianXjStride));
+      }
+
+      virtual const number_t* jacobianData(int k, int i) const
+      {
+        const number_t* ji = _jacobians.data() + k * (JacobianXiStride + JacobianXjStride);
+        return i == 0 ? ji : ji + JacobianXiStride;
+      }
+
+    protected:
+      EdgeType* edge(int k) const { return static_cast<EdgeType*>(_edges[k]);}
+      number_t* jacobianXi(int k) { return _jacobians.data() + k * (JacobianXiStride + JacobianXjStride);}
+      number_t* jacobianXj(int k) { return jacobianXi(k) + JacobianXiStride;}
+      //! map the Jacobians of the edge to the memory of the kernel
+      void mapJacobians(int k) { edge(k)->mapJacobianMemory(jacobianXi(k), jacobianXj(k));}
+
+      std::vector<VertexXiType*> _vertexXi;
+      std::vector<VertexXjType*> _vertexXj;
+      std::vector<number_t, Eigen::aligned_allocator<number_t> > _jacobians;
+  };
+
+  /**
+   * \brief create the batch kernels based on the type of the edges
+   */
+  class G2O_CORE_API BatchEdgeKernelFactory
+  {
+    public:
+      typedef BatchEdgeKernel* (*Creator)();
+
+      //! return the instance
+      static BatchEdgeKernelFactory* instance();
+
+      //! register a kernel for the edge type, given by the name of its typeid
+      void registerKernel(const std::string& edgeTypeName, Creator c);
+      void unregisterKernel(const std::string& edgeTypeName);
+
+      //! construct the kernel for the edge type, 0 if none is registered
+      BatchEdgeKernel* construct(const std::string& edgeTypeName) const;
+
+    protected:
+      std::map<std::string, Creator> _creators;
+  };
+
+  template<typename EdgeType, typename KernelType>
+  class RegisterBatchEdgeKernelProxy
+  {
+    public:
+      RegisterBatchEdgeKernelProxy()
+      {
+        BatchEdgeKernelFactory::instance()->registerKernel(typeid(EdgeType).name(), &create);
+      }
+      ~RegisterBatchEdgeKernelProxy()
+      {
+        BatchEdgeKernelFactory::instance()->unregisterKernel(typeid(EdgeType).name());
+      }
+    private:
+      static BatchEdgeKernel* create() { return new KernelType;}
+  };
+
+#define G2O_REGISTER_BATCH_EDGE_KERNEL(edgeclass, kernelclass) \
+    static g2o::RegisterBatchEdgeKernelProxy<edgeclass, kernelclass> g_batch_edge_kernel_proxy_##kernelclass;
+
+} // end namespace
+
+#endif
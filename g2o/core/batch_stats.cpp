@@ -25,66 +25,177 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "batch_stats.h"
-#include <cstring>
+
+#include <iomanip>
+#include <limits>
+
+#ifdef G2O_OPENMP
+#include <omp.h>
+#endif
 
 namespace g2o {
   using namespace std;
 
   G2OBatchStatistics* G2OBatchStatistics::_globalStats=0;
 
-  #ifndef PTHING
-  #define PTHING(s) \
-    #s << "= " << (st.s) << "\t "
-  #endif
+  namespace {
+    /**
+     * call the visitor for each scalar field of the statistics in the order used for the output
+     */
+    template <typename Visitor>
+    void visitFields(const G2OBatchStatistics& st, Visitor& visitor)
+    {
+#     define G2O_VISIT_FIELD(s) visitor(#s, st.s)
+      G2O_VISIT_FIELD(iteration);
 
-  G2OBatchStatistics::G2OBatchStatistics(){
-    // zero all.
-    memset (this, 0, sizeof(G2OBatchStatistics));
+      G2O_VISIT_FIELD(numVertices); // how many vertices are involved
+      G2O_VISIT_FIELD(numEdges); // how many edges
+      G2O_VISIT_FIELD(chi2);  // total chi2
 
-    // set the iteration to -1 to show that it isn't valid
-    iteration = -1;
+      /** timings **/
+      // nonlinear part
+      G2O_VISIT_FIELD(timeResiduals);
+      G2O_VISIT_FIELD(timeLinearize);   // jacobians
+      G2O_VISIT_FIELD(timeQuadraticForm); // construct the quadratic form in the graph
+
+      // block_solver (constructs Ax=b, plus maybe schur);
+      G2O_VISIT_FIELD(timeSchurComplement); // compute schur complement (0 if not done);
+
+      // linear solver (computes Ax=b);
+      G2O_VISIT_FIELD(timeSymbolicDecomposition); // symbolic decomposition (0 if not done);
+      G2O_VISIT_FIELD(timeNumericDecomposition); // numeric decomposition  (0 if not done);
+      G2O_VISIT_FIELD(timeLinearSolution);             // total time for solving Ax=b
+      G2O_VISIT_FIELD(iterationsLinearSolver);  // iterations of PCG
+      G2O_VISIT_FIELD(timeUpdate); // oplus
+      G2O_VISIT_FIELD(timeIteration); // total time
+
+      G2O_VISIT_FIELD(levenbergIterations);
+      G2O_VISIT_FIELD(timeLinearSolver);
+
+      G2O_VISIT_FIELD(hessianDimension);
+      G2O_VISIT_FIELD(hessianPoseDimension);
+      G2O_VISIT_FIELD(hessianLandmarkDimension);
+      G2O_VISIT_FIELD(choleskyNNZ);
+      G2O_VISIT_FIELD(timeMarginals);
+
+      G2O_VISIT_FIELD(hessianBlocks);
+      G2O_VISIT_FIELD(hessianAllocations);
+      G2O_VISIT_FIELD(numThreads);
+#     undef G2O_VISIT_FIELD
+    }
+
+    struct TextWriter
+    {
+      explicit TextWriter(ostream& os_) : os(os_) {}
+      template <typename T>
+      void operator()(const char* name, const T& value) { os << name << "= " << value << "\t ";}
+      ostream& os;
+    };
+
+    struct CSVHeaderWriter
+    {
+      explicit CSVHeaderWriter(ostream& os_) : os(os_), first(true) {}
+      template <typename T>
+      void operator()(const char* name, const T&) { os << (first ? "" : ",") << name; first = false;}
+      ostream& os;
+      bool first;
+    };
+
+    struct CSVWriter
+    {
+      explicit CSVWriter(ostream& os_) : os(os_), first(true) {}
+      template <typename T>
+      void operator()(const char*, const T& value) { os << (first ? "" : ",") << value; first = false;}
+      ostream& os;
+      bool first;
+    };
+
+    struct JSONWriter
+    {
+      explicit JSONWriter(ostream& os_) : os(os_), first(true) {}
+      template <typename T>
+      void operator()(const char* name, const T& value) { os << (first ? "" : ", ") << "\"" << name << "\": " << value; first = false;}
+      ostream& os;
+      bool first;
+    };
   }
 
-  std::ostream& operator << (std::ostream& os , const G2OBatchStatistics& st)
+  G2OThreadStatistics::G2OThreadStatistics() :
+    edgesLinearized(0), timeQuadraticForm(0.)
   {
-    os << PTHING(iteration);
-
-    os << PTHING( numVertices ); // how many vertices are involved
-    os << PTHING( numEdges ); // hoe many edges
-    os << PTHING(  chi2 );  // total chi2
-    
-    /** timings **/
-    // nonlinear part
-    os << PTHING(  timeResiduals );  
-    os << PTHING(  timeLinearize );   // jacobians
-    os << PTHING(  timeQuadraticForm ); // construct the quadratic form in the graph
-    
-    // block_solver (constructs Ax=b, plus maybe schur);
-    os << PTHING(  timeSchurComplement ); // compute schur complement (0 if not done);
-    
-    // linear solver (computes Ax=b); );
-    os << PTHING(  timeSymbolicDecomposition ); // symbolic decomposition (0 if not done);
-    os << PTHING(  timeNumericDecomposition ); // numeric decomposition  (0 if not done);
-    os << PTHING(  timeLinearSolution );             // total time for solving Ax=b
-    os << PTHING(  iterationsLinearSolver );  // iterations of PCG
-    os << PTHING(  timeUpdate ); // oplus
-    os << PTHING(  timeIteration ); // total time );
-
-    os << PTHING( levenbergIterations );
-    os << PTHING( timeLinearSolver);
-
-    os << PTHING(hessianDimension);
-    os << PTHING(hessianPoseDimension);
-    os << PTHING(hessianLandmarkDimension);
-    os << PTHING(choleskyNNZ);
-    os << PTHING(timeMarginals);
+  }
 
-    return os;
-  };
+  G2OBatchStatistics::G2OBatchStatistics() :
+    // set the iteration to -1 to show that it isn't valid
+    iteration(-1), numVertices(0), numEdges(0), chi2(0.),
+    timeResiduals(0.), timeLinearize(0.), timeQuadraticForm(0.), levenbergIterations(0),
+    timeSchurComplement(0.), timeSymbolicDecomposition(0.), timeNumericDecomposition(0.),
+    timeLinearSolution(0.), timeLinearSolver(0.), iterationsLinearSolver(0),
+    timeUpdate(0.), timeIteration(0.), timeMarginals(0.),
+    hessianDimension(0), hessianPoseDimension(0), hessianLandmarkDimension(0), choleskyNNZ(0),
+    hessianBlocks(0), hessianAllocations(0), numThreads(1)
+  {
+#   ifdef G2O_OPENMP
+    numThreads = omp_get_max_threads();
+#   endif
+  }
 
   void G2OBatchStatistics::setGlobalStats(G2OBatchStatistics* b)
   {
     _globalStats = b;
   }
 
+  std::ostream& operator << (std::ostream& os , const G2OBatchStatistics& st)
+  {
+    TextWriter writer(os);
+    visitFields(st, writer);
+    return os;
+  }
+
+  void writeBatchStatisticsCSV(std::ostream& os, const BatchStatisticsContainer& stats)
+  {
+    // one group of columns for each thread
+    size_t numThreads = 0;
+    for (size_t i = 0; i < stats.size(); ++i)
+      numThreads = max(numThreads, stats[i].threadStatistics.size());
+
+    const G2OBatchStatistics empty;
+    CSVHeaderWriter header(os);
+    visitFields(empty, header);
+    for (size_t t = 0; t < numThreads; ++t)
+      os << ",thread" << t << "_edgesLinearized,thread" << t << "_timeQuadraticForm";
+    os << endl;
+
+    os << setprecision(numeric_limits<number_t>::digits10 + 1);
+    for (size_t i = 0; i < stats.size(); ++i) {
+      const G2OBatchStatistics& st = stats[i];
+      CSVWriter writer(os);
+      visitFields(st, writer);
+      for (size_t t = 0; t < numThreads; ++t) {
+        G2OThreadStatistics ts = t < st.threadStatistics.size() ? st.threadStatistics[t] : G2OThreadStatistics();
+        os << "," << ts.edgesLinearized << "," << ts.timeQuadraticForm;
+      }
+      os << endl;
+    }
+  }
+
+  void writeBatchStatisticsJSON(std::ostream& os, const BatchStatisticsContainer& stats)
+  {
+    os << setprecision(numeric_limits<number_t>::digits10 + 1);
+    os << "[" << endl;
+    for (size_t i = 0; i < stats.size(); ++i) {
+      const G2OBatchStatistics& st = stats[i];
+      os << "  {";
+      JSONWriter writer(os);
+      visitFields(st, writer);
+      os << ", \"threadStatistics\": [";
+      for (size_t t = 0; t < st.threadStatistics.size(); ++t) {
+        const G2OThreadStatistics& ts = st.threadStatistics[t];
+        os << (t > 0 ? ", " : "") << "{\"edgesLinearized\": " << ts.edgesLinearized << ", \"timeQuadraticForm\": " << ts.timeQuadraticForm << "}";
+      }
+      os << "]}" << (i + 1 < stats.size() ? "," : "") << endl;
+    }
+    os << "]" << endl;
+  }
+
 } // end namespace
@@ -30,12 +30,27 @@
 #include <iostream>
 #include <vector>
 
+#include "g2o/stuff/timeutil.h"
 #include "g2o_core_api.h"
 
 namespace g2o {
 
+  /**
+   * \brief counters of a single thread within one iteration
+   */
+  struct G2O_CORE_API G2OThreadStatistics {
+    G2OThreadStatistics();
+    int edgesLinearized;              ///< edges linearized and accumulated into the Hessian by the thread
+    number_t timeQuadraticForm;       ///< time the thread spent on linearizing and constructing the quadratic form
+  };
+
   /**
    * \brief statistics about the optimization
+   *
+   * The statistics of the current iteration are owned by the SparseOptimizer
+   * and passed down to the algorithm, the block solver, and the linear
+   * solver, see SparseOptimizer::currentBatchStatistics(). Hence, several
+   * optimizers running concurrently each fill their own statistics.
    */
   struct G2O_CORE_API G2OBatchStatistics {
     G2OBatchStatistics();
@@ -69,7 +84,16 @@ namespace g2o {
     size_t hessianPoseDimension;      ///< dimension of the pose matrix in Schur
     size_t hessianLandmarkDimension;  ///< dimension of the landmark matrix in Schur
     size_t choleskyNNZ;               ///< number of non-zeros in the cholesky factor
+    size_t hessianBlocks;             ///< number of blocks of the Hessian (including the Schur complement)
+    size_t hessianAllocations;        ///< number of heap allocations holding the blocks of the Hessian
 
+    int numThreads;                   ///< number of threads available to the optimizer
+    std::vector<G2OThreadStatistics> threadStatistics; ///< counters of the threads building the system
+
+    /**
+     * the statistics of the iteration most recently started by an optimizer which
+     * records statistics. Not used by g2o itself, kept for external code.
+     */
     static G2OBatchStatistics* globalStats() {return _globalStats;}
     static void setGlobalStats(G2OBatchStatistics* b);
     protected:
@@ -79,6 +103,52 @@ namespace g2o {
   G2O_CORE_API std::ostream& operator<<(std::ostream&, const G2OBatchStatistics&);
 
   typedef std::vector<G2OBatchStatistics> BatchStatisticsContainer;
+
+  /**
+   * \brief measures the time of a scope into a timing field of the given statistics
+   *
+   * Does not query the clock at all if no statistics are recorded, i.e., stats is 0, e.g.,
+   * BatchStatisticsTimer timer(optimizer->currentBatchStatistics(), &G2OBatchStatistics::timeResiduals);
+   */
+  class G2O_CORE_API BatchStatisticsTimer {
+    public:
+      typedef number_t G2OBatchStatistics::* TimingField;
+
+      BatchStatisticsTimer(G2OBatchStatistics* stats, TimingField field, bool accumulate = false) :
+        _stats(stats), _field(field), _accumulate(accumulate),
+        _start(_stats ? get_monotonic_time() : 0.)
+      {}
+      ~BatchStatisticsTimer()
+      {
+        stop();
+      }
+
+      //! write the elapsed time to the statistics, later calls have no effect
+      void stop()
+      {
+        if (! _stats)
+          return;
+        number_t elapsed = get_monotonic_time() - _start;
+        if (_accumulate)
+          _stats->*_field += elapsed;
+        else
+          _stats->*_field = elapsed;
+        _stats = 0;
+      }
+
+    private:
+      G2OBatchStatistics* _stats;
+      TimingField _field;
+      bool _accumulate;
+      number_t _start;
+      BatchStatisticsTimer(const BatchStatisticsTimer&);
+      BatchStatisticsTimer& operator=(const BatchStatisticsTimer&);
+  };
+
+  //! write the statistics as CSV with a header line, one line per iteration
+  G2O_CORE_API void writeBatchStatisticsCSV(std::ostream& os, const BatchStatisticsContainer& stats);
+  //! write the statistics as a JSON array, one object per iteration
+  G2O_CORE_API void writeBatchStatisticsJSON(std::ostream& os, const BatchStatisticsContainer& stats);
 }
 
 #endif
@@ -33,6 +33,7 @@
 #include "sparse_block_matrix.h"
 #include "sparse_block_matrix_diagonal.h"
 #include "openmp_mutex.h"
+#include "edge_coloring.h"
 #include "g2o/config.h"
 #include "dynamic_aligned_buffer.hpp"
 
@@ -126,6 +127,7 @@ namespace g2o {
       virtual bool init(SparseOptimizer* optmizer, bool online = false);
       virtual bool buildStructure(bool zeroBlocks = false);
       virtual bool updateStructure(const std::vector<HyperGraph::Vertex*>& vset, const HyperGraph::EdgeSet& edges);
+      virtual bool removeFromStructure(const std::vector<HyperGraph::Vertex*>& vset, const HyperGraph::EdgeSet& edges);
       virtual bool buildSystem();
       virtual bool solve();
       virtual bool computeMarginals(SparseBlockMatrix<MatrixX>& spinv, const std::vector<std::pair<int, int> >& blockIndices);
@@ -135,6 +137,23 @@ namespace g2o {
       virtual bool schur() { return _doSchur;}
       virtual void setSchur(bool s) { _doSchur = s;}
 
+      /**
+       * store the blocks of the Hessian in contiguous slabs (default) instead of allocating
+       * each block separately. Takes effect on the next call to buildStructure().
+       */
+      void setArenaStorage(bool arenaStorage) { _arenaStorage = arenaStorage;}
+      bool arenaStorage() const { return _arenaStorage;}
+
+      /**
+       * if compiled with OpenMP, color the active edges such that edges of the same color
+       * do not share a vertex and assemble the quadratic form color by color without taking
+       * any lock (default). Otherwise, all the edges are processed at once and each edge
+       * locks the vertices it writes to. Takes effect on the next call to buildStructure().
+       * Vertices of a degree above EdgeColoring::maxVertexDegree() are locked in either case.
+       */
+      void setColoredAssembly(bool coloredAssembly) { _coloredAssembly = coloredAssembly;}
+      bool coloredAssembly() const { return _coloredAssembly;}
+
       LinearSolver<PoseMatrixType>& linearSolver() const { return *_linearSolver;}
 
       virtual void setWriteDebug(bool writeDebug);
@@ -150,6 +169,22 @@ namespace g2o {
 
       void deallocate();
 
+      //! linearize the edge and accumulate its quadratic form into the blocks of its vertices
+      void constructQuadraticForm(OptimizableGraph::Edge* e, JacobianWorkspace& jacobianWorkspace);
+
+      //! color the active edges and configure the locking of the vertices accordingly
+      void computeEdgeColoring();
+
+      /**
+       * compare the block pattern of the matrix passed to the linear solver with the one of
+       * the previous call and re-initialize the linear solver accordingly, i.e., keep its
+       * symbolic decomposition if the pattern did not change.
+       */
+      void updateLinearSolverPattern();
+
+      //! allocate the blocks of the edge in Hpp, Hpl, Hll and register the pose-pose blocks in the Schur pattern
+      void mapEdgeMemory(OptimizableGraph::Edge* e, bool zeroBlocks, SparseBlockMatrixHashMap<PoseMatrixType>* schurMatrixLookup);
+
       std::unique_ptr<SparseBlockMatrix<PoseMatrixType>> _Hpp;
       std::unique_ptr<SparseBlockMatrix<LandmarkMatrixType>> _Hll;
       std::unique_ptr<SparseBlockMatrix<PoseLandmarkMatrixType>> _Hpl;
@@ -158,6 +193,7 @@ namespace g2o {
       std::unique_ptr<SparseBlockMatrixDiagonal<LandmarkMatrixType>> _DInvSchur;
 
       std::unique_ptr<SparseBlockMatrixCCS<PoseLandmarkMatrixType>> _HplCCS;
+      std::unique_ptr<SparseBlockMatrixCCS<PoseLandmarkMatrixType>> _HplTransposedCCS;
       std::unique_ptr<SparseBlockMatrixCCS<PoseMatrixType>> _HschurTransposedCCS;
 
       std::unique_ptr<LinearSolverType> _linearSolver;
@@ -165,11 +201,15 @@ namespace g2o {
       std::vector<PoseVectorType, Eigen::aligned_allocator<PoseVectorType> > _diagonalBackupPose;
       std::vector<LandmarkVectorType, Eigen::aligned_allocator<LandmarkVectorType> > _diagonalBackupLandmark;
 
-#    ifdef G2O_OPENMP
-      std::vector<OpenMPMutex> _coefficientsMutex;
-#    endif
-
       bool _doSchur;
+      bool _arenaStorage;
+
+      // block pattern of the matrix the linear solver has seen last
+      std::vector<int> _patternBlockIndices;
+      std::vector<int> _patternColumnStart;
+      std::vector<int> _patternRows;
+      bool _coloredAssembly;
+      EdgeColoring _edgeColoring;
 
       std::unique_ptr<number_t[], aligned_deleter<number_t>> _coefficients;
       std::unique_ptr<number_t[], aligned_deleter<number_t>> _bschur;
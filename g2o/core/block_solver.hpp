@@ -48,6 +48,8 @@ BlockSolver<Traits>::BlockSolver(std::unique_ptr<LinearSolverType> linearSolver)
   _sizePoses=0;
   _sizeLandmarks=0;
   _doSchur=true;
+  _arenaStorage=true;
+  _coloredAssembly=true;
 }
 
 template <typename Traits>
@@ -67,16 +69,18 @@ void BlockSolver<Traits>::resize(int* blockPoseIndices, int numPoseBlocks,
   }
 
   _Hpp= g2o::make_unique<PoseHessianType>(blockPoseIndices, blockPoseIndices, numPoseBlocks, numPoseBlocks);
+  _Hpp->setArenaStorage(_arenaStorage);
   if (_doSchur) {
     _Hschur = g2o::make_unique<PoseHessianType>(blockPoseIndices, blockPoseIndices, numPoseBlocks, numPoseBlocks);
+    _Hschur->setArenaStorage(_arenaStorage);
     _Hll = g2o::make_unique<LandmarkHessianType>(blockLandmarkIndices, blockLandmarkIndices, numLandmarkBlocks, numLandmarkBlocks);
+    _Hll->setArenaStorage(_arenaStorage);
     _DInvSchur = g2o::make_unique<SparseBlockMatrixDiagonal<LandmarkMatrixType>>(_Hll->colBlockIndices());
     _Hpl = g2o::make_unique<PoseLandmarkHessianType>(blockPoseIndices, blockLandmarkIndices, numPoseBlocks, numLandmarkBlocks);
+    _Hpl->setArenaStorage(_arenaStorage);
     _HplCCS = g2o::make_unique<SparseBlockMatrixCCS<PoseLandmarkMatrixType>>(_Hpl->rowBlockIndices(), _Hpl->colBlockIndices());
+    _HplTransposedCCS = g2o::make_unique<SparseBlockMatrixCCS<PoseLandmarkMatrixType>>(_Hpl->colBlockIndices(), _Hpl->rowBlockIndices());
     _HschurTransposedCCS = g2o::make_unique<SparseBlockMatrixCCS<PoseMatrixType>>(_Hschur->colBlockIndices(), _Hschur->rowBlockIndices());
-#ifdef G2O_OPENMP
-    _coefficientsMutex.resize(numPoseBlocks);
-#endif
   }
 }
 
@@ -92,6 +96,7 @@ void BlockSolver<Traits>::deallocate()
     _bschur.reset();
     
     _HplCCS.reset();
+    _HplTransposedCCS.reset();
     _HschurTransposedCCS.reset();
 }
 
@@ -132,6 +137,36 @@ bool BlockSolver<Traits>::buildStructure(bool zeroBlocks)
   delete[] blockLandmarkIndices;
   delete[] blockPoseIndices;
 
+  computeEdgeColoring();
+
+  if (_arenaStorage) {
+    // upper bound on the number of blocks, allows to allocate the blocks of each matrix at once
+    size_t numPosePose = _numPoses, numPoseLandmark = 0, numLandmarkLandmark = _numLandmarks;
+    for (OptimizableGraph::Edge* e : _optimizer->activeEdges()) {
+      for (size_t viIdx = 0; viIdx < e->vertices().size(); ++viIdx) {
+        const OptimizableGraph::Vertex* v1 = static_cast<const OptimizableGraph::Vertex*>(e->vertex(viIdx));
+        if (v1->hessianIndex() == -1)
+          continue;
+        for (size_t vjIdx = viIdx + 1; vjIdx < e->vertices().size(); ++vjIdx) {
+          const OptimizableGraph::Vertex* v2 = static_cast<const OptimizableGraph::Vertex*>(e->vertex(vjIdx));
+          if (v2->hessianIndex() == -1)
+            continue;
+          if (! v1->marginalized() && ! v2->marginalized())
+            ++numPosePose;
+          else if (v1->marginalized() && v2->marginalized())
+            ++numLandmarkLandmark;
+          else
+            ++numPoseLandmark;
+        }
+      }
+    }
+    _Hpp->reserveBlocks(numPosePose);
+    if (_doSchur) {
+      _Hll->reserveBlocks(numLandmarkLandmark);
+      _Hpl->reserveBlocks(numPoseLandmark);
+    }
+  }
+
   // allocate the diagonal on Hpp and Hll
   int poseIdx = 0;
   int landmarkIdx = 0;
@@ -163,63 +198,18 @@ bool BlockSolver<Traits>::buildStructure(bool zeroBlocks)
 
   // here we assume that the landmark indices start after the pose ones
   // create the structure in Hpp, Hll and in Hpl
-  for (SparseOptimizer::EdgeContainer::const_iterator it=_optimizer->activeEdges().begin(); it!=_optimizer->activeEdges().end(); ++it){
-    OptimizableGraph::Edge* e = *it;
-
-    for (size_t viIdx = 0; viIdx < e->vertices().size(); ++viIdx) {
-      OptimizableGraph::Vertex* v1 = (OptimizableGraph::Vertex*) e->vertex(viIdx);
-      int ind1 = v1->hessianIndex();
-      if (ind1 == -1)
-        continue;
-      int indexV1Bak = ind1;
-      for (size_t vjIdx = viIdx + 1; vjIdx < e->vertices().size(); ++vjIdx) {
-        OptimizableGraph::Vertex* v2 = (OptimizableGraph::Vertex*) e->vertex(vjIdx);
-        int ind2 = v2->hessianIndex();
-        if (ind2 == -1)
-          continue;
-        ind1 = indexV1Bak;
-        bool transposedBlock = ind1 > ind2;
-        if (transposedBlock){ // make sure, we allocate the upper triangle block
-          std::swap(ind1, ind2);
-        }
-        if (! v1->marginalized() && !v2->marginalized()){
-          PoseMatrixType* m = _Hpp->block(ind1, ind2, true);
-          if (zeroBlocks)
-            m->setZero();
-          e->mapHessianMemory(m->data(), viIdx, vjIdx, transposedBlock);
-          if (_Hschur) {// assume this is only needed in case we solve with the schur complement
-            schurMatrixLookup->addBlock(ind1, ind2);
-          }
-        } else if (v1->marginalized() && v2->marginalized()){
-          // RAINER hmm.... should we ever reach this here????
-          LandmarkMatrixType* m = _Hll->block(ind1-_numPoses, ind2-_numPoses, true);
-          if (zeroBlocks)
-            m->setZero();
-          e->mapHessianMemory(m->data(), viIdx, vjIdx, false);
-        } else { 
-          if (v1->marginalized()){ 
-            PoseLandmarkMatrixType* m = _Hpl->block(v2->hessianIndex(),v1->hessianIndex()-_numPoses, true);
-            if (zeroBlocks)
-              m->setZero();
-            e->mapHessianMemory(m->data(), viIdx, vjIdx, true); // transpose the block before writing to it
-          } else {
-            PoseLandmarkMatrixType* m = _Hpl->block(v1->hessianIndex(),v2->hessianIndex()-_numPoses, true);
-            if (zeroBlocks)
-              m->setZero();
-            e->mapHessianMemory(m->data(), viIdx, vjIdx, false); // directly the block
-          }
-        }
-      }
-    }
-  }
+  for (SparseOptimizer::EdgeContainer::const_iterator it=_optimizer->activeEdges().begin(); it!=_optimizer->activeEdges().end(); ++it)
+    mapEdgeMemory(*it, zeroBlocks, schurMatrixLookup);
 
   if (! _doSchur) {
     delete schurMatrixLookup;
+    updateLinearSolverPattern();
     return true;
   }
 
   _DInvSchur->diagonal().resize(landmarkIdx);
   _Hpl->fillSparseBlockMatrixCCS(*_HplCCS);
+  _Hpl->fillSparseBlockMatrixCCSTransposed(*_HplTransposedCCS);
 
   for (OptimizableGraph::Vertex* v : _optimizer->indexMapping()) {
     if (v->marginalized()){
@@ -239,7 +229,7 @@ bool BlockSolver<Traits>::buildStructure(bool zeroBlocks)
               int i1=v1->hessianIndex();
               int i2=v2->hessianIndex();
               if (i1<=i2) {
-                schurMatrixLookup->addBlock(i1, i2);
+                schurMatrixLookup->addPattern(i1, i2);
               }
             }
           }
@@ -252,75 +242,274 @@ bool BlockSolver<Traits>::buildStructure(bool zeroBlocks)
   delete schurMatrixLookup;
   _Hschur->fillSparseBlockMatrixCCSTransposed(*_HschurTransposedCCS);
 
+  updateLinearSolverPattern();
   return true;
 }
 
+template <typename Traits>
+void BlockSolver<Traits>::mapEdgeMemory(OptimizableGraph::Edge* e, bool zeroBlocks, SparseBlockMatrixHashMap<PoseMatrixType>* schurMatrixLookup)
+{
+  for (size_t viIdx = 0; viIdx < e->vertices().size(); ++viIdx) {
+    OptimizableGraph::Vertex* v1 = (OptimizableGraph::Vertex*) e->vertex(viIdx);
+    int ind1 = v1->hessianIndex();
+    if (ind1 == -1)
+      continue;
+    int indexV1Bak = ind1;
+    for (size_t vjIdx = viIdx + 1; vjIdx < e->vertices().size(); ++vjIdx) {
+      OptimizableGraph::Vertex* v2 = (OptimizableGraph::Vertex*) e->vertex(vjIdx);
+      int ind2 = v2->hessianIndex();
+      if (ind2 == -1)
+        continue;
+      ind1 = indexV1Bak;
+      bool transposedBlock = ind1 > ind2;
+      if (transposedBlock){ // make sure, we allocate the upper triangle block
+        std::swap(ind1, ind2);
+      }
+      if (! v1->marginalized() && !v2->marginalized()){
+        PoseMatrixType* m = _Hpp->block(ind1, ind2, true);
+        if (zeroBlocks)
+          m->setZero();
+        e->mapHessianMemory(m->data(), viIdx, vjIdx, transposedBlock);
+        if (_Hschur) {// assume this is only needed in case we solve with the schur complement
+          if (schurMatrixLookup)
+            schurMatrixLookup->addPattern(ind1, ind2);
+          else
+            _Hschur->block(ind1, ind2, true);
+        }
+      } else if (v1->marginalized() && v2->marginalized()){
+        // RAINER hmm.... should we ever reach this here????
+        LandmarkMatrixType* m = _Hll->block(ind1-_numPoses, ind2-_numPoses, true);
+        if (zeroBlocks)
+          m->setZero();
+        e->mapHessianMemory(m->data(), viIdx, vjIdx, false);
+      } else { 
+        if (v1->marginalized()){ 
+          PoseLandmarkMatrixType* m = _Hpl->block(v2->hessianIndex(),v1->hessianIndex()-_numPoses, true);
+          if (zeroBlocks)
+            m->setZero();
+          e->mapHessianMemory(m->data(), viIdx, vjIdx, true); // transpose the block before writing to it
+        } else {
+          PoseLandmarkMatrixType* m = _Hpl->block(v1->hessianIndex(),v2->hessianIndex()-_numPoses, true);
+          if (zeroBlocks)
+            m->setZero();
+          e->mapHessianMemory(m->data(), viIdx, vjIdx, false); // directly the block
+        }
+      }
+    }
+  }
+}
+
+template <typename Traits>
+void BlockSolver<Traits>::updateLinearSolverPattern()
+{
+  const PoseHessianType& A = _doSchur ? *_Hschur : *_Hpp;
+  std::vector<int> columnStart;
+  std::vector<int> rows;
+  columnStart.reserve(A.blockCols().size() + 1);
+  rows.reserve(_patternRows.size());
+  columnStart.push_back(0);
+  for (size_t c = 0; c < A.blockCols().size(); ++c) {
+    const typename PoseHessianType::IntBlockMap& column = A.blockCols()[c];
+    for (typename PoseHessianType::IntBlockMap::const_iterator it = column.begin(); it != column.end(); ++it)
+      rows.push_back(it->first);
+    columnStart.push_back(rows.size());
+  }
+
+  bool samePattern = A.colBlockIndices() == _patternBlockIndices && columnStart == _patternColumnStart && rows == _patternRows;
+  if (samePattern) {
+    _linearSolver->initSamePattern();
+  } else {
+    _linearSolver->init();
+    _patternBlockIndices = A.colBlockIndices();
+    _patternColumnStart.swap(columnStart);
+    _patternRows.swap(rows);
+  }
+}
+
+template <typename Traits>
+void BlockSolver<Traits>::computeEdgeColoring()
+{
+# ifdef G2O_OPENMP
+  if (_coloredAssembly)
+    _edgeColoring.compute(_optimizer->activeEdges());
+  else
+    _edgeColoring.clear();
+  for (OptimizableGraph::Vertex* v : _optimizer->indexMapping())
+    v->setQuadraticFormLocking(! _coloredAssembly);
+  // edges of the same color may share a hub
+  for (OptimizableGraph::Vertex* v : _edgeColoring.hubVertices())
+    v->setQuadraticFormLocking(true);
+# endif
+}
+
 template <typename Traits>
 bool BlockSolver<Traits>::updateStructure(const std::vector<HyperGraph::Vertex*>& vset, const HyperGraph::EdgeSet& edges)
 {
-  for (std::vector<HyperGraph::Vertex*>::const_iterator vit = vset.begin(); vit != vset.end(); ++vit) {
-    OptimizableGraph::Vertex* v = static_cast<OptimizableGraph::Vertex*>(*vit);
-    int dim = v->dimension();
-    if (! v->marginalized()){
-      v->setColInHessian(_sizePoses);
-      _sizePoses+=dim;
-      _Hpp->rowBlockIndices().push_back(_sizePoses);
-      _Hpp->colBlockIndices().push_back(_sizePoses);
-      _Hpp->blockCols().push_back(typename SparseBlockMatrix<PoseMatrixType>::IntBlockMap());
-      ++_numPoses;
-      int ind = v->hessianIndex();
-      PoseMatrixType* m = _Hpp->block(ind, ind, true);
-      v->mapHessianMemory(m->data());
-    } else {
-      std::cerr << "updateStructure(): Schur not supported" << std::endl;
-      abort();
+  // the landmarks are numbered after the poses, hence add the poses first
+  for (int k = 0; k < 2; ++k) {
+    for (std::vector<HyperGraph::Vertex*>::const_iterator vit = vset.begin(); vit != vset.end(); ++vit) {
+      OptimizableGraph::Vertex* v = static_cast<OptimizableGraph::Vertex*>(*vit);
+      if (static_cast<int>(v->marginalized()) != k)
+        continue;
+      int dim = v->dimension();
+      if (! v->marginalized()){
+        v->setColInHessian(_sizePoses);
+        _sizePoses+=dim;
+        _Hpp->rowBlockIndices().push_back(_sizePoses);
+        _Hpp->colBlockIndices().push_back(_sizePoses);
+        _Hpp->blockCols().push_back(typename SparseBlockMatrix<PoseMatrixType>::IntBlockMap());
+        ++_numPoses;
+        int ind = v->hessianIndex();
+        assert(ind == _numPoses - 1 && "new poses need to be numbered after the existing ones");
+        PoseMatrixType* m = _Hpp->block(ind, ind, true);
+        v->mapHessianMemory(m->data());
+        if (_doSchur) {
+          _Hschur->rowBlockIndices().push_back(_sizePoses);
+          _Hschur->colBlockIndices().push_back(_sizePoses);
+          _Hschur->blockCols().push_back(typename SparseBlockMatrix<PoseMatrixType>::IntBlockMap());
+          _Hschur->block(ind, ind, true);
+          _Hpl->rowBlockIndices().push_back(_sizePoses);
+        }
+      } else {
+        if (! _doSchur) {
+          std::cerr << __PRETTY_FUNCTION__ << ": marginalized vertices require the Schur complement" << std::endl;
+          return false;
+        }
+        v->setColInHessian(_sizeLandmarks);
+        _sizeLandmarks+=dim;
+        _Hll->rowBlockIndices().push_back(_sizeLandmarks);
+        _Hll->colBlockIndices().push_back(_sizeLandmarks);
+        _Hll->blockCols().push_back(typename SparseBlockMatrix<LandmarkMatrixType>::IntBlockMap());
+        _Hpl->colBlockIndices().push_back(_sizeLandmarks);
+        _Hpl->blockCols().push_back(typename SparseBlockMatrix<PoseLandmarkMatrixType>::IntBlockMap());
+        ++_numLandmarks;
+        int ind = v->hessianIndex() - _numPoses;
+        assert(ind == _numLandmarks - 1 && "new landmarks need to be numbered after the existing ones");
+        LandmarkMatrixType* m = _Hll->block(ind, ind, true);
+        v->mapHessianMemory(m->data());
+      }
     }
   }
   resizeVector(_sizePoses + _sizeLandmarks);
+  if (_doSchur) {
+    _coefficients.reset(allocate_aligned<number_t>(_sizePoses + _sizeLandmarks));
+    _bschur.reset(allocate_aligned<number_t>(_sizePoses));
+    _DInvSchur->diagonal().resize(_numLandmarks);
+  }
 
+  std::vector<int> touchedLandmarks;
   for (HyperGraph::EdgeSet::const_iterator it = edges.begin(); it != edges.end(); ++it) {
     OptimizableGraph::Edge* e = static_cast<OptimizableGraph::Edge*>(*it);
+    mapEdgeMemory(e, false, 0);
+    if (! _doSchur)
+      continue;
+    for (size_t i = 0; i < e->vertices().size(); ++i) {
+      const OptimizableGraph::Vertex* v = static_cast<const OptimizableGraph::Vertex*>(e->vertex(i));
+      if (v->hessianIndex() >= 0 && v->marginalized())
+        touchedLandmarks.push_back(v->hessianIndex() - _numPoses);
+    }
+  }
 
-    for (size_t viIdx = 0; viIdx < e->vertices().size(); ++viIdx) {
-      OptimizableGraph::Vertex* v1 = (OptimizableGraph::Vertex*) e->vertex(viIdx);
-      int ind1 = v1->hessianIndex();
-      int indexV1Bak = ind1;
-      if (ind1 == -1)
-        continue;
-      for (size_t vjIdx = viIdx + 1; vjIdx < e->vertices().size(); ++vjIdx) {
-        OptimizableGraph::Vertex* v2 = (OptimizableGraph::Vertex*) e->vertex(vjIdx);
-        int ind2 = v2->hessianIndex();
-        if (ind2 == -1)
-          continue;
-        ind1 = indexV1Bak;
-        bool transposedBlock = ind1 > ind2;
-        if (transposedBlock) // make sure, we allocate the upper triangular block
-          std::swap(ind1, ind2);
-
-        if (! v1->marginalized() && !v2->marginalized()) {
-          PoseMatrixType* m = _Hpp->block(ind1, ind2, true);
-          e->mapHessianMemory(m->data(), viIdx, vjIdx, transposedBlock);
-        } else { 
-          std::cerr << __PRETTY_FUNCTION__ << ": not supported" << std::endl;
-        }
-      }
+  if (_doSchur) {
+    // only the landmarks which received a new observation change the pattern of the Schur complement
+    std::sort(touchedLandmarks.begin(), touchedLandmarks.end());
+    touchedLandmarks.erase(std::unique(touchedLandmarks.begin(), touchedLandmarks.end()), touchedLandmarks.end());
+    for (size_t k = 0; k < touchedLandmarks.size(); ++k) {
+      const typename SparseBlockMatrix<PoseLandmarkMatrixType>::IntBlockMap& landmarkColumn = _Hpl->blockCols()[touchedLandmarks[k]];
+      for (typename SparseBlockMatrix<PoseLandmarkMatrixType>::IntBlockMap::const_iterator it1 = landmarkColumn.begin(); it1 != landmarkColumn.end(); ++it1)
+        for (typename SparseBlockMatrix<PoseLandmarkMatrixType>::IntBlockMap::const_iterator it2 = it1; it2 != landmarkColumn.end(); ++it2)
+          _Hschur->block(it1->first, it2->first, true);
     }
+    _Hpl->fillSparseBlockMatrixCCS(*_HplCCS);
+    _Hpl->fillSparseBlockMatrixCCSTransposed(*_HplTransposedCCS);
+    _Hschur->fillSparseBlockMatrixCCSTransposed(*_HschurTransposedCCS);
+  }
+
+  computeEdgeColoring();
+  updateLinearSolverPattern();
+  return true;
+}
 
+template <typename Traits>
+bool BlockSolver<Traits>::removeFromStructure(const std::vector<HyperGraph::Vertex*>& vset, const HyperGraph::EdgeSet& edges)
+{
+  // the blocks of the removed edges stay in the pattern and are just no longer written
+  (void) edges;
+  if (vset.empty()) {
+    computeEdgeColoring();
+    return true;
   }
 
+  // drop the block rows and columns of the removed vertices, which are located by
+  // their column in the Hessian, and shift the remaining ones
+  std::vector<int> poseMapping(_numPoses, 0);
+  std::vector<int> landmarkMapping(_numLandmarks, 0);
+  for (std::vector<HyperGraph::Vertex*>::const_iterator vit = vset.begin(); vit != vset.end(); ++vit) {
+    OptimizableGraph::Vertex* v = static_cast<OptimizableGraph::Vertex*>(*vit);
+    const std::vector<int>& blockIndices = v->marginalized() ? _Hll->colBlockIndices() : _Hpp->colBlockIndices();
+    int ind = std::upper_bound(blockIndices.begin(), blockIndices.end(), v->colInHessian()) - blockIndices.begin();
+    std::vector<int>& mapping = v->marginalized() ? landmarkMapping : poseMapping;
+    assert(ind < static_cast<int>(mapping.size()) && "removed vertex is not part of the structure");
+    mapping[ind] = -1;
+  }
+  int numPoses = 0;
+  for (size_t i = 0; i < poseMapping.size(); ++i)
+    if (poseMapping[i] == 0)
+      poseMapping[i] = numPoses++;
+  int numLandmarks = 0;
+  for (size_t i = 0; i < landmarkMapping.size(); ++i)
+    if (landmarkMapping[i] == 0)
+      landmarkMapping[i] = numLandmarks++;
+
+  _Hpp->removeBlocks(poseMapping, poseMapping);
+  if (_doSchur) {
+    _Hschur->removeBlocks(poseMapping, poseMapping);
+    _Hll->removeBlocks(landmarkMapping, landmarkMapping);
+    _Hpl->removeBlocks(poseMapping, landmarkMapping);
+  }
+  _numPoses = numPoses;
+  _numLandmarks = numLandmarks;
+  _sizePoses = _Hpp->cols();
+  _sizeLandmarks = _doSchur ? _Hll->cols() : 0;
+
+  // the blocks did not move, only the columns of the vertices changed
+  for (size_t i = 0; i < _optimizer->indexMapping().size(); ++i) {
+    OptimizableGraph::Vertex* v = _optimizer->indexMapping()[i];
+    if (! v->marginalized())
+      v->setColInHessian(_Hpp->colBaseOfBlock(v->hessianIndex()));
+    else
+      v->setColInHessian(_Hll->colBaseOfBlock(v->hessianIndex() - _numPoses));
+  }
+  assert(static_cast<int>(_optimizer->indexMapping().size()) == _numPoses + _numLandmarks);
+
+  resizeVector(_sizePoses + _sizeLandmarks);
+  if (_doSchur) {
+    _coefficients.reset(allocate_aligned<number_t>(_sizePoses + _sizeLandmarks));
+    _bschur.reset(allocate_aligned<number_t>(_sizePoses));
+    _DInvSchur->diagonal().resize(_numLandmarks);
+    _Hpl->fillSparseBlockMatrixCCS(*_HplCCS);
+    _Hpl->fillSparseBlockMatrixCCSTransposed(*_HplTransposedCCS);
+    _Hschur->fillSparseBlockMatrixCCSTransposed(*_HschurTransposedCCS);
+  }
+
+  computeEdgeColoring();
+  updateLinearSolverPattern();
   return true;
 }
 
 template <typename Traits>
 bool BlockSolver<Traits>::solve(){
   //cerr << __PRETTY_FUNCTION__ << endl;
+  G2OBatchStatistics* stats = _optimizer->currentBatchStatistics();
+  _linearSolver->setBatchStatistics(stats);
   if (! _doSchur){
-    number_t t=get_monotonic_time();
+    BatchStatisticsTimer linearSolverTimer(stats, &G2OBatchStatistics::timeLinearSolver);
     bool ok = _linearSolver->solve(*_Hpp, _x, _b);
-    G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-    if (globalStats) {
-      globalStats->timeLinearSolver = get_monotonic_time() - t;
-      globalStats->hessianDimension = globalStats->hessianPoseDimension = _Hpp->cols();
+    linearSolverTimer.stop();
+    if (stats) {
+      stats->hessianDimension = stats->hessianPoseDimension = _Hpp->cols();
+      stats->hessianBlocks = _Hpp->nonZeroBlocks();
+      stats->hessianAllocations = _Hpp->numAllocations();
     }
     return ok;
   }
@@ -328,14 +517,19 @@ bool BlockSolver<Traits>::solve(){
   // schur thing
 
   // backup the coefficient matrix
-  number_t t=get_monotonic_time();
+  BatchStatisticsTimer schurTimer(stats, &G2OBatchStatistics::timeSchurComplement);
 
   // _Hschur = _Hpp, but keeping the pattern of _Hschur
   _Hschur->clear();
   _Hpp->add(*_Hschur);
 
-  //_DInvSchur->clear();
+  // the elimination is split into two passes which both write to disjoint memory
+  // only, hence no locking is required and the result does not depend on the
+  // number of threads.
+  // 1) per landmark: invert its diagonal block and compute Dinv * b_l, which is
+  //    stored in the landmark part of _coefficients until the back substitution.
   memset(_coefficients.get(), 0, _sizePoses*sizeof(number_t));
+  number_t* dbl = _coefficients.get() + _sizePoses;
 # ifdef G2O_OPENMP
 # pragma omp parallel for default (shared) schedule(dynamic, 10)
 # endif
@@ -349,42 +543,52 @@ bool BlockSolver<Traits>::solve(){
     LandmarkMatrixType& Dinv = _DInvSchur->diagonal()[landmarkIndex];
     Dinv = D->inverse();
 
-    LandmarkVectorType  db(D->rows());
-    for (int j=0; j<D->rows(); ++j) {
-      db[j]=_b[_Hll->rowBaseOfBlock(landmarkIndex) + _sizePoses + j];
-    }
-    db=Dinv*db;
-
-    assert((size_t)landmarkIndex < _HplCCS->blockCols().size() && "Index out of bounds");
-    const typename SparseBlockMatrixCCS<PoseLandmarkMatrixType>::SparseColumn& landmarkColumn = _HplCCS->blockCols()[landmarkIndex];
-
-    for (typename SparseBlockMatrixCCS<PoseLandmarkMatrixType>::SparseColumn::const_iterator it_outer = landmarkColumn.begin();
-        it_outer != landmarkColumn.end(); ++it_outer) {
-      int i1 = it_outer->row;
+    int landmarkBase = _Hll->rowBaseOfBlock(landmarkIndex);
+    typename LandmarkVectorType::ConstMapType bl(_b + _sizePoses + landmarkBase, D->rows());
+    typename LandmarkVectorType::MapType db(dbl + landmarkBase, D->rows());
+    db.noalias() = Dinv * bl;
+  }
 
+  // 2) per block row i1 of the reduced system: subtract the contribution of all the
+  //    landmarks observed by pose i1, i.e., B_i1l * Dinv_l * B_i2l^T for i2 >= i1.
+  //    Only the thread processing row i1 writes to the blocks of this row and to
+  //    the coefficients of pose i1.
+# ifdef G2O_OPENMP
+# pragma omp parallel for default (shared) schedule(dynamic, 4)
+# endif
+  for (int i1 = 0; i1 < static_cast<int>(_HplTransposedCCS->blockCols().size()); ++i1) {
+    const typename SparseBlockMatrixCCS<PoseLandmarkMatrixType>::SparseColumn& poseRow = _HplTransposedCCS->blockCols()[i1];
+    if (poseRow.empty())
+      continue;
+    assert(_HplCCS->rowBaseOfBlock(i1) < _sizePoses && "Index out of bounds");
+    typename PoseVectorType::MapType Bb(&_coefficients[_HplCCS->rowBaseOfBlock(i1)], _HplCCS->rowsOfBlock(i1));
+    typename SparseBlockMatrixCCS<PoseMatrixType>::SparseColumn& targetColumn = _HschurTransposedCCS->blockCols()[i1];
+
+    for (typename SparseBlockMatrixCCS<PoseLandmarkMatrixType>::SparseColumn::const_iterator it_outer = poseRow.begin();
+        it_outer != poseRow.end(); ++it_outer) {
+      int landmarkIndex = it_outer->row;
       const PoseLandmarkMatrixType* Bi = it_outer->block;
       assert(Bi);
 
-      PoseLandmarkMatrixType BDinv = (*Bi)*(Dinv);
-      assert(_HplCCS->rowBaseOfBlock(i1) < _sizePoses && "Index out of bounds");
-      typename PoseVectorType::MapType Bb(&_coefficients[_HplCCS->rowBaseOfBlock(i1)], Bi->rows());
-#    ifdef G2O_OPENMP
-      ScopedOpenMPMutex mutexLock(&_coefficientsMutex[i1]);
-#    endif
+      const LandmarkMatrixType& Dinv = _DInvSchur->diagonal()[landmarkIndex];
+      typename LandmarkVectorType::ConstMapType db(dbl + _Hll->rowBaseOfBlock(landmarkIndex), Dinv.rows());
       Bb.noalias() += (*Bi)*db;
 
-      assert(i1 >= 0 && i1 < static_cast<int>(_HschurTransposedCCS->blockCols().size()) && "Index out of bounds");
-      typename SparseBlockMatrixCCS<PoseMatrixType>::SparseColumn::iterator targetColumnIt = _HschurTransposedCCS->blockCols()[i1].begin();
+      PoseLandmarkMatrixType BDinv = (*Bi)*(Dinv);
+      assert((size_t)landmarkIndex < _HplCCS->blockCols().size() && "Index out of bounds");
+      const typename SparseBlockMatrixCCS<PoseLandmarkMatrixType>::SparseColumn& landmarkColumn = _HplCCS->blockCols()[landmarkIndex];
 
       typename SparseBlockMatrixCCS<PoseLandmarkMatrixType>::RowBlock aux(i1, 0);
       typename SparseBlockMatrixCCS<PoseLandmarkMatrixType>::SparseColumn::const_iterator it_inner = lower_bound(landmarkColumn.begin(), landmarkColumn.end(), aux);
+      typename SparseBlockMatrixCCS<PoseMatrixType>::RowBlock auxTarget(i1, 0);
+      typename SparseBlockMatrixCCS<PoseMatrixType>::SparseColumn::iterator targetColumnIt = lower_bound(targetColumn.begin(), targetColumn.end(), auxTarget);
       for (; it_inner != landmarkColumn.end(); ++it_inner) {
         int i2 = it_inner->row;
         const PoseLandmarkMatrixType* Bj = it_inner->block;
         assert(Bj); 
-        while (targetColumnIt->row < i2 /*&& targetColumnIt != _HschurTransposedCCS->blockCols()[i1].end()*/)
+        while (targetColumnIt->row < i2)
           ++targetColumnIt;
-        assert(targetColumnIt != _HschurTransposedCCS->blockCols()[i1].end() && targetColumnIt->row == i2 && "invalid iterator, something wrong with the matrix structure");
+        assert(targetColumnIt != targetColumn.end() && targetColumnIt->row == i2 && "invalid iterator, something wrong with the matrix structure");
         PoseMatrixType* Hi1i2 = targetColumnIt->block;//_Hschur->block(i1,i2);
         assert(Hi1i2);
         (*Hi1i2).noalias() -= BDinv*Bj->transpose();
@@ -399,18 +603,17 @@ bool BlockSolver<Traits>::solve(){
     _bschur[i]-=_coefficients[i];
   }
 
-  G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-  if (globalStats){
-    globalStats->timeSchurComplement = get_monotonic_time() - t;
-  }
+  schurTimer.stop();
 
-  t=get_monotonic_time();
+  BatchStatisticsTimer linearSolverTimer(stats, &G2OBatchStatistics::timeLinearSolver);
   bool solvedPoses = _linearSolver->solve(*_Hschur, _x, _bschur.get());
-  if (globalStats) {
-    globalStats->timeLinearSolver = get_monotonic_time() - t;
-    globalStats->hessianPoseDimension = _Hpp->cols();
-    globalStats->hessianLandmarkDimension = _Hll->cols();
-    globalStats->hessianDimension = globalStats->hessianPoseDimension + globalStats->hessianLandmarkDimension;
+  linearSolverTimer.stop();
+  if (stats) {
+    stats->hessianPoseDimension = _Hpp->cols();
+    stats->hessianLandmarkDimension = _Hll->cols();
+    stats->hessianDimension = stats->hessianPoseDimension + stats->hessianLandmarkDimension;
+    stats->hessianBlocks = _Hpp->nonZeroBlocks() + _Hschur->nonZeroBlocks() + _Hpl->nonZeroBlocks() + _Hll->nonZeroBlocks();
+    stats->hessianAllocations = _Hpp->numAllocations() + _Hschur->numAllocations() + _Hpl->numAllocations() + _Hll->numAllocations();
   }
   //cerr << "Solve [decompose and solve] = " <<  get_monotonic_time()-t << endl;
 
@@ -450,12 +653,10 @@ bool BlockSolver<Traits>::solve(){
 template <typename Traits>
 bool BlockSolver<Traits>::computeMarginals(SparseBlockMatrix<MatrixX>& spinv, const std::vector<std::pair<int, int> >& blockIndices)
 {
-  number_t t = get_monotonic_time();
+  G2OBatchStatistics* stats = _optimizer->currentBatchStatistics();
+  _linearSolver->setBatchStatistics(stats);
+  BatchStatisticsTimer marginalsTimer(stats, &G2OBatchStatistics::timeMarginals);
   bool ok = _linearSolver->solvePattern(spinv, blockIndices, *_Hpp);
-  G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-  if (globalStats) {
-    globalStats->timeMarginals = get_monotonic_time() - t;
-  }
   return ok;
 }
 
@@ -477,33 +678,69 @@ bool BlockSolver<Traits>::buildSystem()
     _Hpl->clear();
   }
 
+  // the Jacobians of the edges evaluated in batches are mapped to the memory of their kernel
+  _optimizer->linearizeBatchedEdges();
+
+  // per thread counters, each thread writes its own element
+  G2OBatchStatistics* stats = _optimizer->currentBatchStatistics();
+  std::vector<G2OThreadStatistics>* threadStatistics = stats ? &stats->threadStatistics : 0;
+
   // resetting the terms for the pairwise constraints
   // built up the current system by storing the Hessian blocks in the edges and vertices
 # ifndef G2O_OPENMP
   // no threading, we do not need to copy the workspace
   JacobianWorkspace& jacobianWorkspace = _optimizer->jacobianWorkspace();
+  number_t t = threadStatistics ? get_monotonic_time() : 0.;
+  for (int k = 0; k < static_cast<int>(_optimizer->activeEdges().size()); ++k)
+    constructQuadraticForm(_optimizer->activeEdges()[k], jacobianWorkspace);
+  if (threadStatistics) {
+    threadStatistics->assign(1, G2OThreadStatistics());
+    threadStatistics->front().edgesLinearized = static_cast<int>(_optimizer->activeEdges().size());
+    threadStatistics->front().timeQuadraticForm = get_monotonic_time() - t;
+  }
 # else
   // if running with threads need to produce copies of the workspace for each thread
   JacobianWorkspace jacobianWorkspace = _optimizer->jacobianWorkspace();
-# pragma omp parallel for default (shared) firstprivate(jacobianWorkspace) if (_optimizer->activeEdges().size() > 100)
-# endif
-  for (int k = 0; k < static_cast<int>(_optimizer->activeEdges().size()); ++k) {
-    OptimizableGraph::Edge* e = _optimizer->activeEdges()[k];
-    e->linearizeOplus(jacobianWorkspace); // jacobian of the nodes' oplus (manifold)
-    e->constructQuadraticForm();
-#  ifndef NDEBUG
-    for (size_t i = 0; i < e->vertices().size(); ++i) {
-      const OptimizableGraph::Vertex* v = static_cast<const OptimizableGraph::Vertex*>(e->vertex(i));
-      if (! v->fixed()) {
-        bool hasANan = arrayHasNaN(jacobianWorkspace.workspaceForVertex(i), e->dimension() * v->dimension());
-        if (hasANan) {
-          std::cerr << "buildSystem(): NaN within Jacobian for edge " << e << " for vertex " << i << std::endl;
-          break;
+  if (threadStatistics)
+    threadStatistics->assign(omp_get_max_threads(), G2OThreadStatistics());
+  if (_coloredAssembly) {
+    if (! _edgeColoring.isValidFor(_optimizer->activeEdges()))
+      computeEdgeColoring();
+    // edges of one color never write to the same vertex, no locking needed
+    const OptimizableGraph::EdgeContainer& coloredEdges = _edgeColoring.edges();
+#   pragma omp parallel default (shared) firstprivate(jacobianWorkspace) if (coloredEdges.size() > 100)
+    {
+      G2OThreadStatistics threadStats;
+      number_t t = threadStatistics ? get_monotonic_time() : 0.;
+      for (int c = 0; c < _edgeColoring.numColors(); ++c) {
+#       pragma omp for schedule(static)
+        for (int k = _edgeColoring.colorBegin(c); k < _edgeColoring.colorBegin(c+1); ++k) {
+          constructQuadraticForm(coloredEdges[k], jacobianWorkspace);
+          ++threadStats.edgesLinearized;
         }
       }
+      if (threadStatistics) {
+        threadStats.timeQuadraticForm = get_monotonic_time() - t;
+        (*threadStatistics)[omp_get_thread_num()] = threadStats;
+      }
+    }
+  } else {
+#   pragma omp parallel default (shared) firstprivate(jacobianWorkspace) if (_optimizer->activeEdges().size() > 100)
+    {
+      G2OThreadStatistics threadStats;
+      number_t t = threadStatistics ? get_monotonic_time() : 0.;
+#     pragma omp for
+      for (int k = 0; k < static_cast<int>(_optimizer->activeEdges().size()); ++k) {
+        constructQuadraticForm(_optimizer->activeEdges()[k], jacobianWorkspace);
+        ++threadStats.edgesLinearized;
+      }
+      if (threadStatistics) {
+        threadStats.timeQuadraticForm = get_monotonic_time() - t;
+        (*threadStatistics)[omp_get_thread_num()] = threadStats;
+      }
     }
-#  endif
   }
+# endif
 
   // flush the current system in a sparse block matrix
 # ifdef G2O_OPENMP
@@ -521,6 +758,26 @@ bool BlockSolver<Traits>::buildSystem()
 }
 
 
+template <typename Traits>
+void BlockSolver<Traits>::constructQuadraticForm(OptimizableGraph::Edge* e, JacobianWorkspace& jacobianWorkspace)
+{
+  if (! e->batchKernel())
+    e->linearizeOplus(jacobianWorkspace); // jacobian of the nodes' oplus (manifold)
+  e->constructQuadraticForm();
+#  ifndef NDEBUG
+  for (size_t i = 0; ! e->batchKernel() && i < e->vertices().size(); ++i) {
+    const OptimizableGraph::Vertex* v = static_cast<const OptimizableGraph::Vertex*>(e->vertex(i));
+    if (! v->fixed()) {
+      bool hasANan = arrayHasNaN(jacobianWorkspace.workspaceForVertex(i), e->dimension() * v->dimension());
+      if (hasANan) {
+        std::cerr << "buildSystem(): NaN within Jacobian for edge " << e << " for vertex " << i << std::endl;
+        break;
+      }
+    }
+  }
+#  endif
+}
+
 template <typename Traits>
 bool BlockSolver<Traits>::setLambda(number_t lambda, bool backup)
 {
@@ -576,7 +833,7 @@ bool BlockSolver<Traits>::init(SparseOptimizer* optimizer, bool online)
     if (_Hll)
       _Hll->clear();
   }
-  _linearSolver->init();
+  // the linear solver is re-initialized once the structure changes, see updateLinearSolverPattern()
   return true;
 }
 
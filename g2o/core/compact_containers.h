@@ -0,0 +1,410 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_COMPACT_CONTAINERS_H
+#define G2O_COMPACT_CONTAINERS_H
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "g2o/config.h"
+
+namespace g2o {
+
+  /**
+   * \brief open addressing index from the hash of a key to a position in an array
+   *
+   * The index only stores positions, comparing the keys is left to the
+   * caller. Erased positions leave a marker in their slot, hence the
+   * owner has to rebuild the index from time to time, see CompactArray.
+   */
+  class CompactIndex
+  {
+    public:
+      CompactIndex() : _shift(0) {}
+
+      bool empty() const { return _slots.empty();}
+      void clear() { std::vector<int>().swap(_slots); _shift = 0;}
+
+      //! true, if the index has to be rebuilt before it can hold n positions
+      bool full(size_t n) const { return 2 * n > _slots.size();}
+
+      //! drop all positions and allocate the slots for n positions
+      void reset(size_t n)
+      {
+        size_t capacity = 16;
+        int bits = 4;
+        while (capacity < 2 * n) {
+          capacity <<= 1;
+          ++bits;
+        }
+        _slots.assign(capacity, static_cast<int>(Empty));
+        _shift = 64 - bits;
+      }
+
+      //! add the position, the key stored at the position must not be indexed yet
+      void insert(unsigned long long hash, int position)
+      {
+        size_t s = slot(hash);
+        while (_slots[s] >= 0)
+          s = (s + 1) & (_slots.size() - 1);
+        _slots[s] = position;
+      }
+
+      //! the first position with the hash for which match(position) is true, -1 if none
+      template <typename Match>
+      int find(unsigned long long hash, Match match) const
+      {
+        for (size_t s = slot(hash); _slots[s] != Empty; s = (s + 1) & (_slots.size() - 1))
+          if (_slots[s] >= 0 && match(_slots[s]))
+            return _slots[s];
+        return -1;
+      }
+
+      //! remove the position, which has been inserted with the hash
+      void erase(unsigned long long hash, int position)
+      {
+        size_t s = slot(hash);
+        while (_slots[s] != position)
+          s = (s + 1) & (_slots.size() - 1);
+        _slots[s] = Erased;
+      }
+
+    protected:
+      enum { Empty = -1, Erased = -2 };
+
+      size_t slot(unsigned long long hash) const { return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ULL) >> _shift);}
+
+      std::vector<int> _slots;
+      int _shift;
+  };
+
+  /**
+   * \brief flat storage of the elements of CompactPointerSet and CompactIdMap
+   *
+   * The elements are stored in an array in the order of their insertion.
+   * Erasing an element turns it into a hole, which is skipped by the
+   * iterators, such that erasing does not invalidate the iterators to
+   * other elements. The holes are squeezed out once they outnumber the
+   * elements, hence inserting may invalidate all iterators. Up to
+   * LinearSearchSize elements are found by scanning the array, larger
+   * containers in addition maintain a CompactIndex.
+   *
+   * Traits provides the key of an element, its hash, and marks the holes.
+   */
+  template <typename Value, typename Traits>
+  class CompactArray
+  {
+    public:
+      typedef typename Traits::KeyType key_type;
+      typedef Value value_type;
+      typedef size_t size_type;
+      typedef std::ptrdiff_t difference_type;
+
+      static const size_t LinearSearchSize = 16;
+
+      //! forward iterator over the elements, V is value_type or const value_type
+      template <typename V>
+      class Iterator
+      {
+        public:
+          typedef std::forward_iterator_tag iterator_category;
+          typedef typename CompactArray::value_type value_type;
+          typedef std::ptrdiff_t difference_type;
+          typedef V* pointer;
+          typedef V& reference;
+
+          Iterator() : _current(0), _end(0) {}
+          Iterator(V* current, V* end) : _current(current), _end(end) { skipHoles();}
+          //! an iterator converts to a const_iterator
+          template <typename U>
+          Iterator(const Iterator<U>& other) : _current(other._current), _end(other._end) {}
+
+          reference operator*() const { return *_current;}
+          pointer operator->() const { return _current;}
+          Iterator& operator++() { ++_current; skipHoles(); return *this;}
+          Iterator operator++(int) { Iterator it(*this); ++(*this); return it;}
+          template <typename U>
+          bool operator==(const Iterator<U>& other) const { return _current == other._current;}
+          template <typename U>
+          bool operator!=(const Iterator<U>& other) const { return _current != other._current;}
+
+        protected:
+          template <typename U> friend class Iterator;
+
+          void skipHoles() { while (_current != _end && Traits::isHole(*_current)) ++_current;}
+
+          V* _current;
+          V* _end;
+      };
+
+    public:
+      CompactArray() : _size(0) {}
+
+      size_type size() const { return _size;}
+      bool empty() const { return _size == 0;}
+      void reserve(size_type n) { _items.reserve(n);}
+
+      void clear()
+      {
+        _items.clear();
+        _index.clear();
+        _size = 0;
+      }
+
+      void swap(CompactArray& other)
+      {
+        _items.swap(other._items);
+        std::swap(_index, other._index);
+        std::swap(_size, other._size);
+      }
+
+    protected:
+      //! the position of the element with the key, -1 if there is none
+      int position(const key_type& key) const
+      {
+        if (_index.empty()) {
+          for (size_t i = 0; i < _items.size(); ++i)
+            if (! Traits::isHole(_items[i]) && Traits::key(_items[i]) == key)
+              return static_cast<int>(i);
+          return -1;
+        }
+        const std::vector<Value>& items = _items;
+        return _index.find(Traits::hash(key), [&items, &key](int pos) { return Traits::key(items[pos]) == key;});
+      }
+
+      //! append the element, its key must not be contained yet
+      int append(const Value& value)
+      {
+        assert(! Traits::isHole(value) && "cannot store a hole");
+        if (_items.size() - _size > _size)
+          compact();
+        _items.push_back(value);
+        ++_size;
+        int pos = static_cast<int>(_items.size()) - 1;
+        if (_index.empty() ? _items.size() > LinearSearchSize : _index.full(_items.size()))
+          rebuildIndex();
+        else if (! _index.empty())
+          _index.insert(Traits::hash(Traits::key(value)), pos);
+        return pos;
+      }
+
+      //! turn the element at the position into a hole
+      void eraseAt(int pos)
+      {
+        if (! _index.empty())
+          _index.erase(Traits::hash(Traits::key(_items[pos])), pos);
+        Traits::makeHole(_items[pos]);
+        --_size;
+      }
+
+      //! squeeze out the holes, keeps the order of the elements
+      void compact()
+      {
+        std::vector<Value> items;
+        items.reserve(_size + 1);
+        for (size_t i = 0; i < _items.size(); ++i)
+          if (! Traits::isHole(_items[i]))
+            items.push_back(_items[i]);
+        _items.swap(items);
+        if (_items.size() > LinearSearchSize)
+          rebuildIndex();
+        else
+          _index.clear();
+      }
+
+      void rebuildIndex()
+      {
+        _index.reset(_items.size());
+        for (size_t i = 0; i < _items.size(); ++i)
+          if (! Traits::isHole(_items[i]))
+            _index.insert(Traits::hash(Traits::key(_items[i])), static_cast<int>(i));
+      }
+
+      std::vector<Value> _items;
+      CompactIndex _index;
+      size_t _size;
+  };
+
+  namespace internal {
+    template <typename T>
+    struct CompactPointerSetTraits
+    {
+      typedef T* KeyType;
+      static T* key(T* value) { return value;}
+      static unsigned long long hash(T* key) { return reinterpret_cast<size_t>(key);}
+      static bool isHole(T* value) { return value == 0;}
+      static void makeHole(T*& value) { value = 0;}
+    };
+
+    template <typename T>
+    struct CompactIdMapTraits
+    {
+      typedef int KeyType;
+      typedef std::pair<const int, T*> Value;
+      static int key(const Value& value) { return value.first;}
+      static unsigned long long hash(int key) { return static_cast<unsigned int>(key);}
+      static bool isHole(const Value& value) { return value.second == 0;}
+      static void makeHole(Value& value) { value.second = 0;}
+    };
+  }
+
+  /**
+   * \brief set of pointers stored in a flat array, replaces std::set<T*>
+   *
+   * Iterates in the order of insertion instead of the order of the
+   * addresses. Null pointers cannot be stored.
+   */
+  template <typename T>
+  class CompactPointerSet : public CompactArray<T*, internal::CompactPointerSetTraits<T> >
+  {
+    typedef CompactArray<T*, internal::CompactPointerSetTraits<T> > Base;
+    public:
+      typedef typename Base::template Iterator<T* const> const_iterator;
+      typedef const_iterator iterator;
+
+      CompactPointerSet() {}
+      template <typename InputIterator>
+      CompactPointerSet(InputIterator first, InputIterator last) { insert(first, last);}
+
+      const_iterator begin() const { return const_iterator(this->_items.data(), this->_items.data() + this->_items.size());}
+      const_iterator end() const { return const_iterator(this->_items.data() + this->_items.size(), this->_items.data() + this->_items.size());}
+
+      std::pair<iterator, bool> insert(T* value)
+      {
+        int pos = this->position(value);
+        bool inserted = pos < 0;
+        if (inserted)
+          pos = this->append(value);
+        return std::make_pair(at(pos), inserted);
+      }
+      //! the hint is ignored, allows to use std::inserter
+      iterator insert(const_iterator hint, T* value) { (void) hint; return insert(value).first;}
+      template <typename InputIterator>
+      void insert(InputIterator first, InputIterator last)
+      {
+        for (; first != last; ++first)
+          insert(*first);
+      }
+
+      iterator erase(const_iterator it)
+      {
+        int pos = static_cast<int>(&*it - this->_items.data());
+        this->eraseAt(pos);
+        return at(pos + 1);
+      }
+      size_t erase(T* value)
+      {
+        int pos = this->position(value);
+        if (pos < 0)
+          return 0;
+        this->eraseAt(pos);
+        return 1;
+      }
+
+      iterator find(T* value) const
+      {
+        int pos = this->position(value);
+        return pos < 0 ? end() : at(pos);
+      }
+      size_t count(T* value) const { return this->position(value) < 0 ? 0 : 1;}
+
+      void swap(CompactPointerSet& other) { Base::swap(other);}
+
+    protected:
+      const_iterator at(int pos) const { return const_iterator(this->_items.data() + pos, this->_items.data() + this->_items.size());}
+  };
+
+  /**
+   * \brief map from an id to a pointer stored in a flat array, replaces std::unordered_map<int, T*>
+   *
+   * Iterates in the order of insertion. Null pointers cannot be stored, a
+   * null value marks an erased element.
+   */
+  template <typename T>
+  class CompactIdMap : public CompactArray<std::pair<const int, T*>, internal::CompactIdMapTraits<T> >
+  {
+    typedef CompactArray<std::pair<const int, T*>, internal::CompactIdMapTraits<T> > Base;
+    public:
+      typedef T* mapped_type;
+      typedef typename Base::value_type value_type;
+      typedef typename Base::template Iterator<value_type> iterator;
+      typedef typename Base::template Iterator<const value_type> const_iterator;
+
+      iterator begin() { return at(0);}
+      iterator end() { return at(static_cast<int>(this->_items.size()));}
+      const_iterator begin() const { return at(0);}
+      const_iterator end() const { return at(static_cast<int>(this->_items.size()));}
+
+      std::pair<iterator, bool> insert(const value_type& value)
+      {
+        int pos = this->position(value.first);
+        bool inserted = pos < 0;
+        if (inserted)
+          pos = this->append(value);
+        return std::make_pair(at(pos), inserted);
+      }
+
+      iterator erase(const_iterator it)
+      {
+        int pos = static_cast<int>(&*it - this->_items.data());
+        this->eraseAt(pos);
+        return at(pos + 1);
+      }
+      size_t erase(int id)
+      {
+        int pos = this->position(id);
+        if (pos < 0)
+          return 0;
+        this->eraseAt(pos);
+        return 1;
+      }
+
+      iterator find(int id)
+      {
+        int pos = this->position(id);
+        return pos < 0 ? end() : at(pos);
+      }
+      const_iterator find(int id) const
+      {
+        int pos = this->position(id);
+        return pos < 0 ? end() : at(pos);
+      }
+      size_t count(int id) const { return this->position(id) < 0 ? 0 : 1;}
+
+      void swap(CompactIdMap& other) { Base::swap(other);}
+
+    protected:
+      iterator at(int pos) { return iterator(this->_items.data() + pos, this->_items.data() + this->_items.size());}
+      const_iterator at(int pos) const { return const_iterator(this->_items.data() + pos, this->_items.data() + this->_items.size());}
+  };
+
+} // end namespace
+
+#endif
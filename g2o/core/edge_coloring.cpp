@@ -0,0 +1,162 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "edge_coloring.h"
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace g2o {
+
+namespace {
+  //! colors already taken by the edges of one vertex, one bit per color
+  typedef std::vector<uint64_t> ColorMask;
+}
+
+EdgeColoring::EdgeColoring() :
+  _maxVertexDegree(64)
+{
+}
+
+void EdgeColoring::clear()
+{
+  _input.clear();
+  _edges.clear();
+  _colorBegin.clear();
+  _hubVertices.clear();
+}
+
+void EdgeColoring::compute(const OptimizableGraph::EdgeContainer& edges)
+{
+  clear();
+  _input = edges;
+
+  // number the vertices the edges are going to write to and count their edges
+  std::unordered_map<const OptimizableGraph::Vertex*, size_t> vertexIndex;
+  std::vector<OptimizableGraph::Vertex*> vertices;
+  std::vector<int> degree;
+  for (size_t k = 0; k < edges.size(); ++k) {
+    OptimizableGraph::Edge* e = edges[k];
+    for (size_t i = 0; i < e->vertices().size(); ++i) {
+      OptimizableGraph::Vertex* v = static_cast<OptimizableGraph::Vertex*>(e->vertex(i));
+      if (! v || v->fixed())
+        continue;
+      std::pair<std::unordered_map<const OptimizableGraph::Vertex*, size_t>::iterator, bool> result =
+        vertexIndex.insert(std::make_pair(v, vertices.size()));
+      if (result.second) {
+        vertices.push_back(v);
+        degree.push_back(0);
+      }
+      ++degree[result.first->second];
+    }
+  }
+  std::vector<bool> isHub(vertices.size(), false);
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    if (degree[i] > _maxVertexDegree) {
+      isHub[i] = true;
+      _hubVertices.push_back(vertices[i]);
+    }
+  }
+
+  std::vector<ColorMask> takenColors(vertices.size());
+  std::vector<int> edgeColor(edges.size(), 0);
+  std::vector<size_t> edgeVertices;
+  int numColors = edges.size() > 0 ? 1 : 0;
+
+  for (size_t k = 0; k < edges.size(); ++k) {
+    const OptimizableGraph::Edge* e = edges[k];
+
+    // the vertices this edge is going to write to
+    edgeVertices.clear();
+    int numHubs = 0;
+    for (size_t i = 0; i < e->vertices().size(); ++i) {
+      const OptimizableGraph::Vertex* v = static_cast<const OptimizableGraph::Vertex*>(e->vertex(i));
+      if (! v || v->fixed())
+        continue;
+      size_t index = vertexIndex[v];
+      edgeVertices.push_back(index);
+      if (isHub[index])
+        ++numHubs;
+    }
+    // a single hub is protected by its lock, the block between two hubs is not
+    if (numHubs == 1) {
+      for (size_t i = 0; i < edgeVertices.size(); ++i) {
+        if (isHub[edgeVertices[i]]) {
+          edgeVertices.erase(edgeVertices.begin() + i);
+          break;
+        }
+      }
+    }
+    if (edgeVertices.empty()) // the edge does not write into the system or only to a hub
+      continue;
+    size_t maxWords = 0;
+    for (size_t i = 0; i < edgeVertices.size(); ++i)
+      maxWords = std::max(maxWords, takenColors[edgeVertices[i]].size());
+
+    // first color which is not taken by any of the vertices
+    int color = -1;
+    for (size_t w = 0; color < 0; ++w) {
+      uint64_t taken = 0;
+      if (w < maxWords) {
+        for (size_t i = 0; i < edgeVertices.size(); ++i) {
+          const ColorMask& mask = takenColors[edgeVertices[i]];
+          if (w < mask.size())
+            taken |= mask[w];
+        }
+      }
+      if (~taken == 0)
+        continue;
+      int bit = 0;
+      while (taken & (uint64_t(1) << bit))
+        ++bit;
+      color = static_cast<int>(w * 64) + bit;
+    }
+
+    size_t word = color / 64;
+    uint64_t bitMask = uint64_t(1) << (color % 64);
+    for (size_t i = 0; i < edgeVertices.size(); ++i) {
+      ColorMask& mask = takenColors[edgeVertices[i]];
+      if (mask.size() <= word)
+        mask.resize(word + 1, 0);
+      mask[word] |= bitMask;
+    }
+    edgeColor[k] = color;
+    numColors = std::max(numColors, color + 1);
+  }
+
+  // bucket the edges by their color keeping the input order within each color
+  _colorBegin.assign(numColors + 1, 0);
+  for (size_t k = 0; k < edges.size(); ++k)
+    ++_colorBegin[edgeColor[k] + 1];
+  for (int c = 0; c < numColors; ++c)
+    _colorBegin[c + 1] += _colorBegin[c];
+  _edges.resize(edges.size());
+  std::vector<int> fill(_colorBegin.begin(), _colorBegin.end() - 1);
+  for (size_t k = 0; k < edges.size(); ++k)
+    _edges[fill[edgeColor[k]]++] = edges[k];
+}
+
+} // end namespace
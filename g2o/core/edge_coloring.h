@@ -0,0 +1,99 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_EDGE_COLORING_H
+#define G2O_EDGE_COLORING_H
+
+#include <vector>
+
+#include "optimizable_graph.h"
+#include "g2o_core_api.h"
+
+namespace g2o {
+
+  /**
+   * \brief partition of a set of edges into colors
+   *
+   * Two edges of the same color never share a vertex which is not
+   * fixed. Hence, all the edges of one color may be linearized and
+   * may accumulate their quadratic form into the blocks of the Hessian
+   * concurrently without any locking. The colors are computed by a
+   * greedy first-fit scheme in the order of the input which makes the
+   * partition, and thus the order of the accumulation, deterministic.
+   *
+   * The number of colors is at least the largest number of edges incident
+   * to one vertex. To keep a single vertex of high degree (e.g., a pose
+   * observing thousands of points) from splitting the edges into
+   * thousands of almost empty colors, vertices with more than
+   * maxVertexDegree() edges are hubs which do not take part in the
+   * coloring. Edges of the same color may share a hub, hence the caller
+   * has to lock the quadratic form of the hubs, see hubVertices(). Edges
+   * which connect two hubs are still colored with respect to the hubs,
+   * since they share the off-diagonal block which is written without lock.
+   */
+  class G2O_CORE_API EdgeColoring
+  {
+    public:
+      EdgeColoring();
+
+      /**
+       * compute the coloring of the given edges
+       */
+      void compute(const OptimizableGraph::EdgeContainer& edges);
+
+      //! drop the coloring
+      void clear();
+
+      //! true, if the coloring has been computed for exactly the given edges in the given order
+      bool isValidFor(const OptimizableGraph::EdgeContainer& edges) const { return _colorBegin.size() > 0 && edges == _input;}
+
+      //! vertices with more edges are hubs which are excluded from the coloring
+      int maxVertexDegree() const { return _maxVertexDegree;}
+      void setMaxVertexDegree(int maxVertexDegree) { _maxVertexDegree = maxVertexDegree;}
+
+      //! the vertices shared by edges of the same color, their quadratic form has to be locked
+      const std::vector<OptimizableGraph::Vertex*>& hubVertices() const { return _hubVertices;}
+
+      //! number of colors
+      int numColors() const { return _colorBegin.empty() ? 0 : static_cast<int>(_colorBegin.size()) - 1;}
+
+      //! the edges sorted by their color
+      const OptimizableGraph::EdgeContainer& edges() const { return _edges;}
+
+      //! the edges of color c are stored in edges()[colorBegin(c)] ... edges()[colorBegin(c+1) - 1]
+      int colorBegin(int c) const { return _colorBegin[c];}
+
+    protected:
+      OptimizableGraph::EdgeContainer _input; ///< the edges the coloring has been computed for
+      OptimizableGraph::EdgeContainer _edges;
+      std::vector<int> _colorBegin;
+      std::vector<OptimizableGraph::Vertex*> _hubVertices;
+      int _maxVertexDegree;
+  };
+
+} // end namespace
+
+#endif
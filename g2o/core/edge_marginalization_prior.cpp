@@ -0,0 +1,166 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "edge_marginalization_prior.h"
+
+#include <algorithm>
+
+#include <Eigen/Eigenvalues>
+
+#include "factory.h"
+
+using namespace std;
+
+namespace g2o {
+
+  G2O_REGISTER_TYPE(EDGE_MARGINALIZATION_PRIOR, EdgeMarginalizationPrior);
+
+  EdgeMarginalizationPrior::EdgeMarginalizationPrior() :
+    BaseMultiEdge<-1, VectorX>(),
+    _firstEstimateJacobians(true)
+  {
+    resize(0);
+  }
+
+  void EdgeMarginalizationPrior::setDimension(int dimension)
+  {
+    _dimension = dimension;
+    _information.setIdentity(dimension, dimension);
+    _error.setZero(dimension);
+  }
+
+  bool EdgeMarginalizationPrior::setQuadraticForm(const MatrixX& H, const VectorX& b, number_t threshold)
+  {
+    int n = 0;
+    _linearizationPoint.resize(_vertices.size());
+    for (size_t i = 0; i < _vertices.size(); ++i) {
+      const OptimizableGraph::Vertex* v = static_cast<const OptimizableGraph::Vertex*>(_vertices[i]);
+      if (! v->getEstimateData(_linearizationPoint[i]))
+        return false;
+      _delta.resize(v->dimension());
+      if (! v->localDifference(_linearizationPoint[i].data(), _delta.data()))
+        return false;
+      n += v->dimension();
+    }
+    assert(H.rows() == n && H.cols() == n && b.size() == n && "quadratic form does not match the vertices");
+    if (n == 0)
+      return false;
+
+    // H = V * Lambda * V^T, the eigenvalues are in increasing order
+    Eigen::SelfAdjointEigenSolver<MatrixX> eigenSolver(H);
+    const VectorX& lambda = eigenSolver.eigenvalues();
+    number_t minEigenvalue = threshold * std::max(lambda(n - 1), cst(0.));
+    int rank = n;
+    while (rank > 0 && lambda(n - rank) <= minEigenvalue)
+      --rank;
+    if (rank == 0)
+      return false;
+
+    VectorX sqrtLambda = lambda.tail(rank).cwiseSqrt();
+    MatrixX Vt = eigenSolver.eigenvectors().rightCols(rank).transpose();
+    setDimension(rank);
+    _jacobian = sqrtLambda.asDiagonal() * Vt;
+    _linearizedError = - (sqrtLambda.cwiseInverse().asDiagonal() * (Vt * b));
+    _delta.setZero(n);
+    _error = _linearizedError;
+    return true;
+  }
+
+  void EdgeMarginalizationPrior::computeError()
+  {
+    int offset = 0;
+    for (size_t i = 0; i < _vertices.size(); ++i) {
+      const OptimizableGraph::Vertex* v = static_cast<const OptimizableGraph::Vertex*>(_vertices[i]);
+      v->localDifference(_linearizationPoint[i].data(), _delta.data() + offset);
+      offset += v->dimension();
+    }
+    _error = _linearizedError;
+    _error.noalias() += _jacobian * _delta;
+  }
+
+  void EdgeMarginalizationPrior::linearizeOplus()
+  {
+    if (! _firstEstimateJacobians) {
+      BaseMultiEdge<-1, VectorX>::linearizeOplus();
+      return;
+    }
+    int offset = 0;
+    for (size_t i = 0; i < _vertices.size(); ++i) {
+      const OptimizableGraph::Vertex* v = static_cast<const OptimizableGraph::Vertex*>(_vertices[i]);
+      if (! v->fixed())
+        _jacobianOplus[i] = _jacobian.middleCols(offset, v->dimension());
+      offset += v->dimension();
+    }
+  }
+
+  bool EdgeMarginalizationPrior::read(std::istream& is)
+  {
+    int dimension, cols, fej;
+    is >> dimension >> cols >> fej;
+    if (is.fail() || dimension <= 0 || cols < dimension)
+      return false;
+    setDimension(dimension);
+    _firstEstimateJacobians = fej != 0;
+
+    _linearizationPoint.resize(_vertices.size());
+    for (size_t i = 0; i < _vertices.size(); ++i) {
+      int estimateDimension;
+      is >> estimateDimension;
+      if (is.fail() || estimateDimension < 0)
+        return false;
+      _linearizationPoint[i].resize(estimateDimension);
+      for (int k = 0; k < estimateDimension; ++k)
+        is >> _linearizationPoint[i][k];
+    }
+    _linearizedError.resize(dimension);
+    for (int r = 0; r < dimension; ++r)
+      is >> _linearizedError(r);
+    _jacobian.resize(dimension, cols);
+    for (int r = 0; r < dimension; ++r)
+      for (int c = 0; c < cols; ++c)
+        is >> _jacobian(r, c);
+    _delta.setZero(cols);
+    return ! is.fail();
+  }
+
+  bool EdgeMarginalizationPrior::write(std::ostream& os) const
+  {
+    // the number of vertices varies, the list of their ids is terminated by ||
+    os << "|| " << _dimension << " " << _jacobian.cols() << " " << (_firstEstimateJacobians ? 1 : 0);
+    for (size_t i = 0; i < _linearizationPoint.size(); ++i) {
+      os << " " << _linearizationPoint[i].size();
+      for (size_t k = 0; k < _linearizationPoint[i].size(); ++k)
+        os << " " << _linearizationPoint[i][k];
+    }
+    for (int r = 0; r < _linearizedError.size(); ++r)
+      os << " " << _linearizedError(r);
+    for (int r = 0; r < _jacobian.rows(); ++r)
+      for (int c = 0; c < _jacobian.cols(); ++c)
+        os << " " << _jacobian(r, c);
+    return os.good();
+  }
+
+} // end namespace
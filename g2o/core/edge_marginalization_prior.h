@@ -0,0 +1,101 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_EDGE_MARGINALIZATION_PRIOR_H
+#define G2O_EDGE_MARGINALIZATION_PRIOR_H
+
+#include <iostream>
+#include <vector>
+
+#include "base_multi_edge.h"
+#include "g2o_core_api.h"
+
+namespace g2o {
+
+  /**
+   * \brief dense prior on a set of vertices, which keeps the information of marginalized vertices
+   *
+   * The prior is the quadratic form H dx = b (b = -J^T Omega e as built by
+   * the solvers) on its vertices, linearized at the estimates the vertices
+   * had when calling setQuadraticForm(). H is factorized as J^T J, such
+   * that the error is
+   *   e = r0 + J * [delta_0; ...; delta_n]
+   * where delta_i is the increment which takes the vertex from its
+   * linearization point to its current estimate (see
+   * OptimizableGraph::Vertex::localDifference()) and J^T r0 = -b. The
+   * information matrix is the identity and the dimension of the edge is the
+   * rank of H.
+   *
+   * With first estimate Jacobians (the default) the Jacobians are J
+   * regardless of the current estimate, which keeps the prior consistent
+   * with the linearization of the eliminated edges. Otherwise the Jacobians
+   * are computed numerically at the current estimate.
+   */
+  class G2O_CORE_API EdgeMarginalizationPrior : public BaseMultiEdge<-1, VectorX>
+  {
+    public:
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+      EdgeMarginalizationPrior();
+
+      /**
+       * set the prior from the quadratic form of its vertices at their
+       * current estimates. The rows and columns of H are ordered as the
+       * vertices of the edge. Eigenvalues of H below threshold times the
+       * largest eigenvalue are dropped.
+       * @returns false if a vertex does not support localDifference() or H is zero
+       */
+      bool setQuadraticForm(const MatrixX& H, const VectorX& b, number_t threshold);
+
+      virtual void computeError();
+      virtual void linearizeOplus();
+
+      virtual bool read(std::istream& is);
+      virtual bool write(std::ostream& os) const;
+
+      //! use the Jacobians at the linearization point
+      bool firstEstimateJacobians() const { return _firstEstimateJacobians;}
+      void setFirstEstimateJacobians(bool fej) { _firstEstimateJacobians = fej;}
+
+      //! the Jacobian J w.r.t. all vertices at the linearization point
+      const MatrixX& jacobian() const { return _jacobian;}
+      //! the error r0 at the linearization point
+      const VectorX& linearizedError() const { return _linearizedError;}
+      //! the estimate of the i-th vertex at the linearization point, see getEstimateData()
+      const std::vector<number_t>& linearizationPoint(int i) const { return _linearizationPoint[i];}
+
+    protected:
+      void setDimension(int dimension);
+
+      MatrixX _jacobian;
+      VectorX _linearizedError;
+      VectorX _delta; ///< the stacked increments from the linearization point
+      std::vector<std::vector<number_t> > _linearizationPoint;
+      bool _firstEstimateJacobians;
+  };
+
+} // end namespace
+
+#endif
@@ -50,37 +50,59 @@ namespace g2o {
 
   EstimatePropagator::AdjacencyMapEntry::AdjacencyMapEntry()
   {
+    _child = 0;
     reset();
   }
 
   void EstimatePropagator::AdjacencyMapEntry::reset()
   {
-    _child = 0;
-    _parent.clear();
     _edge = 0;
     _distance = numeric_limits<number_t>::max();
     _frontierLevel = -1;
-    inQueue = false;
+    _parentBegin = _parentEnd = 0;
+  }
+
+  EstimatePropagator::EstimatePropagator(OptimizableGraph* g): _visitedValid(false), _graph(g)
+  {
+    // the snapshot is taken when propagating, such that it may be restricted
+    // to a part of the graph before, e.g., the active edges of a subgraph which
+    // may also be owned by another graph.
   }
 
-  EstimatePropagator::EstimatePropagator(OptimizableGraph* g): _graph(g)
+  OptimizableGraph::VertexSet& EstimatePropagator::visited()
   {
-    for (OptimizableGraph::VertexIDMap::const_iterator it=_graph->vertices().begin(); it!=_graph->vertices().end(); ++it){
-      AdjacencyMapEntry entry;
-      entry._child = static_cast<OptimizableGraph::Vertex*>(it->second);
-      _adjacencyMap.insert(make_pair(entry.child(), entry));
+    if (! _visitedValid) {
+      _visited.clear();
+      for (size_t k = 0; k < _visitedIndices.size(); ++k)
+        _visited.insert(_snapshot.vertex(_visitedIndices[k]));
+      _visitedValid = true;
     }
+    return _visited;
+  }
+
+  void EstimatePropagator::parents(const AdjacencyMapEntry& entry, OptimizableGraph::VertexSet& parents) const
+  {
+    parents.clear();
+    parents.insert(_parents.begin() + entry._parentBegin, _parents.begin() + entry._parentEnd);
   }
 
   void EstimatePropagator::reset()
   {
-    for (OptimizableGraph::VertexSet::iterator it=_visited.begin(); it!=_visited.end(); ++it){
-      OptimizableGraph::Vertex* v = static_cast<OptimizableGraph::Vertex*>(*it);
-      AdjacencyMap::iterator at = _adjacencyMap.find(v);
-      assert(at != _adjacencyMap.end());
-      at->second.reset();
+    if (_snapshot.numVertices() == 0 && _graph)
+      _snapshot.build(*_graph);
+    int n = _snapshot.numVertices();
+    if (static_cast<int>(_adjacencyMap.size()) != n) {
+      _adjacencyMap.assign(n, AdjacencyMapEntry());
+      for (int i = 0; i < n; ++i)
+        _adjacencyMap[i]._child = static_cast<OptimizableGraph::Vertex*>(_snapshot.vertex(i));
+    } else {
+      for (size_t k = 0; k < _visitedIndices.size(); ++k)
+        _adjacencyMap[_visitedIndices[k]].reset();
     }
-    _visited.clear();
+    _visitedIndices.clear();
+    _visitedValid = false;
+    _parents.clear();
+    _frontier.reset(n);
   }
 
   void EstimatePropagator::propagate(OptimizableGraph::Vertex* v, 
@@ -102,54 +124,56 @@ namespace g2o {
   {
     reset();
 
-    PriorityQueue frontier;
     for (OptimizableGraph::VertexSet::iterator vit=vset.begin(); vit!=vset.end(); ++vit){
-      OptimizableGraph::Vertex* v = static_cast<OptimizableGraph::Vertex*>(*vit);
-      AdjacencyMap::iterator it = _adjacencyMap.find(v);
-      assert(it != _adjacencyMap.end());
-      it->second._distance = 0.;
-      it->second._parent.clear();
-      it->second._frontierLevel = 0;
-      frontier.push(&it->second);
+      int i = _snapshot.index(*vit);
+      if (i < 0) // no edge to propagate along
+        continue;
+      AdjacencyMapEntry& root = _adjacencyMap[i];
+      root._distance = 0.;
+      root._parentBegin = root._parentEnd = 0;
+      root._frontierLevel = 0;
+      _frontier.push(i, 0.);
     }
 
-    while(! frontier.empty()){
-      AdjacencyMapEntry* entry = frontier.pop();
+    OptimizableGraph::VertexSet parentSet;
+    OptimizableGraph::VertexSet initializedVertices;
+    while(! _frontier.empty()){
+      int ui = _frontier.pop();
+      AdjacencyMapEntry* entry = &_adjacencyMap[ui];
       OptimizableGraph::Vertex* u = entry->child();
       number_t uDistance = entry->distance();
       //cerr << "uDistance " << uDistance << endl;
 
       // initialize the vertex
       if (entry->_frontierLevel > 0) {
-        action(entry->edge(), entry->parent(), u);
+        parents(*entry, parentSet);
+        action(entry->edge(), parentSet, u);
       }
 
-      /* std::pair< OptimizableGraph::VertexSet::iterator, bool> insertResult = */ _visited.insert(u);
-      OptimizableGraph::EdgeSet::iterator et = u->edges().begin();
-      while (et != u->edges().end()){
-        OptimizableGraph::Edge* edge = static_cast<OptimizableGraph::Edge*>(*et);
-        ++et;
+      _visitedIndices.push_back(ui);
+
+      for (const int* et = _snapshot.edgesBegin(ui); et != _snapshot.edgesEnd(ui); ++et) {
+        OptimizableGraph::Edge* edge = static_cast<OptimizableGraph::Edge*>(_snapshot.edge(*et));
 
         int maxFrontier = -1;
-        OptimizableGraph::VertexSet initializedVertices;
-        for (size_t i = 0; i < edge->vertices().size(); ++i) {
-          OptimizableGraph::Vertex* z = static_cast<OptimizableGraph::Vertex*>(edge->vertex(i));
-	  if (! z)
-	    continue;
-          AdjacencyMap::iterator ot = _adjacencyMap.find(z);
-          if (ot->second._distance != numeric_limits<number_t>::max()) {
-            initializedVertices.insert(z);
-            maxFrontier = (max)(maxFrontier, ot->second._frontierLevel);
+        initializedVertices.clear();
+        for (const int* zt = _snapshot.verticesBegin(*et); zt != _snapshot.verticesEnd(*et); ++zt) {
+          if (*zt < 0)
+            continue;
+          const AdjacencyMapEntry& ze = _adjacencyMap[*zt];
+          if (ze._distance != numeric_limits<number_t>::max()) {
+            initializedVertices.insert(ze.child());
+            maxFrontier = (max)(maxFrontier, ze._frontierLevel);
           }
         }
         assert(maxFrontier >= 0);
 
-        for (size_t i = 0; i < edge->vertices().size(); ++i) {
-          OptimizableGraph::Vertex* z = static_cast<OptimizableGraph::Vertex*>(edge->vertex(i));
-	  if (! z)
-	    continue;
-          if (z == u)
+        for (const int* zt = _snapshot.verticesBegin(*et); zt != _snapshot.verticesEnd(*et); ++zt) {
+          int zi = *zt;
+          if (zi < 0 || zi == ui)
             continue;
+          AdjacencyMapEntry& ze = _adjacencyMap[zi];
+          OptimizableGraph::Vertex* z = ze.child();
           size_t wasInitialized = initializedVertices.erase(z);
 
           number_t edgeDistance = cost(edge, initializedVertices, z);
@@ -157,17 +181,14 @@ namespace g2o {
             number_t zDistance = uDistance + edgeDistance;
             //cerr << z->id() << " " << zDistance << endl;
 
-            AdjacencyMap::iterator ot = _adjacencyMap.find(z);
-            assert(ot!=_adjacencyMap.end());
-
-            if (zDistance < ot->second.distance() && zDistance < maxDistance){
-              //if (ot->second.inQueue)
-                //cerr << "Updating" << endl;
-              ot->second._distance = zDistance;
-              ot->second._parent = initializedVertices;
-              ot->second._edge = edge;
-              ot->second._frontierLevel = maxFrontier + 1;
-              frontier.push(&ot->second);
+            if (zDistance < ze.distance() && zDistance < maxDistance){
+              ze._distance = zDistance;
+              ze._parentBegin = static_cast<int>(_parents.size());
+              _parents.insert(_parents.end(), initializedVertices.begin(), initializedVertices.end());
+              ze._parentEnd = static_cast<int>(_parents.size());
+              ze._edge = edge;
+              ze._frontierLevel = maxFrontier + 1;
+              _frontier.push(zi, zDistance);
             }
           }
 
@@ -183,15 +204,15 @@ namespace g2o {
     cerr << "Writing cost.dat" << endl;
     ofstream costStream("cost.dat");
     for (AdjacencyMap::const_iterator it = _adjacencyMap.begin(); it != _adjacencyMap.end(); ++it) {
-      HyperGraph::Vertex* u = it->second.child();
-      costStream << "vertex " << u->id() << "  cost " << it->second._distance << endl;
+      HyperGraph::Vertex* u = it->child();
+      costStream << "vertex " << u->id() << "  cost " << it->_distance << endl;
     }
     cerr << "Writing init.dat" << endl;
     ofstream initStream("init.dat");
     vector<AdjacencyMapEntry*> frontierLevels;
     for (AdjacencyMap::iterator it = _adjacencyMap.begin(); it != _adjacencyMap.end(); ++it) {
-      if (it->second._frontierLevel > 0)
-        frontierLevels.push_back(&it->second);
+      if (it->_frontierLevel > 0)
+        frontierLevels.push_back(&*it);
     }
     sort(frontierLevels.begin(), frontierLevels.end(), FrontierLevelCmp());
     for (vector<AdjacencyMapEntry*>::const_iterator it = frontierLevels.begin(); it != frontierLevels.end(); ++it) {
@@ -199,8 +220,8 @@ namespace g2o {
       OptimizableGraph::Vertex* to   = entry->child();
 
       initStream << "calling init level = " << entry->_frontierLevel << "\t (";
-      for (OptimizableGraph::VertexSet::iterator pit = entry->parent().begin(); pit != entry->parent().end(); ++pit) {
-        initStream << " " << (*pit)->id();
+      for (int p = entry->_parentBegin; p < entry->_parentEnd; ++p) {
+        initStream << " " << _parents[p]->id();
       }
       initStream << " ) -> " << to->id() << endl;
     }
@@ -208,32 +229,6 @@ namespace g2o {
 
   }
 
-  void EstimatePropagator::PriorityQueue::push(AdjacencyMapEntry* entry)
-  {
-    assert(entry != NULL);
-    if (entry->inQueue) {
-      assert(entry->queueIt->second == entry);
-      erase(entry->queueIt);
-    }
-
-    entry->queueIt = insert(std::make_pair(entry->distance(), entry));
-    assert(entry->queueIt != end());
-    entry->inQueue = true;
-  }
-
-  EstimatePropagator::AdjacencyMapEntry* EstimatePropagator::PriorityQueue::pop()
-  {
-    assert(!empty());
-    iterator it = begin();
-    AdjacencyMapEntry* entry = it->second;
-    erase(it);
-
-    assert(entry != NULL);
-    entry->queueIt = end();
-    entry->inQueue = false;
-    return entry;
-  }
-
   EstimatePropagatorCost::EstimatePropagatorCost (SparseOptimizer* graph) :
     _graph(graph)
   {
@@ -29,13 +29,13 @@
 
 #include "optimizable_graph.h"
 #include "sparse_optimizer.h"
+#include "hyper_graph_snapshot.h"
 #include "g2o_core_api.h"
 
 #include <map>
 #include <set>
 #include <limits>
-
-#include <unordered_map>
+#include <vector>
 
 namespace g2o {
 
@@ -87,59 +87,49 @@ namespace g2o {
 
       typedef EstimatePropagatorCost PropagateCost;
 
-      class AdjacencyMapEntry;
-
       /**
-       * \brief priority queue for AdjacencyMapEntry
-       */
-      class PriorityQueue : public std::multimap<number_t, AdjacencyMapEntry*> {
-        public:
-          void push(AdjacencyMapEntry* entry);
-          AdjacencyMapEntry* pop();
-      };
-
-      /**
-       * \brief data structure for loopuk during Dijkstra
+       * \brief data structure for lookup during Dijkstra, one entry for each vertex of the snapshot
        */
       class AdjacencyMapEntry {
         public:
           friend class EstimatePropagator;
-          friend class PriorityQueue;
           AdjacencyMapEntry();
           void reset();
           OptimizableGraph::Vertex* child() const {return _child;}
-          const OptimizableGraph::VertexSet& parent() const {return _parent;}
           OptimizableGraph::Edge* edge() const {return _edge;}
           number_t distance() const {return _distance;}
           int frontierLevel() const { return _frontierLevel;}
 
         protected:
           OptimizableGraph::Vertex* _child;
-          OptimizableGraph::VertexSet _parent;
           OptimizableGraph::Edge* _edge;
           number_t _distance;
           int _frontierLevel;
-        private: // for PriorityQueue
-          bool inQueue;
-          PriorityQueue::iterator queueIt;
+          int _parentBegin;   ///< range of the parents in EstimatePropagator::_parents
+          int _parentEnd;
       };
 
-      /**
-       * \brief hash function for a vertex
-       */
-      class VertexIDHashFunction {
-        public:
-          size_t operator ()(const OptimizableGraph::Vertex* v) const { return v->id();}
-      };
-
-      typedef std::unordered_map<OptimizableGraph::Vertex*, AdjacencyMapEntry, VertexIDHashFunction> AdjacencyMap;
+      typedef std::vector<AdjacencyMapEntry> AdjacencyMap;
 
     public:
       EstimatePropagator(OptimizableGraph* g);
-      OptimizableGraph::VertexSet& visited() {return _visited; }
+      //! the vertices visited by the last propagation, assembled on demand
+      OptimizableGraph::VertexSet& visited();
+      //! the entries of the vertices in the order of the snapshot
       AdjacencyMap& adjacencyMap() {return _adjacencyMap; }
       OptimizableGraph* graph() {return _graph;} 
 
+      /**
+       * the adjacency the propagation runs on. If it is empty when
+       * propagate() is called, a snapshot of the whole graph is taken.
+       * Restrict it to the edges of interest, e.g., the active edges of an
+       * optimizer, to avoid traversing the rest of the graph.
+       */
+      HyperGraphSnapshot& snapshot() {return _snapshot;}
+
+      //! the parents of the entry, i.e., the vertices used for initializing its vertex
+      void parents(const AdjacencyMapEntry& entry, OptimizableGraph::VertexSet& parents) const;
+
       /**
        * propagate an initial guess starting from v. The function computes a spanning tree
        * whereas the cost for each edge is determined by calling cost() and the action applied to
@@ -165,7 +155,13 @@ namespace g2o {
 
       AdjacencyMap _adjacencyMap;
       OptimizableGraph::VertexSet _visited;
+      bool _visitedValid;
       OptimizableGraph* _graph;
+
+      HyperGraphSnapshot _snapshot;
+      IndexedHeap _frontier;
+      std::vector<int> _visitedIndices;
+      std::vector<HyperGraph::Vertex*> _parents;
   };
 
 }
@@ -0,0 +1,133 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "estimate_snapshot.h"
+
+#include "cache.h"
+#include "dynamic_aligned_buffer.hpp"
+#include "g2o/config.h"
+
+namespace g2o {
+
+  namespace {
+    //! the alignment of the copies in the buffer
+    const size_t alignment = EIGEN_MAX_ALIGN_BYTES > 16 ? EIGEN_MAX_ALIGN_BYTES : 16;
+  }
+
+  EstimateSnapshot::EstimateSnapshot() :
+    _buffer(0), _bufferSize(0), _saved(false)
+  {
+  }
+
+  EstimateSnapshot::~EstimateSnapshot()
+  {
+    release();
+  }
+
+  void EstimateSnapshot::layout(const OptimizableGraph::VertexContainer& vertices)
+  {
+    release();
+    _vertices = vertices;
+    size_t offset = 0;
+    for (size_t i = 0; i < _vertices.size(); ++i) {
+      OptimizableGraph::Vertex* v = _vertices[i];
+      size_t copySize = v->estimateCopySize();
+      if (copySize == 0) {
+        _stackVertices.push_back(v);
+        continue;
+      }
+      _copyVertices.push_back(v);
+      _offsets.push_back(offset);
+      offset += (copySize + alignment - 1) / alignment * alignment;
+    }
+    _bufferSize = offset;
+    _buffer = allocate_aligned<unsigned char>(_bufferSize);
+    for (size_t i = 0; i < _copyVertices.size(); ++i)
+      _copyVertices[i]->saveEstimateCopy(_buffer + _offsets[i], true);
+    for (size_t i = 0; i < _stackVertices.size(); ++i)
+      _stackVertices[i]->push();
+    _saved = true;
+  }
+
+  void EstimateSnapshot::release()
+  {
+    discard();
+    if (_buffer) {
+      for (size_t i = 0; i < _copyVertices.size(); ++i)
+        _copyVertices[i]->destroyEstimateCopy(_buffer + _offsets[i]);
+      free_aligned(_buffer);
+    }
+    _buffer = 0;
+    _bufferSize = 0;
+    _vertices.clear();
+    _copyVertices.clear();
+    _stackVertices.clear();
+    _offsets.clear();
+  }
+
+  void EstimateSnapshot::save()
+  {
+#   ifdef G2O_OPENMP
+#   pragma omp parallel for default (shared) if (_copyVertices.size() > 1000)
+#   endif
+    for (int i = 0; i < static_cast<int>(_copyVertices.size()); ++i)
+      _copyVertices[i]->saveEstimateCopy(_buffer + _offsets[i], false);
+    discard();
+    for (size_t i = 0; i < _stackVertices.size(); ++i)
+      _stackVertices[i]->push();
+    _saved = true;
+  }
+
+  void EstimateSnapshot::restore(OptimizableGraph::VertexContainer& outdatedCaches)
+  {
+#   ifdef G2O_OPENMP
+#   pragma omp parallel for default (shared) if (_copyVertices.size() > 1000)
+#   endif
+    for (int i = 0; i < static_cast<int>(_copyVertices.size()); ++i)
+      _copyVertices[i]->restoreEstimateCopy(_buffer + _offsets[i]);
+    for (size_t i = 0; i < _copyVertices.size(); ++i) {
+      OptimizableGraph::Vertex* v = _copyVertices[i];
+      if (v->hasCacheContainer()) {
+        v->cacheContainer()->setUpdateNeeded();
+        outdatedCaches.push_back(v);
+      }
+    }
+    // pop() updates the caches right away
+    if (_saved)
+      for (size_t i = 0; i < _stackVertices.size(); ++i)
+        _stackVertices[i]->pop();
+    _saved = false;
+  }
+
+  void EstimateSnapshot::discard()
+  {
+    if (_saved)
+      for (size_t i = 0; i < _stackVertices.size(); ++i)
+        _stackVertices[i]->discardTop();
+    _saved = false;
+  }
+
+} // end namespace
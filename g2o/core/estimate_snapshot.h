@@ -0,0 +1,92 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_ESTIMATE_SNAPSHOT_H
+#define G2O_ESTIMATE_SNAPSHOT_H
+
+#include <cstddef>
+#include <vector>
+
+#include "optimizable_graph.h"
+#include "g2o_core_api.h"
+
+namespace g2o {
+
+  /**
+   * \brief backup of the estimates of a set of vertices in one contiguous buffer
+   *
+   * The buffer holds a copy of the estimate of each vertex at an aligned
+   * offset. It is laid out once for a set of vertices, afterwards save() and
+   * restore() only copy the estimates without allocating memory. restore()
+   * does not update the caches of the vertices, it marks them as outdated and
+   * they have to be updated before evaluating the edges, see
+   * SparseOptimizer::updateOutdatedCaches(). The estimates of vertices which
+   * cannot copy their estimate, see OptimizableGraph::Vertex::estimateCopySize(),
+   * are kept on their own stack by push() and pop().
+   */
+  class G2O_CORE_API EstimateSnapshot
+  {
+    public:
+      EstimateSnapshot();
+      ~EstimateSnapshot();
+
+      //! lay out the buffer for the vertices and store their current estimate
+      void layout(const OptimizableGraph::VertexContainer& vertices);
+      //! destroy the copies and free the buffer
+      void release();
+
+      //! store the current estimate of the vertices
+      void save();
+      /**
+       * restore the estimate of the vertices, the vertices whose caches got
+       * outdated are appended to outdatedCaches
+       */
+      void restore(OptimizableGraph::VertexContainer& outdatedCaches);
+      //! drop the stored estimates without restoring them
+      void discard();
+
+      //! the vertices whose estimates are stored
+      const OptimizableGraph::VertexContainer& vertices() const { return _vertices;}
+      //! the size of the buffer in bytes
+      size_t bufferSize() const { return _bufferSize;}
+
+    protected:
+      OptimizableGraph::VertexContainer _vertices;
+      OptimizableGraph::VertexContainer _copyVertices;  ///< the vertices with a copy in the buffer
+      std::vector<size_t> _offsets;                     ///< offset of the copy of each of _copyVertices
+      unsigned char* _buffer;
+      size_t _bufferSize;
+      OptimizableGraph::VertexContainer _stackVertices; ///< the vertices backed up by push() and pop()
+      bool _saved;                                      ///< true, if the estimates are stored
+
+    private:
+      EstimateSnapshot(const EstimateSnapshot&);
+      EstimateSnapshot& operator=(const EstimateSnapshot&);
+  };
+
+} // end namespace
+
+#endif
@@ -154,6 +154,14 @@ HyperGraph::HyperGraphElement* Factory::construct(const std::string& tag) const
   return 0;
 }
 
+AbstractHyperGraphElementCreator* Factory::creator(const std::string& tag) const
+{
+  CreatorMap::const_iterator foundIt = _creator.find(tag);
+  if (foundIt != _creator.end())
+    return foundIt->second->creator;
+  return 0;
+}
+
 const std::string& Factory::tag(const HyperGraph::HyperGraphElement* e) const
 {
   static std::string emptyStr("");
@@ -77,6 +77,12 @@ namespace g2o {
        */
       HyperGraph::HyperGraphElement* construct(const std::string& tag, const HyperGraph::GraphElemBitset& elemsToConstruct) const;
 
+      /**
+       * return the creator registered for the tag, 0 if the tag is unknown.
+       * Allows to construct many elements of one type without looking up the tag each time.
+       */
+      AbstractHyperGraphElementCreator* creator(const std::string& tag) const;
+
       /**
        * return whether the factory knows this tag or not
        */
@@ -0,0 +1,168 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "graduated_non_convexity.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+#include "sparse_optimizer.h"
+#include "robust_kernel.h"
+#include "g2o/stuff/macros.h"
+
+using namespace std;
+
+namespace g2o {
+
+  GraduatedNonConvexity::GraduatedNonConvexity(SparseOptimizer* optimizer) :
+    _optimizer(optimizer), _innerIterations(5), _annealingFactor(cst(1.4)), _initialScale(2.),
+    _maxStages(numeric_limits<int>::max()), _stages(0)
+  {
+  }
+
+  void GraduatedNonConvexity::setInnerIterations(int iterations)
+  {
+    _innerIterations = iterations;
+  }
+
+  void GraduatedNonConvexity::setAnnealingFactor(number_t factor)
+  {
+    assert(factor > 1. && "annealing factor has to be larger than one");
+    _annealingFactor = factor;
+  }
+
+  void GraduatedNonConvexity::setInitialScale(number_t scale)
+  {
+    _initialScale = scale;
+  }
+
+  void GraduatedNonConvexity::setMaxStages(int stages)
+  {
+    _maxStages = stages;
+  }
+
+  void GraduatedNonConvexity::collectKernels()
+  {
+    _edges.clear();
+    _kernels.clear();
+    for (OptimizableGraph::Edge* e : _optimizer->activeEdges()) {
+      if (! e->robustKernel())
+        continue;
+      _edges.push_back(e);
+      _kernels.push_back(e->robustKernel());
+    }
+    // a kernel may be shared by several edges
+    sort(_kernels.begin(), _kernels.end());
+    _kernels.erase(unique(_kernels.begin(), _kernels.end()), _kernels.end());
+    _deltas.resize(_kernels.size());
+    _squaredDeltas.resize(_kernels.size());
+    for (size_t k = 0; k < _kernels.size(); ++k) {
+      _deltas[k] = _kernels[k]->delta();
+      _squaredDeltas[k] = _kernels[k]->squaredDelta();
+    }
+    _weights.assign(_edges.size(), 1.);
+  }
+
+  number_t GraduatedNonConvexity::initialMu() const
+  {
+    number_t maxRatio = 0.;
+    for (OptimizableGraph::Edge* e : _edges) {
+      number_t squaredDelta = e->robustKernel()->squaredDelta();
+      if (squaredDelta > 0.)
+        maxRatio = (max)(maxRatio, e->chi2() / squaredDelta);
+    }
+    return (max)(cst(1.), _initialScale * maxRatio);
+  }
+
+  void GraduatedNonConvexity::setMu(number_t mu)
+  {
+    for (size_t k = 0; k < _kernels.size(); ++k) {
+      if (mu == 1.)
+        _kernels[k]->setDelta(_deltas[k]);
+      else
+        _kernels[k]->setSquaredDelta(mu * _squaredDeltas[k]);
+    }
+  }
+
+  void GraduatedNonConvexity::updateWeights()
+  {
+    _optimizer->computeActiveErrors();
+#   ifdef G2O_OPENMP
+#   pragma omp parallel for default (shared) if (_edges.size() > 1000)
+#   endif
+    for (int k = 0; k < static_cast<int>(_edges.size()); ++k) {
+      OptimizableGraph::Edge* e = _edges[k];
+      Vector3 rho;
+      e->robustKernel()->robustify(e->chi2(), rho);
+      _weights[k] = rho[1];
+    }
+  }
+
+  int GraduatedNonConvexity::optimize()
+  {
+    _stages = 0;
+    collectKernels();
+    if (_kernels.empty()) {
+      _stages = 1;
+      return _optimizer->optimize(_innerIterations);
+    }
+
+    _optimizer->computeActiveErrors();
+    number_t mu = initialMu();
+    int iterations = 0;
+    bool online = false;
+    for (;;) {
+      bool finalStage = mu <= 1. || _stages + 1 >= _maxStages;
+      if (finalStage)
+        mu = 1.;
+      setMu(mu);
+      int result = _optimizer->optimize(_innerIterations, online);
+      if (result < 0) {
+        setMu(1.);
+        return -1;
+      }
+      online = true;
+      iterations += result;
+      ++_stages;
+
+      updateWeights();
+      if (_optimizer->verbose()) {
+        int inliers = static_cast<int>(count_if(_weights.begin(), _weights.end(), [](number_t w) { return w > 0.5;}));
+        cerr << "GNC stage= " << _stages - 1
+          << "\t mu= " << mu
+          << "\t chi2= " << FIXED(_optimizer->activeRobustChi2())
+          << "\t inliers= " << inliers << "/" << _edges.size() << endl;
+      }
+      if (finalStage || result == 0 || _optimizer->terminate())
+        break;
+      mu /= _annealingFactor;
+    }
+    setMu(1.);
+    return iterations;
+  }
+
+} // end namespace
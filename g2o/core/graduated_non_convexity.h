@@ -0,0 +1,122 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_GRADUATED_NON_CONVEXITY_H
+#define G2O_GRADUATED_NON_CONVEXITY_H
+
+#include <vector>
+
+#include "optimizable_graph.h"
+#include "g2o_core_api.h"
+
+namespace g2o {
+
+  class SparseOptimizer;
+  class RobustKernel;
+
+  /**
+   * \brief optimize with robust kernels by graduated non-convexity (GNC)
+   *
+   * The robust kernels set on the active edges are annealed from a wide,
+   * almost convex shape to the shape they are configured with. In each
+   * stage the squared delta of a kernel (see RobustKernel::squaredDelta())
+   * is its configured value scaled by mu. The first mu is chosen such that
+   * the largest error is initialScale() times smaller than the scaled
+   * squared delta of its kernel, afterwards mu is divided by
+   * annealingFactor() after each stage until it reaches one. For the
+   * Geman-McClure kernel this is the schedule of Yang et al., "Graduated
+   * Non-Convexity for Robust Spatial Perception", RA-L 2020.
+   *
+   * Each stage runs innerIterations() iterations of the optimization
+   * algorithm of the optimizer. The sparsity pattern does not change
+   * between the stages, hence only the first stage builds the structure
+   * and the following ones continue in online mode re-using it along with
+   * the symbolic factorization. Edges without a robust kernel are
+   * optimized as usual, e.g., the kernels may be set on the loop closures
+   * only. initializeOptimization() has to be called before optimize().
+   */
+  class G2O_CORE_API GraduatedNonConvexity
+  {
+    public:
+      explicit GraduatedNonConvexity(SparseOptimizer* optimizer);
+
+      //! iterations of the optimization algorithm within each stage
+      int innerIterations() const { return _innerIterations;}
+      void setInnerIterations(int iterations);
+
+      //! mu is divided by this factor after each stage
+      number_t annealingFactor() const { return _annealingFactor;}
+      void setAnnealingFactor(number_t factor);
+
+      //! ratio between the scaled squared delta and the largest error in the first stage
+      number_t initialScale() const { return _initialScale;}
+      void setInitialScale(number_t scale);
+
+      //! maximum number of stages, the last one always uses the configured kernels
+      int maxStages() const { return _maxStages;}
+      void setMaxStages(int stages);
+
+      /**
+       * run the annealing schedule. Returns the number of iterations over
+       * all stages, or -1 if the optimization could not be started.
+       * Afterwards the kernels are reset to their configured delta.
+       */
+      int optimize();
+
+      //! number of stages carried out by the last call to optimize()
+      int stages() const { return _stages;}
+      //! the active edges which have a robust kernel
+      const OptimizableGraph::EdgeContainer& robustEdges() const { return _edges;}
+      //! the weight rho'(chi2) of each of the robustEdges() after the last stage
+      const std::vector<number_t>& weights() const { return _weights;}
+
+    protected:
+      //! gather the robust edges and the configured delta of their kernels
+      void collectKernels();
+      //! mu of the first stage, based on the current errors
+      number_t initialMu() const;
+      //! scale the squared delta of each kernel by mu
+      void setMu(number_t mu);
+      //! compute the errors and the weight of each robust edge
+      void updateWeights();
+
+      SparseOptimizer* _optimizer;
+      int _innerIterations;
+      number_t _annealingFactor;
+      number_t _initialScale;
+      int _maxStages;
+      int _stages;
+
+      OptimizableGraph::EdgeContainer _edges;
+      std::vector<number_t> _weights;
+      std::vector<RobustKernel*> _kernels; ///< the distinct kernels of the edges
+      std::vector<number_t> _deltas;       ///< the configured delta of each kernel
+      std::vector<number_t> _squaredDeltas;
+  };
+
+} // end namespace
+
+#endif
@@ -0,0 +1,632 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "graph_binary_io.h"
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <streambuf>
+#include <typeinfo>
+
+#if (defined (UNIX) || defined(CYGWIN))
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "creators.h"
+#include "factory.h"
+#include "parameter_container.h"
+
+#include "g2o/stuff/color_macros.h"
+
+using namespace std;
+
+namespace g2o {
+
+using namespace binary_graph;
+
+namespace {
+  //! the arrays of the file hold doubles, we only need to convert if number_t is something else
+  inline const double* toNumbers(const double* src, size_t, std::vector<double>&)
+  {
+    return src;
+  }
+
+  inline const float* toNumbers(const double* src, size_t n, std::vector<float>& buffer)
+  {
+    buffer.resize(n);
+    for (size_t i = 0; i < n; ++i)
+      buffer[i] = static_cast<float>(src[i]);
+    return buffer.data();
+  }
+
+  //! read only stream buffer on top of a memory region
+  class MemoryBuffer : public std::streambuf
+  {
+    public:
+      MemoryBuffer(const char* data, size_t size)
+      {
+        char* p = const_cast<char*>(data);
+        setg(p, p, p + size);
+      }
+  };
+
+  const size_t maxTextChunkSize = 1 << 20;
+}
+
+GraphBinaryWriter::GraphBinaryWriter(const OptimizableGraph& graph, std::ostream& os, bool edgesHaveId) :
+  _graph(graph), _os(os), _edgesHaveId(edgesHaveId), _headerWritten(false), _finished(false), _numTypes(0),
+  _lastTypeId(0), _lastType(0),
+  _pendingType(0), _pendingTypeInfo(0), _pendingCount(0)
+{
+  _text << std::setprecision(std::numeric_limits<double>::max_digits10);
+}
+
+GraphBinaryWriter::~GraphBinaryWriter()
+{
+  if (! _finished)
+    finish();
+}
+
+bool GraphBinaryWriter::writeHeader()
+{
+  if (_headerWritten)
+    return _os.good();
+  FileHeader header;
+  memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+  header.byteOrder = byteOrderMark;
+  _os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  _headerWritten = true;
+  return _os.good();
+}
+
+bool GraphBinaryWriter::writeChunk(uint32_t type, uint32_t typeIndex, uint64_t count, const std::vector<const void*>& arrays, const std::vector<uint64_t>& sizes)
+{
+  static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+  ChunkHeader header;
+  header.type = type;
+  header.typeIndex = typeIndex;
+  header.count = count;
+  header.size = 0;
+  for (size_t i = 0; i < sizes.size(); ++i)
+    header.size += padded(sizes[i]);
+  _os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    if (sizes[i] > 0)
+      _os.write(static_cast<const char*>(arrays[i]), sizes[i]);
+    _os.write(zeros, padded(sizes[i]) - sizes[i]);
+  }
+  return _os.good();
+}
+
+bool GraphBinaryWriter::flush()
+{
+  if (_pendingCount == 0)
+    return _os.good();
+  std::vector<const void*> arrays;
+  std::vector<uint64_t> sizes;
+  uint32_t typeIndex = 0;
+  uint64_t count = _pendingCount;
+  std::string text;
+  switch (_pendingType) {
+    case CHUNK_VERTICES:
+      arrays.push_back(_ids.data());    sizes.push_back(_ids.size() * sizeof(int32_t));
+      arrays.push_back(_fixed.data());  sizes.push_back(_fixed.size() * sizeof(uint8_t));
+      arrays.push_back(_values.data()); sizes.push_back(_values.size() * sizeof(double));
+      typeIndex = _pendingTypeInfo->index;
+      break;
+    case CHUNK_EDGES:
+      arrays.push_back(_ids.data());          sizes.push_back(_ids.size() * sizeof(int32_t));
+      arrays.push_back(_parameterIds.data()); sizes.push_back(_parameterIds.size() * sizeof(int32_t));
+      arrays.push_back(_values.data());       sizes.push_back(_values.size() * sizeof(double));
+      arrays.push_back(_information.data());  sizes.push_back(_information.size() * sizeof(double));
+      typeIndex = _pendingTypeInfo->index;
+      break;
+    case CHUNK_TEXT:
+      text = _text.str();
+      _text.str(std::string());
+      count = text.size();
+      arrays.push_back(text.data()); sizes.push_back(text.size());
+      break;
+    default:
+      assert(0 && "unknown chunk");
+  }
+  writeChunk(_pendingType, typeIndex, count, arrays, sizes);
+  _pendingCount = 0;
+  _pendingTypeInfo = 0;
+  _ids.clear();
+  _fixed.clear();
+  _parameterIds.clear();
+  _values.clear();
+  _information.clear();
+  return _os.good();
+}
+
+GraphBinaryWriter::TypeInfo* GraphBinaryWriter::typeInfo(const HyperGraph::HyperGraphElement* element)
+{
+  const std::type_info& elementType = typeid(*element);
+  if (_lastTypeId && *_lastTypeId == elementType)
+    return _lastType;
+
+  Factory* factory = Factory::instance();
+  const std::string& tag = factory->tag(element);
+  if (tag.empty())
+    return 0;
+  std::map<std::string, TypeInfo>::iterator it = _types.find(tag);
+  if (it == _types.end()) {
+    TypeInfo info;
+    info.index = -1;
+    memset(&info.record, 0, sizeof(info.record));
+
+    // the types opt in to be written as plain arrays of their data
+    if (element->elementType() == HyperGraph::HGET_VERTEX) {
+      const OptimizableGraph::Vertex* v = static_cast<const OptimizableGraph::Vertex*>(element);
+      int dim = v->estimateDimension();
+      if (v->plainDataFormat() && dim > 0) {
+        info.index = _numTypes++;
+        info.record.kind = KIND_VERTEX;
+        info.record.estimateDimension = dim;
+      }
+    } else if (element->elementType() == HyperGraph::HGET_EDGE && ! _edgesHaveId) {
+      const OptimizableGraph::Edge* e = static_cast<const OptimizableGraph::Edge*>(element);
+      int numVertices = e->vertices().size();
+      int dim = e->measurementDimension();
+      if (e->plainDataFormat() && numVertices > 0 && dim > 0) {
+        info.index = _numTypes++;
+        info.record.kind = KIND_EDGE;
+        info.record.numVertices = numVertices;
+        info.record.numParameters = e->numParameters();
+        info.record.measurementDimension = dim;
+        info.record.informationDimension = e->dimension();
+      }
+    }
+
+    if (info.index >= 0) {
+      flush();
+      info.record.tagLength = tag.size();
+      std::vector<const void*> arrays;
+      std::vector<uint64_t> sizes;
+      arrays.push_back(&info.record); sizes.push_back(sizeof(info.record));
+      arrays.push_back(tag.data());   sizes.push_back(tag.size());
+      writeChunk(CHUNK_TYPE, info.index, 1, arrays, sizes);
+    }
+    it = _types.insert(std::make_pair(tag, info)).first;
+  }
+  _lastTypeId = &elementType;
+  _lastType = &it->second;
+  return _lastType;
+}
+
+std::ostream& GraphBinaryWriter::beginText()
+{
+  if (_pendingType != CHUNK_TEXT || static_cast<size_t>(_text.tellp()) >= maxTextChunkSize)
+    flush();
+  _pendingType = CHUNK_TEXT;
+  ++_pendingCount;
+  return _text;
+}
+
+bool GraphBinaryWriter::writeParameters(const ParameterContainer& parameters)
+{
+  if (! writeHeader())
+    return false;
+  if (parameters.size() == 0)
+    return true;
+  return parameters.write(beginText());
+}
+
+bool GraphBinaryWriter::writeVertex(OptimizableGraph::Vertex* v)
+{
+  if (! writeHeader())
+    return false;
+  TypeInfo* type = typeInfo(v);
+  if (! type)
+    return false;
+  if (type->index < 0 || v->userData())
+    return _graph.saveVertex(beginText(), v);
+
+  if (_pendingType != CHUNK_VERTICES || _pendingTypeInfo != type || _pendingCount >= maxChunkElements)
+    flush();
+  _pendingType = CHUNK_VERTICES;
+  _pendingTypeInfo = type;
+  ++_pendingCount;
+  _ids.push_back(v->id());
+  _fixed.push_back(v->fixed() ? 1 : 0);
+  _buffer.resize(type->record.estimateDimension);
+  v->getEstimateData(_buffer.data());
+  _values.insert(_values.end(), _buffer.begin(), _buffer.end());
+  return _os.good();
+}
+
+bool GraphBinaryWriter::writeEdge(OptimizableGraph::Edge* e)
+{
+  if (! writeHeader())
+    return false;
+  TypeInfo* type = typeInfo(e);
+  if (! type)
+    return false;
+  if (type->index < 0 || e->userData() || (int)e->vertices().size() != type->record.numVertices)
+    return _graph.saveEdge(beginText(), e);
+
+  if (_pendingType != CHUNK_EDGES || _pendingTypeInfo != type || _pendingCount >= maxChunkElements)
+    flush();
+  _pendingType = CHUNK_EDGES;
+  _pendingTypeInfo = type;
+  ++_pendingCount;
+  for (size_t i = 0; i < e->vertices().size(); ++i)
+    _ids.push_back(e->vertices()[i] ? e->vertices()[i]->id() : HyperGraph::UnassignedId);
+  for (size_t i = 0; i < e->numParameters(); ++i)
+    _parameterIds.push_back(e->parameterId(i));
+  _buffer.resize(type->record.measurementDimension);
+  e->getMeasurementData(_buffer.data());
+  _values.insert(_values.end(), _buffer.begin(), _buffer.end());
+  const int infoDim = type->record.informationDimension;
+  const number_t* info = e->informationData();
+  for (int c = 0; c < infoDim; ++c)
+    for (int r = 0; r <= c; ++r)
+      _information.push_back(info[c * infoDim + r]);
+  return _os.good();
+}
+
+bool GraphBinaryWriter::finish()
+{
+  if (! writeHeader())
+    return false;
+  flush();
+  writeChunk(CHUNK_END, 0, 0, std::vector<const void*>(), std::vector<uint64_t>());
+  _finished = true;
+  _os.flush();
+  return _os.good();
+}
+
+GraphBinaryReader::GraphBinaryReader(OptimizableGraph& graph, const std::map<std::string, std::string>* renamedTypes) :
+  _graph(graph), _renamedTypes(renamedTypes), _createEdges(true)
+{
+}
+
+bool GraphBinaryReader::isBinary(std::istream& is)
+{
+  if (is.peek() != static_cast<unsigned char>(magic[0]))
+    return false;
+  // compare the whole magic and restore the position of the stream afterwards
+  char buffer[sizeof(magic)];
+  std::streampos start = is.tellg();
+  if (start != std::streampos(-1)) {
+    bool r = static_cast<bool>(is.read(buffer, sizeof(buffer)));
+    is.clear();
+    is.seekg(start);
+    return r && memcmp(buffer, magic, sizeof(magic)) == 0;
+  }
+  // the stream is not seekable, put the matching characters back into its buffer
+  std::streambuf* sb = is.rdbuf();
+  size_t n = 0;
+  while (n < sizeof(magic) && sb->sgetc() == static_cast<unsigned char>(magic[n])) {
+    sb->sbumpc();
+    ++n;
+  }
+  bool result = n == sizeof(magic);
+  while (n > 0 && sb->sputbackc(magic[n - 1]) != std::char_traits<char>::eof())
+    --n;
+  if (n > 0)
+    is.setstate(std::ios::failbit);
+  return result;
+}
+
+bool GraphBinaryReader::isBinary(const char* filename)
+{
+  std::ifstream ifs(filename, std::ios::binary);
+  char buffer[sizeof(magic)];
+  if (! ifs.read(buffer, sizeof(buffer)))
+    return false;
+  return memcmp(buffer, magic, sizeof(magic)) == 0;
+}
+
+bool GraphBinaryReader::read(std::istream& is, bool createEdges)
+{
+  std::vector<char> data;
+  std::vector<char> block(1 << 20);
+  while (is.read(block.data(), block.size()) || is.gcount() > 0)
+    data.insert(data.end(), block.begin(), block.begin() + is.gcount());
+  return read(data.data(), data.size(), createEdges);
+}
+
+bool GraphBinaryReader::read(const char* filename, bool createEdges)
+{
+#if (defined (UNIX) || defined(CYGWIN))
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    cerr << __PRETTY_FUNCTION__ << ": unable to open file " << filename << endl;
+    return false;
+  }
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+    cerr << __PRETTY_FUNCTION__ << ": unable to determine the size of " << filename << endl;
+    close(fd);
+    return false;
+  }
+  size_t size = fileStat.st_size;
+  void* mapping = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    cerr << __PRETTY_FUNCTION__ << ": unable to map file " << filename << endl;
+    return false;
+  }
+  madvise(mapping, size, MADV_SEQUENTIAL);
+  bool result = read(static_cast<const char*>(mapping), size, createEdges);
+  munmap(mapping, size);
+  return result;
+#else
+  std::ifstream ifs(filename, std::ios::binary);
+  if (! ifs) {
+    cerr << __PRETTY_FUNCTION__ << ": unable to open file " << filename << endl;
+    return false;
+  }
+  return read(ifs, createEdges);
+#endif
+}
+
+bool GraphBinaryReader::read(const char* data, size_t size, bool createEdges)
+{
+  _types.clear();
+  _createEdges = createEdges;
+  if (reinterpret_cast<uintptr_t>(data) % 8 != 0) {
+    cerr << __PRETTY_FUNCTION__ << ": data has to be aligned to 8 bytes" << endl;
+    return false;
+  }
+  FileHeader fileHeader;
+  if (size < sizeof(fileHeader)) {
+    cerr << __PRETTY_FUNCTION__ << ": file too short" << endl;
+    return false;
+  }
+  memcpy(&fileHeader, data, sizeof(fileHeader));
+  if (memcmp(fileHeader.magic, magic, sizeof(magic)) != 0) {
+    cerr << __PRETTY_FUNCTION__ << ": not a binary g2o file" << endl;
+    return false;
+  }
+  if (fileHeader.byteOrder != byteOrderMark) {
+    cerr << __PRETTY_FUNCTION__ << ": file was written with a different byte order" << endl;
+    return false;
+  }
+  if (fileHeader.version > version) {
+    cerr << __PRETTY_FUNCTION__ << ": unsupported version " << fileHeader.version << endl;
+    return false;
+  }
+
+  size_t offset = sizeof(fileHeader);
+  bool terminated = false;
+  while (! terminated && offset + sizeof(ChunkHeader) <= size) {
+    ChunkHeader header;
+    memcpy(&header, data + offset, sizeof(header));
+    offset += sizeof(header);
+    if (header.size > size - offset || header.size % 8 != 0) {
+      cerr << __PRETTY_FUNCTION__ << ": corrupted chunk at offset " << offset - sizeof(header) << endl;
+      return false;
+    }
+    const char* payload = data + offset;
+    bool ok = true;
+    switch (header.type) {
+      case CHUNK_TYPE:
+        ok = readType(header, payload);
+        break;
+      case CHUNK_VERTICES:
+        ok = readVertices(header, payload);
+        break;
+      case CHUNK_EDGES:
+        ok = readEdges(header, payload);
+        break;
+      case CHUNK_TEXT:
+        {
+          if (header.count > header.size) {
+            ok = false;
+            break;
+          }
+          MemoryBuffer buffer(payload, header.count);
+          std::istream is(&buffer);
+          ok = _graph.load(is, createEdges);
+        }
+        break;
+      case CHUNK_END:
+        terminated = true;
+        break;
+      default:
+        cerr << __PRETTY_FUNCTION__ << ": skipping unknown chunk " << header.type << endl;
+    }
+    if (! ok) {
+      cerr << __PRETTY_FUNCTION__ << ": error while reading chunk at offset " << offset - sizeof(header) << endl;
+      return false;
+    }
+    offset += header.size;
+  }
+  if (! terminated) {
+    cerr << __PRETTY_FUNCTION__ << ": file is truncated" << endl;
+    return false;
+  }
+  return true;
+}
+
+bool GraphBinaryReader::readType(const ChunkHeader& header, const char* payload)
+{
+  if (header.typeIndex != _types.size() || header.size < sizeof(TypeRecord))
+    return false;
+  TypeInfo info;
+  memcpy(&info.record, payload, sizeof(TypeRecord));
+  const TypeRecord& r = info.record;
+  if (r.tagLength > header.size - sizeof(TypeRecord))
+    return false;
+  static const int maxDimension = 1 << 12;
+  if (r.estimateDimension < 0 || r.estimateDimension > maxDimension || r.numVertices < 0 || r.numVertices > maxDimension
+      || r.numParameters < 0 || r.numParameters > maxDimension || r.measurementDimension < 0 || r.measurementDimension > maxDimension
+      || r.informationDimension < 0 || r.informationDimension > maxDimension)
+    return false;
+  if ((r.kind == KIND_VERTEX && r.estimateDimension == 0) || (r.kind == KIND_EDGE && r.numVertices == 0))
+    return false;
+  info.tag.assign(payload + sizeof(TypeRecord), r.tagLength);
+  if (_renamedTypes) {
+    std::map<std::string, std::string>::const_iterator foundIt = _renamedTypes->find(info.tag);
+    if (foundIt != _renamedTypes->end())
+      info.tag = foundIt->second;
+  }
+
+  // check that the registered type agrees with the layout in the file
+  Factory* factory = Factory::instance();
+  info.creator = factory->creator(info.tag);
+  if (! info.creator) {
+    cerr << CL_RED(__PRETTY_FUNCTION__ << " unknown type: " << info.tag) << endl;
+  } else {
+    HyperGraph::HyperGraphElement* element = info.creator->construct();
+    bool agrees = false;
+    if (r.kind == KIND_VERTEX && element->elementType() == HyperGraph::HGET_VERTEX) {
+      OptimizableGraph::Vertex* v = static_cast<OptimizableGraph::Vertex*>(element);
+      agrees = v->estimateDimension() == r.estimateDimension;
+    } else if (r.kind == KIND_EDGE && element->elementType() == HyperGraph::HGET_EDGE) {
+      OptimizableGraph::Edge* e = static_cast<OptimizableGraph::Edge*>(element);
+      agrees = (int)e->vertices().size() == r.numVertices && (int)e->numParameters() == r.numParameters
+        && e->measurementDimension() == r.measurementDimension && e->dimension() == r.informationDimension;
+    }
+    delete element;
+    if (! agrees) {
+      cerr << __PRETTY_FUNCTION__ << ": type " << info.tag << " does not match the layout of the file" << endl;
+      return false;
+    }
+  }
+  _types.push_back(info);
+  return true;
+}
+
+const GraphBinaryReader::TypeInfo* GraphBinaryReader::type(const ChunkHeader& header, uint32_t kind) const
+{
+  if (header.typeIndex >= _types.size() || _types[header.typeIndex].record.kind != kind)
+    return 0;
+  return &_types[header.typeIndex];
+}
+
+bool GraphBinaryReader::readVertices(const ChunkHeader& header, const char* payload)
+{
+  const TypeInfo* t = type(header, KIND_VERTEX);
+  if (! t || header.count > header.size)
+    return false;
+  const uint64_t n = header.count;
+  const int dim = t->record.estimateDimension;
+  const uint64_t idsSize = padded(n * sizeof(int32_t));
+  const uint64_t fixedSize = padded(n * sizeof(uint8_t));
+  if (idsSize + fixedSize + n * dim * sizeof(double) != header.size)
+    return false;
+  if (! t->creator) // unknown type, already reported
+    return true;
+
+  const int32_t* ids = reinterpret_cast<const int32_t*>(payload);
+  const uint8_t* fixed = reinterpret_cast<const uint8_t*>(payload + idsSize);
+  const double* estimates = reinterpret_cast<const double*>(payload + idsSize + fixedSize);
+  for (uint64_t i = 0; i < n; ++i) {
+    OptimizableGraph::Vertex* v = static_cast<OptimizableGraph::Vertex*>(t->creator->construct());
+    v->setId(ids[i]);
+    if (! v->setEstimateData(toNumbers(estimates + i * dim, dim, _buffer)))
+      cerr << __PRETTY_FUNCTION__ << ": Error reading vertex " << t->tag << " " << ids[i] << endl;
+    v->setFixed(fixed[i] != 0);
+    if (! _graph.addVertex(v)) {
+      cerr << __PRETTY_FUNCTION__ << ": Failure adding Vertex, " << t->tag << " " << ids[i] << endl;
+      delete v;
+    }
+  }
+  return true;
+}
+
+bool GraphBinaryReader::readEdges(const ChunkHeader& header, const char* payload)
+{
+  const TypeInfo* t = type(header, KIND_EDGE);
+  if (! t || header.count > header.size)
+    return false;
+  const uint64_t n = header.count;
+  const int numVertices = t->record.numVertices;
+  const int numParameters = t->record.numParameters;
+  const int dim = t->record.measurementDimension;
+  const int infoDim = t->record.informationDimension;
+  const int infoSize = infoDim * (infoDim + 1) / 2;
+  const uint64_t idsSize = padded(n * numVertices * sizeof(int32_t));
+  const uint64_t parameterSize = padded(n * numParameters * sizeof(int32_t));
+  const uint64_t measurementSize = n * dim * sizeof(double);
+  if (idsSize + parameterSize + measurementSize + n * infoSize * sizeof(double) != header.size)
+    return false;
+  if (! t->creator) // unknown type, already reported
+    return true;
+
+  const int32_t* ids = reinterpret_cast<const int32_t*>(payload);
+  const int32_t* parameterIds = reinterpret_cast<const int32_t*>(payload + idsSize);
+  const double* measurements = reinterpret_cast<const double*>(payload + idsSize + parameterSize);
+  const double* information = reinterpret_cast<const double*>(payload + idsSize + parameterSize + measurementSize);
+  for (uint64_t i = 0; i < n; ++i) {
+    const int32_t* edgeIds = ids + i * numVertices;
+    OptimizableGraph::Edge* e = static_cast<OptimizableGraph::Edge*>(t->creator->construct());
+    // as in the text format, the missing vertices of a pairwise edge are created on request
+    int created = -1;
+    bool vertsOkay = true;
+    for (int l = 0; l < numVertices; ++l) {
+      OptimizableGraph::Vertex* v = 0;
+      if (edgeIds[l] != HyperGraph::UnassignedId) {
+        v = _graph.vertex(edgeIds[l]);
+        if (! v && _createEdges && numVertices == 2 && edgeIds[l] >= 0) {
+          v = e->createVertex(l);
+          if (v) {
+            v->setId(edgeIds[l]);
+            _graph.addVertex(v);
+            created = l;
+          }
+        }
+        vertsOkay = vertsOkay && v;
+      }
+      e->setVertex(l, v);
+    }
+    for (int l = 0; l < numParameters; ++l)
+      e->setParameterId(l, parameterIds[i * numParameters + l]);
+    bool r = e->setMeasurementData(toNumbers(measurements + i * dim, dim, _buffer));
+    const double* triangle = information + i * infoSize;
+    number_t* info = e->informationData();
+    for (int c = 0, k = 0; c < infoDim; ++c)
+      for (int row = 0; row <= c; ++row, ++k)
+        info[c * infoDim + row] = info[row * infoDim + c] = static_cast<number_t>(triangle[k]);
+    if (! vertsOkay || ! r || ! _graph.addEdge(e)) {
+      cerr << __PRETTY_FUNCTION__ << ": Unable to add edge " << t->tag;
+      for (int l = 0; l < numVertices; ++l)
+        cerr << (l > 0 ? " <-> " : " ") << edgeIds[l];
+      cerr << endl;
+      delete e;
+    } else if (created >= 0 && e->vertices()[0] && e->vertices()[1]) {
+      HyperGraph::VertexSet fromSet;
+      fromSet.insert(e->vertices()[1 - created]);
+      e->initialEstimate(fromSet, static_cast<OptimizableGraph::Vertex*>(e->vertices()[created]));
+    }
+  }
+  return true;
+}
+
+} // end namespace
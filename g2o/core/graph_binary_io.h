@@ -0,0 +1,230 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_GRAPH_BINARY_IO_H
+#define G2O_GRAPH_BINARY_IO_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "optimizable_graph.h"
+#include "g2o_core_api.h"
+
+namespace g2o {
+
+  class AbstractHyperGraphElementCreator;
+
+  /**
+   * \brief layout of the binary graph file format (.g2ob)
+   *
+   * A file starts with a FileHeader which is followed by a sequence of
+   * chunks, each consisting of a ChunkHeader and a payload padded to a
+   * multiple of 8 bytes. Hence, all the arrays within the file are
+   * aligned and may be read in place from a memory mapping. Numbers are
+   * stored in the byte order of the writing machine, the byteOrder field
+   * allows to detect a mismatch.
+   *
+   * - CHUNK_TYPE defines the type with index typeIndex: a TypeRecord
+   *   followed by the tag of the type.
+   * - CHUNK_VERTICES holds count vertices of one type as plain arrays:
+   *   int32 ids[count], uint8 fixed[count], double estimates[count][estimateDimension].
+   * - CHUNK_EDGES holds count edges of one type as plain arrays:
+   *   int32 vertexIds[count][numVertices], int32 parameterIds[count][numParameters],
+   *   double measurements[count][measurementDimension] and the upper
+   *   triangle of the information matrices, column by column.
+   * - CHUNK_TEXT holds count bytes of the .g2o text format. It is used for
+   *   the parameters, the user data and all elements whose type does not
+   *   opt in by plainDataFormat().
+   * - CHUNK_END terminates the file.
+   *
+   * The chunks are written in the order of the text format and each chunk
+   * holds a run of consecutive elements, therefore loading a binary file
+   * inserts the elements in the same order as loading the corresponding
+   * text file.
+   */
+  namespace binary_graph {
+    static const char magic[8] = {'\x89', 'G', '2', 'O', '\r', '\n', '\x1a', '\n'};
+    static const uint32_t version = 1;
+    static const uint32_t byteOrderMark = 0x01020304;
+
+    enum ChunkType {
+      CHUNK_TYPE = 1,
+      CHUNK_VERTICES = 2,
+      CHUNK_EDGES = 3,
+      CHUNK_TEXT = 4,
+      CHUNK_END = 5
+    };
+
+    enum TypeKind {
+      KIND_VERTEX = 1,
+      KIND_EDGE = 2
+    };
+
+    struct FileHeader {
+      char magic[8];
+      uint32_t version;
+      uint32_t byteOrder;
+    };
+
+    struct ChunkHeader {
+      uint32_t type;
+      uint32_t typeIndex;
+      uint64_t count;
+      uint64_t size;     ///< size of the payload in bytes including the padding
+    };
+
+    struct TypeRecord {
+      uint32_t kind;
+      int32_t estimateDimension;
+      int32_t numVertices;
+      int32_t numParameters;
+      int32_t measurementDimension;
+      int32_t informationDimension;
+      uint32_t tagLength;
+      uint32_t reserved;
+    };
+
+    //! pad a size in bytes to the 8 byte alignment of the chunks
+    inline uint64_t padded(uint64_t size) { return (size + 7) & ~uint64_t(7);}
+  }
+
+  /**
+   * \brief streaming writer for the binary graph format
+   *
+   * The elements are appended one by one and buffered as long as they
+   * belong to the same type, afterwards the run is flushed as one chunk.
+   * Thus, the memory consumption is bounded by the size of one chunk.
+   *
+   * A type is written as fixed size records, if it opts in by
+   * plainDataFormat(), i.e., its estimate or its measurement, information
+   * matrix, and parameter ids describe the element. Otherwise, the
+   * elements of that type are written as text chunks. Elements carrying
+   * user data are always written as text.
+   */
+  class G2O_CORE_API GraphBinaryWriter
+  {
+    public:
+      //! elements per chunk
+      static const size_t maxChunkElements = 65536;
+
+      GraphBinaryWriter(const OptimizableGraph& graph, std::ostream& os, bool edgesHaveId = false);
+      ~GraphBinaryWriter();
+
+      bool writeParameters(const ParameterContainer& parameters);
+      bool writeVertex(OptimizableGraph::Vertex* v);
+      bool writeEdge(OptimizableGraph::Edge* e);
+
+      //! flush the pending chunk and terminate the file
+      bool finish();
+
+    protected:
+      struct TypeInfo {
+        int index;                 ///< index in the file, -1 if written as text
+        binary_graph::TypeRecord record;
+      };
+
+      TypeInfo* typeInfo(const HyperGraph::HyperGraphElement* element);
+      bool writeHeader();
+      bool flush();
+      bool writeChunk(uint32_t type, uint32_t typeIndex, uint64_t count, const std::vector<const void*>& arrays, const std::vector<uint64_t>& sizes);
+      std::ostream& beginText();
+
+      const OptimizableGraph& _graph;
+      std::ostream& _os;
+      bool _edgesHaveId;
+      bool _headerWritten;
+      bool _finished;
+      int _numTypes;
+
+      std::map<std::string, TypeInfo> _types;
+      const std::type_info* _lastTypeId;
+      TypeInfo* _lastType;
+
+      // the pending chunk
+      uint32_t _pendingType;
+      TypeInfo* _pendingTypeInfo;
+      uint64_t _pendingCount;
+      std::vector<int32_t> _ids;
+      std::vector<uint8_t> _fixed;
+      std::vector<int32_t> _parameterIds;
+      std::vector<double> _values;
+      std::vector<double> _information;
+      std::ostringstream _text;
+      std::vector<number_t> _buffer;
+  };
+
+  /**
+   * \brief reader for the binary graph format
+   *
+   * The file is memory mapped if the platform supports it, which saves
+   * copying the file into memory. Each element is still constructed by the
+   * Factory and filled via setEstimateData() or setMeasurementData() from
+   * the arrays of the mapping, which avoids parsing the text but not the
+   * per element construction.
+   *
+   * If createEdges is true, the missing vertices of pairwise edges are
+   * created and initialized from the edge, as done by the text format.
+   */
+  class G2O_CORE_API GraphBinaryReader
+  {
+    public:
+      explicit GraphBinaryReader(OptimizableGraph& graph, const std::map<std::string, std::string>* renamedTypes = 0);
+
+      //! read the graph from the given memory, which has to be aligned to 8 bytes
+      bool read(const char* data, size_t size, bool createEdges = true);
+      bool read(std::istream& is, bool createEdges = true);
+      bool read(const char* filename, bool createEdges = true);
+
+      //! true, if the stream / file starts with the magic of the binary format. The stream is not consumed.
+      static bool isBinary(std::istream& is);
+      static bool isBinary(const char* filename);
+
+    protected:
+      struct TypeInfo {
+        binary_graph::TypeRecord record;
+        std::string tag;
+        AbstractHyperGraphElementCreator* creator;
+      };
+
+      bool readType(const binary_graph::ChunkHeader& header, const char* payload);
+      bool readVertices(const binary_graph::ChunkHeader& header, const char* payload);
+      bool readEdges(const binary_graph::ChunkHeader& header, const char* payload);
+      const TypeInfo* type(const binary_graph::ChunkHeader& header, uint32_t kind) const;
+
+      OptimizableGraph& _graph;
+      const std::map<std::string, std::string>* _renamedTypes;
+      std::vector<TypeInfo> _types;
+      std::vector<number_t> _buffer;
+      bool _createEdges;
+  };
+
+} // end namespace
+
+#endif
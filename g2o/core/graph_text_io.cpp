@@ -0,0 +1,619 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "graph_text_io.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#ifdef G2O_OPENMP
+#include <omp.h>
+#endif
+
+#include "creators.h"
+#include "factory.h"
+#include "parameter_container.h"
+
+#include "g2o/stuff/color_macros.h"
+
+using namespace std;
+
+namespace g2o {
+
+namespace {
+  //! the numbers are parsed as doubles, we only need to convert if number_t is something else
+  inline const double* toNumbers(const double* src, size_t, std::vector<double>&)
+  {
+    return src;
+  }
+
+  inline const float* toNumbers(const double* src, size_t n, std::vector<float>& buffer)
+  {
+    buffer.resize(n);
+    for (size_t i = 0; i < n; ++i)
+      buffer[i] = static_cast<float>(src[i]);
+    return buffer.data();
+  }
+
+  inline bool isSpace(char c)
+  {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+  }
+
+  inline const char* skipSpace(const char* p, const char* end)
+  {
+    while (p < end && isSpace(*p))
+      ++p;
+    return p;
+  }
+
+  inline const char* skipToken(const char* p, const char* end)
+  {
+    while (p < end && ! isSpace(*p))
+      ++p;
+    return p;
+  }
+
+  /**
+   * only plain decimal numbers are taken, everything else, e.g., nan or
+   * inf, is left to operator>> of the element
+   */
+  inline bool isNumberStart(const char* p, const char* end)
+  {
+    if (*p == '+' || *p == '-')
+      ++p;
+    if (p < end && *p == '.')
+      ++p;
+    return p < end && *p >= '0' && *p <= '9';
+  }
+
+  inline bool toId(double x, int& id)
+  {
+    if (! (x >= numeric_limits<int>::min() && x <= numeric_limits<int>::max()))
+      return false;
+    id = static_cast<int>(x);
+    return id == x;
+  }
+}
+
+GraphTextReader::GraphTextReader(OptimizableGraph& graph, const std::map<std::string, std::string>* renamedTypes, bool edgesHaveId) :
+  _graph(graph), _renamedTypes(renamedTypes), _edgesHaveId(edgesHaveId), _createEdges(true), _lineNumber(0),
+  _lastType(0), _previousDataContainer(0), _previousData(0),
+  _lineStream(&_lineBuffer)
+{
+}
+
+bool GraphTextReader::read(std::istream& is, bool createEdges)
+{
+  _createEdges = createEdges;
+  _lineNumber = 0;
+  _previousDataContainer = 0;
+  _previousData = 0;
+
+  int chunksPerBlock = 1;
+# ifdef G2O_OPENMP
+  chunksPerBlock = 4 * omp_get_max_threads();
+# endif
+  const size_t blockSize = chunksPerBlock * chunkSize;
+
+  std::vector<char> data;
+  std::vector<Chunk> chunks;
+  size_t carried = 0; // bytes of an incomplete line carried over from the previous block
+  bool eof = false;
+  while (! eof) {
+    data.resize(carried + blockSize + 1);
+    is.read(data.data() + carried, blockSize);
+    size_t size = carried + is.gcount();
+    eof = ! is;
+    // the terminating zero stops the number parsing on the last line
+    data[size] = 0;
+
+    // the block ends with the last complete line, the rest is carried over
+    size_t blockEnd = size;
+    if (! eof) {
+      while (blockEnd > 0 && data[blockEnd - 1] != '\n')
+        --blockEnd;
+      if (blockEnd == 0) { // a line longer than the block
+        carried = size;
+        continue;
+      }
+    }
+
+    // split the block into newline aligned chunks
+    const char* blockData = data.data();
+    size_t numChunks = 0;
+    for (size_t begin = 0; begin < blockEnd; ) {
+      size_t end = std::min(begin + chunkSize, blockEnd);
+      while (end < blockEnd && blockData[end - 1] != '\n')
+        ++end;
+      if (numChunks == chunks.size())
+        chunks.resize(numChunks + 1);
+      chunks[numChunks].begin = blockData + begin;
+      chunks[numChunks].end = blockData + end;
+      ++numChunks;
+      begin = end;
+    }
+
+    int n = static_cast<int>(numChunks);
+#   ifdef G2O_OPENMP
+#   pragma omp parallel for default (shared) schedule(dynamic) if (n > 1)
+#   endif
+    for (int i = 0; i < n; ++i)
+      tokenize(chunks[i]);
+
+    for (int i = 0; i < n; ++i)
+      commit(chunks[i]);
+
+    carried = size - blockEnd;
+    memmove(data.data(), data.data() + blockEnd, carried);
+  }
+  return true;
+}
+
+void GraphTextReader::tokenize(Chunk& chunk)
+{
+  chunk.numLines = 0;
+  chunk.lines.clear();
+  chunk.numbers.clear();
+  const char* p = chunk.begin;
+  while (p < chunk.end) {
+    const char* lineEnd = static_cast<const char*>(memchr(p, '\n', chunk.end - p));
+    if (! lineEnd)
+      lineEnd = chunk.end;
+    ++chunk.numLines;
+    const char* tag = skipSpace(p, lineEnd);
+    p = lineEnd + 1;
+    if (tag == lineEnd || *tag == '#')
+      continue;
+
+    Line line;
+    line.lineNumber = chunk.numLines;
+    line.tag = tag;
+    line.rest = skipToken(tag, lineEnd);
+    line.tagLength = static_cast<int>(line.rest - tag);
+    line.end = lineEnd;
+    line.numbersBegin = static_cast<int>(chunk.numbers.size());
+    line.numNumbers = 0;
+    for (const char* s = skipSpace(line.rest, lineEnd); s < lineEnd; s = skipSpace(s, lineEnd)) {
+      const char* tokenEnd = skipToken(s, lineEnd);
+      char* numberEnd = 0;
+      double x = isNumberStart(s, tokenEnd) ? strtod(s, &numberEnd) : 0.;
+      if (numberEnd != tokenEnd) {
+        line.numNumbers = -1;
+        chunk.numbers.resize(line.numbersBegin);
+        break;
+      }
+      chunk.numbers.push_back(x);
+      ++line.numNumbers;
+      s = tokenEnd;
+    }
+    chunk.lines.push_back(line);
+  }
+}
+
+void GraphTextReader::commit(const Chunk& chunk)
+{
+  for (size_t i = 0; i < chunk.lines.size(); ++i) {
+    const Line& line = chunk.lines[i];
+    const double* numbers = line.numNumbers >= 0 ? chunk.numbers.data() + line.numbersBegin : 0;
+    if (line.tagLength == 3 && memcmp(line.tag, "FIX", 3) == 0) {
+      readFix(line, numbers);
+      continue;
+    }
+    TypeInfo* type = typeInfo(line.tag, line.tagLength);
+    switch (type->elementType) {
+      case HyperGraph::HGET_PARAMETER:
+        readParameter(type, line);
+        break;
+      case HyperGraph::HGET_VERTEX:
+        readVertex(type, line, numbers);
+        break;
+      case HyperGraph::HGET_EDGE:
+        readEdge(type, line, numbers);
+        break;
+      case HyperGraph::HGET_DATA:
+        readData(type, line);
+        break;
+      default:
+        break;
+    }
+  }
+  _lineNumber += chunk.numLines;
+}
+
+GraphTextReader::TypeInfo* GraphTextReader::typeInfo(const char* tag, int length)
+{
+  if (_lastType && static_cast<int>(_lastType->fileTag.size()) == length && memcmp(_lastType->fileTag.data(), tag, length) == 0)
+    return _lastType;
+
+  std::string fileTag(tag, length);
+  std::map<std::string, TypeInfo>::iterator it = _types.find(fileTag);
+  if (it == _types.end()) {
+    TypeInfo info;
+    info.fileTag = fileTag;
+    info.tag = fileTag;
+    // do the mapping to an internal type if it matches
+    if (_renamedTypes && _renamedTypes->size() > 0) {
+      std::map<std::string, std::string>::const_iterator foundIt = _renamedTypes->find(fileTag);
+      if (foundIt != _renamedTypes->end())
+        info.tag = foundIt->second;
+    }
+    Factory* factory = Factory::instance();
+    info.creator = factory->creator(info.tag);
+    info.fillFromNumbers = false;
+    if (! factory->knowsTag(info.tag, &info.elementType) || ! info.creator) {
+      info.elementType = -1;
+      cerr << CL_RED(__PRETTY_FUNCTION__ << " unknown type: " << info.tag) << endl;
+    } else if (info.elementType == HyperGraph::HGET_VERTEX || info.elementType == HyperGraph::HGET_EDGE) {
+      // the types opt in to be filled from the numbers
+      HyperGraph::HyperGraphElement* element = info.creator->construct();
+      if (info.elementType == HyperGraph::HGET_VERTEX)
+        info.fillFromNumbers = static_cast<OptimizableGraph::Vertex*>(element)->plainDataFormat();
+      else
+        info.fillFromNumbers = static_cast<OptimizableGraph::Edge*>(element)->plainDataFormat();
+      delete element;
+    }
+    it = _types.insert(std::make_pair(fileTag, info)).first;
+  }
+  _lastType = &it->second;
+  return _lastType;
+}
+
+std::istream& GraphTextReader::lineStream(const Line& line, int skipTokens)
+{
+  const char* p = line.rest;
+  for (int i = 0; i < skipTokens; ++i)
+    p = skipToken(skipSpace(p, line.end), line.end);
+  _lineBuffer.set(p, line.end);
+  _lineStream.clear();
+  return _lineStream;
+}
+
+void GraphTextReader::readFix(const Line& line, const double* numbers)
+{
+  std::vector<int> ids;
+  int id;
+  for (int i = 0; numbers && i < line.numNumbers; ++i) {
+    if (! toId(numbers[i], id)) {
+      numbers = 0;
+      ids.clear();
+      break;
+    }
+    ids.push_back(id);
+  }
+  if (! numbers) {
+    std::istream& currentLine = lineStream(line);
+    while (currentLine >> id)
+      ids.push_back(id);
+  }
+
+  for (size_t i = 0; i < ids.size(); ++i) {
+    OptimizableGraph::Vertex* v = _graph.vertex(ids[i]);
+    if (v) {
+#    ifndef NDEBUG
+      cerr << "Fixing vertex " << v->id() << endl;
+#    endif
+      v->setFixed(true);
+    } else {
+      cerr << "Warning: Unable to fix vertex with id " << ids[i] << ". Not found in the graph." << endl;
+    }
+  }
+}
+
+void GraphTextReader::readParameter(TypeInfo* type, const Line& line)
+{
+  Parameter* p = static_cast<Parameter*>(type->creator->construct());
+  std::istream& currentLine = lineStream(line);
+  int pid;
+  currentLine >> pid;
+  p->setId(pid);
+  bool r = p->read(currentLine);
+  if (! r) {
+    cerr << __PRETTY_FUNCTION__ << ": Error reading data " << type->tag << " for parameter " << pid << endl;
+    delete p;
+  } else {
+    if (! _graph.parameters().addParameter(p) ){
+      cerr << __PRETTY_FUNCTION__ << ": Parameter of type:" << type->tag << " id:" << pid << " already defined" << endl;
+    }
+  }
+}
+
+void GraphTextReader::readVertex(TypeInfo* type, const Line& line, const double* numbers)
+{
+  _previousData = 0;
+  OptimizableGraph::Vertex* v = static_cast<OptimizableGraph::Vertex*>(type->creator->construct());
+  int id;
+  bool r = false;
+  bool filled = false;
+  if (type->fillFromNumbers && numbers && line.numNumbers > 1 && line.numNumbers - 1 == v->estimateDimension() && toId(numbers[0], id))
+    filled = r = v->setEstimateData(toNumbers(numbers + 1, line.numNumbers - 1, _buffer));
+  if (! filled) {
+    std::istream& currentLine = lineStream(line);
+    currentLine >> id;
+    r = v->read(currentLine);
+  }
+  if (! r)
+    cerr << __PRETTY_FUNCTION__ << ": Error reading vertex " << type->tag << " " << id << endl;
+  v->setId(id);
+  if (! _graph.addVertex(v)) {
+    cerr << __PRETTY_FUNCTION__ << ": Failure adding Vertex, " << type->tag << " " << id << endl;
+    delete v;
+  } else {
+    _previousDataContainer = v;
+  }
+}
+
+void GraphTextReader::readEdge(TypeInfo* type, const Line& line, const double* numbers)
+{
+  _previousData = 0;
+  OptimizableGraph::Edge* e = static_cast<OptimizableGraph::Edge*>(type->creator->construct());
+  int numV = e->vertices().size();
+
+  // the ids of the edge and its vertices
+  int numIds = (_edgesHaveId ? 1 : 0) + numV;
+  std::vector<int> ids(numIds);
+  if (numV == 0 || ! numbers || line.numNumbers < numIds)
+    numbers = 0;
+  for (int l = 0; numbers && l < numIds; ++l)
+    if (! toId(numbers[l], ids[l]))
+      numbers = 0;
+  if (! numbers) {
+    std::istream& currentLine = lineStream(line);
+    ids.resize(_edgesHaveId ? 1 : 0);
+    int id;
+    if (_edgesHaveId)
+      currentLine >> ids[0];
+    if (numV != 0) {
+      for (int l = 0; l < numV; ++l) {
+        currentLine >> id;
+        ids.push_back(id);
+      }
+    } else {
+      string buff;
+      currentLine >> buff;
+      while (buff != "||") {
+        ids.push_back(atoi(buff.c_str()));
+        currentLine >> buff;
+      }
+      numV = ids.size() - (_edgesHaveId ? 1 : 0);
+      e->resize(numV);
+    }
+    numIds = ids.size();
+  }
+  if (_edgesHaveId) {
+    e->setId(ids[0]);
+    ids.erase(ids.begin());
+  }
+
+  if (numV == 2) { // it's a pairwise / binary edge type which we handle in a special way
+    int id1 = ids[0];
+    int id2 = ids[1];
+    OptimizableGraph::Vertex* from = _graph.vertex(id1);
+    OptimizableGraph::Vertex* to = _graph.vertex(id2);
+    int doInit = 0;
+
+    if (_createEdges) {
+      if (! from && id1 >= 0) {
+        from = e->createVertex(0);
+        from->setId(id1);
+        _graph.addVertex(from);
+        doInit = 2;
+      }
+      if (! to && id2 >= 0) {
+        to = e->createVertex(1);
+        to->setId(id2);
+        _graph.addVertex(to);
+        doInit = 1;
+      }
+      if (id1 < 0 || id2 < 0)
+        doInit = 0;
+    } else if ((! from && id1 >= 0) || (! to && id2 >= 0)) {
+      cerr << __PRETTY_FUNCTION__ << ": Unable to find vertex for edge " << type->tag << " " << id1 << " <-> " << id2 << endl;
+      delete e;
+      e = 0;
+    }
+    if (e) {
+      e->setVertex(0, from);
+      e->setVertex(1, to);
+      readEdgeData(type, e, line, numbers, numIds);
+      if (! _graph.addEdge(e)) {
+        cerr << __PRETTY_FUNCTION__ << ": Unable to add edge " << type->tag << " " << id1 << " <-> " << id2 << endl;
+        delete e;
+      } else {
+        switch (doInit) {
+          case 1:
+            {
+              HyperGraph::VertexSet fromSet;
+              fromSet.insert(from);
+              e->initialEstimate(fromSet, to);
+              break;
+            }
+          case 2:
+            {
+              HyperGraph::VertexSet toSet;
+              toSet.insert(to);
+              e->initialEstimate(toSet, from);
+              break;
+            }
+          default:;
+        }
+      }
+    }
+  }
+  else { // numV != 2
+    bool vertsOkay = true;
+    for (int l = 0; l < numV; ++l) {
+      int vertexId = ids[l];
+      HyperGraph::Vertex* v = 0;
+      if (vertexId != HyperGraph::UnassignedId) {
+        v = _graph.vertex(vertexId);
+        e->setVertex(l, v);
+        if (! v) {
+          vertsOkay = false;
+          break;
+        }
+      }
+    }
+    if (! vertsOkay) {
+      cerr << __PRETTY_FUNCTION__ << ": Unable to find vertices for edge " << type->tag;
+      for (int l = 0; l < numV; ++l) {
+        if (l > 0)
+          cerr << " <->";
+        cerr << " " << ids[l];
+      }
+      delete e;
+    } else {
+      bool r = readEdgeData(type, e, line, numbers, numIds);
+      if (! r || ! _graph.addEdge(e)) {
+        cerr << __PRETTY_FUNCTION__ << ": Unable to add edge " << type->tag;
+        for (int l = 0; l < numV; ++l) {
+          if (l > 0)
+            cerr << " <->";
+          cerr << " " << ids[l];
+        }
+        delete e;
+        e = 0;
+      }
+    }
+  }
+  _previousDataContainer = e;
+}
+
+bool GraphTextReader::readEdgeData(TypeInfo* type, OptimizableGraph::Edge* e, const Line& line, const double* numbers, int numIds)
+{
+  // the ids have been read from the line stream, which is positioned at the data
+  if (! numbers)
+    return e->read(_lineStream);
+
+  if (type->fillFromNumbers && fillEdge(e, numbers + numIds, line.numNumbers - numIds))
+    return true;
+  return e->read(lineStream(line, numIds));
+}
+
+bool GraphTextReader::fillEdge(OptimizableGraph::Edge* e, const double* data, int numData)
+{
+  // the text holds the measurement followed by the upper triangle of the information matrix, row by row
+  int dim = e->measurementDimension();
+  int infoDim = e->dimension();
+  number_t* information = e->informationData();
+  if (e->numParameters() > 0 || dim <= 0 || infoDim <= 0 || ! information || numData != dim + infoDim * (infoDim + 1) / 2)
+    return false;
+  if (! e->setMeasurementData(toNumbers(data, dim, _buffer)))
+    return false;
+  const double* upper = data + dim;
+  for (int r = 0; r < infoDim; ++r)
+    for (int c = r; c < infoDim; ++c, ++upper)
+      information[r * infoDim + c] = information[c * infoDim + r] = static_cast<number_t>(*upper);
+  return true;
+}
+
+void GraphTextReader::readData(TypeInfo* type, const Line& line)
+{
+  HyperGraph::Data* d = static_cast<HyperGraph::Data*>(type->creator->construct());
+  bool r = d->read(lineStream(line));
+  if (! r) {
+    cerr << __PRETTY_FUNCTION__ << ": Error reading data " << type->tag << " at line " << _lineNumber + line.lineNumber << endl;
+    delete d;
+    _previousData = 0;
+  } else if (_previousData) {
+    _previousData->setNext(d);
+    d->setDataContainer(_previousData->dataContainer());
+    _previousData = d;
+  } else if (_previousDataContainer) {
+    _previousDataContainer->setUserData(d);
+    d->setDataContainer(_previousDataContainer);
+    _previousData = d;
+    _previousDataContainer = 0;
+  } else {
+    cerr << __PRETTY_FUNCTION__ << ": got data element, but no data container available" << endl;
+    delete d;
+    _previousData = 0;
+  }
+}
+
+GraphTextWriter::GraphTextWriter(const OptimizableGraph& graph, std::ostream& os) :
+  _graph(graph), _os(os)
+{
+}
+
+bool GraphTextWriter::writeParameters(const ParameterContainer& parameters)
+{
+  return parameters.write(_os);
+}
+
+bool GraphTextWriter::writeVertices(const OptimizableGraph::VertexContainer& vertices)
+{
+  return writeElements(vertices);
+}
+
+bool GraphTextWriter::writeEdges(const OptimizableGraph::EdgeContainer& edges)
+{
+  return writeElements(edges);
+}
+
+namespace {
+  inline void saveElement(const OptimizableGraph& graph, std::ostream& os, OptimizableGraph::Vertex* v) { graph.saveVertex(os, v);}
+  inline void saveElement(const OptimizableGraph& graph, std::ostream& os, OptimizableGraph::Edge* e) { graph.saveEdge(os, e);}
+}
+
+template <typename T>
+bool GraphTextWriter::writeElements(const std::vector<T*>& elements)
+{
+  int numChunks = static_cast<int>((elements.size() + chunkElements - 1) / chunkElements);
+  int chunksPerBlock = 1;
+# ifdef G2O_OPENMP
+  chunksPerBlock = 4 * omp_get_max_threads();
+# endif
+
+  // the chunks of one block are formatted in parallel and written in order
+  std::vector<std::string> text(chunksPerBlock);
+  for (int first = 0; first < numChunks && _os.good(); first += chunksPerBlock) {
+    int n = std::min(chunksPerBlock, numChunks - first);
+#   ifdef G2O_OPENMP
+#   pragma omp parallel for default (shared) schedule(dynamic) if (n > 1)
+#   endif
+    for (int c = 0; c < n; ++c) {
+      std::ostringstream os;
+      os.imbue(_os.getloc());
+      os.flags(_os.flags());
+      os.precision(_os.precision());
+      size_t begin = static_cast<size_t>(first + c) * chunkElements;
+      size_t end = std::min(begin + chunkElements, elements.size());
+      for (size_t i = begin; i < end; ++i)
+        saveElement(_graph, os, elements[i]);
+      text[c] = os.str();
+    }
+    for (int c = 0; c < n; ++c)
+      _os.write(text[c].data(), text[c].size());
+  }
+  return _os.good();
+}
+
+} // end namespace
@@ -0,0 +1,174 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_GRAPH_TEXT_IO_H
+#define G2O_GRAPH_TEXT_IO_H
+
+#include <iosfwd>
+#include <istream>
+#include <map>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "optimizable_graph.h"
+#include "g2o_core_api.h"
+
+namespace g2o {
+
+  class AbstractHyperGraphElementCreator;
+
+  /**
+   * \brief parallel reader for the text graph format (.g2o)
+   *
+   * The stream is read in blocks which are split into newline aligned
+   * chunks. The chunks of a block are tokenized in parallel and the
+   * numbers of each line are parsed into a buffer of the chunk.
+   * Afterwards, the lines are committed to the graph one by one in the
+   * order of the file. Hence, the graph is the same as the one obtained
+   * by parsing the file line by line: parameters, vertices, and edges are
+   * inserted in the order of the file, FIX commands refer to the vertices
+   * read so far, and data elements are attached to the preceding vertex
+   * or edge.
+   *
+   * A type is filled from the parsed numbers via setEstimateData() or
+   * setMeasurementData() and the information matrix, if it opts in by
+   * plainDataFormat(). All other lines are passed to read() of the element.
+   */
+  class G2O_CORE_API GraphTextReader
+  {
+    public:
+      //! bytes per chunk, a chunk is extended to the end of its last line
+      static const size_t chunkSize = 1 << 18;
+
+      explicit GraphTextReader(OptimizableGraph& graph, const std::map<std::string, std::string>* renamedTypes = 0, bool edgesHaveId = false);
+
+      bool read(std::istream& is, bool createEdges = true);
+
+    protected:
+      struct Line {
+        int lineNumber;        ///< line number within the chunk
+        const char* tag;
+        int tagLength;
+        const char* rest;      ///< the text following the tag
+        const char* end;
+        int numbersBegin;      ///< index of the first number in the numbers of the chunk
+        int numNumbers;        ///< -1, if the line holds a token which is not a number
+      };
+
+      struct Chunk {
+        const char* begin;
+        const char* end;
+        int numLines;
+        std::vector<Line> lines;
+        std::vector<double> numbers;
+      };
+
+      struct TypeInfo {
+        std::string fileTag;   ///< the tag as it appears in the file
+        std::string tag;       ///< the tag after renaming
+        int elementType;       ///< -1 for unknown types
+        AbstractHyperGraphElementCreator* creator;
+        bool fillFromNumbers;  ///< fill the elements from the numbers, see plainDataFormat()
+      };
+
+      //! read only stream buffer on top of one line
+      class LineBuffer : public std::streambuf
+      {
+        public:
+          void set(const char* begin, const char* end)
+          {
+            setg(const_cast<char*>(begin), const_cast<char*>(begin), const_cast<char*>(end));
+          }
+      };
+
+      static void tokenize(Chunk& chunk);
+      void commit(const Chunk& chunk);
+      TypeInfo* typeInfo(const char* tag, int length);
+      //! stream over the text of the line after skipping the given number of tokens
+      std::istream& lineStream(const Line& line, int skipTokens = 0);
+
+      void readFix(const Line& line, const double* numbers);
+      void readParameter(TypeInfo* type, const Line& line);
+      void readVertex(TypeInfo* type, const Line& line, const double* numbers);
+      void readEdge(TypeInfo* type, const Line& line, const double* numbers);
+      void readData(TypeInfo* type, const Line& line);
+      /**
+       * fill the edge from the numbers following its ids or pass the text to
+       * read(). Without numbers the line stream has to be positioned after
+       * the ids.
+       */
+      bool readEdgeData(TypeInfo* type, OptimizableGraph::Edge* e, const Line& line, const double* numbers, int numIds);
+      bool fillEdge(OptimizableGraph::Edge* e, const double* data, int numData);
+
+      OptimizableGraph& _graph;
+      const std::map<std::string, std::string>* _renamedTypes;
+      bool _edgesHaveId;
+      bool _createEdges;
+      int _lineNumber;       ///< number of lines of the previous chunks
+
+      std::map<std::string, TypeInfo> _types;
+      TypeInfo* _lastType;
+
+      HyperGraph::DataContainer* _previousDataContainer;
+      HyperGraph::Data* _previousData;
+
+      LineBuffer _lineBuffer;
+      std::istream _lineStream;
+      std::vector<number_t> _buffer;
+  };
+
+  /**
+   * \brief parallel writer for the text graph format (.g2o)
+   *
+   * Chunks of consecutive vertices or edges are formatted in parallel by
+   * OptimizableGraph::saveVertex() and OptimizableGraph::saveEdge() and
+   * written in order, such that the output is the same as saving the
+   * elements one by one.
+   */
+  class G2O_CORE_API GraphTextWriter
+  {
+    public:
+      //! elements per chunk
+      static const int chunkElements = 1024;
+
+      GraphTextWriter(const OptimizableGraph& graph, std::ostream& os);
+
+      bool writeParameters(const ParameterContainer& parameters);
+      bool writeVertices(const OptimizableGraph::VertexContainer& vertices);
+      bool writeEdges(const OptimizableGraph::EdgeContainer& edges);
+
+    protected:
+      template <typename T>
+      bool writeElements(const std::vector<T*>& elements);
+
+      const OptimizableGraph& _graph;
+      std::ostream& _os;
+  };
+
+} // end namespace
+
+#endif
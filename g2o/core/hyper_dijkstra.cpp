@@ -58,88 +58,110 @@ namespace g2o{
     _distance=distance_;
   }
 
-  HyperDijkstra::HyperDijkstra(HyperGraph* g): _graph(g)
+  HyperDijkstra::HyperDijkstra(HyperGraph* g): _adjacencyMapValid(false), _visitedValid(false), _graph(g)
   {
-    for (HyperGraph::VertexIDMap::const_iterator it=_graph->vertices().begin(); it!=_graph->vertices().end(); it++){
-      AdjacencyMapEntry entry(it->second, 0,0,std::numeric_limits< number_t >::max());
-      _adjacencyMap.insert(make_pair(entry.child(), entry));
-    }
+    _snapshot.build(*_graph);
+    reset();
   }
 
   void HyperDijkstra::reset()
   {
-    for (HyperGraph::VertexSet::iterator it=_visited.begin(); it!=_visited.end(); it++){
-      AdjacencyMap::iterator at=_adjacencyMap.find(*it);
-      assert(at!=_adjacencyMap.end());
-      at->second=AdjacencyMapEntry(at->first,0,0,std::numeric_limits< number_t >::max());
+    int n = _snapshot.numVertices();
+    if (static_cast<int>(_distances.size()) != n) {
+      _distances.assign(n, std::numeric_limits< number_t >::max());
+      _parents.assign(n, -1);
+      _parentEdges.assign(n, -1);
+      _isVisited.assign(n, 0);
+    } else {
+      // only the visited vertices have been modified by the last search
+      for (size_t k = 0; k < _visitedIndices.size(); ++k) {
+        int i = _visitedIndices[k];
+        _distances[i] = std::numeric_limits< number_t >::max();
+        _parents[i] = -1;
+        _parentEdges[i] = -1;
+        _isVisited[i] = 0;
+      }
     }
-    _visited.clear();
+    _visitedIndices.clear();
+    _frontier.reset(n);
+    _adjacencyMapValid = false;
+    _visitedValid = false;
   }
 
-
-  bool operator<(const HyperDijkstra::AdjacencyMapEntry& a, const HyperDijkstra::AdjacencyMapEntry& b)
+  HyperGraph::VertexSet& HyperDijkstra::visited()
   {
-    return a.distance()>b.distance();
+    if (! _visitedValid) {
+      _visited.clear();
+      for (size_t k = 0; k < _visitedIndices.size(); ++k)
+        _visited.insert(_snapshot.vertex(_visitedIndices[k]));
+      _visitedValid = true;
+    }
+    return _visited;
   }
 
+  HyperDijkstra::AdjacencyMap& HyperDijkstra::adjacencyMap()
+  {
+    if (! _adjacencyMapValid) {
+      _adjacencyMap.clear();
+      for (int i = 0; i < _snapshot.numVertices(); ++i) {
+        AdjacencyMapEntry entry(_snapshot.vertex(i),
+            _parents[i] >= 0 ? _snapshot.vertex(_parents[i]) : 0,
+            _parentEdges[i] >= 0 ? _snapshot.edge(_parentEdges[i]) : 0,
+            _distances[i]);
+        _adjacencyMap.insert(make_pair(entry.child(), entry));
+      }
+      _adjacencyMapValid = true;
+    }
+    return _adjacencyMap;
+  }
 
   void HyperDijkstra::shortestPaths(HyperGraph::VertexSet& vset, HyperDijkstra::CostFunction* cost, 
       number_t maxDistance, number_t comparisonConditioner, bool directed, number_t maxEdgeCost)
   {
     reset();
-    std::priority_queue< AdjacencyMapEntry > frontier;
     for (HyperGraph::VertexSet::iterator vit=vset.begin(); vit!=vset.end(); ++vit){
       HyperGraph::Vertex* v=*vit;
       assert(v!=0);
-      AdjacencyMap::iterator it=_adjacencyMap.find(v);
-      if (it == _adjacencyMap.end()) {
+      int i=_snapshot.index(v);
+      if (i < 0) {
         cerr << __PRETTY_FUNCTION__ << "Vertex " << v->id() << " is not in the adjacency map" << endl;
+        continue;
       }
-      assert(it!=_adjacencyMap.end());
-      it->second._distance=0.;
-      it->second._parent=0;
-      frontier.push(it->second);
+      _distances[i]=0.;
+      _parents[i]=-1;
+      _frontier.push(i, 0.);
     }
 
-    while(! frontier.empty()){
-      AdjacencyMapEntry entry=frontier.top();
-      frontier.pop();
-      HyperGraph::Vertex* u=entry.child();
-      AdjacencyMap::iterator ut=_adjacencyMap.find(u);
-      if (ut == _adjacencyMap.end()) {
-        cerr << __PRETTY_FUNCTION__ << "Vertex " << u->id() << " is not in the adjacency map" << endl;
-      }
-      assert(ut!=_adjacencyMap.end());
-      number_t uDistance=ut->second.distance();
+    while(! _frontier.empty()){
+      int u=_frontier.pop();
+      HyperGraph::Vertex* uVertex=_snapshot.vertex(u);
+      number_t uDistance=_distances[u];
 
-      std::pair< HyperGraph::VertexSet::iterator, bool> insertResult=_visited.insert(u); (void) insertResult;
-      HyperGraph::EdgeSet::iterator et=u->edges().begin();
-      while (et != u->edges().end()){
-        HyperGraph::Edge* edge=*et;
-        ++et;
+      if (! _isVisited[u]) {
+        _isVisited[u]=1;
+        _visitedIndices.push_back(u);
+      }
+      for (const int* et=_snapshot.edgesBegin(u); et!=_snapshot.edgesEnd(u); ++et){
+        HyperGraph::Edge* edge=_snapshot.edge(*et);
 
-        if (directed && edge->vertex(0) != u)
+        if (directed && edge->vertex(0) != uVertex)
           continue;
 
-        for (size_t i = 0; i < edge->vertices().size(); ++i) {
-          HyperGraph::Vertex* z = edge->vertex(i);
-          if (z == u)
+        for (const int* zt=_snapshot.verticesBegin(*et); zt!=_snapshot.verticesEnd(*et); ++zt) {
+          int z=*zt;
+          if (z < 0 || z == u)
             continue;
 
-          number_t edgeDistance=(*cost)(edge, u, z);
+          number_t edgeDistance=(*cost)(edge, uVertex, _snapshot.vertex(z));
           if (edgeDistance==std::numeric_limits< number_t >::max() || edgeDistance > maxEdgeCost)
             continue;
           number_t zDistance=uDistance+edgeDistance;
-          //cerr << z->id() << " " << zDistance << endl;
 
-          AdjacencyMap::iterator ot=_adjacencyMap.find(z);
-          assert(ot!=_adjacencyMap.end());
-
-          if (zDistance+comparisonConditioner<ot->second.distance() && zDistance<maxDistance){
-            ot->second._distance=zDistance;
-            ot->second._parent=u;
-            ot->second._edge=edge;
-            frontier.push(ot->second);
+          if (zDistance+comparisonConditioner<_distances[z] && zDistance<maxDistance){
+            _distances[z]=zDistance;
+            _parents[z]=u;
+            _parentEdges[z]=*et;
+            _frontier.push(z, zDistance);
           }
         }
       }
@@ -154,6 +176,48 @@ namespace g2o{
     shortestPaths(vset, cost, maxDistance, comparisonConditioner, directed, maxEdgeCost);
   }
 
+  void HyperDijkstra::visitTree(TreeAction* action, bool useDistance)
+  {
+    // the children of each vertex in compressed sparse row format
+    int n=_snapshot.numVertices();
+    std::vector<int> childOffsets(n + 1, 0);
+    for (int i = 0; i < n; ++i)
+      if (_parents[i] >= 0)
+        ++childOffsets[_parents[i] + 1];
+    for (int i = 0; i < n; ++i)
+      childOffsets[i + 1] += childOffsets[i];
+    std::vector<int> children(childOffsets[n]);
+    std::vector<int> nextChild(childOffsets.begin(), childOffsets.end() - 1);
+    for (int i = 0; i < n; ++i)
+      if (_parents[i] >= 0)
+        children[nextChild[_parents[i]]++] = i;
+
+    // the vertices without the parent are the roots of the trees
+    std::vector<int> queue;
+    queue.reserve(n);
+    for (int i = 0; i < n; ++i) {
+      if (_parents[i] < 0) {
+        action->perform(_snapshot.vertex(i), 0, 0);
+        queue.push_back(i);
+      }
+    }
+
+    for (size_t head = 0; head < queue.size(); ++head) {
+      int parent = queue[head];
+      HyperGraph::Vertex* parentVertex = _snapshot.vertex(parent);
+      for (int k = childOffsets[parent]; k < childOffsets[parent + 1]; ++k) {
+        int child = children[k];
+        HyperGraph::Edge* edge = _snapshot.edge(_parentEdges[child]);
+        if (! useDistance) {
+          action->perform(_snapshot.vertex(child), parentVertex, edge);
+        } else {
+          action->perform(_snapshot.vertex(child), parentVertex, edge, _distances[child]);
+        }
+        queue.push_back(child);
+      }
+    }
+  }
+
   void HyperDijkstra::computeTree(AdjacencyMap& amap)
   {
     for (AdjacencyMap::iterator it=amap.begin(); it!=amap.end(); ++it){
@@ -241,13 +305,14 @@ namespace g2o{
       HyperGraph::Vertex* v0=frontier.front();
       frontier.pop();
       dv.shortestPaths(v0, cost, distance, comparisonConditioner, false, maxEdgeCost);
-      for (HyperGraph::VertexSet::iterator it=dv.visited().begin(); it!=dv.visited().end(); ++it){
-        visited.insert(*it);
-        if (startingSet.find(*it)==startingSet.end())
+      for (size_t k=0; k<dv.visitedIndices().size(); ++k){
+        HyperGraph::Vertex* u=dv.snapshot().vertex(dv.visitedIndices()[k]);
+        visited.insert(u);
+        if (startingSet.find(u)==startingSet.end())
           continue;
-        std::pair<HyperGraph::VertexSet::iterator, bool> insertOutcome=connected.insert(*it);
+        std::pair<HyperGraph::VertexSet::iterator, bool> insertOutcome=connected.insert(u);
         if (insertOutcome.second){ // the node was not in the connectedSet;
-          frontier.push(dynamic_cast<HyperGraph::Vertex*>(*it));
+          frontier.push(u);
         }
       }
     }
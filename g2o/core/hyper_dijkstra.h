@@ -30,8 +30,10 @@
 #include <map>
 #include <set>
 #include <limits>
+#include <vector>
 
 #include "hyper_graph.h"
+#include "hyper_graph_snapshot.h"
 
 namespace g2o{
 
@@ -68,11 +70,28 @@ namespace g2o{
     };
 
     typedef std::map<HyperGraph::Vertex*, AdjacencyMapEntry> AdjacencyMap;
+    /**
+     * takes a snapshot of the vertices and edges of the graph, the searches
+     * run on the snapshot and do not follow later changes of the graph
+     */
     HyperDijkstra(HyperGraph* g);
-    HyperGraph::VertexSet& visited() {return _visited; }
-    AdjacencyMap& adjacencyMap() {return _adjacencyMap; }
+    //! the vertices visited by the last search, assembled on demand from visitedIndices()
+    HyperGraph::VertexSet& visited();
+    //! the result of the last search for all vertices, assembled on demand
+    AdjacencyMap& adjacencyMap();
     HyperGraph* graph() {return _graph;} 
 
+    const HyperGraphSnapshot& snapshot() const {return _snapshot;}
+    //! the indices in the snapshot of the vertices visited by the last search in the order of their visit
+    const std::vector<int>& visitedIndices() const {return _visitedIndices;}
+    int numVisited() const {return static_cast<int>(_visitedIndices.size());}
+    //! distance of the vertex with index i in the snapshot
+    number_t distance(int i) const {return _distances[i];}
+    //! index of the parent of vertex i in the snapshot, -1 for roots and unreached vertices
+    int parent(int i) const {return _parents[i];}
+    //! index of the edge connecting vertex i to its parent, -1 if there is no parent
+    int parentEdge(int i) const {return _parentEdges[i];}
+
     void shortestPaths(HyperGraph::Vertex* v, 
            HyperDijkstra::CostFunction* cost, 
            number_t maxDistance=std::numeric_limits< number_t >::max(), 
@@ -88,6 +107,14 @@ namespace g2o{
            number_t maxEdgeCost=std::numeric_limits< number_t >::max());
 
 
+    /**
+     * apply the action to the spanning tree of the last search in breadth
+     * first order, starting with the vertices without a parent. Same as
+     * computeTree() followed by visitAdjacencyMap() on adjacencyMap(), but
+     * runs on the snapshot.
+     */
+    void visitTree(TreeAction* action, bool useDistance=false);
+
     static void computeTree(AdjacencyMap& amap);
     static void visitAdjacencyMap(AdjacencyMap& amap, TreeAction* action, bool useDistance=false);
     static void connectedSubset(HyperGraph::VertexSet& connected, HyperGraph::VertexSet& visited, 
@@ -100,8 +127,18 @@ namespace g2o{
     void reset();
 
     AdjacencyMap _adjacencyMap;
+    bool _adjacencyMapValid;
     HyperGraph::VertexSet _visited;
+    bool _visitedValid;
     HyperGraph* _graph;
+
+    HyperGraphSnapshot _snapshot;
+    IndexedHeap _frontier;
+    std::vector<number_t> _distances;
+    std::vector<int> _parents;
+    std::vector<int> _parentEdges;
+    std::vector<int> _visitedIndices;
+    std::vector<char> _isVisited;
   };
 
   struct G2O_CORE_API UniformCostFunction: public HyperDijkstra::CostFunction {
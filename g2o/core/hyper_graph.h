@@ -37,7 +37,9 @@
 
 #include <unordered_map>
 
+#include "g2o/config.h"
 #include "g2o_core_api.h"
+#include "compact_containers.h"
 
 /** @addtogroup graph */
 //@{
@@ -132,10 +134,18 @@ namespace g2o {
       };
 
 
+#ifdef G2O_COMPACT_HYPERGRAPH
+      typedef CompactPointerSet<Edge>                   EdgeSet;
+#else
       typedef std::set<Edge*>                           EdgeSet;
+#endif
       typedef std::set<Vertex*>                         VertexSet;
 
+#ifdef G2O_COMPACT_HYPERGRAPH
+      typedef CompactIdMap<Vertex>                      VertexIDMap;
+#else
       typedef std::unordered_map<int, Vertex*>     VertexIDMap;
+#endif
       typedef std::vector<Vertex*>                      VertexContainer;
 
       //! abstract Vertex, your types must derive from that one
@@ -0,0 +1,242 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "hyper_graph_snapshot.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace g2o {
+
+namespace {
+  struct VertexIdCompare {
+    bool operator()(const HyperGraph::Vertex* v1, const HyperGraph::Vertex* v2) const
+    {
+      return v1->id() < v2->id();
+    }
+  };
+}
+
+void HyperGraphSnapshot::PointerIndex::reset(size_t n)
+{
+  size_t capacity = 16;
+  while (capacity < 2 * n)
+    capacity <<= 1;
+  _keys.assign(capacity, 0);
+  _indices.assign(capacity, -1);
+}
+
+size_t HyperGraphSnapshot::PointerIndex::bucket(const void* key) const
+{
+  uint64_t h = reinterpret_cast<uintptr_t>(key);
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return static_cast<size_t>(h) & (_keys.size() - 1);
+}
+
+int HyperGraphSnapshot::PointerIndex::find(const void* key) const
+{
+  if (_keys.empty())
+    return -1;
+  for (size_t b = bucket(key); _keys[b]; b = (b + 1) & (_keys.size() - 1)) {
+    if (_keys[b] == key)
+      return _indices[b];
+  }
+  return -1;
+}
+
+int HyperGraphSnapshot::PointerIndex::insert(const void* key, int index)
+{
+  size_t b = bucket(key);
+  for (; _keys[b]; b = (b + 1) & (_keys.size() - 1)) {
+    if (_keys[b] == key)
+      return _indices[b];
+  }
+  _keys[b] = key;
+  _indices[b] = index;
+  return index;
+}
+
+HyperGraphSnapshot::HyperGraphSnapshot()
+{
+  clear();
+}
+
+void HyperGraphSnapshot::clear()
+{
+  _vertices.clear();
+  _edges.clear();
+  _vertexIndex.reset(0);
+  _edgeIndex.reset(0);
+  _vertexEdgeOffsets.assign(1, 0);
+  _vertexEdges.clear();
+  _edgeVertexOffsets.assign(1, 0);
+  _edgeVertices.clear();
+}
+
+void HyperGraphSnapshot::build(const HyperGraph& graph)
+{
+  clear();
+  _vertices.reserve(graph.vertices().size());
+  for (HyperGraph::VertexIDMap::const_iterator it = graph.vertices().begin(); it != graph.vertices().end(); ++it)
+    _vertices.push_back(it->second);
+  std::sort(_vertices.begin(), _vertices.end(), VertexIdCompare());
+  _vertexIndex.reset(_vertices.size());
+  for (size_t i = 0; i < _vertices.size(); ++i)
+    _vertexIndex.insert(_vertices[i], static_cast<int>(i));
+
+  _edges.assign(graph.edges().begin(), graph.edges().end());
+  buildAdjacency();
+}
+
+void HyperGraphSnapshot::buildFromEdges(const std::vector<HyperGraph::Edge*>& edges)
+{
+  clear();
+  _edges = edges;
+  size_t numIncidences = 0;
+  for (size_t i = 0; i < _edges.size(); ++i)
+    numIncidences += _edges[i]->vertices().size();
+  _vertexIndex.reset(numIncidences);
+  for (size_t i = 0; i < _edges.size(); ++i) {
+    const std::vector<HyperGraph::Vertex*>& vertices = _edges[i]->vertices();
+    for (size_t j = 0; j < vertices.size(); ++j) {
+      int nextIndex = static_cast<int>(_vertices.size());
+      if (vertices[j] && _vertexIndex.insert(vertices[j], nextIndex) == nextIndex)
+        _vertices.push_back(vertices[j]);
+    }
+  }
+  buildAdjacency();
+}
+
+void HyperGraphSnapshot::buildAdjacency()
+{
+  _edgeIndex.reset(_edges.size());
+  _edgeVertexOffsets.resize(_edges.size() + 1);
+  for (size_t i = 0; i < _edges.size(); ++i) {
+    _edgeIndex.insert(_edges[i], static_cast<int>(i));
+    const std::vector<HyperGraph::Vertex*>& vertices = _edges[i]->vertices();
+    for (size_t j = 0; j < vertices.size(); ++j)
+      _edgeVertices.push_back(vertices[j] ? _vertexIndex.find(vertices[j]) : -1);
+    _edgeVertexOffsets[i + 1] = static_cast<int>(_edgeVertices.size());
+  }
+
+  // the edges of a vertex are kept in the order of Vertex::edges()
+  _vertexEdgeOffsets.resize(_vertices.size() + 1);
+  for (size_t i = 0; i < _vertices.size(); ++i) {
+    const HyperGraph::EdgeSet& edges = _vertices[i]->edges();
+    for (HyperGraph::EdgeSet::const_iterator it = edges.begin(); it != edges.end(); ++it) {
+      int e = _edgeIndex.find(*it);
+      if (e >= 0)
+        _vertexEdges.push_back(e);
+    }
+    _vertexEdgeOffsets[i + 1] = static_cast<int>(_vertexEdges.size());
+  }
+}
+
+IndexedHeap::IndexedHeap() :
+  _sequence(0)
+{
+}
+
+void IndexedHeap::reset(int n)
+{
+  if (static_cast<int>(_position.size()) != n) {
+    _position.assign(n, -1);
+  } else {
+    for (size_t i = 0; i < _nodes.size(); ++i)
+      _position[_nodes[i].index] = -1;
+  }
+  _nodes.clear();
+  _sequence = 0;
+}
+
+void IndexedHeap::push(int i, number_t key)
+{
+  Node node;
+  node.key = key;
+  node.sequence = _sequence++;
+  node.index = i;
+  int pos = _position[i];
+  if (pos >= 0) {
+    place(pos, node);
+    siftUp(pos);
+    siftDown(_position[i]);
+  } else {
+    _nodes.push_back(node);
+    _position[i] = static_cast<int>(_nodes.size()) - 1;
+    siftUp(_nodes.size() - 1);
+  }
+}
+
+int IndexedHeap::pop()
+{
+  int top = _nodes.front().index;
+  _position[top] = -1;
+  Node last = _nodes.back();
+  _nodes.pop_back();
+  if (! _nodes.empty()) {
+    place(0, last);
+    siftDown(0);
+  }
+  return top;
+}
+
+void IndexedHeap::siftUp(size_t pos)
+{
+  Node node = _nodes[pos];
+  while (pos > 0) {
+    size_t parent = (pos - 1) / Arity;
+    if (! less(node, _nodes[parent]))
+      break;
+    place(pos, _nodes[parent]);
+    pos = parent;
+  }
+  place(pos, node);
+}
+
+void IndexedHeap::siftDown(size_t pos)
+{
+  Node node = _nodes[pos];
+  size_t n = _nodes.size();
+  while (1) {
+    size_t first = pos * Arity + 1;
+    if (first >= n)
+      break;
+    size_t best = first;
+    size_t last = std::min(first + Arity, n);
+    for (size_t c = first + 1; c < last; ++c)
+      if (less(_nodes[c], _nodes[best]))
+        best = c;
+    if (! less(_nodes[best], node))
+      break;
+    place(pos, _nodes[best]);
+    pos = best;
+  }
+  place(pos, node);
+}
+
+} // end namespace
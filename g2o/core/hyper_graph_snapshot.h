@@ -0,0 +1,170 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_HYPER_GRAPH_SNAPSHOT_H
+#define G2O_HYPER_GRAPH_SNAPSHOT_H
+
+#include <cstddef>
+#include <vector>
+
+#include "hyper_graph.h"
+#include "g2o_core_api.h"
+
+namespace g2o {
+
+  /**
+   * \brief immutable adjacency of a hyper graph in compressed sparse row format
+   *
+   * The vertices and the edges are numbered densely. For each vertex the
+   * indices of its edges are stored consecutively in the order of
+   * Vertex::edges(), for each edge the indices of its vertices. A vertex of
+   * an edge which is not part of the snapshot has the index -1. Traversals
+   * run on the indices and avoid the lookups in the node based containers
+   * of the HyperGraph. The snapshot does not follow later changes of the
+   * graph.
+   */
+  class G2O_CORE_API HyperGraphSnapshot
+  {
+    public:
+      HyperGraphSnapshot();
+
+      //! all vertices of the graph and their edges within the graph, the vertices are numbered in the order of their ids
+      void build(const HyperGraph& graph);
+
+      /**
+       * the given edges and their vertices, the vertices are numbered in the
+       * order of their first appearance
+       */
+      template <typename EdgeIterator>
+      void build(EdgeIterator begin, EdgeIterator end)
+      {
+        std::vector<HyperGraph::Edge*> edges(begin, end);
+        buildFromEdges(edges);
+      }
+
+      void clear();
+
+      int numVertices() const { return static_cast<int>(_vertices.size());}
+      int numEdges() const { return static_cast<int>(_edges.size());}
+      HyperGraph::Vertex* vertex(int i) const { return _vertices[i];}
+      HyperGraph::Edge* edge(int i) const { return _edges[i];}
+
+      //! index of the vertex, -1 if it is not part of the snapshot
+      int index(const HyperGraph::Vertex* v) const { return _vertexIndex.find(v);}
+      //! index of the edge, -1 if it is not part of the snapshot
+      int index(const HyperGraph::Edge* e) const { return _edgeIndex.find(e);}
+
+      //! the edges of vertex i
+      const int* edgesBegin(int i) const { return _vertexEdges.data() + _vertexEdgeOffsets[i];}
+      const int* edgesEnd(int i) const { return _vertexEdges.data() + _vertexEdgeOffsets[i + 1];}
+      //! the vertices of edge i
+      const int* verticesBegin(int i) const { return _edgeVertices.data() + _edgeVertexOffsets[i];}
+      const int* verticesEnd(int i) const { return _edgeVertices.data() + _edgeVertexOffsets[i + 1];}
+
+    protected:
+      /**
+       * \brief open addressing hash map from a pointer to an index
+       */
+      class PointerIndex
+      {
+        public:
+          //! prepare the table for n keys, removes all keys
+          void reset(size_t n);
+          //! the index of the key, -1 if not present
+          int find(const void* key) const;
+          //! insert the key if it is not present yet, returns the index stored for the key
+          int insert(const void* key, int index);
+        protected:
+          size_t bucket(const void* key) const;
+          std::vector<const void*> _keys;
+          std::vector<int> _indices;
+      };
+
+      void buildFromEdges(const std::vector<HyperGraph::Edge*>& edges);
+      //! number the edges and build the vertices of the edges and the edges of the vertices
+      void buildAdjacency();
+
+      std::vector<HyperGraph::Vertex*> _vertices;
+      std::vector<HyperGraph::Edge*> _edges;
+      PointerIndex _vertexIndex;
+      PointerIndex _edgeIndex;
+      std::vector<int> _vertexEdgeOffsets;
+      std::vector<int> _vertexEdges;
+      std::vector<int> _edgeVertexOffsets;
+      std::vector<int> _edgeVertices;
+  };
+
+  /**
+   * \brief d-ary min heap on the indices 0..n-1 each having a key
+   *
+   * Pushing an index which is already in the heap updates its key. Indices
+   * with the same key are popped in the order of their last push.
+   */
+  class G2O_CORE_API IndexedHeap
+  {
+    public:
+      static const int Arity = 4;
+
+      IndexedHeap();
+
+      //! indices 0..n-1 may be pushed, removes all indices
+      void reset(int n);
+      bool empty() const { return _nodes.empty();}
+      size_t size() const { return _nodes.size();}
+      bool contains(int i) const { return _position[i] >= 0;}
+
+      //! insert the index or update its key
+      void push(int i, number_t key);
+      //! remove the index with the smallest key and return it
+      int pop();
+
+    protected:
+      struct Node {
+        number_t key;
+        size_t sequence;
+        int index;
+      };
+
+      static bool less(const Node& a, const Node& b)
+      {
+        return a.key < b.key || (a.key == b.key && a.sequence < b.sequence);
+      }
+      void place(size_t pos, const Node& node)
+      {
+        _nodes[pos] = node;
+        _position[node.index] = static_cast<int>(pos);
+      }
+      void siftUp(size_t pos);
+      void siftDown(size_t pos);
+
+      std::vector<Node> _nodes;
+      std::vector<int> _position;
+      size_t _sequence;
+  };
+
+} // end namespace
+
+#endif
@@ -0,0 +1,460 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "incremental_cholesky.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <queue>
+
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+
+using namespace std;
+
+namespace g2o {
+
+  IncrementalCholesky::IncrementalCholesky() :
+    _nonZeros(0), _touchedBlocks(0), _solveAll(true)
+  {
+  }
+
+  void IncrementalCholesky::clear()
+  {
+    _L.clear(true);
+    _L.rowBlockIndices().clear();
+    _L.colBlockIndices().clear();
+    _L.blockCols().clear();
+    _w.clear();
+    _nonZeros = 0;
+    _touchedBlocks = 0;
+    _y.resize(0);
+    _c.resize(0);
+    _parent.clear();
+    _children.clear();
+    _changed.clear();
+    _changedColumns.clear();
+    _queued.clear();
+    _solveAll = true;
+  }
+
+  int IncrementalCholesky::addBlock(int dim)
+  {
+    const int base = _L.rows();
+    _L.rowBlockIndices().push_back(base + dim);
+    _L.colBlockIndices().push_back(base + dim);
+    _L.blockCols().push_back(SparseBlockMatrix<MatrixX>::IntBlockMap());
+    const int k = numBlocks() - 1;
+    _L.block(k, k, true);
+    _nonZeros += dim * dim;
+
+    _y.conservativeResize(_L.rows());
+    _y.tail(dim).setZero();
+    _c.conservativeResize(_L.rows());
+    _c.tail(dim).setZero();
+    _parent.push_back(-1);
+    _children.push_back(vector<int>());
+    _changed.push_back(true);
+    _changedColumns.push_back(k);
+    _queued.push_back(false);
+    return k;
+  }
+
+  MatrixX* IncrementalCholesky::lowerBlock(int r, int c)
+  {
+    assert(r >= c && "block is not in the lower triangle");
+    _solveAll = true;
+    SparseBlockMatrix<MatrixX>::IntBlockMap& column = _L.blockCols()[c];
+    SparseBlockMatrix<MatrixX>::IntBlockMap::iterator it = column.find(r);
+    if (it != column.end())
+      return it->second;
+    _nonZeros += _L.rowsOfBlock(r) * _L.colsOfBlock(c);
+    return _L.block(r, c, true);
+  }
+
+  bool IncrementalCholesky::factorize()
+  {
+    typedef SparseBlockMatrix<MatrixX>::IntBlockMap IntBlockMap;
+    typedef Eigen::SparseMatrix<number_t, Eigen::ColMajor> SparseMatrix;
+    const int n = rows();
+    _solveAll = true;
+
+    // scalar lower triangle of A, the blocks are already in elimination order
+    vector<int> scalarBlock(n);
+    vector<Eigen::Triplet<number_t> > triplets;
+    triplets.reserve(_nonZeros);
+    for (int k = 0; k < numBlocks(); ++k) {
+      const int colBase = _L.colBaseOfBlock(k);
+      for (int c = 0; c < _L.colsOfBlock(k); ++c)
+        scalarBlock[colBase + c] = k;
+      const IntBlockMap& column = _L.blockCols()[k];
+      for (IntBlockMap::const_iterator it = column.begin(); it != column.end(); ++it) {
+        const MatrixX& B = *it->second;
+        const int rowBase = _L.rowBaseOfBlock(it->first);
+        for (int c = 0; c < B.cols(); ++c)
+          for (int r = it->first == k ? c : 0; r < B.rows(); ++r)
+            triplets.push_back(Eigen::Triplet<number_t>(rowBase + r, colBase + c, B(r, c)));
+      }
+    }
+    SparseMatrix A(n, n);
+    A.setFromTriplets(triplets.begin(), triplets.end());
+
+    // the numeric factorization is done by the simplicial Cholesky of Eigen
+    Eigen::SimplicialLLT<SparseMatrix, Eigen::Lower, Eigen::NaturalOrdering<int> > cholesky(A);
+    if (cholesky.info() != Eigen::Success)
+      return false;
+
+    // copy L to the blocks
+    _L.clear(true);
+    _nonZeros = 0;
+    const SparseMatrix L = cholesky.matrixL();
+    for (int j = 0; j < n; ++j) {
+      const int k = scalarBlock[j];
+      const int c = j - _L.colBaseOfBlock(k);
+      IntBlockMap& column = _L.blockCols()[k];
+      IntBlockMap::iterator blockIt = column.begin();
+      for (SparseMatrix::InnerIterator it(L, j); it; ++it) {
+        const int r = scalarBlock[it.row()];
+        while (blockIt != column.end() && blockIt->first < r)
+          ++blockIt;
+        if (blockIt == column.end() || blockIt->first != r) {
+          _nonZeros += _L.block(r, k, true)->size();
+          blockIt = column.find(r);
+        }
+        (*blockIt->second)(it.row() - _L.rowBaseOfBlock(r), c) = it.value();
+      }
+    }
+
+    // the elimination tree of the blocks
+    _parent.assign(numBlocks(), -1);
+    _children.assign(numBlocks(), vector<int>());
+    for (int k = 0; k < numBlocks(); ++k)
+      updateParent(k);
+    return true;
+  }
+
+  bool IncrementalCholesky::update(const std::vector<int>& blocks, const MatrixX& U, bool downdate)
+  {
+    _touchedBlocks = 0;
+    for (int j = 0; j < U.cols(); ++j) {
+      _w.clear();
+      int offset = 0;
+      for (size_t i = 0; i < blocks.size(); ++i) {
+        const int dim = _L.rowsOfBlock(blocks[i]);
+        _w[blocks[i]] = U.block(offset, j, dim, 1);
+        offset += dim;
+      }
+      assert(offset == U.rows() && "dimension of the update does not match the blocks");
+      if (! rankOneUpdate(downdate)) {
+        _solveAll = true;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool IncrementalCholesky::rankOneUpdate(bool downdate)
+  {
+    typedef SparseBlockMatrix<MatrixX>::IntBlockMap IntBlockMap;
+    vector<pair<MatrixX*, VectorX*> > below;
+    while (! _w.empty()) {
+      const int k = _w.begin()->first;
+      VectorX wk = _w.begin()->second;
+      _w.erase(_w.begin());
+      if (wk.isZero(0))
+        continue;
+      ++_touchedBlocks;
+      columnChanged(k);
+
+      // the pattern of column k becomes the union of its pattern and of w
+      IntBlockMap& column = _L.blockCols()[k];
+      for (map<int, VectorX>::const_iterator it = _w.begin(); it != _w.end(); ++it) {
+        if (column.find(it->first) == column.end()) {
+          _L.block(it->first, k, true);
+          _nonZeros += it->second.size() * wk.size();
+        }
+      }
+      updateParent(k);
+      below.clear();
+      for (IntBlockMap::iterator it = column.begin(); it != column.end(); ++it) {
+        if (it->first == k)
+          continue;
+        VectorX& wi = _w[it->first];
+        if (wi.size() == 0)
+          wi = VectorX::Zero(it->second->rows());
+        below.push_back(make_pair(it->second, &wi));
+      }
+
+      MatrixX& D = *column.find(k)->second;
+      const int dim = D.rows();
+      for (int c = 0; c < dim; ++c) {
+        const number_t x = wk(c);
+        if (x == 0.)
+          continue;
+        const number_t l = D(c, c);
+        if (! downdate) {
+          // Givens rotation of (L(:,c), w) which annihilates w(c)
+          const number_t r = std::hypot(l, x);
+          const number_t cs = l / r;
+          const number_t sn = x / r;
+          D(c, c) = r;
+          for (int i = c + 1; i < dim; ++i) {
+            const number_t li = D(i, c);
+            D(i, c) = cs * li + sn * wk(i);
+            wk(i) = cs * wk(i) - sn * li;
+          }
+          for (size_t b = 0; b < below.size(); ++b) {
+            MatrixX& B = *below[b].first;
+            VectorX& wi = *below[b].second;
+            const VectorX li = B.col(c);
+            B.col(c) = cs * li + sn * wi;
+            wi = cs * wi - sn * li;
+          }
+        } else {
+          // hyperbolic rotation, fails if A - w w^T is not positive definite
+          const number_t r2 = l * l - x * x;
+          if (r2 <= 0.)
+            return false;
+          const number_t r = std::sqrt(r2);
+          const number_t cs = r / l;
+          const number_t sn = x / l;
+          D(c, c) = r;
+          for (int i = c + 1; i < dim; ++i) {
+            D(i, c) = (D(i, c) - sn * wk(i)) / cs;
+            wk(i) = cs * wk(i) - sn * D(i, c);
+          }
+          for (size_t b = 0; b < below.size(); ++b) {
+            MatrixX& B = *below[b].first;
+            VectorX& wi = *below[b].second;
+            B.col(c) = (B.col(c) - sn * wi) / cs;
+            wi = cs * wi - sn * B.col(c);
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+  bool IncrementalCholesky::solve(number_t* x, const number_t* b) const
+  {
+    typedef SparseBlockMatrix<MatrixX>::IntBlockMap IntBlockMap;
+    const int n = rows();
+    VectorX::MapType xx(x, n);
+    if (x != b)
+      xx = VectorX::ConstMapType(b, n);
+
+    // forward substitution L y = b
+    for (int k = 0; k < numBlocks(); ++k) {
+      const IntBlockMap& column = _L.blockCols()[k];
+      const MatrixX& D = *column.find(k)->second;
+      if (D.diagonal().minCoeff() <= 0.)
+        return false;
+      auto xk = xx.segment(_L.rowBaseOfBlock(k), D.rows());
+      D.triangularView<Eigen::Lower>().solveInPlace(xk);
+      for (IntBlockMap::const_iterator it = column.begin(); it != column.end(); ++it) {
+        if (it->first == k)
+          continue;
+        xx.segment(_L.rowBaseOfBlock(it->first), it->second->rows()).noalias() -= *it->second * xk;
+      }
+    }
+
+    // backward substitution L^T x = y
+    for (int k = numBlocks() - 1; k >= 0; --k) {
+      const IntBlockMap& column = _L.blockCols()[k];
+      const MatrixX& D = *column.find(k)->second;
+      auto xk = xx.segment(_L.rowBaseOfBlock(k), D.rows());
+      for (IntBlockMap::const_iterator it = column.begin(); it != column.end(); ++it) {
+        if (it->first == k)
+          continue;
+        xk.noalias() -= it->second->transpose() * xx.segment(_L.rowBaseOfBlock(it->first), it->second->rows());
+      }
+      D.transpose().triangularView<Eigen::Upper>().solveInPlace(xk);
+    }
+    return true;
+  }
+
+  void IncrementalCholesky::columnChanged(int k)
+  {
+    typedef SparseBlockMatrix<MatrixX>::IntBlockMap IntBlockMap;
+    if (_solveAll || _changed[k])
+      return;
+    _changed[k] = true;
+    _changedColumns.push_back(k);
+    const IntBlockMap& column = _L.blockCols()[k];
+    const auto yk = _y.segment(_L.rowBaseOfBlock(k), _L.rowsOfBlock(k));
+    for (IntBlockMap::const_iterator it = column.upper_bound(k); it != column.end(); ++it)
+      _c.segment(_L.rowBaseOfBlock(it->first), it->second->rows()).noalias() -= *it->second * yk;
+  }
+
+  void IncrementalCholesky::updateParent(int k)
+  {
+    typedef SparseBlockMatrix<MatrixX>::IntBlockMap IntBlockMap;
+    const IntBlockMap& column = _L.blockCols()[k];
+    IntBlockMap::const_iterator it = column.upper_bound(k);
+    const int parent = it == column.end() ? -1 : it->first;
+    if (parent == _parent[k])
+      return;
+    if (_parent[k] >= 0) {
+      vector<int>& siblings = _children[_parent[k]];
+      siblings.erase(std::find(siblings.begin(), siblings.end(), k));
+    }
+    if (parent >= 0)
+      _children[parent].push_back(k);
+    _parent[k] = parent;
+  }
+
+  bool IncrementalCholesky::solveIncremental(number_t* x, const number_t* b, const std::vector<int>& rhsChanged, number_t threshold, std::vector<int>& changedBlocks)
+  {
+    typedef SparseBlockMatrix<MatrixX>::IntBlockMap IntBlockMap;
+    const int n = rows();
+    VectorX::MapType xx(x, n);
+    VectorX::ConstMapType bb(b, n);
+    changedBlocks.clear();
+
+    // forward substitution L y = b for the blocks which depend on a change
+    priority_queue<int, vector<int>, greater<int> > forward;
+    if (_solveAll) {
+      _c.setZero(n);
+      for (int k = 0; k < numBlocks(); ++k) {
+        _changed[k] = true;
+        _queued[k] = true;
+        forward.push(k);
+      }
+    } else {
+      for (size_t i = 0; i < _changedColumns.size(); ++i) {
+        _queued[_changedColumns[i]] = true;
+        forward.push(_changedColumns[i]);
+      }
+      for (size_t i = 0; i < rhsChanged.size(); ++i) {
+        if (! _queued[rhsChanged[i]]) {
+          _queued[rhsChanged[i]] = true;
+          forward.push(rhsChanged[i]);
+        }
+      }
+    }
+    _changedColumns.clear();
+
+    vector<int> recomputed;
+    while (! forward.empty()) {
+      const int k = forward.top();
+      forward.pop();
+      _queued[k] = false;
+      const IntBlockMap& column = _L.blockCols()[k];
+      const MatrixX& D = *column.find(k)->second;
+      if (D.diagonal().minCoeff() <= 0.) {
+        for (; ! forward.empty(); forward.pop())
+          _queued[forward.top()] = false;
+        _solveAll = true;
+        return false;
+      }
+      const int base = _L.rowBaseOfBlock(k);
+      auto yk = _y.segment(base, D.rows());
+      if (! _changed[k]) {
+        for (IntBlockMap::const_iterator it = column.upper_bound(k); it != column.end(); ++it)
+          _c.segment(_L.rowBaseOfBlock(it->first), it->second->rows()).noalias() -= *it->second * yk;
+      }
+      yk = bb.segment(base, D.rows()) - _c.segment(base, D.rows());
+      D.triangularView<Eigen::Lower>().solveInPlace(yk);
+      for (IntBlockMap::const_iterator it = column.upper_bound(k); it != column.end(); ++it) {
+        _c.segment(_L.rowBaseOfBlock(it->first), it->second->rows()).noalias() += *it->second * yk;
+        if (! _queued[it->first]) {
+          _queued[it->first] = true;
+          forward.push(it->first);
+        }
+      }
+      _changed[k] = false;
+      recomputed.push_back(k);
+    }
+
+    // backward substitution L^T x = y, which descends the elimination tree from the changed blocks
+    priority_queue<int> backward;
+    for (size_t i = 0; i < recomputed.size(); ++i) {
+      _queued[recomputed[i]] = true;
+      backward.push(recomputed[i]);
+    }
+    VectorX xk;
+    while (! backward.empty()) {
+      const int k = backward.top();
+      backward.pop();
+      _queued[k] = false;
+      const IntBlockMap& column = _L.blockCols()[k];
+      const MatrixX& D = *column.find(k)->second;
+      const int base = _L.rowBaseOfBlock(k);
+      xk = _y.segment(base, D.rows());
+      for (IntBlockMap::const_iterator it = column.upper_bound(k); it != column.end(); ++it)
+        xk.noalias() -= it->second->transpose() * xx.segment(_L.rowBaseOfBlock(it->first), it->second->rows());
+      D.transpose().triangularView<Eigen::Upper>().solveInPlace(xk);
+      const number_t delta = (xk - xx.segment(base, D.rows())).lpNorm<Eigen::Infinity>();
+      xx.segment(base, D.rows()) = xk;
+      changedBlocks.push_back(k);
+      if (_solveAll || threshold <= 0. || delta > threshold) {
+        const vector<int>& children = _children[k];
+        for (size_t i = 0; i < children.size(); ++i) {
+          if (! _queued[children[i]]) {
+            _queued[children[i]] = true;
+            backward.push(children[i]);
+          }
+        }
+      }
+    }
+    _solveAll = false;
+    return true;
+  }
+
+  void IncrementalCholesky::fillCCS(std::vector<int>& Lp, std::vector<int>& Li, std::vector<number_t>& Lx) const
+  {
+    typedef SparseBlockMatrix<MatrixX>::IntBlockMap IntBlockMap;
+    Lp.assign(1, 0);
+    Li.clear();
+    Lx.clear();
+    Li.reserve(_nonZeros);
+    Lx.reserve(_nonZeros);
+    for (int k = 0; k < numBlocks(); ++k) {
+      const IntBlockMap& column = _L.blockCols()[k];
+      const MatrixX& D = *column.find(k)->second;
+      const int base = _L.colBaseOfBlock(k);
+      for (int c = 0; c < D.cols(); ++c) {
+        for (int r = c; r < D.rows(); ++r) {
+          Li.push_back(base + r);
+          Lx.push_back(D(r, c));
+        }
+        for (IntBlockMap::const_iterator it = column.begin(); it != column.end(); ++it) {
+          if (it->first == k)
+            continue;
+          const int rowBase = _L.rowBaseOfBlock(it->first);
+          for (int r = 0; r < it->second->rows(); ++r) {
+            Li.push_back(rowBase + r);
+            Lx.push_back((*it->second)(r, c));
+          }
+        }
+        Lp.push_back(static_cast<int>(Li.size()));
+      }
+    }
+  }
+
+} // end namespace
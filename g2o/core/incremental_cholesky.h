@@ -0,0 +1,149 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_INCREMENTAL_CHOLESKY_H
+#define G2O_INCREMENTAL_CHOLESKY_H
+
+#include <map>
+#include <vector>
+
+#include "eigen_types.h"
+#include "sparse_block_matrix.h"
+#include "g2o_core_api.h"
+
+namespace g2o {
+
+  /**
+   * \brief block sparse Cholesky factor which is modified by low-rank updates and downdates
+   *
+   * Stores the lower triangular factor L of A = L L^T, where the block
+   * columns of L are in elimination order. L is either computed from A by
+   * factorize() or modified in place. A block is appended by addBlock()
+   * with a zero column, update() adds U U^T to A and, if downdate is true,
+   * subtracts it. Each column of U is applied by a sequence of Givens
+   * (respectively hyperbolic) rotations running down the elimination tree of
+   * L, which introduces the fill-in of the update. A block which was
+   * appended is positive definite after the first update which spans it.
+   *
+   * solveIncremental() keeps the intermediate result of the forward
+   * substitution and only re-computes the blocks which depend on a column
+   * modified since the last call or on a changed block of b.
+   */
+  class G2O_CORE_API IncrementalCholesky
+  {
+    public:
+      IncrementalCholesky();
+
+      //! removes all blocks
+      void clear();
+
+      //! append a block of dimension dim with a zero column, returns the index of the block
+      int addBlock(int dim);
+
+      /**
+       * returns the block (r, c) of the lower triangle, i.e., r >= c. Before
+       * factorize() the blocks hold A, afterwards they hold L.
+       */
+      MatrixX* lowerBlock(int r, int c);
+
+      /**
+       * compute L from the lower triangle of A stored in the blocks by the
+       * simplicial Cholesky of Eigen in the order of the blocks. Returns false,
+       * if A is not positive definite.
+       */
+      bool factorize();
+
+      /**
+       * A += U U^T, respectively A -= U U^T if downdate is true. The rows of U
+       * are the concatenation of the given blocks. Returns false, if a downdate
+       * would result in an indefinite matrix. In this case L is undefined and
+       * has to be re-computed.
+       */
+      bool update(const std::vector<int>& blocks, const MatrixX& U, bool downdate = false);
+
+      /**
+       * solve A x = b, x and b may point to the same memory. Returns false if
+       * L is singular, e.g., some block was never spanned by an update.
+       */
+      bool solve(number_t* x, const number_t* b) const;
+
+      /**
+       * solve A x = b, where x holds the solution of the previous call and the
+       * blocks rhsChanged of b changed since then. The forward substitution
+       * re-computes the blocks which depend on a modified column of L or on
+       * rhsChanged, i.e., their ancestors in the elimination tree. The backward
+       * substitution starts at these blocks and descends the elimination tree
+       * as long as the max norm of the change of a block exceeds threshold, a
+       * threshold of 0 yields the exact solution. The first call after
+       * factorize() solves for all blocks. The re-computed blocks of x are
+       * returned in changedBlocks.
+       */
+      bool solveIncremental(number_t* x, const number_t* b, const std::vector<int>& rhsChanged, number_t threshold, std::vector<int>& changedBlocks);
+
+      /**
+       * fill the CCS arrays of the lower triangle of L, the diagonal entry is
+       * the first element of each column.
+       */
+      void fillCCS(std::vector<int>& Lp, std::vector<int>& Li, std::vector<number_t>& Lx) const;
+
+      //! the factor L
+      const SparseBlockMatrix<MatrixX>& L() const { return _L;}
+      //! number of blocks
+      int numBlocks() const { return static_cast<int>(_L.blockCols().size());}
+      //! dimension of A
+      int rows() const { return _L.rows();}
+      //! number of scalar entries of the blocks of L
+      size_t nonZeros() const { return _nonZeros;}
+      //! number of block columns modified by the last call to update()
+      int touchedBlocks() const { return _touchedBlocks;}
+
+    protected:
+      //! apply the rank one update stored in _w
+      bool rankOneUpdate(bool downdate);
+      //! remove the contribution of column k to the forward substitution before it gets modified
+      void columnChanged(int k);
+      //! set the parent of block k in the elimination tree from the pattern of its column
+      void updateParent(int k);
+
+      SparseBlockMatrix<MatrixX> _L;
+      std::map<int, VectorX> _w;     ///< the sparse vector of the current rank one update
+      size_t _nonZeros;
+      int _touchedBlocks;
+
+      // state of solveIncremental()
+      VectorX _y;                                ///< solution of the forward substitution L y = b
+      VectorX _c;                                ///< sum of L(k, j) y(j) over the columns j < k for each block k
+      std::vector<int> _parent;                  ///< parent of each block in the elimination tree, -1 for a root
+      std::vector<std::vector<int> > _children;  ///< children of each block in the elimination tree
+      std::vector<bool> _changed;                ///< the column changed since the last solve, its contribution is not in _c
+      std::vector<int> _changedColumns;
+      std::vector<bool> _queued;
+      bool _solveAll;                            ///< the next solveIncremental() processes all blocks
+  };
+
+} // end namespace
+
+#endif
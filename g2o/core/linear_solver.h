@@ -28,6 +28,7 @@
 #define G2O_LINEAR_SOLVER_H
 #include "sparse_block_matrix.h"
 #include "sparse_block_matrix_ccs.h"
+#include "batch_stats.h"
 
 namespace g2o {
 
@@ -41,7 +42,7 @@ template <typename MatrixType>
 class LinearSolver
 {
   public:
-    LinearSolver() {};
+    LinearSolver() : _batchStatistics(0) {};
     virtual ~LinearSolver() {}
 
     /**
@@ -49,6 +50,13 @@ class LinearSolver
      */
     virtual bool init() = 0;
 
+    /**
+     * init for operating on a newly built matrix which has the same non-zero pattern
+     * like before. Solvers which keep pointers to the blocks of the matrix have to
+     * refresh them, but the symbolic decomposition may be re-used.
+     */
+    virtual bool initSamePattern() { return init();}
+
     /**
      * Assumes that A is the same matrix for several calls.
      * Among other assumptions, the non-zero pattern does not change!
@@ -78,6 +86,16 @@ class LinearSolver
     //! write a debug dump of the system matrix if it is not PSD in solve
     virtual bool writeDebug() const { return false;}
     virtual void setWriteDebug(bool) {}
+
+    /**
+     * the statistics the following calls are recorded to, 0 if none. Set by the BlockSolver
+     * to the statistics of the current iteration of the optimizer.
+     */
+    G2OBatchStatistics* batchStatistics() const { return _batchStatistics;}
+    virtual void setBatchStatistics(G2OBatchStatistics* batchStatistics) { _batchStatistics = batchStatistics;}
+
+  protected:
+    G2OBatchStatistics* _batchStatistics;
 };
 
 /**
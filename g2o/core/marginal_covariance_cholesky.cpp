@@ -28,22 +28,51 @@
 
 #include <algorithm>
 #include <cassert>
+
+#ifdef G2O_OPENMP
+#include <omp.h>
+#endif
 using namespace std;
 
 namespace g2o {
 
-struct MatrixElem
-{
-  int r, c;
-  MatrixElem(int r_, int c_) : r(r_), c(c_) {}
-  bool operator<(const MatrixElem& other) const
+namespace {
+  //! per thread workspace for computing one column of the sparse inverse
+  struct ColumnWorkspace
+  {
+    vector<int> position;   ///< local index of a row in the current column, -1 if not in the column
+    vector<number_t> sum;
+  };
+
+  //! minimal number of independent columns to distribute them over the threads
+  const int minParallelColumns = 32;
+
+  int numThreads()
+  {
+#   ifdef G2O_OPENMP
+    return omp_get_max_threads();
+#   else
+    return 1;
+#   endif
+  }
+
+  int threadId()
   {
-    return c > other.c || (c == other.c && r > other.r);
+#   ifdef G2O_OPENMP
+    return omp_get_thread_num();
+#   else
+    return 0;
+#   endif
   }
-};
+
+  bool sortByColumn(const pair<int, int>& a, const pair<int, int>& b)
+  {
+    return a.second < b.second || (a.second == b.second && a.first < b.first);
+  }
+}
 
 MarginalCovarianceCholesky::MarginalCovarianceCholesky() :
-  _n(0), _Ap(0), _Ai(0), _Ax(0), _perm(0)
+  _n(0), _Ap(0), _Ai(0), _Ax(0), _perm(0), _sortedColumns(true)
 {
 }
 
@@ -59,51 +88,201 @@ void MarginalCovarianceCholesky::setCholeskyFactor(int n, int* Lp, int* Li, numb
   _Ax = Lx;
   _perm = permInv;
 
-  // pre-compute reciprocal values of the diagonal of L
+  // pre-compute reciprocal values of the diagonal of L and the elimination tree
   _diag.resize(n);
+  _parent.assign(n, -1);
+  _sortedColumns = true;
   for (int r = 0; r < n; ++r) {
     const int& sc = _Ap[r]; // L is lower triangular, thus the first elem in the column is the diagonal entry
     assert(r == _Ai[sc] && "Error in CCS storage of L");
     _diag[r] = 1.0 / _Ax[sc];
+    for (int j = sc + 1; j < _Ap[r+1]; ++j) {
+      if (_parent[r] < 0 || _Ai[j] < _parent[r])
+        _parent[r] = _Ai[j];
+      if (j > sc + 1 && _Ai[j] < _Ai[j-1])
+        _sortedColumns = false;
+    }
   }
 }
 
-number_t MarginalCovarianceCholesky::computeEntry(int r, int c)
+int MarginalCovarianceCholesky::entryIndex(int r, int c) const
 {
   assert(r <= c);
-  int idx = computeIndex(r, c);
+  const int sc = _Ap[r];
+  if (r == c)
+    return sc;
+  const int* begin = _Ai + sc + 1;
+  const int* end = _Ai + _Ap[r+1];
+  const int* it = _sortedColumns ? lower_bound(begin, end, c) : find(begin, end, c);
+  if (it == end || *it != c)
+    return -1;
+  return static_cast<int>(it - _Ai);
+}
+
+void MarginalCovarianceCholesky::computeSparseInverse(vector<char>& needed)
+{
+  // the columns of the sparse inverse only depend on their ancestors in the elimination tree
+  for (int j = 0; j < _n; ++j) {
+    if (! needed[j])
+      continue;
+    for (int p = _parent[j]; p >= 0 && ! needed[p]; p = _parent[p])
+      needed[p] = 1;
+  }
 
-  LookupMap::const_iterator foundIt = _map.find(idx);
-  if (foundIt != _map.end()) {
-    return foundIt->second;
+  // group the columns by their depth, columns of the same depth are independent
+  vector<int> depth(_n, -1);
+  int numLevels = 0;
+  for (int j = _n - 1; j >= 0; --j) {
+    if (! needed[j])
+      continue;
+    depth[j] = _parent[j] < 0 ? 0 : depth[_parent[j]] + 1;
+    numLevels = max(numLevels, depth[j] + 1);
   }
+  vector<int> levelBegin(numLevels + 1, 0);
+  for (int j = 0; j < _n; ++j)
+    if (depth[j] >= 0)
+      ++levelBegin[depth[j] + 1];
+  for (int l = 0; l < numLevels; ++l)
+    levelBegin[l + 1] += levelBegin[l];
+  vector<int> levelColumns(levelBegin[numLevels]);
+  vector<int> levelFill(levelBegin.begin(), levelBegin.end() - 1);
+  for (int j = 0; j < _n; ++j)
+    if (depth[j] >= 0)
+      levelColumns[levelFill[depth[j]]++] = j;
 
-  // compute the summation over column r
-  number_t s = 0.;
-  const int& sc = _Ap[r];
-  const int& ec = _Ap[r+1];
-  for (int j = sc+1; j < ec; ++j) { // sum over row r while skipping the element on the diagonal
-    const int& rr = _Ai[j];
-    number_t val = rr < c ? computeEntry(rr, c) : computeEntry(c, rr);
-    s += val * _Ax[j];
+  _sigma.resize(_Ap[_n]);
+  vector<ColumnWorkspace> workspaces(numThreads());
+  for (size_t t = 0; t < workspaces.size(); ++t) {
+    workspaces[t].position.assign(_n, -1);
+    workspaces[t].sum.resize(_n);
   }
 
-  number_t result;
-  if (r == c) {
-    const number_t& diagElem = _diag[r];
-    result = diagElem * (diagElem - s);
-  } else {
-    result = -s * _diag[r];
+  for (int l = 0; l < numLevels; ++l) {
+    const int levelSize = levelBegin[l + 1] - levelBegin[l];
+#   ifdef G2O_OPENMP
+#   pragma omp parallel for default (shared) schedule(dynamic, 8) if (levelSize >= minParallelColumns)
+#   endif
+    for (int k = 0; k < levelSize; ++k) {
+      const int c = levelColumns[levelBegin[l] + k];
+      ColumnWorkspace& ws = workspaces[threadId()];
+      const int sc = _Ap[c];
+      const int ec = _Ap[c+1];
+      for (int p = sc + 1; p < ec; ++p) {
+        ws.position[_Ai[p]] = p - sc;
+        ws.sum[p - sc] = 0.;
+      }
+
+      // sum[i] = sum_k L(k, c) * Sigma(i, k) over the rows i, k of column c
+      for (int p = sc + 1; p < ec; ++p) {
+        const int k = _Ai[p];
+        const number_t& lk = _Ax[p];
+        const int sk = _Ap[k];
+        ws.sum[p - sc] += lk * _sigma[sk];
+        for (int q = sk + 1; q < _Ap[k+1]; ++q) {
+          const int i = ws.position[_Ai[q]];
+          if (i < 0)
+            continue;
+          ws.sum[i] += lk * _sigma[q];
+          ws.sum[p - sc] += _Ax[sc + i] * _sigma[q];
+        }
+      }
+
+      const number_t& diagElem = _diag[c];
+      number_t s = 0.;
+      for (int p = sc + 1; p < ec; ++p) {
+        _sigma[p] = -ws.sum[p - sc] * diagElem;
+        s += _Ax[p] * _sigma[p];
+        ws.position[_Ai[p]] = -1;
+      }
+      _sigma[sc] = diagElem * (diagElem - s);
+    }
   }
-  _map[idx] = result;
-  return result;
+}
+
+void MarginalCovarianceCholesky::computeOutOfPattern(const vector<pair<int, int> >& elems, const vector<int>& outOfPattern, vector<number_t>& values)
+{
+  // one column of the covariance per distinct column of the requested elements
+  vector<pair<int, int> > byColumn;
+  byColumn.reserve(outOfPattern.size());
+  for (size_t k = 0; k < outOfPattern.size(); ++k)
+    byColumn.push_back(make_pair(elems[outOfPattern[k]].first, elems[outOfPattern[k]].second));
+  sort(byColumn.begin(), byColumn.end(), sortByColumn);
+  byColumn.erase(unique(byColumn.begin(), byColumn.end()), byColumn.end());
+  vector<int> columnBegin;
+  for (size_t k = 0; k < byColumn.size(); ++k)
+    if (k == 0 || byColumn[k].second != byColumn[k-1].second)
+      columnBegin.push_back(static_cast<int>(k));
+  columnBegin.push_back(static_cast<int>(byColumn.size()));
+  vector<number_t> result(byColumn.size());
+
+  const int numColumns = static_cast<int>(columnBegin.size()) - 1;
+# ifdef G2O_OPENMP
+# pragma omp parallel default (shared) if (numColumns > 1)
+# endif
+  {
+    vector<number_t> x(_n);
+#   ifdef G2O_OPENMP
+#   pragma omp for schedule(dynamic, 1)
+#   endif
+    for (int k = 0; k < numColumns; ++k) {
+      const int c = byColumn[columnBegin[k]].second;
+      const int minRow = byColumn[columnBegin[k]].first;
+      // solve L L^T x = e_c
+      fill(x.begin(), x.end(), 0.);
+      x[c] = 1.;
+      for (int j = c; j < _n; ++j) {
+        if (x[j] == 0.)
+          continue;
+        x[j] *= _diag[j];
+        for (int p = _Ap[j] + 1; p < _Ap[j+1]; ++p)
+          x[_Ai[p]] -= _Ax[p] * x[j];
+      }
+      for (int j = _n - 1; j >= minRow; --j) {
+        number_t s = x[j];
+        for (int p = _Ap[j] + 1; p < _Ap[j+1]; ++p)
+          s -= _Ax[p] * x[_Ai[p]];
+        x[j] = s * _diag[j];
+      }
+      for (int e = columnBegin[k]; e < columnBegin[k+1]; ++e)
+        result[e] = x[byColumn[e].first];
+    }
+  }
+
+  for (size_t k = 0; k < outOfPattern.size(); ++k) {
+    const pair<int, int>& elem = elems[outOfPattern[k]];
+    vector<pair<int, int> >::const_iterator it = lower_bound(byColumn.begin(), byColumn.end(), elem, sortByColumn);
+    assert(it != byColumn.end() && *it == elem);
+    values[outOfPattern[k]] = result[it - byColumn.begin()];
+  }
+}
+
+void MarginalCovarianceCholesky::computeEntries(const vector<pair<int, int> >& elems, vector<number_t>& values)
+{
+  values.resize(elems.size());
+  vector<int> entries(elems.size());
+  vector<int> outOfPattern;
+  vector<char> needed(_n, 0);
+  for (size_t k = 0; k < elems.size(); ++k) {
+    entries[k] = entryIndex(elems[k].first, elems[k].second);
+    if (entries[k] < 0)
+      outOfPattern.push_back(static_cast<int>(k));
+    else
+      needed[elems[k].first] = 1;
+  }
+
+  computeSparseInverse(needed);
+  for (size_t k = 0; k < elems.size(); ++k)
+    if (entries[k] >= 0)
+      values[k] = _sigma[entries[k]];
+
+  if (! outOfPattern.empty())
+    computeOutOfPattern(elems, outOfPattern, values);
 }
 
 void MarginalCovarianceCholesky::computeCovariance(number_t** covBlocks, const std::vector<int>& blockIndices)
 {
-  _map.clear();
   int base = 0;
-  vector<MatrixElem> elemsToCompute;
+  vector<pair<int, int> > elemsToCompute;
   for (size_t i = 0; i < blockIndices.size(); ++i) {
     int nbase = blockIndices[i];
     int vdim = nbase - base;
@@ -113,38 +292,28 @@ void MarginalCovarianceCholesky::computeCovariance(number_t** covBlocks, const s
         int c = _perm ? _perm[cc + base] : cc + base;
         if (r > c) // make sure it's still upper triangular after applying the permutation
           swap(r, c);
-        elemsToCompute.push_back(MatrixElem(r, c));
+        elemsToCompute.push_back(make_pair(r, c));
       }
     base = nbase;
   }
 
-  // sort the elems to reduce the recursive calls
-  sort(elemsToCompute.begin(), elemsToCompute.end());
-
   // compute the inverse elements we need
-  for (size_t i = 0; i < elemsToCompute.size(); ++i) {
-    const MatrixElem& me = elemsToCompute[i];
-    computeEntry(me.r, me.c);
-  }
+  vector<number_t> values;
+  computeEntries(elemsToCompute, values);
 
   // set the marginal covariance for the vertices, by writing to the blocks memory
   base = 0;
+  size_t idx = 0;
   for (size_t i = 0; i < blockIndices.size(); ++i) {
     int nbase = blockIndices[i];
     int vdim = nbase - base;
     number_t* cov = covBlocks[i];
     for (int rr = 0; rr < vdim; ++rr)
       for (int cc = rr; cc < vdim; ++cc) {
-        int r = _perm ? _perm[rr + base] : rr + base; // apply permutation
-        int c = _perm ? _perm[cc + base] : cc + base;
-        if (r > c) // upper triangle
-          swap(r, c);
-        int idx = computeIndex(r, c);
-        LookupMap::const_iterator foundIt = _map.find(idx);
-        assert(foundIt != _map.end());
-        cov[rr*vdim + cc] = foundIt->second;
+        const number_t& value = values[idx++];
+        cov[rr*vdim + cc] = value;
         if (rr != cc)
-          cov[cc*vdim + rr] = foundIt->second;
+          cov[cc*vdim + rr] = value;
       }
     base = nbase;
   }
@@ -158,8 +327,7 @@ void MarginalCovarianceCholesky::computeCovariance(SparseBlockMatrix<MatrixX>& s
               &rowBlockIndices[0], 
               rowBlockIndices.size(),
               rowBlockIndices.size(), true);
-  _map.clear();
-  vector<MatrixElem> elemsToCompute;
+  vector<pair<int, int> > elemsToCompute;
   for (size_t i = 0; i < blockIndices.size(); ++i) {
     int blockRow=blockIndices[i].first;    
     int blockCol=blockIndices[i].second;
@@ -181,41 +349,24 @@ void MarginalCovarianceCholesky::computeCovariance(SparseBlockMatrix<MatrixX>& s
         int c = _perm ? _perm[cc] : cc;
         if (r > c)
           swap(r, c);
-        elemsToCompute.push_back(MatrixElem(r, c));
+        elemsToCompute.push_back(make_pair(r, c));
       }
   }
 
-  // sort the elems to reduce the number of recursive calls
-  sort(elemsToCompute.begin(), elemsToCompute.end());
-
   // compute the inverse elements we need
-  for (size_t i = 0; i < elemsToCompute.size(); ++i) {
-    const MatrixElem& me = elemsToCompute[i];
-    computeEntry(me.r, me.c);
-  }
+  vector<number_t> values;
+  computeEntries(elemsToCompute, values);
 
   // set the marginal covariance 
+  size_t idx = 0;
   for (size_t i = 0; i < blockIndices.size(); ++i) {
     int blockRow=blockIndices[i].first;    
     int blockCol=blockIndices[i].second;
-    int rowBase=spinv.rowBaseOfBlock(blockRow);
-    int colBase=spinv.colBaseOfBlock(blockCol);
-    
     MatrixX *block=spinv.block(blockRow, blockCol);
     assert(block);
     for (int iRow=0; iRow<block->rows(); ++iRow)
-      for (int iCol=0; iCol<block->cols(); ++iCol){
-        int rr=rowBase+iRow;
-        int cc=colBase+iCol;
-        int r = _perm ? _perm[rr] : rr; // apply permutation
-        int c = _perm ? _perm[cc] : cc;
-        if (r > c)
-          swap(r, c);
-        int idx = computeIndex(r, c);
-        LookupMap::const_iterator foundIt = _map.find(idx);
-        assert(foundIt != _map.end());
-        (*block)(iRow, iCol) = foundIt->second;
-      }
+      for (int iCol=0; iCol<block->cols(); ++iCol)
+        (*block)(iRow, iCol) = values[idx++];
   }
 }
 
@@ -33,22 +33,22 @@
 #include <cassert>
 #include <vector>
 
-#include <unordered_map>
-
 #include "g2o_core_api.h"
 
 namespace g2o {
 
   /**
    * \brief computing the marginal covariance given a cholesky factor (lower triangle of the factor)
+   *
+   * The entries of the covariance on the non-zero pattern of L are computed by
+   * the recursion of Takahashi et al. column by column from the root of the
+   * elimination tree towards the requested columns. Only the columns on the
+   * paths from the requested columns to the root are evaluated. The columns of
+   * one depth in the tree do not depend on each other and are computed in
+   * parallel. Requested entries outside of the pattern of L are obtained by
+   * solving with L and L^T for the corresponding column of the covariance.
    */
   class G2O_CORE_API MarginalCovarianceCholesky {
-    protected:
-      /**
-       * hash struct for storing the matrix elements needed to compute the covariance
-       */
-      typedef std::unordered_map<int, number_t>     LookupMap;
-    
     public:
       MarginalCovarianceCholesky();
       ~MarginalCovarianceCholesky();
@@ -83,16 +83,25 @@ namespace g2o {
       number_t* _Ax;      ///< values of the cholesky factor
       int* _perm;       ///< permutation of the cholesky factor. Variable re-ordering for better fill-in
 
-      LookupMap _map;             ///< hash look up table for the already computed entries
       std::vector<number_t> _diag;  ///< cache 1 / H_ii to avoid recalculations
+      std::vector<number_t> _sigma; ///< entries of the covariance on the pattern of L, aligned with _Ax
+      std::vector<int> _parent;     ///< elimination tree of L, -1 for a root
+      bool _sortedColumns;          ///< the row indices in each column of L are sorted
+
+      //! position of the entry (r, c) with r <= c in _sigma, -1 if it is not on the pattern of L
+      int entryIndex(int r, int c) const;
 
-      //! compute the index used for hashing
-      int computeIndex(int r, int c) const { /*assert(r <= c);*/ return r*_n + c;}
       /**
-       * compute one entry in the covariance, r and c are values after applying the permutation, and upper triangular.
-       * May issue recursive calls to itself to compute the missing values.
+       * compute the entries of the covariance, the indices of the elements are after applying the
+       * permutation and upper triangular.
        */
-      number_t computeEntry(int r, int c);
+      void computeEntries(const std::vector<std::pair<int, int> >& elems, std::vector<number_t>& values);
+
+      //! compute the columns of the covariance on the pattern of L which are marked in needed
+      void computeSparseInverse(std::vector<char>& needed);
+
+      //! compute the entries of the elements which are not on the pattern of L by a solve per column
+      void computeOutOfPattern(const std::vector<std::pair<int, int> >& elems, const std::vector<int>& outOfPattern, std::vector<number_t>& values);
   };
 
 }
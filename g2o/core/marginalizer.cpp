@@ -0,0 +1,243 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "marginalizer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+
+#include <Eigen/Eigenvalues>
+
+#include "sparse_optimizer.h"
+#include "edge_marginalization_prior.h"
+#include "jacobian_workspace.h"
+
+using namespace std;
+
+namespace g2o {
+
+  namespace {
+    //! number of elements of a Hessian block, padded such that the next block stays aligned for Eigen
+    inline int alignedBlockSize(int rows, int cols)
+    {
+      const int alignment = EIGEN_MAX_ALIGN_BYTES > static_cast<int>(sizeof(number_t)) ? EIGEN_MAX_ALIGN_BYTES / static_cast<int>(sizeof(number_t)) : 1;
+      return (rows * cols + alignment - 1) / alignment * alignment;
+    }
+  }
+
+  Marginalizer::Marginalizer(SparseOptimizer* optimizer) :
+    _optimizer(optimizer), _eigenvalueThreshold(cst(1e-12)), _firstEstimateJacobians(true), _prior(0)
+  {
+  }
+
+  bool Marginalizer::marginalize(HyperGraph::VertexSet& vset)
+  {
+    _prior = 0;
+
+    // the edges to remove, the vertices to eliminate and their Markov blanket
+    HyperGraph::EdgeSet eset;
+    OptimizableGraph::VertexContainer eliminated;
+    for (HyperGraph::VertexSet::const_iterator it = vset.begin(); it != vset.end(); ++it) {
+      OptimizableGraph::Vertex* v = static_cast<OptimizableGraph::Vertex*>(*it);
+      if (_optimizer->vertex(v->id()) != v) {
+        cerr << __PRETTY_FUNCTION__ << ": vertex " << v->id() << " is not part of the graph" << endl;
+        return false;
+      }
+      if (! v->fixed())
+        eliminated.push_back(v);
+      eset.insert(v->edges().begin(), v->edges().end());
+    }
+    HyperGraph::VertexSet blanketSet;
+    for (HyperGraph::EdgeSet::const_iterator it = eset.begin(); it != eset.end(); ++it) {
+      HyperGraph::Edge* e = *it;
+      for (size_t i = 0; i < e->vertices().size(); ++i) {
+        OptimizableGraph::Vertex* v = static_cast<OptimizableGraph::Vertex*>(e->vertex(i));
+        if (v && ! v->fixed() && vset.find(v) == vset.end())
+          blanketSet.insert(v);
+      }
+    }
+    OptimizableGraph::VertexContainer blanket;
+    for (HyperGraph::VertexSet::const_iterator it = blanketSet.begin(); it != blanketSet.end(); ++it)
+      blanket.push_back(static_cast<OptimizableGraph::Vertex*>(*it));
+    sort(eliminated.begin(), eliminated.end(), OptimizableGraph::VertexIDCompare());
+    sort(blanket.begin(), blanket.end(), OptimizableGraph::VertexIDCompare());
+
+    // the prior measures the increments of the blanket from the current estimate
+    vector<number_t> estimate;
+    VectorX delta;
+    for (size_t k = 0; k < blanket.size(); ++k) {
+      OptimizableGraph::Vertex* v = blanket[k];
+      delta.resize(v->dimension());
+      if (! v->getEstimateData(estimate) || ! v->localDifference(estimate.data(), delta.data())) {
+        cerr << __PRETTY_FUNCTION__ << ": vertex " << v->id() << " does not support a prior linearized at its estimate" << endl;
+        return false;
+      }
+    }
+
+    // the layout of the dense system, the eliminated vertices go first
+    OptimizableGraph::VertexContainer vertices(eliminated);
+    vertices.insert(vertices.end(), blanket.begin(), blanket.end());
+    map<OptimizableGraph::Vertex*, int> offsets;
+    int m = 0;
+    int dimension = 0;
+    int diagonalSize = 0;
+    for (size_t k = 0; k < vertices.size(); ++k) {
+      offsets[vertices[k]] = dimension;
+      dimension += vertices[k]->dimension();
+      diagonalSize += alignedBlockSize(vertices[k]->dimension(), vertices[k]->dimension());
+      if (k + 1 == eliminated.size())
+        m = dimension;
+    }
+    int n = dimension - m;
+
+    // linearize the edges and let them build their part of the Hessian in
+    // buffers of our own, the vertices get their Hessian memory back afterwards
+    MatrixX H = MatrixX::Zero(dimension, dimension);
+    VectorX b = VectorX::Zero(dimension);
+    VectorX diagonal = VectorX::Zero(diagonalSize);
+    vector<number_t*> hessianData(vertices.size());
+    for (size_t k = 0, d = 0; k < vertices.size(); ++k) {
+      OptimizableGraph::Vertex* v = vertices[k];
+      hessianData[k] = v->hessianData();
+      v->mapHessianMemory(diagonal.data() + d);
+      v->clearQuadraticForm();
+      d += alignedBlockSize(v->dimension(), v->dimension());
+    }
+
+    OptimizableGraph::EdgeContainer edges;
+    JacobianWorkspace jacobianWorkspace;
+    for (HyperGraph::EdgeSet::const_iterator it = eset.begin(); it != eset.end(); ++it) {
+      OptimizableGraph::Edge* e = static_cast<OptimizableGraph::Edge*>(*it);
+      if (e->numUndefinedVertices() || e->allVerticesFixed())
+        continue;
+      edges.push_back(e);
+      jacobianWorkspace.updateSize(e);
+    }
+    jacobianWorkspace.allocate();
+    sort(edges.begin(), edges.end(), OptimizableGraph::EdgeIDCompare());
+    VectorX offDiagonal;
+    for (size_t k = 0; k < edges.size(); ++k) {
+      OptimizableGraph::Edge* e = edges[k];
+      int numVertices = static_cast<int>(e->vertices().size());
+      int offDiagonalSize = 0;
+      for (int i = 0; i < numVertices; ++i)
+        for (int j = i + 1; j < numVertices; ++j)
+          offDiagonalSize += alignedBlockSize(static_cast<OptimizableGraph::Vertex*>(e->vertex(i))->dimension(), static_cast<OptimizableGraph::Vertex*>(e->vertex(j))->dimension());
+      offDiagonal.setZero(offDiagonalSize);
+      number_t* block = offDiagonal.data();
+      for (int i = 0; i < numVertices; ++i) {
+        for (int j = i + 1; j < numVertices; ++j) {
+          OptimizableGraph::Vertex* vi = static_cast<OptimizableGraph::Vertex*>(e->vertex(i));
+          OptimizableGraph::Vertex* vj = static_cast<OptimizableGraph::Vertex*>(e->vertex(j));
+          if (! vi->fixed() && ! vj->fixed())
+            e->mapHessianMemory(block, i, j, false);
+          block += alignedBlockSize(vi->dimension(), vj->dimension());
+        }
+      }
+
+      e->computeError();
+      e->linearizeOplus(jacobianWorkspace);
+      e->constructQuadraticForm();
+
+      block = offDiagonal.data();
+      for (int i = 0; i < numVertices; ++i) {
+        for (int j = i + 1; j < numVertices; ++j) {
+          OptimizableGraph::Vertex* vi = static_cast<OptimizableGraph::Vertex*>(e->vertex(i));
+          OptimizableGraph::Vertex* vj = static_cast<OptimizableGraph::Vertex*>(e->vertex(j));
+          if (! vi->fixed() && ! vj->fixed()) {
+            Eigen::Map<MatrixX> hij(block, vi->dimension(), vj->dimension());
+            H.block(offsets[vi], offsets[vj], vi->dimension(), vj->dimension()) += hij;
+            H.block(offsets[vj], offsets[vi], vj->dimension(), vi->dimension()) += hij.transpose();
+          }
+          block += alignedBlockSize(vi->dimension(), vj->dimension());
+        }
+      }
+    }
+
+    for (size_t k = 0, d = 0; k < vertices.size(); ++k) {
+      OptimizableGraph::Vertex* v = vertices[k];
+      int vdim = v->dimension();
+      H.block(offsets[v], offsets[v], vdim, vdim) += Eigen::Map<MatrixX>(diagonal.data() + d, vdim, vdim);
+      b.segment(offsets[v], vdim) += Eigen::Map<VectorX>(v->bData(), vdim);
+      v->mapHessianMemory(hessianData[k]);
+      d += alignedBlockSize(vdim, vdim);
+    }
+
+    // Schur complement on the blanket, the eliminated part may be rank
+    // deficient, e.g., for a vertex only observed by a monocular camera
+    MatrixX Hbb = H.bottomRightCorner(n, n);
+    VectorX bb = b.tail(n);
+    if (m > 0 && n > 0) {
+      Eigen::SelfAdjointEigenSolver<MatrixX> eigenSolver(H.topLeftCorner(m, m));
+      const VectorX& lambda = eigenSolver.eigenvalues();
+      number_t minEigenvalue = _eigenvalueThreshold * std::max(lambda(m - 1), cst(0.));
+      VectorX lambdaInverse(m);
+      for (int i = 0; i < m; ++i)
+        lambdaInverse(i) = lambda(i) > minEigenvalue ? 1. / lambda(i) : 0.;
+      // K = H_bm * H_mm^-1
+      MatrixX K = (H.bottomLeftCorner(n, m) * eigenSolver.eigenvectors()) * lambdaInverse.asDiagonal() * eigenSolver.eigenvectors().transpose();
+      Hbb.noalias() -= K * H.topRightCorner(m, n);
+      bb.noalias() -= K * b.head(m);
+      Hbb = cst(0.5) * (Hbb + Hbb.transpose()).eval();
+    }
+
+    EdgeMarginalizationPrior* prior = 0;
+    if (n > 0) {
+      prior = new EdgeMarginalizationPrior;
+      prior->resize(blanket.size());
+      for (size_t k = 0; k < blanket.size(); ++k)
+        prior->setVertex(k, blanket[k]);
+      prior->setFirstEstimateJacobians(_firstEstimateJacobians);
+      if (! prior->setQuadraticForm(Hbb, bb, _eigenvalueThreshold)) {
+        delete prior;
+        prior = 0;
+      }
+    }
+
+    // replace the vertices and their edges by the prior, keeping the
+    // structures of the optimizer for online processing
+    bool initialized = ! _optimizer->indexMapping().empty();
+    if (initialized && ! _optimizer->removeFromInitialization(vset, eset)) {
+      _optimizer->clearIndexMapping();
+      initialized = false;
+    }
+    for (HyperGraph::VertexSet::const_iterator it = vset.begin(); it != vset.end(); ++it)
+      _optimizer->removeVertex(*it);
+    if (prior) {
+      _optimizer->addEdge(prior);
+      if (initialized) {
+        HyperGraph::VertexSet noVertices;
+        HyperGraph::EdgeSet priorSet;
+        priorSet.insert(prior);
+        _optimizer->updateInitialization(noVertices, priorSet);
+      }
+    }
+    _prior = prior;
+    return true;
+  }
+
+} // end namespace
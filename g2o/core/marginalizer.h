@@ -0,0 +1,90 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_MARGINALIZER_H
+#define G2O_MARGINALIZER_H
+
+#include "eigen_types.h"
+#include "hyper_graph.h"
+#include "g2o_core_api.h"
+
+namespace g2o {
+
+  class SparseOptimizer;
+  class EdgeMarginalizationPrior;
+
+  /**
+   * \brief permanently remove vertices from the graph while keeping their information
+   *
+   * The edges incident to the vertices which are marginalized are
+   * linearized at the current estimate and their quadratic form is
+   * assembled the same way the solvers build the Hessian, including the
+   * weighting by robust kernels. The marginalized vertices are eliminated
+   * by the Schur complement and the information which remains on their
+   * Markov blanket, i.e., the other non-fixed vertices of these edges, is
+   * kept as an EdgeMarginalizationPrior. Afterwards the vertices along with
+   * their edges are removed from the graph and the prior is added instead.
+   *
+   * This bounds the size of the graph for sliding window estimation. If
+   * the optimizer is initialized, its structures are updated for online
+   * processing, such that optimize(iterations, true) can be called right
+   * away. If the optimization algorithm does not support removing vertices
+   * from its structures, initializeOptimization() has to be called again.
+   */
+  class G2O_CORE_API Marginalizer
+  {
+    public:
+      explicit Marginalizer(SparseOptimizer* optimizer);
+
+      //! eigenvalues below this threshold times the largest one are treated as zero
+      number_t eigenvalueThreshold() const { return _eigenvalueThreshold;}
+      void setEigenvalueThreshold(number_t threshold) { _eigenvalueThreshold = threshold;}
+
+      //! the priors evaluate their Jacobians at the linearization point
+      bool firstEstimateJacobians() const { return _firstEstimateJacobians;}
+      void setFirstEstimateJacobians(bool fej) { _firstEstimateJacobians = fej;}
+
+      /**
+       * marginalize the vertices, which are deleted along with their edges.
+       * The vertices of the Markov blanket have to support getEstimateData()
+       * and OptimizableGraph::Vertex::localDifference(), otherwise the graph
+       * is not changed and false is returned.
+       */
+      bool marginalize(HyperGraph::VertexSet& vset);
+
+      //! the prior added by the last call to marginalize(), 0 if no information was left
+      EdgeMarginalizationPrior* prior() const { return _prior;}
+
+    protected:
+      SparseOptimizer* _optimizer;
+      number_t _eigenvalueThreshold;
+      bool _firstEstimateJacobians;
+      EdgeMarginalizationPrior* _prior;
+  };
+
+} // end namespace
+
+#endif
@@ -36,6 +36,8 @@
 
 #include "estimate_propagator.h"
 #include "factory.h"
+#include "graph_binary_io.h"
+#include "graph_text_io.h"
 #include "optimization_algorithm_property.h"
 #include "hyper_graph_action.h"
 #include "cache.h"
@@ -46,6 +48,7 @@
 #include "g2o/stuff/color_macros.h"
 #include "g2o/stuff/string_tools.h"
 #include "g2o/stuff/misc.h"
+#include "g2o/stuff/filesys_tools.h"
 
 namespace g2o {
 
@@ -54,7 +57,7 @@ namespace g2o {
   OptimizableGraph::Vertex::Vertex() :
     HyperGraph::Vertex(),
     _graph(0), _userData(0), _hessianIndex(-1), _fixed(false), _marginalized(false),
-    _colInHessian(-1), _cacheContainer(0)
+    _colInHessian(-1), _quadraticFormLocking(true), _cacheContainer(0)
   {
   }
 
@@ -72,6 +75,32 @@ namespace g2o {
     }
   }
 
+  void OptimizableGraph::Vertex::numericJacobian(Edge* edge, number_t delta, number_t* jacobian)
+  {
+    // generic version based on the backup stack, BaseVertex perturbs a local copy of the estimate
+    const int errorDim = edge->dimension();
+    const number_t scalar = 1 / (2*delta);
+    Eigen::Map<MatrixX> J(jacobian, errorDim, _dimension);
+    Eigen::Map<const VectorX> error(edge->errorData(), errorDim);
+    VectorX add = VectorX::Zero(_dimension);
+    for (int d = 0; d < _dimension; ++d) {
+      push();
+      add[d] = delta;
+      oplus(add.data());
+      edge->computeError();
+      J.col(d) = error;
+      pop();
+      push();
+      add[d] = -delta;
+      oplus(add.data());
+      edge->computeError();
+      J.col(d) -= error;
+      pop();
+      add[d] = 0.;
+      J.col(d) *= scalar;
+    }
+  }
+
   OptimizableGraph::Vertex::~Vertex()
   {
     delete _cacheContainer;
@@ -117,10 +146,15 @@ namespace g2o {
     return -1;
   }
 
+  bool OptimizableGraph::Vertex::localDifference(const number_t*, number_t*) const
+  {
+    return false;
+  }
+
 
   OptimizableGraph::Edge::Edge() :
     HyperGraph::Edge(),
-    _dimension(-1), _level(0), _robustKernel(nullptr)
+    _dimension(-1), _level(0), _robustKernel(nullptr), _batchKernel(nullptr)
   {
   }
 
@@ -396,272 +430,23 @@ void OptimizableGraph::setFixed(HyperGraph::VertexSet& vset, bool fixed)
 
 bool OptimizableGraph::load(istream& is, bool createEdges)
 {
-  set<string> warnedUnknownTypes;
-  stringstream currentLine;
-  string token;
-
-  Factory* factory = Factory::instance();
-  HyperGraph::GraphElemBitset elemBitset;
-  elemBitset[HyperGraph::HGET_PARAMETER] = 1;
-  elemBitset.flip();
-
-  HyperGraph::GraphElemBitset elemParamBitset;
-  elemParamBitset[HyperGraph::HGET_PARAMETER] = 1;
-
-  HyperGraph::DataContainer* previousDataContainer = 0;
-  Data* previousData = 0;
-
-  int lineNumber = 0;
-  while (1) {
-    int bytesRead = readLine(is, currentLine);
-    lineNumber ++;
-    if (bytesRead == -1)
-      break;
-    currentLine >> token;
-    //cerr << "Token=" << token << endl;
-    if (bytesRead == 0 || token.size() == 0 || token[0] == '#')
-      continue;
-
-    // handle commands encoded in the file
-    bool handledCommand = false;
-
-    if (token == "FIX") {
-      handledCommand = true;
-      int id;
-      while (currentLine >> id) {
-        OptimizableGraph::Vertex* v = static_cast<OptimizableGraph::Vertex*>(vertex(id));
-        if (v) {
-#        ifndef NDEBUG
-          cerr << "Fixing vertex " << v->id() << endl;
-#        endif
-          v->setFixed(true);
-        } else {
-          cerr << "Warning: Unable to fix vertex with id " << id << ". Not found in the graph." << endl;
-        }
-      }
-    }
-
-    if (handledCommand)
-      continue;
-
-    // do the mapping to an internal type if it matches
-    if (_renamedTypesLookup.size() > 0) {
-      map<string, string>::const_iterator foundIt = _renamedTypesLookup.find(token);
-      if (foundIt != _renamedTypesLookup.end()) {
-        token = foundIt->second;
-      }
-    }
-
-    if (! factory->knowsTag(token)) {
-      if (warnedUnknownTypes.count(token) != 1) {
-        warnedUnknownTypes.insert(token);
-        cerr << CL_RED(__PRETTY_FUNCTION__ << " unknown type: " << token) << endl;
-      }
-      continue;
-    }
-
-    // first handle the parameters
-    HyperGraph::HyperGraphElement* pelement = factory->construct(token, elemParamBitset);
-    if (pelement) { // not a parameter or otherwise unknown tag
-      assert(pelement->elementType() == HyperGraph::HGET_PARAMETER && "Should be a param");
-      Parameter* p = static_cast<Parameter*>(pelement);
-      int pid;
-      currentLine >> pid;
-      p->setId(pid);
-      bool r = p->read(currentLine);
-      if (! r) {
-        cerr << __PRETTY_FUNCTION__ << ": Error reading data " << token << " for parameter " << pid << endl;
-        delete p;
-      } else {
-        if (! _parameters.addParameter(p) ){
-          cerr << __PRETTY_FUNCTION__ << ": Parameter of type:" << token << " id:" << pid << " already defined" << endl;
-        }
-      }
-      continue;
-    }
+  if (GraphBinaryReader::isBinary(is))
+    return loadBinary(is, createEdges);
 
-    HyperGraph::HyperGraphElement* element = factory->construct(token, elemBitset);
-    if (dynamic_cast<Vertex*>(element)) { // it's a vertex type
-      //cerr << "it is a vertex" << endl;
-      previousData = 0;
-      Vertex* v = static_cast<Vertex*>(element);
-      int id;
-      currentLine >> id;
-      bool r = v->read(currentLine);
-      if (! r)
-        cerr << __PRETTY_FUNCTION__ << ": Error reading vertex " << token << " " << id << endl;
-      v->setId(id);
-      if (!addVertex(v)) {
-        cerr << __PRETTY_FUNCTION__ << ": Failure adding Vertex, " << token << " " << id << endl;
-        delete v;
-      } else {
-        previousDataContainer = v;
-      }
-    }
-    else if (dynamic_cast<Edge*>(element)) {
-      //cerr << "it is an edge" << endl;
-      previousData = 0;
-      Edge* e = static_cast<Edge*>(element);
-      int numV = e->vertices().size();
-      if (_edge_has_id){
-        int id;
-        currentLine >> id;
-        e->setId(id);
-      }
-      //cerr << PVAR(token) << " " << PVAR(numV) << endl;
-      if (numV == 2) { // it's a pairwise / binary edge type which we handle in a special way
-        int id1, id2;
-        currentLine >> id1 >> id2;
-        Vertex* from = vertex(id1);
-        Vertex* to = vertex(id2);
-        int doInit=0;
-
-	if (createEdges){
-	  if (! from && id1 >=0) {
-	    from=e->createVertex(0);
-	    from->setId(id1);
-	    addVertex(from);
-	    doInit=2;
-	  }
-	  if (! to && id2 >=0) {
-	    to=e->createVertex(1);
-	    to->setId(id2);
-	    addVertex(to);
-	    doInit=1;
-	  }
-	  if (id1<0 || id2<0)
-	    doInit = 0;
-	} else {
-	  if ( (!from && id1>=0) ){
-            cerr << __PRETTY_FUNCTION__ << ": Unable to find vertex for edge " << token << " " << id1 << " <-> " << id2 << endl;
-	    delete e;
-	    e=0;
-	  }
-	  if (! to && id2>=0 ){
-            cerr << __PRETTY_FUNCTION__ << ": Unable to find vertex for edge " << token << " " << id1 << " <-> " << id2 << endl;
-	    delete e;
-	    e=0;
-	  }
-	}
-	if (e){
-          e->setVertex(0, from);
-          e->setVertex(1, to);
-          e->read(currentLine);
-          if (!addEdge(e)) {
-            cerr << __PRETTY_FUNCTION__ << ": Unable to add edge " << token << " " << id1 << " <-> " << id2 << endl;
-            delete e;
-          } else {
-            switch (doInit){
-              case 1:
-                {
-                  HyperGraph::VertexSet fromSet;
-                  fromSet.insert(from);
-                  e->initialEstimate(fromSet, to);
-                  break;
-                }
-              case 2:
-                {
-                  HyperGraph::VertexSet toSet;
-                  toSet.insert(to);
-                  e->initialEstimate(toSet, from);
-                  break;
-                }
-              default:;
-            }
-          }
-        }
-      }
-      else { // numV != 2
-	vector<int> ids;
-	if(numV!=0){
-	  ids.resize(numV);
-	  for (int l = 0; l < numV; ++l)
-	    currentLine >> ids[l];
-	}
-	else{
-	  string buff;
-	  currentLine >> buff;
-	  while(buff != "||"){
-	    ids.push_back(atoi(buff.c_str()));
-	    currentLine >> buff;
-	  }
-	  numV = ids.size();
-	  e->resize(numV);
-	}
-        bool vertsOkay = true;
-        for (int l = 0; l < numV; ++l) {
-	  int vertexId=ids[l];
-	  HyperGraph::Vertex* v=0;
-	  if (vertexId != HyperGraph::UnassignedId){
-	    v = vertex(vertexId);
-	    e->setVertex(l,v);
-	    if (!v) {
-	      vertsOkay = false;
-	      break;
-	    }
-	  }
-        }
-        if (! vertsOkay) {
-          cerr << __PRETTY_FUNCTION__ << ": Unable to find vertices for edge " << token;
-          for (int l = 0; l < numV; ++l) {
-            if (l > 0)
-              cerr << " <->";
-            cerr << " " << ids[l];
-          }
-          delete e;
-        } else {
-          bool r = e->read(currentLine);
-          if (!r || !addEdge(e)) {
-            cerr << __PRETTY_FUNCTION__ << ": Unable to add edge " << token;
-            for (int l = 0; l < numV; ++l) {
-              if (l > 0)
-                cerr << " <->";
-              cerr << " " << ids[l];
-            }
-            delete e;
-	    e=0;
-          }
-        }
-      }
-      previousDataContainer = e;
-    } else if (dynamic_cast<Data*>(element)) { // reading in the data packet for the vertex
-      //cerr << "read data packet " << token << " vertex " << previousVertex->id() << endl;
-      Data* d = static_cast<Data*>(element);
-      bool r = d->read(currentLine);
-      if (! r) {
-	cerr << __PRETTY_FUNCTION__ << ": Error reading data " << token << " at line " << lineNumber << endl;
-	delete d;
-	previousData = 0;
-      } else if (previousData){
-	//cerr << "chaining" << endl;
-	previousData->setNext(d);
-	d->setDataContainer(previousData->dataContainer());
-        previousData = d;
-	//cerr << "done" << endl;
-      } else if (previousDataContainer){
-	//cerr << "embedding in vertex" << endl;
-	previousDataContainer->setUserData(d);
-	d->setDataContainer(previousDataContainer);
-	previousData = d;
-	previousDataContainer = 0;
-	//cerr << "done" << endl;
-      } else {
-        cerr << __PRETTY_FUNCTION__ << ": got data element, but no data container available" << endl;
-        delete d;
-	previousData = 0;
-      }
-    }
-  } // while read line
+  GraphTextReader reader(*this, &_renamedTypesLookup, _edge_has_id);
+  bool result = reader.read(is, createEdges);
 
 #ifndef NDEBUG
   cerr << "Loaded " << _parameters.size() << " parameters" << endl;
 #endif
 
-  return true;
+  return result;
 }
 
 bool OptimizableGraph::load(const char* filename, bool createEdges)
 {
+  if (GraphBinaryReader::isBinary(filename))
+    return loadBinary(filename, createEdges);
   ifstream ifs(filename);
   if (!ifs) {
     cerr << __PRETTY_FUNCTION__ << " unable to open file " << filename << endl;
@@ -672,19 +457,18 @@ bool OptimizableGraph::load(const char* filename, bool createEdges)
 
 bool OptimizableGraph::save(const char* filename, int level) const
 {
+  if (getFileExtension(filename) == "g2ob")
+    return saveBinary(filename, level);
   ofstream ofs(filename);
   if (!ofs)
     return false;
   return save(ofs, level);
 }
 
-bool OptimizableGraph::save(ostream& os, int level) const
+void OptimizableGraph::elementsToSave(int level, VertexContainer& vertices, EdgeContainer& edges) const
 {
-  // write the parameters to the top of the file
-  if (! _parameters.write(os))
-    return false;
   set<Vertex*, VertexIDCompare> verticesToSave;
-  for (HyperGraph::EdgeSet::const_iterator it = edges().begin(); it != edges().end(); ++it) {
+  for (HyperGraph::EdgeSet::const_iterator it = this->edges().begin(); it != this->edges().end(); ++it) {
     OptimizableGraph::Edge* e = static_cast<OptimizableGraph::Edge*>(*it);
     if (e->level() == level) {
       for (vector<HyperGraph::Vertex*>::const_iterator it = e->vertices().begin(); it != e->vertices().end(); ++it) {
@@ -693,26 +477,66 @@ bool OptimizableGraph::save(ostream& os, int level) const
       }
     }
   }
+  vertices.assign(verticesToSave.begin(), verticesToSave.end());
 
-  for (set<Vertex*, VertexIDCompare>::const_iterator it = verticesToSave.begin(); it != verticesToSave.end(); ++it){
-    OptimizableGraph::Vertex* v = *it;
-    saveVertex(os, v);
-  }
-
-  EdgeContainer edgesToSave;
-  for (HyperGraph::EdgeSet::const_iterator it = edges().begin(); it != edges().end(); ++it) {
+  edges.clear();
+  for (HyperGraph::EdgeSet::const_iterator it = this->edges().begin(); it != this->edges().end(); ++it) {
     const OptimizableGraph::Edge* e = dynamic_cast<const OptimizableGraph::Edge*>(*it);
     if (e->level() == level)
-      edgesToSave.push_back(const_cast<Edge*>(e));
+      edges.push_back(const_cast<Edge*>(e));
   }
-  sort(edgesToSave.begin(), edgesToSave.end(), EdgeIDCompare());
+  sort(edges.begin(), edges.end(), EdgeIDCompare());
+}
 
-  for (EdgeContainer::const_iterator it = edgesToSave.begin(); it != edgesToSave.end(); ++it) {
-    OptimizableGraph::Edge* e = *it;
-    saveEdge(os, e);
-  }
+bool OptimizableGraph::save(ostream& os, int level) const
+{
+  // write the parameters to the top of the file
+  GraphTextWriter writer(*this, os);
+  if (! writer.writeParameters(_parameters))
+    return false;
 
-  return os.good();
+  VertexContainer verticesToSave;
+  EdgeContainer edgesToSave;
+  elementsToSave(level, verticesToSave, edgesToSave);
+
+  writer.writeVertices(verticesToSave);
+  return writer.writeEdges(edgesToSave);
+}
+
+bool OptimizableGraph::loadBinary(istream& is, bool createEdges)
+{
+  GraphBinaryReader reader(*this, &_renamedTypesLookup);
+  return reader.read(is, createEdges);
+}
+
+bool OptimizableGraph::loadBinary(const char* filename, bool createEdges)
+{
+  GraphBinaryReader reader(*this, &_renamedTypesLookup);
+  return reader.read(filename, createEdges);
+}
+
+bool OptimizableGraph::saveBinary(const char* filename, int level) const
+{
+  ofstream ofs(filename, ios::binary);
+  if (!ofs)
+    return false;
+  return saveBinary(ofs, level);
+}
+
+bool OptimizableGraph::saveBinary(ostream& os, int level) const
+{
+  VertexContainer verticesToSave;
+  EdgeContainer edgesToSave;
+  elementsToSave(level, verticesToSave, edgesToSave);
+
+  GraphBinaryWriter writer(*this, os, _edge_has_id);
+  if (! writer.writeParameters(_parameters))
+    return false;
+  for (VertexContainer::const_iterator it = verticesToSave.begin(); it != verticesToSave.end(); ++it)
+    writer.writeVertex(*it);
+  for (EdgeContainer::const_iterator it = edgesToSave.begin(); it != edgesToSave.end(); ++it)
+    writer.writeEdge(*it);
+  return writer.finish();
 }
 
 
@@ -50,6 +50,7 @@ namespace g2o {
   class Cache;
   class CacheContainer;
   class RobustKernel;
+  class BatchEdgeKernel;
 
   /**
      @addtogroup g2o
@@ -194,6 +195,14 @@ namespace g2o {
          */
         virtual int estimateDimension() const;
 
+        /**
+         * true, if read() and write() use the estimate data of get/setEstimateData()
+         * as plain numbers and read() does nothing beyond setEstimateData(). The
+         * readers and writers of the graph files may then use the estimate data
+         * directly instead of parsing the text. Types opt in by overriding this.
+         */
+        virtual bool plainDataFormat() const { return false;}
+
         /**
          * sets the initial estimate from an array of number_t.
          * Implement setMinimalEstimateDataImpl()
@@ -238,6 +247,15 @@ namespace g2o {
          */
         virtual int minimalEstimateDimension() const;
 
+        /**
+         * computes the increment delta such that oplus(delta) applied to the
+         * estimate given as an array of number_t (see getEstimateData()) yields
+         * the current estimate. Used by priors which keep their linearization
+         * point, e.g., EdgeMarginalizationPrior.
+         * @returns true on success, false if not supported by the vertex
+         */
+        virtual bool localDifference(const number_t* estimate, number_t* delta) const;
+
         //! backup the position of the vertex to a stack
         virtual void push() = 0;
 
@@ -250,6 +268,31 @@ namespace g2o {
         //! return the stack size
         virtual int stackSize() const = 0;
 
+        /**
+         * Size in bytes of a copy of the estimate. The copies are used by the
+         * EstimateSnapshot to backup the estimates of many vertices in one buffer.
+         * By default, the copy is the estimate given by getEstimateData(). A size
+         * of 0 means that the vertex cannot copy its estimate and the snapshot
+         * uses push() and pop() instead. BaseVertex copies the estimate itself.
+         */
+        virtual size_t estimateCopySize() const
+        {
+          int dim = estimateDimension();
+          return dim > 0 ? dim * sizeof(number_t) : 0;
+        }
+        //! copy the estimate to the aligned memory d, constructs the copy if construct is true
+        virtual void saveEstimateCopy(void* d, bool /*construct*/) const
+        {
+          getEstimateData(static_cast<number_t*>(d));
+        }
+        //! restore the estimate from the copy, the caches are not updated
+        virtual void restoreEstimateCopy(const void* d)
+        {
+          setEstimateDataImpl(static_cast<const number_t*>(d));
+        }
+        //! destroy the copy constructed by saveEstimateCopy()
+        virtual void destroyEstimateCopy(void* /*d*/) const {}
+
         /**
          * Update the position of the node from the parameters in v.
          * Depends on the implementation of oplusImpl in derived classes to actually carry
@@ -262,6 +305,16 @@ namespace g2o {
           updateCache();
         }
 
+        /**
+         * Jacobian of the error of the edge with respect to this vertex by central
+         * differences with step size delta. The error is evaluated on the estimate
+         * perturbed around a local copy which is restored afterwards, i.e., the
+         * backup stack is not used. The Jacobian is stored column-major with
+         * edge->dimension() rows and dimension() columns. The error of the edge
+         * is left at the last perturbation.
+         */
+        virtual void numericJacobian(Edge* edge, number_t delta, number_t* jacobian);
+
         //! temporary index of this node in the parameter vector obtained from linearization
         int hessianIndex() const { return _hessianIndex;}
         int G2O_ATTRIBUTE_DEPRECATED(tempIndex() const) { return hessianIndex();}
@@ -297,11 +350,19 @@ namespace g2o {
          * lock for the block of the hessian and the b vector associated with this vertex, to avoid
          * race-conditions if multi-threaded.
          */
-        void lockQuadraticForm() { _quadraticFormMutex.lock();}
+        void lockQuadraticForm() { if (_quadraticFormLocking) _quadraticFormMutex.lock();}
         /**
          * unlock the block of the hessian and the b vector associated with this vertex
          */
-        void unlockQuadraticForm() { _quadraticFormMutex.unlock();}
+        void unlockQuadraticForm() { if (_quadraticFormLocking) _quadraticFormMutex.unlock();}
+        /**
+         * enable / disable the lock of the quadratic form. A solver which guarantees that
+         * no two threads accumulate into this vertex at the same time, e.g., by coloring
+         * the edges, may switch it off.
+         */
+        void setQuadraticFormLocking(bool locking) { _quadraticFormLocking = locking;}
+        //! true, if lockQuadraticForm() actually acquires the lock
+        bool quadraticFormLocking() const { return _quadraticFormLocking;}
 
         //! read the vertex from a stream, i.e., the internal state of the vertex
         virtual bool read(std::istream& is) = 0;
@@ -311,6 +372,8 @@ namespace g2o {
         virtual void updateCache();
 
         CacheContainer* cacheContainer();
+        //! true if caches depend on this vertex, without creating the container
+        bool hasCacheContainer() const { return _cacheContainer != 0;}
       protected:
         OptimizableGraph* _graph;
         Data* _userData;
@@ -320,6 +383,7 @@ namespace g2o {
         int _dimension;
         int _colInHessian;
         OpenMPMutex _quadraticFormMutex;
+        bool _quadraticFormLocking;
 
         CacheContainer* _cacheContainer;
 
@@ -373,6 +437,16 @@ namespace g2o {
         //! by get/setMeasurement;
         virtual int measurementDimension() const;
 
+        /**
+         * true, if read() and write() use the measurement data of
+         * get/setMeasurementData() followed by the upper triangle of the
+         * information matrix, row by row, as plain numbers and read() does
+         * nothing beyond setting them. The readers and writers of the graph files
+         * may then use the data directly instead of parsing the text. Types opt
+         * in by overriding this.
+         */
+        virtual bool plainDataFormat() const { return false;}
+
         /**
          * sets the estimate to have a zero error, based on the current value of the state variables
          * returns false if not supported.
@@ -386,6 +460,13 @@ namespace g2o {
          */
         void setRobustKernel(RobustKernel* ptr);
 
+        /**
+         * if NOT NULL, the error and the Jacobians of this edge are computed by the kernel
+         * together with the other edges of its type, see SparseOptimizer::setBatchEvaluation()
+         */
+        BatchEdgeKernel* batchKernel() const { return _batchKernel;}
+        void setBatchKernel(BatchEdgeKernel* kernel) { _batchKernel = kernel;}
+
         //! returns the error vector cached after calling the computeError;
         virtual const number_t* errorData() const = 0;
         virtual number_t* errorData() = 0;
@@ -457,15 +538,20 @@ namespace g2o {
         bool setParameterId(int argNum, int paramId);
         inline const Parameter* parameter(int argNo) const {return *_parameters.at(argNo);}
         inline size_t numParameters() const {return _parameters.size();}
+        //! the id of the parameter used as argument argNo
+        inline int parameterId(int argNo) const {return _parameterIds[argNo];}
         inline void resizeParameters(size_t newSize) {
           _parameters.resize(newSize, 0);
           _parameterIds.resize(newSize, -1);
           _parameterTypes.resize(newSize, typeid(void*).name());
         }
+        //! look up the parameters by their ids in the graph of the vertices
+        bool resolveParameters();
       protected:
 	int _dimension;
         int _level;
         RobustKernel* _robustKernel;
+        BatchEdgeKernel* _batchKernel;
         long long _internalId;
         std::vector<int> _cacheIds;
 
@@ -484,7 +570,6 @@ namespace g2o {
               const std::string& _type,
               const ParameterVector& parameters);
 
-        bool resolveParameters();
         virtual bool resolveCaches();
 
         std::vector<std::string> _parameterTypes;
@@ -567,14 +652,25 @@ namespace g2o {
     //! discard the last backup of the estimate for all variables by removing it from the stack
     virtual void discardTop();
 
-    //! load the graph from a stream. Uses the Factory singleton for creating the vertices and edges.
+    /**
+     * load the graph from a stream. Uses the Factory singleton for creating the vertices and edges.
+     * A stream starting with the magic of the binary format is read by loadBinary().
+     */
     virtual bool load(std::istream& is, bool createEdges=true);
+    //! load the graph from a file, binary files are memory mapped
     bool load(const char* filename, bool createEdges=true);
     //! save the graph to a stream. Again uses the Factory system.
     virtual bool save(std::ostream& os, int level = 0) const;
-    //! function provided for convenience, see save() above
+    //! function provided for convenience, see save() above. A file ending in .g2ob is written in the binary format
     bool save(const char* filename, int level = 0) const;
 
+    //! load the graph from a stream in the binary format, see GraphBinaryReader
+    bool loadBinary(std::istream& is, bool createEdges=true);
+    bool loadBinary(const char* filename, bool createEdges=true);
+    //! save the graph to a stream in the binary format, see GraphBinaryWriter
+    bool saveBinary(std::ostream& os, int level = 0) const;
+    bool saveBinary(const char* filename, int level = 0) const;
+
 
     //! save a subgraph to a stream. Again uses the Factory system.
     bool saveSubset(std::ostream& os, HyperGraph::VertexSet& vset, int level = 0);
@@ -655,6 +751,9 @@ namespace g2o {
     inline const ParameterContainer& parameters() const {return _parameters;}
 
   protected:
+    //! the vertices (sorted by their id) and edges (sorted by their internal id) save() writes for the given level
+    void elementsToSave(int level, VertexContainer& vertices, EdgeContainer& edges) const;
+
     std::map<std::string, std::string> _renamedTypesLookup;
     long long _nextEdgeId;
     std::vector<HyperGraphActionSet> _graphActions;
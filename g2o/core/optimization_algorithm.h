@@ -75,6 +75,12 @@ namespace g2o {
        */
       virtual bool updateStructure(const std::vector<HyperGraph::Vertex*>& vset, const HyperGraph::EdgeSet& edges) = 0;
 
+      /**
+       * remove vertices and edges from the structures for online processing.
+       * If your solver does not support it, return false.
+       */
+      virtual bool removeFromStructure(const std::vector<HyperGraph::Vertex*>& vset, const HyperGraph::EdgeSet& edges) { (void) vset; (void) edges; return false;}
+
       /**
        * called by the optimizer if verbose. re-implement, if you want to print something
        */
@@ -78,20 +78,14 @@ namespace g2o {
       _wasPDInAllIterations = true;
     }
 
-    number_t t=get_monotonic_time();
-    _optimizer->computeActiveErrors();
-    G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-    if (globalStats) {
-      globalStats->timeResiduals = get_monotonic_time()-t;
-      t=get_monotonic_time();
-    }
+    BatchStatisticsTimer residualsTimer(_optimizer->currentBatchStatistics(), &G2OBatchStatistics::timeResiduals);
+    number_t currentChi = _optimizer->computeActiveErrorsAndRobustChi2();
+    residualsTimer.stop();
 
-    number_t currentChi = _optimizer->activeRobustChi2();
+    BatchStatisticsTimer quadraticFormTimer(_optimizer->currentBatchStatistics(), &G2OBatchStatistics::timeQuadraticForm);
 
     _solver.buildSystem();
-    if (globalStats) {
-      globalStats->timeQuadraticForm = get_monotonic_time()-t;
-    }
+    quadraticFormTimer.stop();
 
     VectorX::ConstMapType b(_solver.b(), _solver.vectorSize());
 
@@ -182,8 +176,7 @@ namespace g2o {
       // apply the update and see what happens
       _optimizer->push();
       _optimizer->update(_hdl.data());
-      _optimizer->computeActiveErrors();
-      number_t newChi = _optimizer-> activeRobustChi2();
+      number_t newChi = _optimizer->computeActiveErrorsAndRobustChi2();
       number_t nonLinearGain = currentChi - newChi;
       if (fabs(linearGain) < 1e-12)
         linearGain = cst(1e-12);
@@ -53,12 +53,9 @@ namespace g2o {
     bool ok = true;
     
     //here so that correct component for max-mixtures can be computed before the build structure
-    number_t t=get_monotonic_time();
+    BatchStatisticsTimer residualsTimer(_optimizer->currentBatchStatistics(), &G2OBatchStatistics::timeResiduals);
     _optimizer->computeActiveErrors();
-    G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-    if (globalStats) {
-      globalStats->timeResiduals = get_monotonic_time()-t;
-    }
+    residualsTimer.stop();
     
     if (iteration == 0 && !online) { // built up the CCS structure, here due to easy time measure
       ok = _solver.buildStructure();
@@ -68,23 +65,17 @@ namespace g2o {
       }
     }
 
-    t=get_monotonic_time();
+    BatchStatisticsTimer quadraticFormTimer(_optimizer->currentBatchStatistics(), &G2OBatchStatistics::timeQuadraticForm);
     _solver.buildSystem();
-    if (globalStats) {
-      globalStats->timeQuadraticForm = get_monotonic_time()-t;
-      t=get_monotonic_time();
-    }
+    quadraticFormTimer.stop();
 
+    BatchStatisticsTimer linearSolutionTimer(_optimizer->currentBatchStatistics(), &G2OBatchStatistics::timeLinearSolution);
     ok = _solver.solve();
-    if (globalStats) {
-      globalStats->timeLinearSolution = get_monotonic_time()-t;
-      t=get_monotonic_time();
-    }
+    linearSolutionTimer.stop();
 
+    BatchStatisticsTimer updateTimer(_optimizer->currentBatchStatistics(), &G2OBatchStatistics::timeUpdate);
     _optimizer->update(_solver.x());
-    if (globalStats) {
-      globalStats->timeUpdate = get_monotonic_time()-t;
-    }
+    updateTimer.stop();
     if (ok)
       return OK;
     else
@@ -0,0 +1,503 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "optimization_algorithm_incremental.h"
+
+#include <cassert>
+#include <iostream>
+#include <unordered_set>
+
+#include <Eigen/Eigenvalues>
+#include <Eigen/Sparse>
+#include <Eigen/OrderingMethods>
+
+#include "batch_stats.h"
+#include "marginal_covariance_cholesky.h"
+#include "sparse_optimizer.h"
+
+using namespace std;
+
+namespace g2o {
+
+  OptimizationAlgorithmIncremental::OptimizationAlgorithmIncremental() :
+    OptimizationAlgorithm(),
+    _batchRequired(true), _updatesSinceBatch(0), _nonZerosAfterBatch(0), _numRelinearized(0)
+  {
+    _relinearizeThreshold = _properties.makeProperty<Property<number_t> >("relinearizeThreshold", 0.1);
+    _wildfireThreshold = _properties.makeProperty<Property<number_t> >("wildfireThreshold", 0.001);
+    _batchEveryN = _properties.makeProperty<Property<int> >("batchEveryN", 100);
+    _maxFillGrowth = _properties.makeProperty<Property<number_t> >("maxFillGrowth", 2.);
+  }
+
+  OptimizationAlgorithmIncremental::~OptimizationAlgorithmIncremental()
+  {
+  }
+
+  bool OptimizationAlgorithmIncremental::init(bool online)
+  {
+    assert(_optimizer && "optimizer not set");
+    if (! online || _variables.empty())
+      _batchRequired = true;
+    return true;
+  }
+
+  OptimizationAlgorithm::SolverResult OptimizationAlgorithmIncremental::solve(int iteration, bool online)
+  {
+    (void) iteration;
+    bool batch = ! online || _batchRequired;
+    if (online && batchEveryN() > 0 && _updatesSinceBatch >= batchEveryN())
+      batch = true;
+    if (online && _nonZerosAfterBatch > 0 && _factor.nonZeros() > maxFillGrowth() * _nonZerosAfterBatch)
+      batch = true;
+
+    _numRelinearized = 0;
+    if (batch && ! batchStep())
+      return Fail;
+    if (! solveAndUpdate())
+      return Fail;
+    if (online && ! relinearize())
+      return Fail;
+    return OK;
+  }
+
+  bool OptimizationAlgorithmIncremental::batchStep()
+  {
+    _factor.clear();
+    _variables.clear();
+    _variableIndex.clear();
+    _terms.clear();
+    _rhsChanged.clear();
+    _candidates.clear();
+    _isCandidate.clear();
+
+    const SparseOptimizer::VertexContainer& vertices = _optimizer->indexMapping();
+    _variables.reserve(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i)
+      if (! addVariable(vertices[i], -1))
+        return false;
+
+    vector<int> order;
+    computeOrdering(order);
+    _blockVariables = order;
+    for (size_t k = 0; k < order.size(); ++k) {
+      Variable& var = _variables[order[k]];
+      var.block = _factor.addBlock(var.vertex->dimension());
+    }
+    _b.setZero(_factor.rows());
+    _x.setZero(_factor.rows());
+
+    // assemble the lower triangle of the Hessian in the blocks of the factor
+    const SparseOptimizer::EdgeContainer& edges = _optimizer->activeEdges();
+    for (size_t i = 0; i < edges.size(); ++i) {
+      EdgeTerm& term = _terms[edges[i]];
+      if (! linearize(edges[i], term))
+        return false;
+      for (size_t a = 0, offsetA = 0; a < term.blocks.size(); ++a) {
+        const int da = _factor.L().rowsOfBlock(term.blocks[a]);
+        for (size_t b = 0, offsetB = 0; b < term.blocks.size(); ++b) {
+          const int db = _factor.L().rowsOfBlock(term.blocks[b]);
+          if (term.blocks[a] >= term.blocks[b])
+            *_factor.lowerBlock(term.blocks[a], term.blocks[b]) += term.H.block(offsetA, offsetB, da, db);
+          offsetB += db;
+        }
+        offsetA += da;
+      }
+      addToB(term, 1.);
+    }
+    if (! _factor.factorize()) {
+      cerr << __PRETTY_FUNCTION__ << ": Cholesky failure, the Hessian is not positive definite" << endl;
+      return false;
+    }
+
+    _batchRequired = false;
+    _updatesSinceBatch = 0;
+    _nonZerosAfterBatch = _factor.nonZeros();
+    _numRelinearized = static_cast<int>(_variables.size());
+    return true;
+  }
+
+  void OptimizationAlgorithmIncremental::computeOrdering(std::vector<int>& order) const
+  {
+    typedef Eigen::SparseMatrix<number_t, Eigen::ColMajor> SparseMatrix;
+    typedef Eigen::Triplet<number_t> Triplet;
+    const int n = static_cast<int>(_variables.size());
+    order.resize(n);
+    if (n == 0)
+      return;
+
+    // the block pattern of the Hessian
+    vector<Triplet> triplets;
+    for (int i = 0; i < n; ++i)
+      triplets.push_back(Triplet(i, i, 0.));
+    const SparseOptimizer::EdgeContainer& edges = _optimizer->activeEdges();
+    vector<int> edgeVariables;
+    for (size_t i = 0; i < edges.size(); ++i) {
+      const OptimizableGraph::Edge* e = edges[i];
+      edgeVariables.clear();
+      for (size_t j = 0; j < e->vertices().size(); ++j) {
+        auto it = _variableIndex.find(static_cast<const OptimizableGraph::Vertex*>(e->vertex(j)));
+        if (it != _variableIndex.end())
+          edgeVariables.push_back(it->second);
+      }
+      for (size_t a = 0; a < edgeVariables.size(); ++a)
+        for (size_t b = a + 1; b < edgeVariables.size(); ++b)
+          triplets.push_back(Triplet(std::min(edgeVariables[a], edgeVariables[b]), std::max(edgeVariables[a], edgeVariables[b]), 0.));
+    }
+    SparseMatrix auxBlockMatrix(n, n);
+    auxBlockMatrix.setFromTriplets(triplets.begin(), triplets.end());
+    SparseMatrix C;
+    C = auxBlockMatrix.selfadjointView<Eigen::Upper>();
+    Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic> blockP;
+    Eigen::internal::minimum_degree_ordering(C, blockP);
+    for (int k = 0; k < n; ++k)
+      order[k] = blockP.indices()(k);
+  }
+
+  bool OptimizationAlgorithmIncremental::addVariable(OptimizableGraph::Vertex* v, int block)
+  {
+    const int estimateDimension = v->estimateDimension();
+    if (estimateDimension <= 0) {
+      cerr << __PRETTY_FUNCTION__ << ": vertex " << v->id() << " does not implement getEstimateData()" << endl;
+      return false;
+    }
+    Variable var;
+    var.vertex = v;
+    var.block = block;
+    var.linearizationPoint.resize(estimateDimension);
+    v->getEstimateData(var.linearizationPoint.data());
+    _variableIndex[v] = static_cast<int>(_variables.size());
+    _variables.push_back(var);
+    _isCandidate.push_back(false);
+    return true;
+  }
+
+  bool OptimizationAlgorithmIncremental::linearize(OptimizableGraph::Edge* e, EdgeTerm& term)
+  {
+    term.variables.clear();
+    term.blocks.clear();
+    vector<int> vertexIndices;
+    for (size_t i = 0; i < e->vertices().size(); ++i) {
+      OptimizableGraph::Vertex* v = static_cast<OptimizableGraph::Vertex*>(e->vertex(i));
+      if (v->fixed())
+        continue;
+      auto it = _variableIndex.find(v);
+      if (it == _variableIndex.end()) {
+        cerr << __PRETTY_FUNCTION__ << ": vertex " << v->id() << " of an edge is not part of the optimization" << endl;
+        return false;
+      }
+      term.variables.push_back(it->second);
+      term.blocks.push_back(_variables[it->second].block);
+      vertexIndices.push_back(static_cast<int>(i));
+    }
+    const int m = static_cast<int>(term.variables.size());
+
+    // evaluate the edge at the linearization point of its variables
+    for (int a = 0; a < m; ++a) {
+      Variable& var = _variables[term.variables[a]];
+      var.vertex->push();
+      var.vertex->setEstimateData(var.linearizationPoint.data());
+    }
+    e->computeError();
+    e->linearizeOplus(_optimizer->jacobianWorkspace());
+
+    // let the edge write its quadratic form into the scratch memory
+    vector<int> offsets(m + 1, 0);
+    _vertexHessians.resize(m);
+    _edgeHessians.resize(m * (m - 1) / 2);
+    for (int a = 0; a < m; ++a) {
+      OptimizableGraph::Vertex* v = _variables[term.variables[a]].vertex;
+      offsets[a + 1] = offsets[a] + v->dimension();
+      _vertexHessians[a].setZero(v->dimension(), v->dimension());
+      v->mapHessianMemory(_vertexHessians[a].data());
+      v->clearQuadraticForm();
+    }
+    for (int a = 0, idx = 0; a < m; ++a) {
+      for (int b = a + 1; b < m; ++b, ++idx) {
+        _edgeHessians[idx].setZero(offsets[a + 1] - offsets[a], offsets[b + 1] - offsets[b]);
+        e->mapHessianMemory(_edgeHessians[idx].data(), vertexIndices[a], vertexIndices[b], false);
+      }
+    }
+    e->constructQuadraticForm();
+
+    const int dim = offsets[m];
+    MatrixX& H = term.H;
+    H.resize(dim, dim);
+    term.b.resize(dim);
+    for (int a = 0, idx = 0; a < m; ++a) {
+      OptimizableGraph::Vertex* v = _variables[term.variables[a]].vertex;
+      const int da = offsets[a + 1] - offsets[a];
+      H.block(offsets[a], offsets[a], da, da) = _vertexHessians[a];
+      term.b.segment(offsets[a], da) = VectorX::ConstMapType(v->bData(), da);
+      for (int b = a + 1; b < m; ++b, ++idx) {
+        const int db = offsets[b + 1] - offsets[b];
+        H.block(offsets[a], offsets[b], da, db) = _edgeHessians[idx];
+        H.block(offsets[b], offsets[a], db, da) = _edgeHessians[idx].transpose();
+      }
+    }
+    for (int a = 0; a < m; ++a)
+      _variables[term.variables[a]].vertex->pop();
+    return true;
+  }
+
+  void OptimizationAlgorithmIncremental::computeUpdate(const EdgeTerm& term, MatrixX& U) const
+  {
+    // H = U U^T, the directions without information are dropped
+    const int dim = static_cast<int>(term.H.rows());
+    Eigen::SelfAdjointEigenSolver<MatrixX> eigenSolver(term.H);
+    const VectorX& lambda = eigenSolver.eigenvalues();
+    const number_t threshold = (dim > 0 ? std::max(lambda.maxCoeff(), number_t(0.)) : number_t(0.)) * 1e-12;
+    int rank = 0;
+    for (int i = 0; i < dim; ++i)
+      if (lambda(i) > threshold)
+        ++rank;
+    U.resize(dim, rank);
+    for (int i = dim - rank, c = 0; i < dim; ++i, ++c)
+      U.col(c) = eigenSolver.eigenvectors().col(i) * std::sqrt(lambda(i));
+  }
+
+  bool OptimizationAlgorithmIncremental::addTerm(OptimizableGraph::Edge* e)
+  {
+    EdgeTerm& term = _terms[e];
+    if (! linearize(e, term)) {
+      _terms.erase(e);
+      return false;
+    }
+    computeUpdate(term, _U);
+    _factor.update(term.blocks, _U);
+    addToB(term, 1.);
+    return true;
+  }
+
+  bool OptimizationAlgorithmIncremental::removeTerm(OptimizableGraph::Edge* e)
+  {
+    auto it = _terms.find(e);
+    if (it == _terms.end())
+      return true;
+    const EdgeTerm& term = it->second;
+    computeUpdate(term, _U);
+    bool ok = _factor.update(term.blocks, _U, true);
+    addToB(term, -1.);
+    _terms.erase(it);
+    return ok;
+  }
+
+  void OptimizationAlgorithmIncremental::addToB(const EdgeTerm& term, number_t scale)
+  {
+    for (size_t a = 0, offset = 0; a < term.blocks.size(); ++a) {
+      const int dim = _factor.L().rowsOfBlock(term.blocks[a]);
+      _b.segment(_factor.L().rowBaseOfBlock(term.blocks[a]), dim) += scale * term.b.segment(offset, dim);
+      _rhsChanged.push_back(term.blocks[a]);
+      offset += dim;
+    }
+  }
+
+  bool OptimizationAlgorithmIncremental::solveAndUpdate()
+  {
+    BatchStatisticsTimer linearSolutionTimer(_optimizer->currentBatchStatistics(), &G2OBatchStatistics::timeLinearSolution);
+    bool ok = _factor.solveIncremental(_x.data(), _b.data(), _rhsChanged, wildfireThreshold(), _changedBlocks);
+    _rhsChanged.clear();
+    if (! ok) {
+      cerr << __PRETTY_FUNCTION__ << ": the factor is singular" << endl;
+      return false;
+    }
+    linearSolutionTimer.stop();
+
+    // the other variables keep their increment and hence their estimate
+    BatchStatisticsTimer updateTimer(_optimizer->currentBatchStatistics(), &G2OBatchStatistics::timeUpdate);
+    for (size_t i = 0; i < _changedBlocks.size(); ++i) {
+      const int index = _blockVariables[_changedBlocks[i]];
+      Variable& var = _variables[index];
+      var.vertex->setEstimateData(var.linearizationPoint.data());
+      var.vertex->oplus(_x.data() + _factor.L().rowBaseOfBlock(var.block));
+      if (! _isCandidate[index]) {
+        _isCandidate[index] = true;
+        _candidates.push_back(index);
+      }
+    }
+    return true;
+  }
+
+  bool OptimizationAlgorithmIncremental::relinearize()
+  {
+    BatchStatisticsTimer quadraticFormTimer(_optimizer->currentBatchStatistics(), &G2OBatchStatistics::timeQuadraticForm);
+    vector<int> moved;
+    vector<OptimizableGraph::Edge*> edges;
+    unordered_set<OptimizableGraph::Edge*> edgeSet;
+    // only the variables whose increment changed since the last call can exceed the threshold
+    for (size_t c = 0; c < _candidates.size(); ++c) {
+      const int i = _candidates[c];
+      _isCandidate[i] = false;
+      const Variable& var = _variables[i];
+      const int dim = var.vertex->dimension();
+      if (_x.segment(_factor.L().rowBaseOfBlock(var.block), dim).lpNorm<Eigen::Infinity>() <= relinearizeThreshold())
+        continue;
+      moved.push_back(i);
+      for (HyperGraph::EdgeSet::const_iterator it = var.vertex->edges().begin(); it != var.vertex->edges().end(); ++it) {
+        OptimizableGraph::Edge* e = static_cast<OptimizableGraph::Edge*>(*it);
+        if (_terms.count(e) && edgeSet.insert(e).second)
+          edges.push_back(e);
+      }
+    }
+    _candidates.clear();
+    if (moved.empty())
+      return true;
+    // down- and updating most of the edges is more expensive than re-computing the factor
+    if (2 * edges.size() > _terms.size())
+      return batchStep();
+
+    for (size_t i = 0; i < edges.size(); ++i) {
+      if (! removeTerm(edges[i])) {
+        // the factor is broken, it gets re-computed by the next iteration
+        _batchRequired = true;
+        return true;
+      }
+    }
+    for (size_t i = 0; i < moved.size(); ++i) {
+      Variable& var = _variables[moved[i]];
+      var.vertex->getEstimateData(var.linearizationPoint.data());
+      _x.segment(_factor.L().rowBaseOfBlock(var.block), var.vertex->dimension()).setZero();
+      _rhsChanged.push_back(var.block);
+    }
+    for (size_t i = 0; i < edges.size(); ++i)
+      if (! addTerm(edges[i]))
+        return false;
+    _numRelinearized = static_cast<int>(moved.size());
+    return true;
+  }
+
+  bool OptimizationAlgorithmIncremental::updateStructure(const std::vector<HyperGraph::Vertex*>& vset, const HyperGraph::EdgeSet& edges)
+  {
+    JacobianWorkspace& jacobianWorkspace = _optimizer->jacobianWorkspace();
+    for (HyperGraph::EdgeSet::const_iterator it = edges.begin(); it != edges.end(); ++it)
+      jacobianWorkspace.updateSize(*it);
+    jacobianWorkspace.allocate();
+    if (_batchRequired)
+      return true;
+
+    BatchStatisticsTimer quadraticFormTimer(_optimizer->currentBatchStatistics(), &G2OBatchStatistics::timeQuadraticForm);
+    for (size_t i = 0; i < vset.size(); ++i) {
+      OptimizableGraph::Vertex* v = static_cast<OptimizableGraph::Vertex*>(vset[i]);
+      if (v->fixed() || _variableIndex.count(v))
+        continue;
+      const int block = _factor.addBlock(v->dimension());
+      if (! addVariable(v, block))
+        return false;
+      _blockVariables.push_back(static_cast<int>(_variables.size()) - 1);
+    }
+    const int oldRows = static_cast<int>(_b.size());
+    _b.conservativeResize(_factor.rows());
+    _b.tail(_factor.rows() - oldRows).setZero();
+    _x.conservativeResize(_factor.rows());
+    _x.tail(_factor.rows() - oldRows).setZero();
+
+    for (HyperGraph::EdgeSet::const_iterator it = edges.begin(); it != edges.end(); ++it) {
+      OptimizableGraph::Edge* e = static_cast<OptimizableGraph::Edge*>(*it);
+      if (e->allVerticesFixed() || _terms.count(e))
+        continue;
+      if (! addTerm(e))
+        return false;
+    }
+    ++_updatesSinceBatch;
+    return true;
+  }
+
+  bool OptimizationAlgorithmIncremental::removeFromStructure(const std::vector<HyperGraph::Vertex*>& vset, const HyperGraph::EdgeSet& edges)
+  {
+    // removing a variable would leave a hole in the factor, re-compute it instead
+    if (! vset.empty())
+      _batchRequired = true;
+    if (_batchRequired)
+      return true;
+    for (HyperGraph::EdgeSet::const_iterator it = edges.begin(); it != edges.end(); ++it) {
+      if (! removeTerm(static_cast<OptimizableGraph::Edge*>(*it))) {
+        _batchRequired = true;
+        break;
+      }
+    }
+    return true;
+  }
+
+  bool OptimizationAlgorithmIncremental::computeMarginals(SparseBlockMatrix<MatrixX>& spinv, const std::vector<std::pair<int, int> >& blockIndices)
+  {
+    const SparseOptimizer::VertexContainer& vertices = _optimizer->indexMapping();
+    if (_batchRequired || vertices.size() != _variables.size())
+      return false;
+
+    // the marginals are computed at the linearization point
+    vector<int> Lp, Li;
+    vector<number_t> Lx;
+    _factor.fillCCS(Lp, Li, Lx);
+
+    // map the Hessian index of the vertices to the blocks of the factor
+    vector<int> rowBlockIndices(vertices.size());
+    vector<int> permInv(_factor.rows());
+    for (size_t i = 0, base = 0; i < vertices.size(); ++i) {
+      const int dim = vertices[i]->dimension();
+      auto it = _variableIndex.find(vertices[i]);
+      if (it == _variableIndex.end())
+        return false;
+      const int factorBase = _factor.L().rowBaseOfBlock(_variables[it->second].block);
+      for (int d = 0; d < dim; ++d)
+        permInv[base + d] = factorBase + d;
+      base += dim;
+      rowBlockIndices[i] = static_cast<int>(base);
+    }
+
+    MarginalCovarianceCholesky mcc;
+    mcc.setCholeskyFactor(_factor.rows(), Lp.data(), Li.data(), Lx.data(), permInv.data());
+    mcc.computeCovariance(spinv, rowBlockIndices, blockIndices);
+    return true;
+  }
+
+  void OptimizationAlgorithmIncremental::setRelinearizeThreshold(number_t threshold)
+  {
+    _relinearizeThreshold->setValue(threshold);
+  }
+
+  void OptimizationAlgorithmIncremental::setWildfireThreshold(number_t threshold)
+  {
+    _wildfireThreshold->setValue(threshold);
+  }
+
+  void OptimizationAlgorithmIncremental::setBatchEveryN(int n)
+  {
+    _batchEveryN->setValue(n);
+  }
+
+  void OptimizationAlgorithmIncremental::setMaxFillGrowth(number_t growth)
+  {
+    _maxFillGrowth->setValue(growth);
+  }
+
+  void OptimizationAlgorithmIncremental::printVerbose(std::ostream& os) const
+  {
+    os
+      << "\t relinearized= " << _numRelinearized
+      << "\t solvedBlocks= " << _changedBlocks.size()
+      << "\t nnzL= " << _factor.nonZeros();
+  }
+
+} // end namespace
@@ -0,0 +1,167 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_OPTIMIZATION_ALGORITHM_INCREMENTAL_H
+#define G2O_OPTIMIZATION_ALGORITHM_INCREMENTAL_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "optimization_algorithm.h"
+#include "optimizable_graph.h"
+#include "incremental_cholesky.h"
+#include "g2o_core_api.h"
+
+namespace g2o {
+
+  /**
+   * \brief Gauss-Newton which keeps the Cholesky factor of the Hessian alive between online updates
+   *
+   * In batch mode, i.e., optimize(iterations, false), each iteration
+   * linearizes all the edges at the current estimate, computes a fill
+   * reducing ordering of the variables and factorizes the Hessian. In online
+   * mode, SparseOptimizer::updateInitialization() appends the new vertices to
+   * the factor and adds the new edges as low-rank updates. Each online
+   * iteration solves with the current factor for the blocks affected by the
+   * updates, see IncrementalCholesky::solveIncremental(), and only updates
+   * the vertices of these blocks. The variables whose increment
+   * exceeds relinearizeThreshold() are re-linearized by downdating the old and
+   * updating the new contribution of their edges. After batchEveryN() online
+   * updates or if the fill-in grew by more than maxFillGrowth(), the variables
+   * are re-ordered and the factor is re-computed from scratch.
+   *
+   * The factor is computed from the rank updates of the edges, such that only
+   * Eigen is required. Marginalized vertices are regular variables of the
+   * factor. The vertices have to implement getEstimateData() and
+   * setEstimateData() for storing their linearization point.
+   */
+  class G2O_CORE_API OptimizationAlgorithmIncremental : public OptimizationAlgorithm
+  {
+    public:
+      OptimizationAlgorithmIncremental();
+      virtual ~OptimizationAlgorithmIncremental();
+
+      virtual bool init(bool online = false);
+
+      virtual SolverResult solve(int iteration, bool online = false);
+
+      virtual bool computeMarginals(SparseBlockMatrix<MatrixX>& spinv, const std::vector<std::pair<int, int> >& blockIndices);
+
+      virtual bool updateStructure(const std::vector<HyperGraph::Vertex*>& vset, const HyperGraph::EdgeSet& edges);
+
+      virtual bool removeFromStructure(const std::vector<HyperGraph::Vertex*>& vset, const HyperGraph::EdgeSet& edges);
+
+      virtual void printVerbose(std::ostream& os) const;
+
+      //! a variable is re-linearized in online mode, if the max norm of its increment exceeds this threshold
+      number_t relinearizeThreshold() const { return _relinearizeThreshold->value();}
+      void setRelinearizeThreshold(number_t threshold);
+
+      //! the back-substitution stops descending if the max norm of the change of a block is below this threshold, 0 solves exactly
+      number_t wildfireThreshold() const { return _wildfireThreshold->value();}
+      void setWildfireThreshold(number_t threshold);
+
+      //! re-order and re-factorize after this number of online updates, 0 disables it
+      int batchEveryN() const { return _batchEveryN->value();}
+      void setBatchEveryN(int n);
+
+      //! re-order and re-factorize, if the non-zeros of L grew by this factor since the last re-ordering
+      number_t maxFillGrowth() const { return _maxFillGrowth->value();}
+      void setMaxFillGrowth(number_t growth);
+
+      //! the current factor of the Hessian
+      const IncrementalCholesky& factor() const { return _factor;}
+
+    protected:
+      //! a vertex of the optimizer within the factor
+      struct Variable
+      {
+        OptimizableGraph::Vertex* vertex;
+        int block;                                ///< block of the variable in the factor
+        std::vector<number_t> linearizationPoint; ///< estimate of the vertex at which its edges are linearized
+      };
+
+      //! the contribution of an edge to the Hessian and to b
+      struct EdgeTerm
+      {
+        std::vector<int> variables; ///< the variables of the edge in the order of the vertices
+        std::vector<int> blocks;    ///< the blocks of the variables in the factor
+        MatrixX H;
+        VectorX b;
+      };
+
+      //! re-order the variables and factorize the Hessian at the current estimate
+      bool batchStep();
+      //! fill-reducing order of the variables, order[k] is the variable of the k-th block
+      void computeOrdering(std::vector<int>& order) const;
+      //! append a variable for the given vertex
+      bool addVariable(OptimizableGraph::Vertex* v, int block);
+      //! linearize the edge at the linearization point of its variables
+      bool linearize(OptimizableGraph::Edge* e, EdgeTerm& term);
+      //! the low-rank update U U^T = H of the term
+      void computeUpdate(const EdgeTerm& term, MatrixX& U) const;
+      //! linearize the edge and add its term to the factor
+      bool addTerm(OptimizableGraph::Edge* e);
+      //! remove the term of the edge from the factor, false if the downdate failed
+      bool removeTerm(OptimizableGraph::Edge* e);
+      //! add the right hand side of the term scaled by scale to _b
+      void addToB(const EdgeTerm& term, number_t scale);
+      //! solve for the increment and set the estimate of the vertices
+      bool solveAndUpdate();
+      //! re-linearize the variables which moved too far away from their linearization point
+      bool relinearize();
+
+      Property<number_t>* _relinearizeThreshold;
+      Property<number_t>* _wildfireThreshold;
+      Property<int>* _batchEveryN;
+      Property<number_t>* _maxFillGrowth;
+
+      IncrementalCholesky _factor;
+      std::vector<Variable> _variables;
+      std::unordered_map<const OptimizableGraph::Vertex*, int> _variableIndex;
+      std::unordered_map<OptimizableGraph::Edge*, EdgeTerm> _terms;
+      std::vector<int> _blockVariables; ///< the variable of each block of the factor
+      VectorX _b;                       ///< right hand side in the order of the factor
+      VectorX _x;                       ///< increment of the variables w.r.t. their linearization point
+      std::vector<int> _rhsChanged;     ///< blocks of _b which changed since the last solve
+      std::vector<int> _changedBlocks;  ///< blocks of _x which were re-computed by the last solve
+      std::vector<int> _candidates;     ///< variables whose increment changed since the last re-linearization
+      std::vector<bool> _isCandidate;
+
+      bool _batchRequired;
+      int _updatesSinceBatch;
+      size_t _nonZerosAfterBatch;
+      int _numRelinearized;
+
+      // scratch memory for the quadratic form of an edge
+      std::vector<MatrixX> _vertexHessians;
+      std::vector<MatrixX> _edgeHessians;
+      MatrixX _U;
+  };
+
+} // end namespace
+
+#endif
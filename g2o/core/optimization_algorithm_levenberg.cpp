@@ -33,6 +33,7 @@
 #include "sparse_optimizer.h"
 #include "solver.h"
 #include "batch_stats.h"
+#include "parallel_reduction.h"
 using namespace std;
 
 namespace g2o {
@@ -68,21 +69,16 @@ namespace g2o {
       }
     }
 
-    number_t t=get_monotonic_time();
-    _optimizer->computeActiveErrors();
-    G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-    if (globalStats) {
-      globalStats->timeResiduals = get_monotonic_time()-t;
-      t=get_monotonic_time();
-    }
-
-    number_t currentChi = _optimizer->activeRobustChi2();
+    BatchStatisticsTimer residualsTimer(_optimizer->currentBatchStatistics(), &G2OBatchStatistics::timeResiduals);
+    number_t currentChi = _optimizer->computeActiveErrorsAndRobustChi2();
     number_t tempChi=currentChi;
+    residualsTimer.stop();
+
+    BatchStatisticsTimer quadraticFormTimer(_optimizer->currentBatchStatistics(), &G2OBatchStatistics::timeQuadraticForm);
 
     _solver.buildSystem();
-    if (globalStats) {
-      globalStats->timeQuadraticForm = get_monotonic_time()-t;
-    }
+    quadraticFormTimer.stop();
+    G2OBatchStatistics* stats = _optimizer->currentBatchStatistics();
 
     // core part of the Levenbarg algorithm
     if (iteration == 0) {
@@ -95,27 +91,23 @@ namespace g2o {
     qmax = 0;
     do {
       _optimizer->push();
-      if (globalStats) {
-        globalStats->levenbergIterations++;
-        t=get_monotonic_time();
+      if (stats) {
+        stats->levenbergIterations++;
       }
       // update the diagonal of the system matrix
+      BatchStatisticsTimer linearSolutionTimer(_optimizer->currentBatchStatistics(), &G2OBatchStatistics::timeLinearSolution, true);
       _solver.setLambda(_currentLambda, true);
       bool ok2 = _solver.solve();
-      if (globalStats) {
-        globalStats->timeLinearSolution+=get_monotonic_time()-t;
-        t=get_monotonic_time();
-      }
+      linearSolutionTimer.stop();
+
+      BatchStatisticsTimer updateTimer(_optimizer->currentBatchStatistics(), &G2OBatchStatistics::timeUpdate);
       _optimizer->update(_solver.x());
-      if (globalStats) {
-        globalStats->timeUpdate = get_monotonic_time()-t;
-      }
+      updateTimer.stop();
 
       // restore the diagonal
       _solver.restoreDiagonal();
 
-      _optimizer->computeActiveErrors();
-      tempChi = _optimizer->activeRobustChi2();
+      tempChi = _optimizer->computeActiveErrorsAndRobustChi2();
 
       if (! ok2)
         tempChi=std::numeric_limits<number_t>::max();
@@ -153,25 +145,29 @@ namespace g2o {
   {
     if (_userLambdaInit->value() > 0)
       return _userLambdaInit->value();
-    number_t maxDiagonal=0;
-    for (size_t k = 0; k < _optimizer->indexMapping().size(); k++) {
-      OptimizableGraph::Vertex* v = _optimizer->indexMapping()[k];
-      assert(v);
-      int dim = v->dimension();
-      for (int j = 0; j < dim; ++j){
-        maxDiagonal = std::max(fabs(v->hessian(j,j)),maxDiagonal);
-      }
-    }
+    const SparseOptimizer::VertexContainer& vertices = _optimizer->indexMapping();
+    number_t maxDiagonal = orderedParallelReduce<number_t>(static_cast<int>(vertices.size()), 0.,
+        [&vertices](int k) {
+          OptimizableGraph::Vertex* v = vertices[k];
+          assert(v);
+          number_t vertexMax = 0;
+          int dim = v->dimension();
+          for (int j = 0; j < dim; ++j){
+            vertexMax = std::max(fabs(v->hessian(j,j)),vertexMax);
+          }
+          return vertexMax;
+        },
+        [](number_t a, number_t b) { return std::max(a, b);});
     return _tau*maxDiagonal;
   }
 
   number_t OptimizationAlgorithmLevenberg::computeScale() const
   {
-    number_t scale = 0;
-    for (size_t j=0; j < _solver.vectorSize(); j++){
-      scale += _solver.x()[j] * (_currentLambda * _solver.x()[j] + _solver.b()[j]);
-    }
-    return scale;
+    const number_t* x = _solver.x();
+    const number_t* b = _solver.b();
+    const number_t lambda = _currentLambda;
+    return orderedParallelSum<number_t>(static_cast<int>(_solver.vectorSize()),
+        [x, b, lambda](int j) { return x[j] * (lambda * x[j] + b[j]);});
   }
 
   void OptimizationAlgorithmLevenberg::setMaxTrialsAfterFailure(int max_trials)
@@ -89,9 +89,20 @@ namespace g2o {
 
   bool OptimizationAlgorithmWithHessian::updateStructure(const std::vector<HyperGraph::Vertex*>& vset, const HyperGraph::EdgeSet& edges)
   {
+    // without a structure, e.g., before the first optimize(), init() builds it from scratch
+    if (! _solver.optimizer())
+      return true;
     return _solver.updateStructure(vset, edges);
   }
 
+  bool OptimizationAlgorithmWithHessian::removeFromStructure(const std::vector<HyperGraph::Vertex*>& vset, const HyperGraph::EdgeSet& edges)
+  {
+    // without a structure, e.g., before the first optimize(), init() builds it from scratch
+    if (! _solver.optimizer())
+      return true;
+    return _solver.removeFromStructure(vset, edges);
+  }
+
   void OptimizationAlgorithmWithHessian::setWriteDebug(bool writeDebug)
   {
     _writeDebug->setValue(writeDebug);
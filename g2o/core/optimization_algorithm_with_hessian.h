@@ -53,6 +53,8 @@ namespace g2o {
 
       virtual bool updateStructure(const std::vector<HyperGraph::Vertex*>& vset, const HyperGraph::EdgeSet& edges);
 
+      virtual bool removeFromStructure(const std::vector<HyperGraph::Vertex*>& vset, const HyperGraph::EdgeSet& edges);
+
       //! return the underlying solver used to solve the linear system
       Solver& solver() { return _solver;}
 
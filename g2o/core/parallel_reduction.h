@@ -0,0 +1,84 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_PARALLEL_REDUCTION_H
+#define G2O_PARALLEL_REDUCTION_H
+
+#include <algorithm>
+#include <vector>
+
+#include "g2o/config.h"
+
+namespace g2o {
+
+  /**
+   * Reduce f(0), ..., f(n-1) by op, starting from identity. The elements are
+   * reduced in blocks of a fixed size, the blocks are processed in parallel
+   * and their results are combined in the order of the blocks. Hence, the
+   * result does not depend on the number of threads and it is the same with
+   * and without OpenMP, which would not be the case for a reduction clause on
+   * floating point numbers.
+   */
+  template <typename T, typename ElementFunction, typename ReduceOp>
+  T orderedParallelReduce(int n, T identity, ElementFunction f, ReduceOp op)
+  {
+    const int blockSize = 256;
+    const int numBlocks = (n + blockSize - 1) / blockSize;
+    if (numBlocks <= 1) {
+      T result = identity;
+      for (int i = 0; i < n; ++i)
+        result = op(result, f(i));
+      return result;
+    }
+
+    std::vector<T> blockResults(numBlocks, identity);
+#   ifdef G2O_OPENMP
+#   pragma omp parallel for default (shared) schedule(dynamic) if (numBlocks > 2)
+#   endif
+    for (int b = 0; b < numBlocks; ++b) {
+      T blockResult = identity;
+      const int end = std::min(n, (b + 1) * blockSize);
+      for (int i = b * blockSize; i < end; ++i)
+        blockResult = op(blockResult, f(i));
+      blockResults[b] = blockResult;
+    }
+
+    T result = identity;
+    for (int b = 0; b < numBlocks; ++b)
+      result = op(result, blockResults[b]);
+    return result;
+  }
+
+  //! sum of f(0), ..., f(n-1) computed by orderedParallelReduce()
+  template <typename T, typename ElementFunction>
+  T orderedParallelSum(int n, ElementFunction f)
+  {
+    return orderedParallelReduce(n, T(0), f, [](T a, T b) { return a + b;});
+  }
+
+} // end namespace
+
+#endif
@@ -26,6 +26,8 @@
 
 #include "robust_kernel.h"
 
+#include <cmath>
+
 namespace g2o {
 
 RobustKernel::RobustKernel() :
@@ -43,4 +45,14 @@ void RobustKernel::setDelta(number_t delta)
   _delta = delta;
 }
 
+number_t RobustKernel::squaredDelta() const
+{
+  return _delta * _delta;
+}
+
+void RobustKernel::setSquaredDelta(number_t squaredDelta)
+{
+  setDelta(std::sqrt(squaredDelta));
+}
+
 } // end namespace g2o
@@ -68,6 +68,16 @@ namespace g2o {
       virtual void setDelta(number_t delta);
       number_t delta() const { return _delta;}
 
+      /**
+       * the squared error at which the kernel starts to treat errors as
+       * outliers, i.e., delta^2 for the kernels whose delta is a bound on the
+       * error and delta for the ones whose delta is given in units of the
+       * squared error.
+       */
+      virtual number_t squaredDelta() const;
+      //! set delta such that squaredDelta() returns the argument
+      virtual void setSquaredDelta(number_t squaredDelta);
+
     protected:
       number_t _delta;
   };
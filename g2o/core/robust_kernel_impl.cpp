@@ -106,6 +106,16 @@ void RobustKernelGemanMcClure::robustify(number_t e2, Vector3& rho) const
   rho[2] = -2. * rho[1] * aux;
 }
 
+number_t RobustKernelGemanMcClure::squaredDelta() const
+{
+  return _delta;
+}
+
+void RobustKernelGemanMcClure::setSquaredDelta(number_t squaredDelta)
+{
+  setDelta(squaredDelta);
+}
+
 void RobustKernelWelsch::robustify(number_t e2, Vector3& rho) const
 {
   const number_t dsqr = _delta * _delta;
@@ -169,6 +179,16 @@ void RobustKernelDCS::robustify(number_t e2, Vector3& rho) const
   rho[2] = 0;
 }
 
+number_t RobustKernelDCS::squaredDelta() const
+{
+  return _delta;
+}
+
+void RobustKernelDCS::setSquaredDelta(number_t squaredDelta)
+{
+  setDelta(squaredDelta);
+}
+
 // register the kernel to their factory
 G2O_REGISTER_ROBUST_KERNEL(Huber, RobustKernelHuber)
 G2O_REGISTER_ROBUST_KERNEL(PseudoHuber, RobustKernelPseudoHuber)
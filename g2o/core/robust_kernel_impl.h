@@ -124,6 +124,9 @@ namespace g2o {
   {
     public:
       virtual void robustify(number_t e2, Vector3& rho) const;
+      //! delta is given in units of the squared error
+      virtual number_t squaredDelta() const;
+      virtual void setSquaredDelta(number_t squaredDelta);
   };
 
   /**
@@ -194,6 +197,9 @@ namespace g2o {
   {
     public:
       virtual void robustify(number_t e2, Vector3& rho) const;
+      //! phi is given in units of the squared error
+      virtual number_t squaredDelta() const;
+      virtual void setSquaredDelta(number_t squaredDelta);
   };
 } // end namespace g2o
 
@@ -0,0 +1,267 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_SMALL_PROBLEM_SOLVER_H
+#define G2O_SMALL_PROBLEM_SOLVER_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/Cholesky>
+
+#include "g2o/config.h"
+#include "g2o/stuff/misc.h"
+#include "optimizable_graph.h"
+#include "jacobian_workspace.h"
+#include "robust_kernel.h"
+
+#ifdef G2O_OPENMP
+#include <omp.h>
+#endif
+
+namespace g2o {
+
+  /**
+   * \brief a problem solved by SmallProblemSolver, a vertex along with unary edges on it
+   */
+  template <typename VertexType>
+  struct SmallProblem
+  {
+    VertexType* vertex;
+    std::vector<OptimizableGraph::Edge*> edges; ///< unary edges, vertex(0) is the vertex of the problem
+    int iterations;                             ///< iterations carried out by the last solve
+    number_t chi2;                              ///< robust chi2 of the edges of the level after the last solve
+    SmallProblem() : vertex(0), iterations(0), chi2(0.) {}
+  };
+
+  /**
+   * \brief Levenberg-Marquardt on many small independent problems, e.g., pose-only refinement
+   *
+   * Each problem consists of one vertex and unary edges on it, e.g.,
+   * EdgeSE3ProjectXYZOnlyPose and EdgeStereoSE3ProjectXYZOnlyPose on a
+   * VertexSE3Expmap. The problems are solved without a SparseOptimizer: the
+   * edges accumulate their quadratic form by constructQuadraticForm() into a
+   * fixed size matrix of the solver, which is mapped as the Hessian of the
+   * vertex, and the damped system is solved by a fixed size LLT. The
+   * Levenberg-Marquardt steps follow OptimizationAlgorithmLevenberg. Apart
+   * from growing the Jacobian workspaces of the threads, solving does not
+   * allocate memory, and solve() distributes a batch of problems over the
+   * threads.
+   *
+   * As for SparseOptimizer::initializeOptimization(level), only the edges
+   * of level() are taken into account. The edges are not part of a graph,
+   * hence they must not depend on parameters.
+   */
+  template <typename VertexType>
+  class SmallProblemSolver
+  {
+    public:
+      static const int Dimension = VertexType::Dimension;
+      typedef SmallProblem<VertexType> Problem;
+      typedef Eigen::Matrix<number_t, Dimension, Dimension, Eigen::ColMajor> HessianType;
+      typedef Eigen::Matrix<number_t, Dimension, 1, Eigen::ColMajor> VectorType;
+      typedef typename VertexType::EstimateType EstimateType;
+
+      SmallProblemSolver() :
+        _iterations(10), _level(0), _maxTrialsAfterFailure(10), _tau(cst(1e-5)), _maxEdgeDimension(0)
+      {
+        static_assert(Dimension > 0, "SmallProblemSolver requires a vertex of fixed dimension");
+      }
+
+      //! iterations of Levenberg-Marquardt for each problem
+      int iterations() const { return _iterations;}
+      void setIterations(int iterations) { _iterations = iterations;}
+
+      //! only the edges of this level are optimized
+      int level() const { return _level;}
+      void setLevel(int level) { _level = level;}
+
+      //! failed steps with increased damping before giving up on a problem
+      int maxTrialsAfterFailure() const { return _maxTrialsAfterFailure;}
+      void setMaxTrialsAfterFailure(int trials) { _maxTrialsAfterFailure = trials;}
+
+      //! the initial damping is tau times the largest element on the diagonal of the Hessian
+      number_t tau() const { return _tau;}
+      void setTau(number_t tau) { _tau = tau;}
+
+      //! solve the problems, which are distributed over the threads
+      void solve(std::vector<Problem>& problems)
+      {
+        allocateWorkspaces(problems.data(), problems.data() + problems.size());
+#       ifdef G2O_OPENMP
+#       pragma omp parallel for default (shared) schedule(dynamic, 4) if (problems.size() > 1)
+#       endif
+        for (int i = 0; i < static_cast<int>(problems.size()); ++i)
+          solveProblem(problems[i], _workspaces[threadId()]);
+      }
+
+      //! solve a single problem
+      void solve(Problem& problem)
+      {
+        allocateWorkspaces(&problem, &problem + 1);
+        solveProblem(problem, _workspaces[0]);
+      }
+
+    protected:
+      static int threadId()
+      {
+#       ifdef G2O_OPENMP
+        return omp_get_thread_num();
+#       else
+        return 0;
+#       endif
+      }
+
+      //! grow the workspaces of the threads to the largest Jacobian of the problems
+      void allocateWorkspaces(const Problem* begin, const Problem* end)
+      {
+        int numThreads = 1;
+#       ifdef G2O_OPENMP
+        numThreads = omp_get_max_threads();
+#       endif
+        int maxEdgeDimension = _maxEdgeDimension;
+        for (const Problem* p = begin; p != end; ++p)
+          for (size_t k = 0; k < p->edges.size(); ++k)
+            maxEdgeDimension = std::max(maxEdgeDimension, p->edges[k]->dimension());
+        if (maxEdgeDimension == _maxEdgeDimension && static_cast<int>(_workspaces.size()) >= numThreads)
+          return;
+        _maxEdgeDimension = maxEdgeDimension;
+        _workspaces.resize(std::max(numThreads, static_cast<int>(_workspaces.size())));
+        for (size_t t = 0; t < _workspaces.size(); ++t) {
+          _workspaces[t].updateSize(1, _maxEdgeDimension * Dimension);
+          _workspaces[t].allocate();
+        }
+      }
+
+      //! compute the errors of the edges and return the robust chi2 of the problem
+      number_t computeChi2(Problem& problem) const
+      {
+        number_t chi = 0.;
+        for (size_t k = 0; k < problem.edges.size(); ++k) {
+          OptimizableGraph::Edge* e = problem.edges[k];
+          if (e->level() != _level)
+            continue;
+          e->computeError();
+          if (e->robustKernel()) {
+            Vector3 rho;
+            e->robustKernel()->robustify(e->chi2(), rho);
+            chi += rho[0];
+          } else {
+            chi += e->chi2();
+          }
+        }
+        return chi;
+      }
+
+      void solveProblem(Problem& problem, JacobianWorkspace& workspace) const
+      {
+        VertexType* v = problem.vertex;
+        problem.iterations = 0;
+        number_t currentChi = computeChi2(problem);
+        if (v->fixed()) {
+          problem.chi2 = currentChi;
+          return;
+        }
+
+        // the edges write their quadratic form into H through the vertex
+        HessianType H;
+        number_t* hessianData = v->hessianData();
+        v->mapHessianMemory(H.data());
+
+        number_t lambda = 0.;
+        number_t ni = 2.;
+        bool rejected = false;
+        for (int iteration = 0; iteration < _iterations; ++iteration) {
+          H.setZero();
+          v->clearQuadraticForm();
+          for (size_t k = 0; k < problem.edges.size(); ++k) {
+            OptimizableGraph::Edge* e = problem.edges[k];
+            if (e->level() != _level)
+              continue;
+            e->linearizeOplus(workspace);
+            e->constructQuadraticForm();
+          }
+          const VectorType b = v->b();
+          if (iteration == 0)
+            lambda = _tau * H.diagonal().cwiseAbs().maxCoeff();
+
+          number_t rho = 0.;
+          int trials = 0;
+          do {
+            HessianType A = H;
+            A.diagonal().array() += lambda;
+            Eigen::LLT<HessianType> llt(A);
+            VectorType dx = llt.solve(b);
+            EstimateType backup = v->estimate();
+            v->oplus(dx.data());
+            number_t tempChi = llt.info() == Eigen::Success ? computeChi2(problem) : std::numeric_limits<number_t>::max();
+
+            rho = (currentChi - tempChi) / (dx.dot(lambda * dx + b) + cst(1e-3));
+            if (rho > 0 && g2o_isfinite(tempChi)) { // the step was good
+              number_t alpha = 1. - std::pow(2 * rho - 1, 3);
+              lambda *= std::max(cst(1.) / 3, std::min(alpha, cst(2.) / 3));
+              ni = 2.;
+              currentChi = tempChi;
+              rejected = false;
+            } else {
+              lambda *= ni;
+              ni *= 2.;
+              v->setEstimate(backup);
+              rejected = true;
+              if (! g2o_isfinite(lambda))
+                break;
+            }
+            ++trials;
+          } while (rho < 0 && trials < _maxTrialsAfterFailure);
+          ++problem.iterations;
+
+          if (trials == _maxTrialsAfterFailure || rho == 0 || ! g2o_isfinite(lambda))
+            break;
+        }
+        // the errors of the edges refer to the final estimate
+        if (rejected)
+          currentChi = computeChi2(problem);
+        problem.chi2 = currentChi;
+        v->mapHessianMemory(hessianData);
+      }
+
+      int _iterations;
+      int _level;
+      int _maxTrialsAfterFailure;
+      number_t _tau;
+      int _maxEdgeDimension;
+      std::vector<JacobianWorkspace> _workspaces; ///< one for each thread
+
+    public:
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+} // end namespace
+
+#endif
@@ -61,6 +61,11 @@ namespace g2o {
        * update the structures for online processing
        */
       virtual bool updateStructure(const std::vector<HyperGraph::Vertex*>& vset, const HyperGraph::EdgeSet& edges) = 0;
+      /**
+       * remove vertices and edges from the structures for online processing.
+       * Returns false if not supported by the solver.
+       */
+      virtual bool removeFromStructure(const std::vector<HyperGraph::Vertex*>& vset, const HyperGraph::EdgeSet& edges) { (void) vset; (void) edges; return false;}
       /**
        * build the current system
        */
@@ -37,6 +37,7 @@
 #include <memory>
 
 #include "sparse_block_matrix_ccs.h"
+#include "sparse_block_matrix_arena.h"
 #include "matrix_structure.h"
 #include "matrix_operations.h"
 #include "g2o/config.h"
@@ -90,10 +91,43 @@ class SparseBlockMatrix {
 
     ~SparseBlockMatrix();
 
+    //! take over the blocks of other, the blocks formerly owned by this matrix are released
+    SparseBlockMatrix& operator=(SparseBlockMatrix&& other);
+
     
     //! this zeroes all the blocks. If dealloc=true the blocks are removed from memory
     void clear(bool dealloc=false) ;
 
+    /**
+     * remove block rows and block columns. The block row r is dropped if rowMapping[r] is -1,
+     * otherwise it becomes the block row rowMapping[r], the same holds for the columns. The
+     * mappings have to preserve the order of the remaining blocks. The remaining blocks keep
+     * their memory, in arena mode the slots of the removed blocks are reused by the next
+     * allocations of the same block size.
+     */
+    void removeBlocks(const std::vector<int>& rowMapping, const std::vector<int>& colMapping);
+
+    /**
+     * allocate the blocks within a few contiguous slabs instead of one heap
+     * allocation per block. Has to be set before the first block is allocated.
+     * In this mode all blocks in blockCols() are owned by the arena, i.e.,
+     * blocks must not be inserted or removed by directly modifying the block columns.
+     *
+     * Only the coefficients are moved into the arena, the index of the blocks
+     * is still the per column std::map returned by blockCols(), i.e., there is
+     * one tree node per block. blockCols() is the interface all the linear
+     * solvers iterate and modify the pattern through, a flat CSC index would
+     * require to change all of them. Solvers which need a flat index build it
+     * once per structure, see SparseBlockMatrixCCS.
+     */
+    void setArenaStorage(bool arenaStorage);
+    //! true, if the blocks are stored in an arena
+    bool arenaStorage() const { return _arena != nullptr;}
+    //! the arena holding the blocks, 0 if the blocks are allocated one by one
+    const SparseBlockMatrixArena<MatrixType>* arena() const { return _arena.get();}
+    //! in arena mode, reserve memory for numBlocks blocks within a single slab
+    void reserveBlocks(size_t numBlocks);
+
     //! returns the block at location r,c. if alloc=true he block is created if it does not exist
     SparseMatrixBlock* block(int r, int c, bool alloc=false);
     //! returns the block at location r,c
@@ -115,6 +149,8 @@ class SparseBlockMatrix {
     size_t nonZeros() const; 
     //! number of allocated blocks
     size_t nonZeroBlocks() const; 
+    //! number of heap allocations holding the blocks
+    size_t numAllocations() const;
 
     //! deep copy of a sparse-block-matrix;
     SparseBlockMatrix* clone() const ;
@@ -222,8 +258,14 @@ class SparseBlockMatrix {
     //! and the block column is stored as a map row_block -> matrix_block_ptr.
     std::vector <IntBlockMap> _blockCols;
     bool _hasStorage;
+    std::unique_ptr<SparseBlockMatrixArena<MatrixType> > _arena; ///< storage of the blocks in arena mode
 
   private:
+    //! allocate the memory for the block r,c without inserting it into the block columns
+    SparseMatrixBlock* allocateBlock(int r, int c);
+    //! free a block obtained by allocateBlock()
+    void freeBlock(SparseMatrixBlock* b);
+
     template <class MatrixTransposedType>
     void transpose_internal(SparseBlockMatrix<MatrixTransposedType>& dest) const;
 
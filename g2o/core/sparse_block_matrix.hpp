@@ -65,6 +65,16 @@ namespace g2o {
 
   template <class MatrixType>
   void SparseBlockMatrix<MatrixType>::clear(bool dealloc) {
+    if (_arena) {
+      if (_hasStorage && dealloc) {
+        for (size_t i=0; i < _blockCols.size(); ++i)
+          _blockCols[i].clear();
+        _arena->release();
+      } else {
+        _arena->setZero();
+      }
+      return;
+    }
 #   ifdef G2O_OPENMP
 #   pragma omp parallel for default (shared) if (_blockCols.size() > 100)
 #   endif
@@ -81,12 +91,107 @@ namespace g2o {
     }
   }
 
+  template <class MatrixType>
+  void SparseBlockMatrix<MatrixType>::removeBlocks(const std::vector<int>& rowMapping, const std::vector<int>& colMapping) {
+    assert(rowMapping.size() == _rowBlockIndices.size() && colMapping.size() == _colBlockIndices.size());
+    // the first block row which is removed or moved, the rows above keep their index
+    int firstChangedRow = rowMapping.size();
+    for (size_t r = 0; r < rowMapping.size(); ++r)
+      if (rowMapping[r] != static_cast<int>(r)) {
+        firstChangedRow = r;
+        break;
+      }
+
+    std::vector<int> rowBlockIndices;
+    for (size_t r = 0; r < rowMapping.size(); ++r)
+      if (rowMapping[r] >= 0)
+        rowBlockIndices.push_back((rowBlockIndices.empty() ? 0 : rowBlockIndices.back()) + rowsOfBlock(r));
+    std::vector<int> colBlockIndices;
+    for (size_t c = 0; c < colMapping.size(); ++c)
+      if (colMapping[c] >= 0)
+        colBlockIndices.push_back((colBlockIndices.empty() ? 0 : colBlockIndices.back()) + colsOfBlock(c));
+
+    size_t numCols = 0;
+    for (size_t c = 0; c < _blockCols.size(); ++c) {
+      IntBlockMap& column = _blockCols[c];
+      if (colMapping[c] < 0) {
+        if (_hasStorage)
+          for (typename IntBlockMap::const_iterator it = column.begin(); it != column.end(); ++it)
+            freeBlock(it->second);
+        continue;
+      }
+      assert(colMapping[c] == static_cast<int>(numCols) && "the mapping has to preserve the order");
+      if (column.empty() || column.rbegin()->first < firstChangedRow) {
+        if (numCols != c)
+          _blockCols[numCols].swap(column);
+        ++numCols;
+        continue;
+      }
+      IntBlockMap renumbered;
+      for (typename IntBlockMap::const_iterator it = column.begin(); it != column.end(); ++it) {
+        int r = rowMapping[it->first];
+        if (r >= 0)
+          renumbered.insert(renumbered.end(), std::make_pair(r, it->second));
+        else if (_hasStorage)
+          freeBlock(it->second);
+      }
+      _blockCols[numCols++].swap(renumbered);
+    }
+    _blockCols.resize(numCols);
+    _rowBlockIndices.swap(rowBlockIndices);
+    _colBlockIndices.swap(colBlockIndices);
+  }
+
   template <class MatrixType>
   SparseBlockMatrix<MatrixType>::~SparseBlockMatrix(){
     if (_hasStorage)
       clear(true);
   }
 
+  template <class MatrixType>
+  SparseBlockMatrix<MatrixType>& SparseBlockMatrix<MatrixType>::operator=(SparseBlockMatrix<MatrixType>&& other){
+    std::swap(_rowBlockIndices, other._rowBlockIndices);
+    std::swap(_colBlockIndices, other._colBlockIndices);
+    std::swap(_blockCols, other._blockCols);
+    std::swap(_hasStorage, other._hasStorage);
+    std::swap(_arena, other._arena);
+    return *this;
+  }
+
+  template <class MatrixType>
+  void SparseBlockMatrix<MatrixType>::setArenaStorage(bool arenaStorage) {
+    if (arenaStorage == (_arena != nullptr))
+      return;
+    assert(nonZeroBlocks() == 0 && "storage mode can only be changed on an empty matrix");
+    if (arenaStorage)
+      _arena.reset(new SparseBlockMatrixArena<MatrixType>());
+    else
+      _arena.reset();
+  }
+
+  template <class MatrixType>
+  void SparseBlockMatrix<MatrixType>::reserveBlocks(size_t numBlocks) {
+    if (_arena)
+      _arena->reserve(numBlocks);
+  }
+
+  template <class MatrixType>
+  typename SparseBlockMatrix<MatrixType>::SparseMatrixBlock* SparseBlockMatrix<MatrixType>::allocateBlock(int r, int c) {
+    int rb=rowsOfBlock(r);
+    int cb=colsOfBlock(c);
+    if (_arena)
+      return _arena->allocate(rb, cb);
+    return new typename SparseBlockMatrix<MatrixType>::SparseMatrixBlock(rb,cb);
+  }
+
+  template <class MatrixType>
+  void SparseBlockMatrix<MatrixType>::freeBlock(SparseMatrixBlock* b) {
+    if (_arena)
+      _arena->deallocate(b);
+    else
+      delete b;
+  }
+
   template <class MatrixType>
   typename SparseBlockMatrix<MatrixType>::SparseMatrixBlock* SparseBlockMatrix<MatrixType>::block(int r, int c, bool alloc) {
     typename SparseBlockMatrix<MatrixType>::IntBlockMap::iterator it =_blockCols[c].find(r);
@@ -95,9 +200,7 @@ namespace g2o {
       if (!_hasStorage && ! alloc )
         return 0;
       else {
-        int rb=rowsOfBlock(r);
-        int cb=colsOfBlock(c);
-        _block=new typename SparseBlockMatrix<MatrixType>::SparseMatrixBlock(rb,cb);
+        _block=allocateBlock(r, c);
         _block->setZero();
         std::pair < typename SparseBlockMatrix<MatrixType>::IntBlockMap::iterator, bool> result
           =_blockCols[c].insert(std::make_pair(r,_block)); (void) result;
@@ -390,6 +493,15 @@ namespace g2o {
     return count;
   }
 
+  template <class MatrixType>
+  size_t SparseBlockMatrix<MatrixType>::numAllocations() const {
+    // dynamic blocks allocate their coefficients separately
+    size_t coefficientAllocations = MatrixType::SizeAtCompileTime == Eigen::Dynamic ? nonZeroBlocks() : 0;
+    if (_arena)
+      return _arena->numSlabs() + coefficientAllocations;
+    return nonZeroBlocks() + coefficientAllocations;
+  }
+
   template <class MatrixType>
   size_t SparseBlockMatrix<MatrixType>::nonZeros() const{
     if (MatrixType::SizeAtCompileTime != Eigen::Dynamic) {
@@ -662,6 +774,12 @@ namespace g2o {
     // exploiting that we are inserting a sorted structure
     typedef std::pair<int, MatrixType*> SparseColumnPair;
     typedef typename SparseBlockMatrixHashMap<MatrixType>::SparseColumn HashSparseColumn;
+    if (_arena) {
+      size_t numBlocks = 0;
+      for (size_t i = 0; i < hashMatrix.blockCols().size(); ++i)
+        numBlocks += hashMatrix.blockCols()[i].size();
+      _arena->reserve(numBlocks);
+    }
     for (size_t i = 0; i < hashMatrix.blockCols().size(); ++i) {
       // prepare a temporary vector for sorting
       HashSparseColumn& column = hashMatrix.blockCols()[i];
@@ -675,6 +793,19 @@ namespace g2o {
       // try to free some memory early
       HashSparseColumn aux;
       std::swap(aux, column);
+      // allocate the blocks which have been added as pattern only, in arena
+      // mode the blocks are moved into the arena
+      for (size_t j = 0; j < sparseRowSorted.size(); ++j) {
+        MatrixType*& b = sparseRowSorted[j].second;
+        if (b && ! _arena)
+          continue;
+        MatrixType* m = allocateBlock(sparseRowSorted[j].first, static_cast<int>(i));
+        if (b) {
+          *m = *b;
+          delete b;
+        }
+        b = m;
+      }
       // now insert sorted vector to the std::map structure
       IntBlockMap& destColumnMap = blockCols()[i];
       destColumnMap.insert(sparseRowSorted[0]);
@@ -0,0 +1,182 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_SPARSE_BLOCK_MATRIX_ARENA_H
+#define G2O_SPARSE_BLOCK_MATRIX_ARENA_H
+
+#include <vector>
+#include <map>
+#include <cassert>
+#include <algorithm>
+#include <Eigen/Core>
+
+#include "g2o/config.h"
+#include "dynamic_aligned_buffer.hpp"
+
+namespace g2o {
+
+  /**
+   * \brief Slab storage for the blocks of a SparseBlockMatrix
+   *
+   * The blocks are constructed in place within a few large aligned
+   * slabs instead of being allocated one by one on the heap.  A block
+   * never moves once it has been handed out, hence pointers to its
+   * memory (as used by mapHessianMemory()) stay valid until release()
+   * is called. For fixed size blocks the coefficients of all blocks
+   * are stored contiguously, for dynamic blocks only the matrix
+   * headers live in the slabs. Blocks returned by deallocate() are kept
+   * on a free list per block size and handed out again by allocate().
+   */
+  template <class MatrixType>
+  class SparseBlockMatrixArena
+  {
+    public:
+      explicit SparseBlockMatrixArena(size_t slabSize = 1024) :
+        _slabSize(std::max<size_t>(slabSize, 1)), _numBlocks(0), _numFreeBlocks(0)
+      {}
+
+      ~SparseBlockMatrixArena()
+      {
+        release();
+      }
+
+      /**
+       * make sure that the next numBlocks allocations are served from a
+       * single slab.
+       */
+      void reserve(size_t numBlocks)
+      {
+        if (! _slabs.empty() && _slabs.back().capacity - _slabs.back().used >= numBlocks)
+          return;
+        addSlab(numBlocks);
+      }
+
+      //! construct a new block of size rows x cols within the arena, the block is not initialized
+      MatrixType* allocate(int rows, int cols)
+      {
+        typename FreeBlockMap::iterator freeIt = _freeBlocks.find(std::make_pair(rows, cols));
+        if (freeIt != _freeBlocks.end() && ! freeIt->second.empty()) {
+          MatrixType* m = freeIt->second.back();
+          freeIt->second.pop_back();
+          --_numFreeBlocks;
+          return m;
+        }
+        if (_slabs.empty() || _slabs.back().used == _slabs.back().capacity)
+          addSlab(_slabs.empty() ? _slabSize : std::max(_slabSize, _numBlocks)); // grow geometrically
+        Slab& slab = _slabs.back();
+        MatrixType* m = new (slab.data + slab.used) MatrixType(rows, cols);
+        ++slab.used;
+        ++_numBlocks;
+        return m;
+      }
+
+      /**
+       * return a block to the arena, its slot is reused by the next
+       * allocate() of the same size. The block stays constructed until
+       * release() is called.
+       */
+      void deallocate(MatrixType* m)
+      {
+        assert(owns(m) && "the block was not allocated by this arena");
+        _freeBlocks[std::make_pair(static_cast<int>(m->rows()), static_cast<int>(m->cols()))].push_back(m);
+        ++_numFreeBlocks;
+      }
+
+      //! destroy all the blocks and free the slabs
+      void release()
+      {
+        for (size_t i = 0; i < _slabs.size(); ++i) {
+          Slab& slab = _slabs[i];
+          for (size_t j = 0; j < slab.used; ++j)
+            slab.data[j].~MatrixType();
+          free_aligned(slab.data);
+        }
+        _slabs.clear();
+        _freeBlocks.clear();
+        _numBlocks = 0;
+        _numFreeBlocks = 0;
+      }
+
+      //! set all the allocated blocks to zero by a linear sweep over the slabs
+      void setZero()
+      {
+        for (size_t i = 0; i < _slabs.size(); ++i) {
+          Slab& slab = _slabs[i];
+          for (size_t j = 0; j < slab.used; ++j)
+            slab.data[j].setZero();
+        }
+      }
+
+      //! true, if the block has been allocated by this arena
+      bool owns(const MatrixType* m) const
+      {
+        for (size_t i = 0; i < _slabs.size(); ++i) {
+          const Slab& slab = _slabs[i];
+          if (m >= slab.data && m < slab.data + slab.used)
+            return true;
+        }
+        return false;
+      }
+
+      //! number of blocks constructed within the arena, including the free ones
+      size_t numBlocks() const { return _numBlocks;}
+      //! number of blocks waiting on the free list to be reused
+      size_t numFreeBlocks() const { return _numFreeBlocks;}
+      //! number of slabs, i.e., heap allocations, the arena currently holds
+      size_t numSlabs() const { return _slabs.size();}
+
+    protected:
+      struct Slab
+      {
+        MatrixType* data;
+        size_t capacity;
+        size_t used;
+      };
+      typedef std::map<std::pair<int, int>, std::vector<MatrixType*> > FreeBlockMap;
+
+      void addSlab(size_t capacity)
+      {
+        Slab slab;
+        slab.data = allocate_aligned<MatrixType>(capacity);
+        slab.capacity = capacity;
+        slab.used = 0;
+        _slabs.push_back(slab);
+      }
+
+      size_t _slabSize;           ///< number of blocks of the first slab
+      size_t _numBlocks;          ///< number of blocks constructed in the slabs
+      size_t _numFreeBlocks;      ///< number of blocks on the free lists
+      std::vector<Slab> _slabs;
+      FreeBlockMap _freeBlocks;   ///< deallocated blocks by their size
+
+    private:
+      SparseBlockMatrixArena(const SparseBlockMatrixArena&);
+      SparseBlockMatrixArena& operator=(const SparseBlockMatrixArena&);
+  };
+
+} //end namespace
+
+#endif
@@ -255,7 +255,7 @@ namespace g2o {
         assert(c <(int)_blockCols.size() && "accessing column which is not available");
         SparseColumn& sparseColumn = _blockCols[c];
         typename SparseColumn::iterator foundIt = sparseColumn.find(r);
-        if (foundIt == sparseColumn.end()) {
+        if (foundIt == sparseColumn.end() || foundIt->second == 0) {
           int rb = rowsOfBlock(r);
           int cb = colsOfBlock(c);
           MatrixType* m = new MatrixType(rb, cb);
@@ -267,6 +267,16 @@ namespace g2o {
         return foundIt->second;
       }
 
+      /**
+       * add a block to the pattern without allocating its memory. The
+       * memory is allocated by the matrix which takes over the pattern.
+       */
+      void addPattern(int r, int c)
+      {
+        assert(c <(int)_blockCols.size() && "accessing column which is not available");
+        _blockCols[c].insert(std::make_pair(r, static_cast<MatrixType*>(0)));
+      }
+
     protected:
       const std::vector<int>& _rowBlockIndices; ///< vector of the indices of the blocks along the rows.
       const std::vector<int>& _colBlockIndices; ///< vector of the indices of the blocks along the cols
@@ -24,15 +24,12 @@
 // NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+
 #include "sparse_block_matrix.h"
 #include <iostream>
 
 using namespace std;
 using namespace g2o;
-using namespace Eigen;
-
-typedef SparseBlockMatrix< MatrixX >
-SparseBlockMatrixX;
 
 std::ostream& operator << (std::ostream& os, const SparseBlockMatrixX::SparseMatrixBlock& m) {
   for (int i=0; i<m.rows(); ++i){
@@ -43,7 +40,163 @@ std::ostream& operator << (std::ostream& os, const SparseBlockMatrixX::SparseMat
   return os;
 }
 
+#define CHECK(cond) \
+  if (! (cond)) { \
+    cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << endl; \
+    return 1; \
+  }
+
+/**
+ * fill the same pattern into a matrix with heap blocks and into a matrix
+ * with arena blocks and compare the results of the operations on them.
+ */
+template <class MatrixType>
+int testArena(const int* rbi, const int* cbi, int rb, int cb)
+{
+  typedef SparseBlockMatrix<MatrixType> Sbm;
+  Sbm heap(rbi, cbi, rb, cb);
+  Sbm arena(rbi, cbi, rb, cb);
+  arena.setArenaStorage(true);
+  CHECK(arena.arenaStorage());
+
+  int numBlocks = 0;
+  for (int c = 0; c < cb; ++c)
+    for (int r = c % 2; r < rb; r += 2)
+      ++numBlocks;
+  arena.reserveBlocks(numBlocks);
+  for (int c = 0; c < cb; ++c) {
+    for (int r = c % 2; r < rb; r += 2) {
+      typename Sbm::SparseMatrixBlock* h = heap.block(r, c, true);
+      typename Sbm::SparseMatrixBlock* a = arena.block(r, c, true);
+      CHECK(a->rows() == arena.rowsOfBlock(r) && a->cols() == arena.colsOfBlock(c));
+      CHECK(a->isZero());
+      h->setRandom();
+      *a = *h;
+    }
+  }
+  CHECK(arena.nonZeroBlocks() == heap.nonZeroBlocks());
+  CHECK(arena.nonZeros() == heap.nonZeros());
+  // everything has been reserved, the blocks have to be served from one slab
+  size_t coefficientAllocations = MatrixType::SizeAtCompileTime == Eigen::Dynamic ? numBlocks : 0;
+  CHECK(arena.numAllocations() == 1 + coefficientAllocations);
+
+  // blocks keep their address
+  typename Sbm::SparseMatrixBlock* first = arena.block(0, 0);
+  arena.block(rb - 1, cb - 1, true)->setIdentity();
+  heap.block(rb - 1, cb - 1, true)->setIdentity();
+  CHECK(arena.block(0, 0) == first);
+
+  // operations have to yield the same result for both storages
+  std::vector<number_t> x(arena.cols());
+  for (size_t i = 0; i < x.size(); ++i)
+    x[i] = static_cast<number_t>(i) - 2;
+  number_t* ya = 0;
+  number_t* yh = 0;
+  arena.multiply(ya, x.data());
+  heap.multiply(yh, x.data());
+  for (int i = 0; i < arena.rows(); ++i)
+    CHECK(std::abs(ya[i] - yh[i]) < 1e-9);
+  delete[] ya;
+  delete[] yh;
+
+  std::unique_ptr<Sbm> arenaCopy = arena.added();
+  for (int c = 0; c < cb; ++c)
+    for (typename Sbm::IntBlockMap::const_iterator it = heap.blockCols()[c].begin(); it != heap.blockCols()[c].end(); ++it) {
+      CHECK(arena.block(it->first, c) != 0);
+      CHECK(arena.block(it->first, c)->isApprox(*it->second));
+      CHECK(arenaCopy->block(it->first, c)->isApprox(*it->second));
+    }
+
+  // clear() zeroes the blocks but keeps the pattern
+  arena.clear();
+  CHECK(arena.nonZeroBlocks() == heap.nonZeroBlocks());
+  for (int c = 0; c < cb; ++c)
+    for (typename Sbm::IntBlockMap::const_iterator it = arena.blockCols()[c].begin(); it != arena.blockCols()[c].end(); ++it)
+      CHECK(it->second->isZero());
+
+  // clear(true) releases all blocks at once
+  arena.clear(true);
+  CHECK(arena.nonZeroBlocks() == 0);
+  CHECK(arena.numAllocations() == 0);
+
+  // the pattern of a hash map is materialized within the arena
+  std::vector<int> rowIndices(rbi, rbi + rb);
+  std::vector<int> colIndices(cbi, cbi + cb);
+  SparseBlockMatrixHashMap<MatrixType> hashMatrix(rowIndices, colIndices);
+  hashMatrix.blockCols().resize(cb);
+  for (int c = 0; c < cb; ++c)
+    for (int r = c % 2; r < rb; r += 2) {
+      if (r == c)
+        hashMatrix.addBlock(r, c)->setConstant(r);
+      else
+        hashMatrix.addPattern(r, c);
+    }
+  arena.takePatternFromHash(hashMatrix);
+  CHECK(arena.nonZeroBlocks() == static_cast<size_t>(numBlocks));
+  CHECK(arena.numAllocations() == 1 + coefficientAllocations);
+  for (int c = 0; c < cb; ++c) {
+    int lastRow = -1;
+    for (typename Sbm::IntBlockMap::const_iterator it = arena.blockCols()[c].begin(); it != arena.blockCols()[c].end(); ++it) {
+      CHECK(it->first > lastRow);
+      lastRow = it->first;
+      if (it->first == c)
+        CHECK(it->second->isConstant(c));
+    }
+  }
+  return 0;
+}
+
+/**
+ * remove every third block row and every second block column and check that
+ * the remaining blocks keep their memory and are found at the shifted indices.
+ */
+template <class MatrixType>
+int testRemoveBlocks(const int* rbi, const int* cbi, int rb, int cb, bool arenaStorage)
+{
+  typedef SparseBlockMatrix<MatrixType> Sbm;
+  Sbm m(rbi, cbi, rb, cb);
+  m.setArenaStorage(arenaStorage);
+  for (int c = 0; c < cb; ++c)
+    for (int r = 0; r < rb; ++r)
+      if ((r + c) % 2 == 0)
+        m.block(r, c, true)->setRandom();
+  Sbm original(rbi, cbi, rb, cb);
+  m.add(original);
+
+  std::vector<int> rowMapping(rb), colMapping(cb);
+  for (int r = 0, k = 0; r < rb; ++r)
+    rowMapping[r] = r % 3 == 1 ? -1 : k++;
+  for (int c = 0, k = 0; c < cb; ++c)
+    colMapping[c] = c % 2 == 1 ? -1 : k++;
+  std::vector<std::vector<typename Sbm::SparseMatrixBlock*> > pointers(rb, std::vector<typename Sbm::SparseMatrixBlock*>(cb, 0));
+  for (int c = 0; c < cb; ++c)
+    for (int r = 0; r < rb; ++r)
+      pointers[r][c] = m.block(r, c);
+  m.removeBlocks(rowMapping, colMapping);
+
+  size_t numBlocks = 0;
+  for (int c = 0; c < cb; ++c) {
+    if (colMapping[c] < 0)
+      continue;
+    CHECK(m.colsOfBlock(colMapping[c]) == original.colsOfBlock(c));
+    for (int r = 0; r < rb; ++r) {
+      if (rowMapping[r] < 0)
+        continue;
+      CHECK(m.rowsOfBlock(rowMapping[r]) == original.rowsOfBlock(r));
+      CHECK(m.block(rowMapping[r], colMapping[c]) == pointers[r][c]);
+      if (pointers[r][c]) {
+        CHECK(*pointers[r][c] == *original.block(r, c));
+        ++numBlocks;
+      }
+    }
+  }
+  CHECK(m.nonZeroBlocks() == numBlocks);
+  CHECK(m.blockCols().size() == m.colBlockIndices().size());
+  return 0;
+}
+
 int main (int argc, char** argv){
+  (void) argc; (void) argv;
   int rcol[] = {3,6,8,12};
   int ccol[] = {2,4,13};
   cerr << "creation" << endl;
@@ -78,17 +231,15 @@ int main (int argc, char** argv){
 
   cerr << "SUM" << endl;
 
-  SparseBlockMatrixX* Ms=0;
-  M->add(Ms);
-  M->add(Ms);
+  std::unique_ptr<SparseBlockMatrixX> Ms = M->added();
+  M->add(*Ms);
   cerr << *Ms;
   
-  SparseBlockMatrixX* Mt=0;
-  M->transpose(Mt);
+  std::unique_ptr<SparseBlockMatrixX> Mt = M->transposed<MatrixX>();
   cerr << *Mt << endl;
 
   SparseBlockMatrixX* Mp=0;
-  M->multiply(Mp, Mt);
+  M->multiply(Mp, Mt.get());
   cerr << *Mp << endl;
   
   int iperm[]={3,2,1,0};
@@ -101,7 +252,26 @@ int main (int argc, char** argv){
   Mp->block(3,0)->fill(0.);
   Mp->symmPermutation(PMp,iperm, true);
   cerr << *PMp << endl;
-  
-  
-  
+
+  delete PMp;
+  delete Mp;
+  delete M;
+
+  cerr << "arena storage" << endl;
+  if (testArena<MatrixX>(rcol, ccol, 4, 3))
+    return 1;
+  int rcol3[] = {3,6,9,12,15,18};
+  int ccol3[] = {3,6,9,12,15};
+  if (testArena<Matrix3>(rcol3, ccol3, 6, 5))
+    return 1;
+
+  cerr << "remove blocks" << endl;
+  for (int arena = 0; arena < 2; ++arena) {
+    if (testRemoveBlocks<MatrixX>(rcol, ccol, 4, 3, arena != 0))
+      return 1;
+    if (testRemoveBlocks<Matrix3>(rcol3, ccol3, 6, 5, arena != 0))
+      return 1;
+  }
+  cerr << "OK" << endl;
+  return 0;
 }
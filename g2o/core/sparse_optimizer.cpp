@@ -30,13 +30,18 @@
 #include <iomanip>
 #include <algorithm>
 #include <iterator>
+#include <typeinfo>
 #include <cassert>
 #include <algorithm>
 
 #include "estimate_propagator.h"
+#include "batch_edge_kernel.h"
 #include "optimization_algorithm.h"
 #include "batch_stats.h"
+#include "cache.h"
+#include "estimate_snapshot.h"
 #include "hyper_graph_action.h"
+#include "parallel_reduction.h"
 #include "robust_kernel.h"
 #include "g2o/stuff/timeutil.h"
 #include "g2o/stuff/macros.h"
@@ -49,18 +54,33 @@ namespace g2o{
   using namespace std;
 
   SparseOptimizer::SparseOptimizer() :
-    _forceStopFlag(0), _verbose(false), _algorithm(nullptr), _computeBatchStatistics(false)
+    _forceStopFlag(0), _verbose(false), _algorithm(nullptr), _computeBatchStatistics(false),
+    _currentBatchStatistics(0), _batchEvaluation(false), _contiguousBackup(false), _snapshotLevels(0)
   {
     _graphActions.resize(AT_NUM_ELEMENTS);
   }
 
   SparseOptimizer::~SparseOptimizer()
   {
+    clearBatchKernels();
+    releaseSnapshots();
     release(_algorithm);
     G2OBatchStatistics::setGlobalStats(0);
   }
 
-  void SparseOptimizer::computeActiveErrors()
+  namespace {
+    //! the chi2 of the edge weighted by its robust kernel
+    inline number_t robustChi2(const OptimizableGraph::Edge* e)
+    {
+      if (! e->robustKernel())
+        return e->chi2();
+      Vector3 rho;
+      e->robustKernel()->robustify(e->chi2(), rho);
+      return rho[0];
+    }
+  }
+
+  void SparseOptimizer::prepareComputeActiveErrors()
   {
     // call the callbacks in case there is something registered
     HyperGraphActionSet& actions = _graphActions[AT_COMPUTEACTIVERROR];
@@ -69,14 +89,14 @@ namespace g2o{
         (*(*it))(this);
     }
 
-#   ifdef G2O_OPENMP
-#   pragma omp parallel for default (shared) if (_activeEdges.size() > 50)
-#   endif
-    for (int k = 0; k < static_cast<int>(_activeEdges.size()); ++k) {
-      OptimizableGraph::Edge* e = _activeEdges[k];
-      e->computeError();
-    }
+    updateOutdatedCaches();
 
+    for (size_t i = 0; i < _batchKernels.size(); ++i)
+      _batchKernels[i]->computeErrors();
+  }
+
+  void SparseOptimizer::checkActiveErrors() const
+  {
 #  ifndef NDEBUG
     for (int k = 0; k < static_cast<int>(_activeEdges.size()); ++k) {
       OptimizableGraph::Edge* e = _activeEdges[k];
@@ -86,33 +106,76 @@ namespace g2o{
       }
     }
 #  endif
-
   }
 
-  number_t SparseOptimizer::activeChi2( ) const
+  void SparseOptimizer::computeActiveErrors()
   {
-    number_t chi = 0.0;
-    for (EdgeContainer::const_iterator it = _activeEdges.begin(); it != _activeEdges.end(); ++it) {
-      const OptimizableGraph::Edge* e = *it;
-      chi += e->chi2();
+    prepareComputeActiveErrors();
+
+#   ifdef G2O_OPENMP
+#   pragma omp parallel for default (shared) if (_activeEdges.size() > 50)
+#   endif
+    for (int k = 0; k < static_cast<int>(_activeEdges.size()); ++k) {
+      OptimizableGraph::Edge* e = _activeEdges[k];
+      if (! e->batchKernel())
+        e->computeError();
     }
+
+    checkActiveErrors();
+  }
+
+  number_t SparseOptimizer::computeActiveErrorsAndRobustChi2()
+  {
+    prepareComputeActiveErrors();
+
+    // the chi2 of an edge is accumulated right after computing its error
+    number_t chi = orderedParallelSum<number_t>(static_cast<int>(_activeEdges.size()),
+        [this](int k) {
+          OptimizableGraph::Edge* e = _activeEdges[k];
+          if (! e->batchKernel())
+            e->computeError();
+          return robustChi2(e);
+        });
+
+    checkActiveErrors();
     return chi;
   }
 
-  number_t SparseOptimizer::activeRobustChi2() const
+  void SparseOptimizer::linearizeBatchedEdges()
   {
-    Vector3 rho;
-    number_t chi = 0.0;
-    for (EdgeContainer::const_iterator it = _activeEdges.begin(); it != _activeEdges.end(); ++it) {
-      const OptimizableGraph::Edge* e = *it;
-      if (e->robustKernel()) {
-        e->robustKernel()->robustify(e->chi2(), rho);
-        chi += rho[0];
+    if (_batchKernels.empty())
+      return;
+    BatchStatisticsTimer linearizeTimer(_currentBatchStatistics, &G2OBatchStatistics::timeLinearize);
+    for (size_t i = 0; i < _batchKernels.size(); ++i)
+      _batchKernels[i]->linearizeOplus();
+#  ifndef NDEBUG
+    // the check of BlockSolver::buildSystem() only covers the Jacobians in the workspace
+    for (size_t i = 0; i < _batchKernels.size(); ++i) {
+      const BatchEdgeKernel* kernel = _batchKernels[i];
+      for (int k = 0; k < kernel->size(); ++k) {
+        const OptimizableGraph::Edge* e = kernel->edges()[k];
+        for (size_t j = 0; j < e->vertices().size(); ++j) {
+          const OptimizableGraph::Vertex* v = static_cast<const OptimizableGraph::Vertex*>(e->vertex(j));
+          if (! v->fixed() && arrayHasNaN(kernel->jacobianData(k, static_cast<int>(j)), e->dimension() * v->dimension())) {
+            cerr << "linearizeBatchedEdges(): NaN within Jacobian for edge " << e << " for vertex " << j << endl;
+            break;
+          }
+        }
       }
-      else
-        chi += e->chi2();
     }
-    return chi;
+#  endif
+  }
+
+  number_t SparseOptimizer::activeChi2( ) const
+  {
+    return orderedParallelSum<number_t>(static_cast<int>(_activeEdges.size()),
+        [this](int k) { return _activeEdges[k]->chi2();});
+  }
+
+  number_t SparseOptimizer::activeRobustChi2() const
+  {
+    return orderedParallelSum<number_t>(static_cast<int>(_activeEdges.size()),
+        [this](int k) { return robustChi2(_activeEdges[k]);});
   }
 
   OptimizableGraph::Vertex* SparseOptimizer::findGauge(){
@@ -194,8 +257,8 @@ namespace g2o{
   void SparseOptimizer::clearIndexMapping(){
     for (size_t i=0; i<_ivMap.size(); ++i){
       _ivMap[i]->setHessianIndex(-1);
-      _ivMap[i]=0;
     }
+    _ivMap.clear();
   }
 
   bool SparseOptimizer::initializeOptimization(int level){
@@ -217,7 +280,7 @@ namespace g2o{
     _activeVertices.clear();
     _activeVertices.reserve(vset.size());
     _activeEdges.clear();
-    set<Edge*> auxEdgeSet; // temporary structure to avoid duplicates
+    _activeEdges.reserve(_edges.size());
     for (HyperGraph::VertexSet::iterator it=vset.begin(); it!=vset.end(); ++it){
       OptimizableGraph::Vertex* v= (OptimizableGraph::Vertex*) *it;
       const OptimizableGraph::EdgeSet& vEdges=v->edges();
@@ -235,7 +298,7 @@ namespace g2o{
             }
           }
           if (allVerticesOK && !e->allVerticesFixed()) {
-            auxEdgeSet.insert(e);
+            _activeEdges.push_back(e);
             levelEdges++;
           }
 
@@ -261,11 +324,10 @@ namespace g2o{
       }
     }
 
-    _activeEdges.reserve(auxEdgeSet.size());
-    for (set<Edge*>::iterator it = auxEdgeSet.begin(); it != auxEdgeSet.end(); ++it)
-      _activeEdges.push_back(*it);
-
+    // each edge got collected once per vertex, the sorting brings the duplicates together
     sortVectorContainers();
+    _activeEdges.erase(std::unique(_activeEdges.begin(), _activeEdges.end()), _activeEdges.end());
+    updateBatchKernels();
     bool indexMappingStatus = buildIndexMapping(_activeVertices);
     postIteration(-1);
     return indexMappingStatus;
@@ -273,28 +335,28 @@ namespace g2o{
 
   bool SparseOptimizer::initializeOptimization(HyperGraph::EdgeSet& eset){
     preIteration(-1);
-    bool workspaceAllocated = _jacobianWorkspace.allocate(); (void) workspaceAllocated;
-    assert(workspaceAllocated && "Error while allocating memory for the Jacobians");
     clearIndexMapping();
     _activeVertices.clear();
     _activeEdges.clear();
     _activeEdges.reserve(eset.size());
-    set<Vertex*> auxVertexSet; // temporary structure to avoid duplicates
     for (HyperGraph::EdgeSet::iterator it=eset.begin(); it!=eset.end(); ++it){
       OptimizableGraph::Edge* e=(OptimizableGraph::Edge*)(*it);
       if (e->numUndefinedVertices())
 	continue;
       for (vector<HyperGraph::Vertex*>::const_iterator vit = e->vertices().begin(); vit != e->vertices().end(); ++vit) {
-        auxVertexSet.insert(static_cast<OptimizableGraph::Vertex*>(*vit));
+        _activeVertices.push_back(static_cast<OptimizableGraph::Vertex*>(*vit));
       }
       _activeEdges.push_back(reinterpret_cast<OptimizableGraph::Edge*>(*it));
+      // the edge may belong to another graph if we optimize a part of it on our own
+      _jacobianWorkspace.updateSize(e);
     }
+    bool workspaceAllocated = _jacobianWorkspace.allocate(); (void) workspaceAllocated;
+    assert(workspaceAllocated && "Error while allocating memory for the Jacobians");
 
-    _activeVertices.reserve(auxVertexSet.size());
-    for (set<Vertex*>::iterator it = auxVertexSet.begin(); it != auxVertexSet.end(); ++it)
-      _activeVertices.push_back(*it);
-
+    // vertices shared by several edges got collected multiple times
     sortVectorContainers();
+    _activeVertices.erase(std::unique(_activeVertices.begin(), _activeVertices.end()), _activeVertices.end());
+    updateBatchKernels();
     bool indexMappingStatus = buildIndexMapping(_activeVertices);
     postIteration(-1);
     return indexMappingStatus;
@@ -346,7 +408,9 @@ namespace g2o{
       }
     }
 
+    // the cost functions only propagate along the active edges
     EstimatePropagator estimatePropagator(this);
+    estimatePropagator.snapshot().build(_activeEdges.begin(), _activeEdges.end());
     estimatePropagator.propagate(fixedVertices, costFunction);
 
     // restoring the vertices that should not be initialized
@@ -388,6 +452,7 @@ namespace g2o{
     for (int i=0; i<iterations && ! terminate() && ok; i++){
       preIteration(i);
 
+      _currentBatchStatistics = _computeBatchStatistics ? &_batchStatistics[i] : 0;
       if (_computeBatchStatistics) {
         G2OBatchStatistics& cstat = _batchStatistics[i];
         G2OBatchStatistics::setGlobalStats(&cstat);
@@ -399,12 +464,14 @@ namespace g2o{
       number_t ts = get_monotonic_time();
       result = _algorithm->solve(i, online);
       ok = ( result == OptimizationAlgorithm::OK );
+      updateOutdatedCaches();
 
       bool errorComputed = false;
+      number_t chi2 = 0;
       if (_computeBatchStatistics) {
-        computeActiveErrors();
+        chi2 = computeActiveErrorsAndRobustChi2();
         errorComputed = true;
-        _batchStatistics[i].chi2 = activeRobustChi2();
+        _batchStatistics[i].chi2 = chi2;
         _batchStatistics[i].timeIteration = get_monotonic_time()-ts;
       }
 
@@ -412,9 +479,9 @@ namespace g2o{
         number_t dts = get_monotonic_time()-ts;
         cumTime += dts;
         if (! errorComputed)
-          computeActiveErrors();
+          chi2 = computeActiveErrorsAndRobustChi2();
         cerr << "iteration= " << i
-          << "\t chi2= " << FIXED(activeRobustChi2())
+          << "\t chi2= " << FIXED(chi2)
           << "\t time= " << dts
           << "\t cumTime= " << cumTime
           << "\t edges= " << _activeEdges.size();
@@ -424,6 +491,7 @@ namespace g2o{
       ++cjIterations; 
       postIteration(i);
     }
+    _currentBatchStatistics = 0;
     if (result == OptimizationAlgorithm::Fail) {
       return 0;
     }
@@ -432,16 +500,27 @@ namespace g2o{
 
   void SparseOptimizer::update(const number_t* update)
   {
-    // update the graph by calling oplus on the vertices
+    // the offset of the increment of each vertex in the update vector
+    _updateOffsets.resize(_ivMap.size());
+    int offset = 0;
     for (size_t i=0; i < _ivMap.size(); ++i) {
+      _updateOffsets[i] = offset;
+      offset += _ivMap[i]->dimension();
+    }
+
+    // update the graph by calling oplus on the vertices
+#   ifdef G2O_OPENMP
+#   pragma omp parallel for default (shared) if (_ivMap.size() > 1000)
+#   endif
+    for (int i=0; i < static_cast<int>(_ivMap.size()); ++i) {
       OptimizableGraph::Vertex* v= _ivMap[i];
+      const number_t* vertexUpdate = update + _updateOffsets[i];
 #ifndef NDEBUG
-      bool hasNan = arrayHasNaN(update, v->dimension());
+      bool hasNan = arrayHasNaN(vertexUpdate, v->dimension());
       if (hasNan)
         cerr << __PRETTY_FUNCTION__ << ": Update contains a nan for vertex " << v->id() << endl;
 #endif
-      v->oplus(update);
-      update += v->dimension();
+      v->oplus(vertexUpdate);
     }
   }
 
@@ -464,32 +543,79 @@ namespace g2o{
       OptimizableGraph::Edge* e = static_cast<OptimizableGraph::Edge*>(*it);
       if (!e->allVerticesFixed()) _activeEdges.push_back(e);
     }
-    
-    // update the index mapping
-    size_t next = _ivMap.size();
+
+    // split the new vertices into poses and landmarks, sorted by their ID to be deterministic
+    VertexContainer newPoses;
+    VertexContainer newLandmarks;
     for (HyperGraph::VertexSet::iterator it = vset.begin(); it != vset.end(); ++it) {
       OptimizableGraph::Vertex* v=static_cast<OptimizableGraph::Vertex*>(*it);
       if (! v->fixed()){
-        if (! v->marginalized()){
-          v->setHessianIndex(next);
-          _ivMap.push_back(v);
-          newVertices.push_back(v);
-          _activeVertices.push_back(v);
-          next++;
-        } 
-        else // not supported right now
-          abort();
+        if (! v->marginalized())
+          newPoses.push_back(v);
+        else
+          newLandmarks.push_back(v);
+        _activeVertices.push_back(v);
       }
       else {
         v->setHessianIndex(-1);
       }
     }
+    sort(newPoses.begin(), newPoses.end(), VertexIDCompare());
+    sort(newLandmarks.begin(), newLandmarks.end(), VertexIDCompare());
+
+    // update the index mapping, the poses go in front of the landmarks, i.e.,
+    // adding a pose shifts the Hessian index of the marginalized vertices
+    VertexContainer::iterator firstLandmark = std::partition_point(_ivMap.begin(), _ivMap.end(),
+        [](const OptimizableGraph::Vertex* v) { return ! v->marginalized();});
+    size_t numPoses = firstLandmark - _ivMap.begin();
+    _ivMap.insert(firstLandmark, newPoses.begin(), newPoses.end());
+    _ivMap.insert(_ivMap.end(), newLandmarks.begin(), newLandmarks.end());
+    for (size_t i = numPoses; i < _ivMap.size(); ++i)
+      _ivMap[i]->setHessianIndex(i);
+    newVertices.insert(newVertices.end(), newPoses.begin(), newPoses.end());
+    newVertices.insert(newVertices.end(), newLandmarks.begin(), newLandmarks.end());
+    if (_batchEvaluation)
+      updateBatchKernels();
+    // the new edges grew the size of the workspace when they were added to the graph
+    _jacobianWorkspace.allocate();
 
-    //if (newVertices.size() != vset.size())
-    //cerr << __PRETTY_FUNCTION__ << ": something went wrong " << PVAR(vset.size()) << " " << PVAR(newVertices.size()) << endl;
     return _algorithm->updateStructure(newVertices, eset);
   }
 
+  bool SparseOptimizer::removeFromInitialization(HyperGraph::VertexSet& vset, HyperGraph::EdgeSet& eset)
+  {
+    // drop the given edges and the edges of the removed vertices
+    EdgeContainer::iterator edgesEnd = std::remove_if(_activeEdges.begin(), _activeEdges.end(),
+        [&vset, &eset](const OptimizableGraph::Edge* e) {
+          if (eset.find(const_cast<OptimizableGraph::Edge*>(e)) != eset.end())
+            return true;
+          for (size_t i = 0; i < e->vertices().size(); ++i)
+            if (vset.find(e->vertices()[i]) != vset.end())
+              return true;
+          return false;
+        });
+    _activeEdges.erase(edgesEnd, _activeEdges.end());
+    if (_batchEvaluation)
+      updateBatchKernels();
+
+    std::vector<HyperGraph::Vertex*> removedVertices;
+    if (! vset.empty()) {
+      auto removed = [&vset](const OptimizableGraph::Vertex* v) { return vset.find(const_cast<OptimizableGraph::Vertex*>(v)) != vset.end();};
+      _activeVertices.erase(std::remove_if(_activeVertices.begin(), _activeVertices.end(), removed), _activeVertices.end());
+      for (size_t i = 0; i < _ivMap.size(); ++i) {
+        if (removed(_ivMap[i])) {
+          _ivMap[i]->setHessianIndex(-1);
+          removedVertices.push_back(_ivMap[i]);
+        }
+      }
+      _ivMap.erase(std::remove_if(_ivMap.begin(), _ivMap.end(), removed), _ivMap.end());
+      for (size_t i = 0; i < _ivMap.size(); ++i)
+        _ivMap[i]->setHessianIndex(i);
+    }
+
+    return _algorithm->removeFromStructure(removedVertices, eset);
+  }
+
   void SparseOptimizer::sortVectorContainers()
   {
     // sort vector structures to get deterministic ordering based on IDs
@@ -497,7 +623,67 @@ namespace g2o{
     sort(_activeEdges.begin(), _activeEdges.end(), EdgeIDCompare());
   }
 
+  void SparseOptimizer::setBatchEvaluation(bool batchEvaluation)
+  {
+    _batchEvaluation = batchEvaluation;
+  }
+
+  void SparseOptimizer::updateBatchKernels()
+  {
+    clearBatchKernels();
+    if (! _batchEvaluation)
+      return;
+
+    // group the edges by their type, the edges of a type keep their order given by the IDs
+    typedef std::map<std::string, std::vector<OptimizableGraph::Edge*> > EdgesByType;
+    EdgesByType edgesByType;
+    const std::type_info* lastType = 0;
+    std::vector<OptimizableGraph::Edge*>* lastGroup = 0;
+    for (size_t k = 0; k < _activeEdges.size(); ++k) {
+      OptimizableGraph::Edge* e = _activeEdges[k];
+      const std::type_info& type = typeid(*e);
+      if (! lastType || type != *lastType) {
+        lastType = &type;
+        lastGroup = &edgesByType[type.name()];
+      }
+      lastGroup->push_back(e);
+    }
+
+    for (EdgesByType::iterator it = edgesByType.begin(); it != edgesByType.end(); ++it) {
+      // a single chunk is not worth the packing
+      if (it->second.size() < static_cast<size_t>(BatchEdgeKernel::LaneWidth))
+        continue;
+      BatchEdgeKernel* kernel = BatchEdgeKernelFactory::instance()->construct(it->first);
+      if (! kernel)
+        continue;
+      kernel->setEdges(it->second);
+      for (size_t k = 0; k < it->second.size(); ++k)
+        it->second[k]->setBatchKernel(kernel);
+      _batchKernels.push_back(kernel);
+    }
+    if (_verbose && _batchKernels.size() > 0) {
+      size_t numBatched = 0;
+      for (size_t i = 0; i < _batchKernels.size(); ++i)
+        numBatched += _batchKernels[i]->size();
+      cerr << __PRETTY_FUNCTION__ << ": " << numBatched << " of " << _activeEdges.size()
+        << " edges evaluated by " << _batchKernels.size() << " batch kernels" << endl;
+    }
+  }
+
+  void SparseOptimizer::clearBatchKernels()
+  {
+    for (size_t i = 0; i < _batchKernels.size(); ++i) {
+      const std::vector<OptimizableGraph::Edge*>& kernelEdges = _batchKernels[i]->edges();
+      for (size_t k = 0; k < kernelEdges.size(); ++k)
+        kernelEdges[k]->setBatchKernel(0);
+      delete _batchKernels[i];
+    }
+    _batchKernels.clear();
+  }
+
   void SparseOptimizer::clear() {
+    clearBatchKernels();
+    releaseSnapshots();
     _ivMap.clear();
     _activeVertices.clear();
     _activeEdges.clear();
@@ -581,7 +767,15 @@ namespace g2o{
   }
 
   bool SparseOptimizer::computeMarginals(SparseBlockMatrix<MatrixX>& spinv, const std::vector<std::pair<int, int> >& blockIndices){
-    return _algorithm->computeMarginals(spinv, blockIndices);
+    // account the marginals to the last iteration
+    G2OBatchStatistics* stats = 0;
+    for (size_t i = _batchStatistics.size(); _computeBatchStatistics && i > 0 && ! stats; --i)
+      if (_batchStatistics[i-1].iteration >= 0)
+        stats = &_batchStatistics[i-1];
+    _currentBatchStatistics = stats;
+    bool result = _algorithm->computeMarginals(spinv, blockIndices);
+    _currentBatchStatistics = 0;
+    return result;
   }
 
   void SparseOptimizer::setForceStopFlag(bool* flag)
@@ -593,12 +787,25 @@ namespace g2o{
   {
     OptimizableGraph::Vertex* vv = static_cast<OptimizableGraph::Vertex*>(v);
     if (vv->hessianIndex() >= 0) {
-      clearIndexMapping();
-      _ivMap.clear();
+      // keep the structures for online processing if the algorithm is able to drop the vertex
+      HyperGraph::VertexSet vset;
+      HyperGraph::EdgeSet eset;
+      vset.insert(v);
+      if (! _algorithm || ! removeFromInitialization(vset, eset))
+        clearIndexMapping();
     }
+    releaseSnapshots();
     return HyperGraph::removeVertex(v, detach);
   }
 
+  bool SparseOptimizer::removeEdge(HyperGraph::Edge* e)
+  {
+    OptimizableGraph::Edge* ee = static_cast<OptimizableGraph::Edge*>(e);
+    if (ee->batchKernel())
+      clearBatchKernels();
+    return OptimizableGraph::removeEdge(e);
+  }
+
   bool SparseOptimizer::addComputeErrorAction(HyperGraphAction* action)
   {
     std::pair<HyperGraphActionSet::iterator, bool> insertResult = _graphActions[AT_COMPUTEACTIVERROR].insert(action);
@@ -612,17 +819,67 @@ namespace g2o{
 
   void SparseOptimizer::push()
   {
-    push(_activeVertices);
+    if (! _contiguousBackup) {
+      push(_activeVertices);
+      return;
+    }
+    if (_snapshotLevels == _snapshots.size())
+      _snapshots.push_back(new EstimateSnapshot);
+    EstimateSnapshot* snapshot = _snapshots[_snapshotLevels++];
+    if (snapshot->vertices() == _activeVertices)
+      snapshot->save();
+    else
+      snapshot->layout(_activeVertices);
   }
 
   void SparseOptimizer::pop()
   {
-    pop(_activeVertices);
+    if (! _contiguousBackup) {
+      pop(_activeVertices);
+      return;
+    }
+    assert(_snapshotLevels > 0 && "pop() without a matching push()");
+    _snapshots[--_snapshotLevels]->restore(_outdatedCaches);
   }
 
   void SparseOptimizer::discardTop()
   {
-    discardTop(_activeVertices);
+    if (! _contiguousBackup) {
+      discardTop(_activeVertices);
+      return;
+    }
+    assert(_snapshotLevels > 0 && "discardTop() without a matching push()");
+    _snapshots[--_snapshotLevels]->discard();
+  }
+
+  void SparseOptimizer::setContiguousBackup(bool contiguousBackup)
+  {
+    releaseSnapshots();
+    _contiguousBackup = contiguousBackup;
+  }
+
+  void SparseOptimizer::updateOutdatedCaches()
+  {
+    if (_outdatedCaches.empty())
+      return;
+    // a vertex restored several times is listed once for each pop()
+    sort(_outdatedCaches.begin(), _outdatedCaches.end());
+    _outdatedCaches.erase(std::unique(_outdatedCaches.begin(), _outdatedCaches.end()), _outdatedCaches.end());
+#   ifdef G2O_OPENMP
+#   pragma omp parallel for default (shared) if (_outdatedCaches.size() > 1000)
+#   endif
+    for (int k = 0; k < static_cast<int>(_outdatedCaches.size()); ++k)
+      _outdatedCaches[k]->cacheContainer()->update();
+    _outdatedCaches.clear();
+  }
+
+  void SparseOptimizer::releaseSnapshots()
+  {
+    updateOutdatedCaches();
+    for (size_t i = 0; i < _snapshots.size(); ++i)
+      delete _snapshots[i];
+    _snapshots.clear();
+    _snapshotLevels = 0;
   }
 
 } // end namespace
@@ -42,6 +42,8 @@ namespace g2o {
   class ActivePathCostFunction;
   class OptimizationAlgorithm;
   class EstimatePropagatorCost;
+  class BatchEdgeKernel;
+  class EstimateSnapshot;
 
   class G2O_CORE_API SparseOptimizer : public OptimizableGraph {
 
@@ -89,9 +91,25 @@ namespace g2o {
     virtual bool initializeOptimization(int level=0);
 
     /**
-     * HACK updating the internal structures for online processing
+     * Adds vertices and edges to the structures for online processing without
+     * rebuilding them from scratch. New marginalized vertices are supported if the
+     * structure has been initialized with the Schur complement.
+     * @param vset: the new vertices
+     * @param eset: the new edges
+     * @returns false if somethings goes wrong
      */
     virtual bool updateInitialization(HyperGraph::VertexSet& vset, HyperGraph::EdgeSet& eset);
+
+    /**
+     * Removes vertices and edges from the structures for online processing.
+     * The edges of removed vertices get removed as well. Removing only edges keeps the
+     * structure of the solver (and thus its symbolic decomposition), removing vertices
+     * drops their rows and columns from the structure of the solver.
+     * @param vset: the vertices to remove
+     * @param eset: the edges to remove
+     * @returns false if somethings goes wrong
+     */
+    virtual bool removeFromInitialization(HyperGraph::VertexSet& vset, HyperGraph::EdgeSet& eset);
   
     /**
      * Propagates an initial guess from the vertex specified as origin.
@@ -190,6 +208,11 @@ namespace g2o {
 
     //! the index mapping of the vertices
     const VertexContainer& indexMapping() const {return _ivMap;}
+    /**
+     * release the vertices of the index mapping by resetting their index in
+     * the Hessian. Afterwards another optimizer may safely work on them.
+     */
+    void clearIndexMapping();
     //! the vertices active in the current optimization
     const VertexContainer& activeVertices() const { return _activeVertices;}
     //! the edges active in the current optimization
@@ -197,12 +220,20 @@ namespace g2o {
 
     /**
      * Remove a vertex. If the vertex is contained in the currently active set
-     * of vertices, then the internal temporary structures are cleaned, e.g., the index
+     * of vertices, it is removed from the structures for online processing
+     * (see removeFromInitialization()). If the algorithm does not support
+     * this, the internal temporary structures are cleaned, e.g., the index
      * mapping is erased. In case you need the index mapping for manipulating the
      * graph, you have to store it in your own copy.
      */
     virtual bool removeVertex(HyperGraph::Vertex* v, bool detach=false);
 
+    /**
+     * Remove an edge. If the edge is evaluated by a batch kernel, the
+     * kernels are dropped until the optimization is initialized again.
+     */
+    virtual bool removeEdge(HyperGraph::Edge* e);
+
     /**
      * search for an edge in _activeVertices and return the iterator pointing to it
      * getActiveVertices().end() if not found
@@ -238,6 +269,21 @@ namespace g2o {
     void discardTop();
     using OptimizableGraph::discardTop;
 
+    /**
+     * Store the backups of the active vertices created by push() in one
+     * contiguous buffer per level instead of the stacks of the vertices. The
+     * buffers are kept for the next push(), such that backing up and restoring
+     * the estimates does not allocate memory as long as the set of active
+     * vertices does not change. pop() marks the caches of the restored vertices
+     * as outdated, they are updated by updateOutdatedCaches() before the errors
+     * are computed again.
+     */
+    void setContiguousBackup(bool contiguousBackup);
+    bool contiguousBackup() const { return _contiguousBackup;}
+
+    //! update the caches of the vertices restored by pop() since the last update
+    void updateOutdatedCaches();
+
     /**
      * clears the graph, and polishes some intermediate structures
      * Note that this only removes nodes / edges. Parameters can be removed
@@ -250,6 +296,30 @@ namespace g2o {
      */
     void computeActiveErrors();
 
+    /**
+     * computes the error vectors of the active edges like computeActiveErrors()
+     * and returns activeRobustChi2() accumulated in the same pass over the edges
+     */
+    number_t computeActiveErrorsAndRobustChi2();
+
+    /**
+     * computes the Jacobians of the edges evaluated by the batch kernels,
+     * the remaining edges are linearized by the solver
+     */
+    void linearizeBatchedEdges();
+
+    /**
+     * Evaluate the active edges, whose type has a kernel registered in the
+     * BatchEdgeKernelFactory, by the kernel in chunks of several edges at
+     * once. Takes effect when the optimization is initialized. The
+     * measurements of the edges are packed by the kernels at this point, hence
+     * changing the measurements requires to initialize again.
+     */
+    void setBatchEvaluation(bool batchEvaluation);
+    bool batchEvaluation() const { return _batchEvaluation;}
+    //! the kernels evaluating the active edges
+    const std::vector<BatchEdgeKernel*>& batchKernels() const { return _batchKernels;}
+
     /**
      * Linearizes the system by computing the Jacobians for the nodes
      * and edges in the graph
@@ -279,6 +349,12 @@ namespace g2o {
     
     bool computeBatchStatistics() const { return _computeBatchStatistics;}
 
+    /**
+     * the statistics of the iteration which is currently performed by optimize(), or of the
+     * iteration computeMarginals() is accounted to. 0 if no statistics are recorded.
+     */
+    G2OBatchStatistics* currentBatchStatistics() const { return _currentBatchStatistics;}
+
     /**** callbacks ****/
     //! add an action to be executed before the error vectors are computed
     bool addComputeErrorAction(HyperGraphAction* action);
@@ -296,6 +372,18 @@ namespace g2o {
     EdgeContainer _activeEdges;        ///< sorted according to EdgeIDCompare
 
     void sortVectorContainers();
+
+    //! call the actions and the batch kernels before computing the errors of the active edges
+    void prepareComputeActiveErrors();
+    //! report the active edges with a NaN in their error, only in debug builds
+    void checkActiveErrors() const;
+
+    /**
+     * group the active edges by their type and assign them to the batch kernels
+     */
+    void updateBatchKernels();
+    //! delete the batch kernels and reset the kernel of their edges
+    void clearBatchKernels();
  
     OptimizationAlgorithm* _algorithm;
 
@@ -303,10 +391,23 @@ namespace g2o {
      * builds the mapping of the active vertices to the (block) row / column in the Hessian
      */
     bool buildIndexMapping(SparseOptimizer::VertexContainer& vlist);
-    void clearIndexMapping();
 
     BatchStatisticsContainer _batchStatistics;   ///< global statistics of the optimizer, e.g., timing, num-non-zeros
     bool _computeBatchStatistics;
+    G2OBatchStatistics* _currentBatchStatistics;
+
+    bool _batchEvaluation;
+    std::vector<BatchEdgeKernel*> _batchKernels;
+
+    //! destroy the backups of the active vertices
+    void releaseSnapshots();
+
+    bool _contiguousBackup;
+    std::vector<EstimateSnapshot*> _snapshots; ///< one for each level of the stack, allocated ones are reused
+    size_t _snapshotLevels;                    ///< number of levels in use
+    VertexContainer _outdatedCaches;
+
+    std::vector<int> _updateOffsets; ///< offset of each vertex in the vector passed to update()
   };
 } // end namespace
 
@@ -0,0 +1,156 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <cmath>
+#include <iostream>
+#include <type_traits>
+
+#include "auto_differentiation.h"
+#include "base_vertex.h"
+#include "jacobian_workspace.h"
+
+using namespace std;
+using namespace g2o;
+
+#define CHECK(cond) \
+  if (! (cond)) { \
+    cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << endl; \
+    return 1; \
+  }
+
+/**
+ * point whose oplus() adds the increment to its estimate data
+ */
+class VertexPoint : public BaseVertex<2, Vector2>
+{
+  public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+    virtual bool read(std::istream&) { return false;}
+    virtual bool write(std::ostream&) const { return false;}
+    virtual void setToOriginImpl() { _estimate.setZero();}
+    virtual void oplusImpl(const number_t* update) { _estimate += Eigen::Map<const Vector2>(update);}
+    virtual bool getEstimateData(number_t* est) const { Eigen::Map<Vector2> v(est); v = _estimate; return true;}
+    virtual int estimateDimension() const { return 2;}
+};
+
+/**
+ * point whose oplus() scales the increment, the Jacobian with respect to the
+ * estimate data is not the one with respect to the increment
+ */
+class VertexScaledPoint : public VertexPoint
+{
+  public:
+    virtual void oplusImpl(const number_t* update) { _estimate += 2 * Eigen::Map<const Vector2>(update);}
+};
+
+namespace g2o {
+  template <> struct AutoDiffOplusIsAddition<VertexPoint> { static const bool value = true; };
+}
+
+template <typename VertexType>
+class EdgeProduct : public AutoDiffEdge<EdgeProduct<VertexType>, BaseBinaryEdge<2, Vector2, VertexType, VertexType> >
+{
+  public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+    virtual bool read(std::istream&) { return false;}
+    virtual bool write(std::ostream&) const { return false;}
+
+    EdgeProduct() : _dualFails(false) {}
+
+    //! let the functor fail on the dual numbers, i.e., for the automatic differentiation
+    void setDualFails(bool dualFails) { _dualFails = dualFails;}
+
+    template <typename T>
+    bool operator()(const T* xi, const T* xj, T* error) const
+    {
+      using std::sin;
+      if (_dualFails && ! std::is_same<T, number_t>::value) {
+        error[0] = error[1] = T(0);
+        return false;
+      }
+      error[0] = xi[0] * xj[1] - this->_measurement[0];
+      error[1] = sin(xi[1]) + xj[0] * xj[0] - this->_measurement[1];
+      return true;
+    }
+
+    void computeError()
+    {
+      const VertexType* vi = static_cast<const VertexType*>(this->_vertices[0]);
+      const VertexType* vj = static_cast<const VertexType*>(this->_vertices[1]);
+      (*this)(vi->estimate().data(), vj->estimate().data(), this->_error.data());
+    }
+
+  protected:
+    bool _dualFails;
+};
+
+/**
+ * linearize the edge and compare to the analytic Jacobian scaled by the
+ * factor the vertices apply to the increment
+ */
+template <typename VertexType>
+static int testJacobian(number_t scale, number_t tolerance, bool dualFails = false)
+{
+  VertexType vi, vj;
+  vi.setEstimate(Vector2(0.3, -1.2));
+  vj.setEstimate(Vector2(0.7, 2.1));
+  EdgeProduct<VertexType> e;
+  e.setVertex(0, &vi);
+  e.setVertex(1, &vj);
+  e.setMeasurement(Vector2(0.1, 0.2));
+  e.setInformation(Matrix2::Identity());
+  e.setDualFails(dualFails);
+  JacobianWorkspace workspace;
+  workspace.updateSize(&e);
+  workspace.allocate();
+  e.computeError();
+  e.linearizeOplus(workspace);
+
+  const Vector2& xi = vi.estimate();
+  const Vector2& xj = vj.estimate();
+  Matrix2 Ji, Jj;
+  Ji << xj[1], 0,
+        0, std::cos(xi[1]);
+  Jj << 0, xi[0],
+        2 * xj[0], 0;
+  CHECK((e.jacobianOplusXi() - scale * Ji).norm() < tolerance);
+  CHECK((e.jacobianOplusXj() - scale * Jj).norm() < tolerance);
+  return 0;
+}
+
+int main()
+{
+  // automatic differentiation for the vertex which opted in
+  if (testJacobian<VertexPoint>(1., 1e-12))
+    return 1;
+  // numeric differentiation otherwise
+  if (testJacobian<VertexScaledPoint>(2., 1e-6))
+    return 1;
+  // numeric differentiation if the functor fails
+  if (testJacobian<VertexPoint>(1., 1e-6, true))
+    return 1;
+  cerr << "OK" << endl;
+  return 0;
+}
@@ -0,0 +1,148 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "compact_containers.h"
+
+using namespace std;
+using namespace g2o;
+
+#define CHECK(cond) \
+  if (! (cond)) { \
+    cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << endl; \
+    return 1; \
+  }
+
+/**
+ * random inserts and erases which cross the size of the linear search and
+ * trigger the compaction, compared against std::set
+ */
+int testPointerSet()
+{
+  vector<int> storage(500);
+  CompactPointerSet<int> set;
+  std::set<int*> reference;
+  vector<int*> order; // expected order of the iteration
+  srand(7);
+  for (int step = 0; step < 20000; ++step) {
+    int* p = &storage[rand() % storage.size()];
+    if (rand() % 3) {
+      bool inserted = set.insert(p).second;
+      CHECK(inserted == reference.insert(p).second);
+      if (inserted)
+        order.push_back(p);
+    } else {
+      CHECK(set.erase(p) == reference.erase(p));
+      order.erase(std::remove(order.begin(), order.end(), p), order.end());
+    }
+    CHECK(set.size() == reference.size());
+    CHECK(set.count(p) == reference.count(p));
+    if (step % 100 == 0) {
+      vector<int*> elements(set.begin(), set.end());
+      CHECK(elements == order);
+      for (size_t i = 0; i < storage.size(); ++i) {
+        CompactPointerSet<int>::iterator it = set.find(&storage[i]);
+        CHECK((it != set.end()) == (reference.count(&storage[i]) == 1));
+        CHECK(it == set.end() || *it == &storage[i]);
+      }
+    }
+  }
+
+  // erasing while iterating returns the next element
+  size_t numElements = set.size();
+  for (CompactPointerSet<int>::iterator it = set.begin(); it != set.end();) {
+    if ((*it - &storage[0]) % 2 == 0) {
+      it = set.erase(it);
+      --numElements;
+    } else
+      ++it;
+  }
+  CHECK(set.size() == numElements);
+  CHECK((size_t) std::distance(set.begin(), set.end()) == numElements);
+
+  // std::inserter and the range constructor
+  CompactPointerSet<int> copy(set.begin(), set.end());
+  CompactPointerSet<int> inserted;
+  std::copy(set.begin(), set.end(), std::inserter(inserted, inserted.end()));
+  CHECK(vector<int*>(copy.begin(), copy.end()) == vector<int*>(set.begin(), set.end()));
+  CHECK(vector<int*>(inserted.begin(), inserted.end()) == vector<int*>(set.begin(), set.end()));
+
+  set.clear();
+  CHECK(set.empty());
+  CHECK(set.begin() == set.end());
+  return 0;
+}
+
+int testIdMap()
+{
+  vector<int> storage(1000);
+  CompactIdMap<int> map;
+  std::map<int, int*> reference;
+  srand(11);
+  for (int step = 0; step < 20000; ++step) {
+    int id = rand() % 1000 - 200; // negative ids are valid keys
+    if (rand() % 3) {
+      bool inserted = map.insert(make_pair(id, &storage[id + 200])).second;
+      CHECK(inserted == reference.insert(make_pair(id, &storage[id + 200])).second);
+    } else {
+      CHECK(map.erase(id) == reference.erase(id));
+    }
+    CHECK(map.size() == reference.size());
+    if (step % 100 == 0) {
+      std::map<int, int*> elements(map.begin(), map.end());
+      CHECK(elements == reference);
+      const CompactIdMap<int>& constMap = map;
+      for (int i = -200; i < 800; ++i) {
+        CompactIdMap<int>::const_iterator it = constMap.find(i);
+        CHECK((it != constMap.end()) == (reference.count(i) == 1));
+        CHECK(it == constMap.end() || it->second == &storage[i + 200]);
+      }
+    }
+  }
+
+  CompactIdMap<int> other;
+  other.insert(make_pair(1, &storage[0]));
+  other.swap(map);
+  CHECK(map.size() == 1);
+  CHECK(map.find(1)->second == &storage[0]);
+  CHECK(other.size() == reference.size());
+  return 0;
+}
+
+int main()
+{
+  if (testPointerSet() || testIdMap())
+    return 1;
+  cerr << "OK" << endl;
+  return 0;
+}
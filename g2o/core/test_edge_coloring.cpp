@@ -0,0 +1,169 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <iostream>
+#include <set>
+
+#include "base_vertex.h"
+#include "base_binary_edge.h"
+#include "edge_coloring.h"
+
+using namespace std;
+using namespace g2o;
+
+#define CHECK(cond) \
+  if (! (cond)) { \
+    cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << endl; \
+    return 1; \
+  }
+
+class VertexPoint : public BaseVertex<2, Vector2>
+{
+  public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    virtual void setToOriginImpl() { _estimate.setZero();}
+    virtual void oplusImpl(const number_t* update) { _estimate += Eigen::Map<const Vector2>(update);}
+    virtual bool read(std::istream&) { return false;}
+    virtual bool write(std::ostream&) const { return false;}
+};
+
+class EdgePointPoint : public BaseBinaryEdge<2, Vector2, VertexPoint, VertexPoint>
+{
+  public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    virtual void computeError()
+    {
+      const VertexPoint* v1 = static_cast<const VertexPoint*>(_vertices[0]);
+      const VertexPoint* v2 = static_cast<const VertexPoint*>(_vertices[1]);
+      _error = v2->estimate() - v1->estimate() - _measurement;
+    }
+    virtual bool read(std::istream&) { return false;}
+    virtual bool write(std::ostream&) const { return false;}
+};
+
+/**
+ * check that edges of the same color share only hubs and never the
+ * block between two vertices
+ */
+int checkColoring(const EdgeColoring& coloring, const OptimizableGraph::EdgeContainer& edges)
+{
+  CHECK(coloring.isValidFor(edges));
+  CHECK(coloring.edges().size() == edges.size());
+  std::set<OptimizableGraph::Edge*> allEdges(coloring.edges().begin(), coloring.edges().end());
+  CHECK(allEdges.size() == edges.size());
+  std::set<OptimizableGraph::Vertex*> hubs(coloring.hubVertices().begin(), coloring.hubVertices().end());
+  for (int c = 0; c < coloring.numColors(); ++c) {
+    std::set<OptimizableGraph::Vertex*> written;
+    std::set<std::pair<OptimizableGraph::Vertex*, OptimizableGraph::Vertex*> > writtenBlocks;
+    for (int k = coloring.colorBegin(c); k < coloring.colorBegin(c+1); ++k) {
+      OptimizableGraph::Edge* e = coloring.edges()[k];
+      OptimizableGraph::Vertex* v1 = static_cast<OptimizableGraph::Vertex*>(e->vertex(0));
+      OptimizableGraph::Vertex* v2 = static_cast<OptimizableGraph::Vertex*>(e->vertex(1));
+      if (! v1->fixed() && ! hubs.count(v1))
+        CHECK(written.insert(v1).second);
+      if (! v2->fixed() && ! hubs.count(v2))
+        CHECK(written.insert(v2).second);
+      if (! v1->fixed() && ! v2->fixed())
+        CHECK(writtenBlocks.insert(std::make_pair(std::min(v1, v2), std::max(v1, v2))).second);
+    }
+  }
+  return 0;
+}
+
+int main()
+{
+  const int numPoints = 300;
+  std::vector<VertexPoint*> vertices;
+  for (int i = 0; i < numPoints + 3; ++i) {
+    VertexPoint* v = new VertexPoint;
+    v->setId(i);
+    vertices.push_back(v);
+  }
+  vertices.back()->setFixed(true);
+
+  // vertex 0 and 1 observe all the points, the points form a chain
+  OptimizableGraph::EdgeContainer edges;
+  for (int i = 0; i < numPoints; ++i) {
+    for (int h = 0; h < 2; ++h) {
+      EdgePointPoint* e = new EdgePointPoint;
+      e->setVertex(0, vertices[h]);
+      e->setVertex(1, vertices[i + 2]);
+      edges.push_back(e);
+    }
+    if (i > 0) {
+      EdgePointPoint* e = new EdgePointPoint;
+      e->setVertex(0, vertices[i + 1]);
+      e->setVertex(1, vertices[i + 2]);
+      edges.push_back(e);
+    }
+    // the fixed vertex does not constrain the coloring
+    EdgePointPoint* e = new EdgePointPoint;
+    e->setVertex(0, vertices.back());
+    e->setVertex(1, vertices[i + 2]);
+    edges.push_back(e);
+  }
+  // parallel edges between the two hubs share the off-diagonal block
+  for (int i = 0; i < 3; ++i) {
+    EdgePointPoint* e = new EdgePointPoint;
+    e->setVertex(0, vertices[0]);
+    e->setVertex(1, vertices[1]);
+    edges.push_back(e);
+  }
+
+  EdgeColoring coloring;
+  CHECK(! coloring.isValidFor(edges));
+
+  // without hubs the number of colors is bounded by the degree of the hubs
+  coloring.setMaxVertexDegree(numPoints * 10);
+  coloring.compute(edges);
+  if (checkColoring(coloring, edges))
+    return 1;
+  CHECK(coloring.hubVertices().empty());
+  CHECK(coloring.numColors() >= numPoints + 3);
+
+  // with hubs the number of colors is bounded by the degree of the other vertices
+  coloring.setMaxVertexDegree(64);
+  coloring.compute(edges);
+  if (checkColoring(coloring, edges))
+    return 1;
+  // the points have five edges, greedy coloring needs at most 2 * (5 - 1) + 1 colors
+  CHECK(coloring.hubVertices().size() == 2);
+  CHECK(coloring.numColors() <= 9);
+
+  // the coloring is invalid for any other set or order of edges
+  OptimizableGraph::EdgeContainer swapped = edges;
+  std::swap(swapped[0], swapped[1]);
+  CHECK(! coloring.isValidFor(swapped));
+  coloring.clear();
+  CHECK(! coloring.isValidFor(edges));
+
+  for (size_t i = 0; i < edges.size(); ++i)
+    delete edges[i];
+  for (size_t i = 0; i < vertices.size(); ++i)
+    delete vertices[i];
+  cerr << "OK" << endl;
+  return 0;
+}
@@ -0,0 +1,152 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+
+#include "base_vertex.h"
+#include "estimate_snapshot.h"
+
+using namespace std;
+using namespace g2o;
+
+#define CHECK(cond) \
+  if (! (cond)) { \
+    cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << endl; \
+    return 1; \
+  }
+
+/**
+ * vertex copied by the fast path of BaseVertex
+ */
+class VertexPoint : public BaseVertex<2, Vector2>
+{
+  public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+    virtual bool read(std::istream&) { return false;}
+    virtual bool write(std::ostream&) const { return false;}
+    virtual void setToOriginImpl() { _estimate.setZero();}
+    virtual void oplusImpl(const number_t* update) { _estimate += Eigen::Map<const Vector2>(update);}
+};
+
+/**
+ * vertex which uses the default copy of OptimizableGraph::Vertex, i.e., the
+ * estimate given by getEstimateData(), as a vertex type defined outside of g2o
+ */
+class VertexDataCopy : public VertexPoint
+{
+  public:
+    virtual size_t estimateCopySize() const { return OptimizableGraph::Vertex::estimateCopySize();}
+    virtual void saveEstimateCopy(void* d, bool construct) const { OptimizableGraph::Vertex::saveEstimateCopy(d, construct);}
+    virtual void restoreEstimateCopy(const void* d) { OptimizableGraph::Vertex::restoreEstimateCopy(d);}
+    virtual void destroyEstimateCopy(void* d) const { OptimizableGraph::Vertex::destroyEstimateCopy(d);}
+
+    virtual bool getEstimateData(number_t* est) const { Eigen::Map<Vector2> v(est); v = _estimate; return true;}
+    virtual int estimateDimension() const { return 2;}
+  protected:
+    virtual bool setEstimateDataImpl(const number_t* est) { _estimate = Eigen::Map<const Vector2>(est); return true;}
+};
+
+/**
+ * vertex which cannot copy its estimate, the snapshot falls back to its stack
+ */
+class VertexStackCopy : public VertexDataCopy
+{
+  public:
+    virtual bool getEstimateData(number_t*) const { return false;}
+    virtual int estimateDimension() const { return -1;}
+  protected:
+    virtual bool setEstimateDataImpl(const number_t*) { return false;}
+};
+
+static bool hasEstimates(const std::vector<VertexPoint*>& vertices, const std::vector<Vector2, Eigen::aligned_allocator<Vector2> >& estimates)
+{
+  for (size_t i = 0; i < vertices.size(); ++i)
+    if (vertices[i]->estimate() != estimates[i])
+      return false;
+  return true;
+}
+
+static void randomize(const std::vector<VertexPoint*>& vertices, std::vector<Vector2, Eigen::aligned_allocator<Vector2> >& estimates)
+{
+  estimates.clear();
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    vertices[i]->setEstimate(Vector2::Random());
+    estimates.push_back(vertices[i]->estimate());
+  }
+}
+
+int main()
+{
+  std::vector<VertexPoint*> vertices;
+  OptimizableGraph::VertexContainer container;
+  for (int i = 0; i < 9; ++i) {
+    VertexPoint* v = i % 3 == 0 ? new VertexPoint : i % 3 == 1 ? new VertexDataCopy : new VertexStackCopy;
+    v->setId(i);
+    vertices.push_back(v);
+    container.push_back(v);
+  }
+  CHECK(vertices[0]->estimateCopySize() == sizeof(Vector2));
+  CHECK(vertices[1]->estimateCopySize() == 2 * sizeof(number_t));
+  CHECK(vertices[2]->estimateCopySize() == 0);
+
+  std::vector<Vector2, Eigen::aligned_allocator<Vector2> > saved, changed;
+  EstimateSnapshot snapshot;
+  OptimizableGraph::VertexContainer outdatedCaches;
+
+  // layout stores the estimates, restore brings them back
+  randomize(vertices, saved);
+  snapshot.layout(container);
+  CHECK(vertices[2]->stackSize() == 1);
+  CHECK(vertices[0]->stackSize() == 0);
+  randomize(vertices, changed);
+  snapshot.restore(outdatedCaches);
+  CHECK(hasEstimates(vertices, saved));
+  CHECK(vertices[2]->stackSize() == 0);
+
+  // save re-uses the layout
+  randomize(vertices, saved);
+  snapshot.save();
+  randomize(vertices, changed);
+  snapshot.restore(outdatedCaches);
+  CHECK(hasEstimates(vertices, saved));
+
+  // discard keeps the current estimates and drops the stack
+  snapshot.save();
+  randomize(vertices, changed);
+  snapshot.discard();
+  CHECK(hasEstimates(vertices, changed));
+  CHECK(vertices[2]->stackSize() == 0);
+
+  // release drops the stored estimates
+  snapshot.save();
+  snapshot.release();
+  CHECK(vertices[2]->stackSize() == 0);
+  CHECK(snapshot.vertices().empty());
+
+  for (size_t i = 0; i < vertices.size(); ++i)
+    delete vertices[i];
+  cerr << "OK" << endl;
+  return 0;
+}
@@ -0,0 +1,225 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "hyper_graph.h"
+#include "hyper_graph_snapshot.h"
+#include "hyper_dijkstra.h"
+
+using namespace std;
+using namespace g2o;
+
+#define CHECK(cond) \
+  if (! (cond)) { \
+    cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << endl; \
+    return 1; \
+  }
+
+//! the cost of an edge is derived from its id
+struct IdCostFunction : public HyperDijkstra::CostFunction
+{
+  virtual number_t operator ()(HyperGraph::Edge* edge, HyperGraph::Vertex*, HyperGraph::Vertex*)
+  {
+    return 1. + edge->id() % 5;
+  }
+};
+
+HyperGraph::Edge* addEdge(HyperGraph& graph, int id, int v1, int v2, int v3 = -1)
+{
+  HyperGraph::Edge* e = new HyperGraph::Edge(id);
+  e->resize(v3 < 0 ? 2 : 3);
+  e->setVertex(0, graph.vertex(v1));
+  e->setVertex(1, graph.vertex(v2));
+  if (v3 >= 0)
+    e->setVertex(2, graph.vertex(v3));
+  graph.addEdge(e);
+  return e;
+}
+
+//! the snapshot has to reproduce the incidences of the graph
+int checkAdjacency(const HyperGraphSnapshot& snapshot)
+{
+  for (int i = 0; i < snapshot.numEdges(); ++i) {
+    HyperGraph::Edge* e = snapshot.edge(i);
+    CHECK(snapshot.index(e) == i);
+    CHECK(snapshot.verticesEnd(i) - snapshot.verticesBegin(i) == (int) e->vertices().size());
+    for (size_t j = 0; j < e->vertices().size(); ++j)
+      CHECK(snapshot.verticesBegin(i)[j] == snapshot.index(e->vertex(j)));
+  }
+  for (int i = 0; i < snapshot.numVertices(); ++i) {
+    HyperGraph::Vertex* v = snapshot.vertex(i);
+    CHECK(snapshot.index(v) == i);
+    vector<int> expected;
+    for (HyperGraph::EdgeSet::const_iterator it = v->edges().begin(); it != v->edges().end(); ++it)
+      if (snapshot.index(*it) >= 0)
+        expected.push_back(snapshot.index(*it));
+    CHECK(vector<int>(snapshot.edgesBegin(i), snapshot.edgesEnd(i)) == expected);
+  }
+  return 0;
+}
+
+int testSnapshot()
+{
+  HyperGraph graph;
+  for (int i = 9; i >= 0; --i)
+    graph.addVertex(new HyperGraph::Vertex(i));
+  vector<HyperGraph::Edge*> subset;
+  for (int i = 0; i < 9; ++i) {
+    HyperGraph::Edge* e = addEdge(graph, i, i, i + 1);
+    if (i >= 5)
+      subset.push_back(e);
+  }
+  HyperGraph::Edge* hyperEdge = addEdge(graph, 9, 0, 4, 8);
+
+  HyperGraphSnapshot snapshot;
+  snapshot.build(graph);
+  CHECK(snapshot.numVertices() == 10);
+  CHECK(snapshot.numEdges() == 10);
+  for (int i = 0; i < snapshot.numVertices(); ++i)
+    CHECK(snapshot.vertex(i)->id() == i);
+  CHECK(checkAdjacency(snapshot) == 0);
+
+  // the vertices of a subset of the edges are numbered in the order of their appearance
+  snapshot.build(subset.begin(), subset.end());
+  CHECK(snapshot.numEdges() == 4);
+  CHECK(snapshot.numVertices() == 5);
+  for (int i = 0; i < snapshot.numVertices(); ++i)
+    CHECK(snapshot.vertex(i)->id() == 5 + i);
+  CHECK(snapshot.index(graph.vertex(0)) == -1);
+  CHECK(snapshot.index(hyperEdge) == -1);
+  CHECK(checkAdjacency(snapshot) == 0);
+
+  snapshot.clear();
+  CHECK(snapshot.numVertices() == 0);
+  CHECK(snapshot.numEdges() == 0);
+  return 0;
+}
+
+int testIndexedHeap()
+{
+  const int n = 200;
+  IndexedHeap heap;
+  heap.reset(n);
+  // reference: index -> (key, time of the last push)
+  map<int, pair<number_t, int> > reference;
+  srand(3);
+  int time = 0;
+  for (int step = 0; step < 5000; ++step) {
+    if (rand() % 3 || reference.empty()) {
+      int i = rand() % n;
+      number_t key = rand() % 50;
+      heap.push(i, key);
+      reference[i] = make_pair(key, time++);
+    } else {
+      map<int, pair<number_t, int> >::iterator best = reference.begin();
+      for (map<int, pair<number_t, int> >::iterator it = reference.begin(); it != reference.end(); ++it)
+        if (it->second < best->second)
+          best = it;
+      int i = heap.pop();
+      CHECK(i == best->first);
+      CHECK(! heap.contains(i));
+      reference.erase(best);
+    }
+    CHECK(heap.size() == reference.size());
+  }
+  heap.reset(n);
+  CHECK(heap.empty());
+  for (int i = 0; i < n; ++i)
+    CHECK(! heap.contains(i));
+  return 0;
+}
+
+int testDijkstra()
+{
+  // a random connected graph, the distances are compared against Bellman-Ford
+  const int n = 60;
+  HyperGraph graph;
+  for (int i = 0; i < n; ++i)
+    graph.addVertex(new HyperGraph::Vertex(i));
+  srand(5);
+  int id = 0;
+  for (int i = 1; i < n; ++i)
+    addEdge(graph, id++, rand() % i, i);
+  for (int i = 0; i < 2 * n; ++i) {
+    int a = rand() % n, b = rand() % n;
+    if (a != b)
+      addEdge(graph, id++, a, b);
+  }
+
+  IdCostFunction cost;
+  vector<number_t> expected(n, numeric_limits<number_t>::max());
+  expected[0] = 0.;
+  for (int round = 0; round < n; ++round)
+    for (HyperGraph::EdgeSet::const_iterator it = graph.edges().begin(); it != graph.edges().end(); ++it) {
+      HyperGraph::Edge* e = *it;
+      int a = e->vertex(0)->id(), b = e->vertex(1)->id();
+      number_t c = cost(e, e->vertex(0), e->vertex(1));
+      if (expected[a] + c < expected[b])
+        expected[b] = expected[a] + c;
+      if (expected[b] + c < expected[a])
+        expected[a] = expected[b] + c;
+    }
+
+  HyperDijkstra dijkstra(&graph);
+  dijkstra.shortestPaths(graph.vertex(0), &cost);
+  CHECK(dijkstra.numVisited() == n);
+  CHECK(dijkstra.visited().size() == (size_t) n);
+  const HyperGraphSnapshot& snapshot = dijkstra.snapshot();
+  for (int i = 0; i < n; ++i) {
+    int v = snapshot.index(graph.vertex(i));
+    CHECK(dijkstra.distance(v) == expected[i]);
+    int p = dijkstra.parent(v);
+    if (i == 0) {
+      CHECK(p == -1);
+      continue;
+    }
+    HyperGraph::Edge* e = snapshot.edge(dijkstra.parentEdge(v));
+    CHECK(dijkstra.distance(p) + cost(e, snapshot.vertex(p), snapshot.vertex(v)) == expected[i]);
+  }
+
+  // the search only reaches the vertices closer than the maximum distance
+  dijkstra.shortestPaths(graph.vertex(0), &cost, 3.);
+  int reachable = 0;
+  for (int i = 0; i < n; ++i)
+    if (expected[i] < 3.)
+      ++reachable;
+  CHECK(dijkstra.numVisited() == reachable);
+  return 0;
+}
+
+int main()
+{
+  if (testSnapshot() || testIndexedHeap() || testDijkstra())
+    return 1;
+  cerr << "OK" << endl;
+  return 0;
+}
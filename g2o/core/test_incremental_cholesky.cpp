@@ -0,0 +1,174 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdlib>
+#include <iostream>
+
+#include "incremental_cholesky.h"
+
+using namespace std;
+using namespace g2o;
+
+#define CHECK(cond) \
+  if (! (cond)) { \
+    cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << endl; \
+    return 1; \
+  }
+
+/**
+ * applies random rank updates to the factor and to the dense matrix A
+ */
+struct Problem
+{
+  IncrementalCholesky factor;
+  MatrixX A;
+  VectorX b;
+  VectorX x;
+  std::vector<int> rhsChanged;
+  std::vector<int> changedBlocks;
+  MatrixX lastU; ///< U of the last update
+
+  void addBlock(int dim)
+  {
+    factor.addBlock(dim);
+    const int n = factor.rows();
+    A.conservativeResize(n, n);
+    A.rightCols(dim).setZero();
+    A.bottomRows(dim).setZero();
+    b.conservativeResize(n);
+    b.tail(dim).setZero();
+    x.conservativeResize(n);
+    x.tail(dim).setZero();
+  }
+
+  //! A += U U^T for a random U spanning the given blocks
+  bool update(const std::vector<int>& blocks, int rank, bool downdate = false, const MatrixX* given = 0)
+  {
+    int dim = 0;
+    for (size_t i = 0; i < blocks.size(); ++i)
+      dim += factor.L().rowsOfBlock(blocks[i]);
+    MatrixX U = given ? *given : MatrixX(MatrixX::Random(dim, rank));
+    MatrixX S = MatrixX::Zero(factor.rows(), U.cols());
+    for (size_t i = 0, offset = 0; i < blocks.size(); ++i) {
+      const int d = factor.L().rowsOfBlock(blocks[i]);
+      S.middleRows(factor.L().rowBaseOfBlock(blocks[i]), d) = U.middleRows(offset, d);
+      offset += d;
+    }
+    A += (downdate ? -1. : 1.) * S * S.transpose();
+    lastU = U;
+    return factor.update(blocks, U, downdate);
+  }
+
+  void changeRhs(int block)
+  {
+    b.segment(factor.L().rowBaseOfBlock(block), factor.L().rowsOfBlock(block)) += VectorX::Random(factor.L().rowsOfBlock(block));
+    rhsChanged.push_back(block);
+  }
+
+  bool solve(number_t threshold)
+  {
+    bool ok = factor.solveIncremental(x.data(), b.data(), rhsChanged, threshold, changedBlocks);
+    rhsChanged.clear();
+    return ok;
+  }
+
+  number_t error() const
+  {
+    return (A.ldlt().solve(b) - x).lpNorm<Eigen::Infinity>();
+  }
+};
+
+int main()
+{
+  srand(42);
+  Problem p;
+
+  // a chain of blocks with some loop closures
+  const int numBlocks = 40;
+  for (int k = 0; k < numBlocks; ++k) {
+    p.addBlock(k % 2 ? 3 : 2);
+    std::vector<int> blocks(1, k);
+    if (k > 0)
+      blocks.insert(blocks.begin(), k - 1);
+    CHECK(p.update(blocks, 3));
+    p.changeRhs(k);
+  }
+  CHECK(p.solve(0.));
+  CHECK(p.error() < 1e-8);
+  CHECK(p.changedBlocks.size() == (size_t) numBlocks);
+
+  // a change at the root of the elimination tree does not touch the other blocks in the forward substitution
+  p.changeRhs(numBlocks - 1);
+  CHECK(p.solve(1e10));
+  CHECK(p.changedBlocks.size() == 1);
+  p.changeRhs(numBlocks - 1);
+  CHECK(p.solve(0.));
+  CHECK(p.error() < 1e-8);
+
+  // updates, new blocks and a downdate are solved exactly with a threshold of 0
+  for (int round = 0; round < 20; ++round) {
+    p.addBlock(3);
+    const int last = p.factor.numBlocks() - 1;
+    std::vector<int> blocks;
+    blocks.push_back(rand() % last);
+    blocks.push_back(last);
+    CHECK(p.update(blocks, 4));
+    p.changeRhs(last);
+    p.changeRhs(rand() % last);
+    CHECK(p.solve(0.));
+    CHECK(p.error() < 1e-8);
+  }
+  std::vector<int> blocks;
+  blocks.push_back(3);
+  blocks.push_back(17);
+  CHECK(p.update(blocks, 2));
+  MatrixX U = p.lastU;
+  CHECK(p.solve(0.));
+  CHECK(p.error() < 1e-8);
+  CHECK(p.update(blocks, 2, true, &U));
+  CHECK(p.solve(0.));
+  CHECK(p.error() < 1e-8);
+
+  // the first solve after factorize() processes all the blocks
+  IncrementalCholesky factor;
+  for (int k = 0; k < p.factor.numBlocks(); ++k)
+    factor.addBlock(p.factor.L().rowsOfBlock(k));
+  for (int c = 0; c < factor.numBlocks(); ++c)
+    for (int r = c; r < factor.numBlocks(); ++r) {
+      const MatrixX block = p.A.block(factor.L().rowBaseOfBlock(r), factor.L().colBaseOfBlock(c), factor.L().rowsOfBlock(r), factor.L().colsOfBlock(c));
+      if (! block.isZero(0))
+        *factor.lowerBlock(r, c) = block;
+    }
+  CHECK(factor.factorize());
+  VectorX x = VectorX::Zero(factor.rows());
+  std::vector<int> changedBlocks;
+  CHECK(factor.solveIncremental(x.data(), p.b.data(), std::vector<int>(), 0., changedBlocks));
+  CHECK(changedBlocks.size() == (size_t) factor.numBlocks());
+  CHECK((x - p.x).lpNorm<Eigen::Infinity>() < 1e-8);
+
+  cerr << "OK" << endl;
+  return 0;
+}
@@ -83,13 +83,14 @@ int main(int argc, const char* argv[]){
   {
     cout << endl;
     cout << "Please type: " << endl;
-    cout << "ba_demo [PIXEL_NOISE] [OUTLIER RATIO] [ROBUST_KERNEL] [STRUCTURE_ONLY] [DENSE]" << endl;
+    cout << "ba_demo [PIXEL_NOISE] [OUTLIER RATIO] [ROBUST_KERNEL] [STRUCTURE_ONLY] [DENSE] [BATCH]" << endl;
     cout << endl;
     cout << "PIXEL_NOISE: noise in image space (E.g.: 1)" << endl;
     cout << "OUTLIER_RATIO: probability of spuroius observation  (default: 0.0)" << endl;
     cout << "ROBUST_KERNEL: use robust kernel (0 or 1; default: 0==false)" << endl;
     cout << "STRUCTURE_ONLY: performe structure-only BA to get better point initializations (0 or 1; default: 0==false)" << endl;
     cout << "DENSE: Use dense solver (0 or 1; default: 0==false)" << endl;
+    cout << "BATCH: evaluate the projections in batches (0 or 1; default: 0==false)" << endl;
     cout << endl;
     cout << "Note, if OUTLIER_RATIO is above 0, ROBUST_KERNEL should be set to 1==true." << endl;
     cout << endl;
@@ -117,11 +118,17 @@ int main(int argc, const char* argv[]){
     DENSE = atoi(argv[5]) != 0;
   }
 
+  bool BATCH = false;
+  if (argc>6){
+    BATCH = atoi(argv[6]) != 0;
+  }
+
   cout << "PIXEL_NOISE: " <<  PIXEL_NOISE << endl;
   cout << "OUTLIER_RATIO: " << OUTLIER_RATIO<<  endl;
   cout << "ROBUST_KERNEL: " << ROBUST_KERNEL << endl;
   cout << "STRUCTURE_ONLY: " << STRUCTURE_ONLY<< endl;
   cout << "DENSE: "<<  DENSE << endl;
+  cout << "BATCH: "<<  BATCH << endl;
 
 
 
@@ -247,6 +254,7 @@ int main(int argc, const char* argv[]){
     }
   }
   cout << endl;
+  optimizer.setBatchEvaluation(BATCH);
   optimizer.initializeOptimization();
   optimizer.setVerbose(true);
   if (STRUCTURE_ONLY){
@@ -259,6 +267,11 @@ int main(int argc, const char* argv[]){
         points.push_back(v);
     }
     structure_only_ba.calc(points, 10);
+    int numConverged = 0;
+    for (size_t i = 0; i < structure_only_ba.pointStatus().size(); ++i)
+      if (structure_only_ba.pointStatus()[i].result == g2o::StructureOnlySolver<3>::Converged)
+        ++numConverged;
+    cout << numConverged << " of " << points.size() << " points converged" << endl;
   }
   //optimizer.save("test.g2o");
   cout << endl;
@@ -130,9 +130,9 @@ int main(int argc, char** argv)
   d.shortestPaths(gauge, &f);
   //cerr << PVAR(d.visited().size()) << endl;
 
-  if (d.visited().size()!=optimizer.vertices().size()) {
+  if (d.numVisited()!=(int)optimizer.vertices().size()) {
     cerr << CL_RED("Warning: d.visited().size() != optimizer.vertices().size()") << endl;
-    cerr << "visited: " << d.visited().size() << endl;
+    cerr << "visited: " << d.numVisited() << endl;
     cerr << "vertices: " << optimizer.vertices().size() << endl;
     if (1)
       for (SparseOptimizer::VertexIDMap::const_iterator it = optimizer.vertices().begin(); it != optimizer.vertices().end(); ++it) {
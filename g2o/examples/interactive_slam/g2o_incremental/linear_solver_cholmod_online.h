@@ -106,10 +106,10 @@ class LinearSolverCholmodOnline : public LinearSolver<MatrixType>, public Linear
       memcpy(x, xcholmod->x, sizeof(double) * bcholmod.nrow); // copy back to our array
       cholmod_free_dense(&xcholmod, &_cholmodCommon);
 
-      G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-      if (globalStats){
-        globalStats->timeNumericDecomposition = get_monotonic_time() - t;
-        globalStats->choleskyNNZ = static_cast<size_t>(_cholmodCommon.method[0].lnz);
+      G2OBatchStatistics* stats = this->batchStatistics();
+      if (stats){
+        stats->timeNumericDecomposition = get_monotonic_time() - t;
+        stats->choleskyNNZ = static_cast<size_t>(_cholmodCommon.method[0].lnz);
       }
 
       return true;
@@ -208,9 +208,9 @@ class LinearSolverCholmodOnline : public LinearSolver<MatrixType>, public Linear
       _cholmodCommon.method[0].ordering = CHOLMOD_GIVEN;
       _cholmodFactor = cholmod_analyze_p(_cholmodSparse, _scalarPermutation.data(), NULL, 0, &_cholmodCommon);
 
-      G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-      if (globalStats)
-        globalStats->timeSymbolicDecomposition = get_monotonic_time() - t;
+      G2OBatchStatistics* stats = this->batchStatistics();
+      if (stats)
+        stats->timeSymbolicDecomposition = get_monotonic_time() - t;
 
     }
 
@@ -0,0 +1,467 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+
+#include "g2o/core/jacobian_workspace.h"
+#include "g2o/stuff/command_args.h"
+#include "g2o/stuff/sampler.h"
+#include "g2o/stuff/timeutil.h"
+#include "g2o/types/sim3/types_seven_dof_expmap.h"
+#include "g2o/types/slam2d/edge_se2_pointxy_bearing.h"
+#include "g2o/types/slam2d/edge_se2_pointxy_calib.h"
+#include "g2o/types/slam2d_addons/edge_se2_segment2d.h"
+#include "g2o/types/slam2d_addons/edge_se2_segment2d_line.h"
+#include "g2o/types/slam2d_addons/edge_se2_segment2d_pointLine.h"
+#include "g2o/types/slam2d_addons/edge_se2_line2d.h"
+#include "g2o/types/slam2d_addons/edge_line2d_pointxy.h"
+#include "g2o/types/sclam2d/edge_se2_sensor_calib.h"
+#include "g2o/types/sclam2d/edge_se2_odom_differential_calib.h"
+#include "g2o/types/slam3d_addons/edge_se3_calib.h"
+#include "g2o/types/slam3d_addons/edge_se3_plane_calib.h"
+
+using namespace std;
+using namespace g2o;
+
+// checks the analytic Jacobians of the edge types against the numeric
+// differentiation of their base class and reports the cost of the
+// linearization per edge. Returns 1, if one of the Jacobians differs.
+
+/**
+ * the edge linearized by the numeric differentiation of NumericBase
+ */
+template <typename EdgeType, typename NumericBase>
+class NumericEdge : public EdgeType
+{
+  public:
+    using EdgeType::linearizeOplus;
+    virtual void linearizeOplus() { NumericBase::linearizeOplus();}
+};
+
+number_t noise(number_t sigma)
+{
+  return sampleUniform(-sigma, sigma);
+}
+
+Matrix3 randomRotation()
+{
+  Vector3 axis = Vector3::Random();
+  return AngleAxis(sampleUniform(-M_PI, M_PI), axis.normalized()).toRotationMatrix();
+}
+
+Isometry3 randomIsometry3(number_t maxAngle, number_t maxTranslation)
+{
+  Vector3 axis = Vector3::Random();
+  Isometry3 result = (Isometry3)AngleAxis(sampleUniform(-maxAngle, maxAngle), axis.normalized()).toRotationMatrix();
+  result.translation() = maxTranslation * Vector3::Random();
+  return result;
+}
+
+SE2 randomSE2(number_t maxAngle, number_t maxTranslation)
+{
+  return SE2(noise(maxTranslation), noise(maxTranslation), noise(maxAngle));
+}
+
+/*
+ * Each setup function creates the vertices of one random configuration,
+ * connects them to both edges and sets a measurement close to the
+ * prediction.
+ */
+
+VertexSim3Expmap* randomSim3Vertex()
+{
+  VertexSim3Expmap* v = new VertexSim3Expmap;
+  v->setEstimate(Sim3(randomRotation(), Vector3::Random(), sampleUniform(0.5, 2.)));
+  v->_focal_length1 = Vector2(sampleUniform(400., 600.), sampleUniform(400., 600.));
+  v->_focal_length2 = Vector2(sampleUniform(400., 600.), sampleUniform(400., 600.));
+  v->_principle_point1 = Vector2(320., 240.);
+  v->_principle_point2 = Vector2(320., 240.);
+  v->_fix_scale = sampleUniform() < 0.5;
+  return v;
+}
+
+Vector3 randomPointInFront()
+{
+  return Vector3(noise(1.), noise(1.), sampleUniform(2., 5.));
+}
+
+void setupSim3ProjectXYZ(EdgeSim3ProjectXYZ* edges[2])
+{
+  VertexSim3Expmap* sim3 = randomSim3Vertex();
+  VertexSBAPointXYZ* point = new VertexSBAPointXYZ;
+  Vector3 inCamera = randomPointInFront();
+  point->setEstimate(sim3->estimate().inverse().map(inCamera));
+  Vector2 measurement = sim3->cam_map1(project(inCamera)) + Vector2(noise(1.), noise(1.));
+  for (int i = 0; i < 2; ++i) {
+    edges[i]->setVertex(0, point);
+    edges[i]->setVertex(1, sim3);
+    edges[i]->setMeasurement(measurement);
+  }
+}
+
+void setupInverseSim3ProjectXYZ(EdgeInverseSim3ProjectXYZ* edges[2])
+{
+  VertexSim3Expmap* sim3 = randomSim3Vertex();
+  VertexSBAPointXYZ* point = new VertexSBAPointXYZ;
+  Vector3 inCamera = randomPointInFront();
+  point->setEstimate(sim3->estimate().map(inCamera));
+  Vector2 measurement = sim3->cam_map2(project(inCamera)) + Vector2(noise(1.), noise(1.));
+  for (int i = 0; i < 2; ++i) {
+    edges[i]->setVertex(0, point);
+    edges[i]->setVertex(1, sim3);
+    edges[i]->setMeasurement(measurement);
+  }
+}
+
+void setupSE2PointXYBearing(EdgeSE2PointXYBearing* edges[2])
+{
+  VertexSE2* pose = new VertexSE2;
+  pose->setEstimate(randomSE2(M_PI, 10.));
+  VertexPointXY* point = new VertexPointXY;
+  number_t angle = noise(M_PI);
+  point->setEstimate(pose->estimate() * (sampleUniform(1., 5.) * Vector2(std::cos(angle), std::sin(angle))));
+  for (int i = 0; i < 2; ++i) {
+    edges[i]->setVertex(0, pose);
+    edges[i]->setVertex(1, point);
+    edges[i]->setMeasurement(normalize_theta(angle + noise(0.05)));
+  }
+}
+
+void setupSE2PointXYCalib(EdgeSE2PointXYCalib* edges[2])
+{
+  VertexSE2* pose = new VertexSE2;
+  pose->setEstimate(randomSE2(M_PI, 10.));
+  VertexSE2* calib = new VertexSE2;
+  calib->setEstimate(randomSE2(0.5, 0.5));
+  VertexPointXY* point = new VertexPointXY;
+  point->setEstimate(pose->estimate() * Vector2(noise(5.), noise(5.)));
+  Vector2 measurement = (pose->estimate() * calib->estimate()).inverse() * point->estimate() + Vector2(noise(0.1), noise(0.1));
+  for (int i = 0; i < 2; ++i) {
+    edges[i]->setVertex(0, pose);
+    edges[i]->setVertex(1, point);
+    edges[i]->setVertex(2, calib);
+    edges[i]->setMeasurement(measurement);
+  }
+}
+
+VertexSegment2D* randomSegmentVertex(const SE2& pose)
+{
+  VertexSegment2D* segment = new VertexSegment2D;
+  Vector2 p1(noise(5.), noise(5.));
+  number_t angle = noise(M_PI);
+  Vector2 p2 = p1 + sampleUniform(1., 3.) * Vector2(std::cos(angle), std::sin(angle));
+  segment->setEstimateP1(pose * p1);
+  segment->setEstimateP2(pose * p2);
+  return segment;
+}
+
+void setupSE2Segment2D(EdgeSE2Segment2D* edges[2])
+{
+  VertexSE2* pose = new VertexSE2;
+  pose->setEstimate(randomSE2(M_PI, 10.));
+  VertexSegment2D* segment = randomSegmentVertex(pose->estimate());
+  for (int i = 0; i < 2; ++i) {
+    edges[i]->setVertex(0, pose);
+    edges[i]->setVertex(1, segment);
+  }
+  edges[0]->setMeasurement(Vector4::Zero());
+  edges[0]->computeError();
+  Vector4 measurement = edges[0]->error() + 0.1 * Vector4::Random();
+  for (int i = 0; i < 2; ++i)
+    edges[i]->setMeasurement(measurement);
+}
+
+void setupSE2Segment2DLine(EdgeSE2Segment2DLine* edges[2])
+{
+  VertexSE2* pose = new VertexSE2;
+  pose->setEstimate(randomSE2(M_PI, 10.));
+  VertexSegment2D* segment = randomSegmentVertex(pose->estimate());
+  for (int i = 0; i < 2; ++i) {
+    edges[i]->setVertex(0, pose);
+    edges[i]->setVertex(1, segment);
+  }
+  edges[0]->setMeasurement(Vector2::Zero());
+  edges[0]->computeError();
+  Vector2 measurement = edges[0]->error() + Vector2(noise(0.05), noise(0.1));
+  for (int i = 0; i < 2; ++i)
+    edges[i]->setMeasurement(measurement);
+}
+
+void setupSE2Segment2DPointLine(EdgeSE2Segment2DPointLine* edges[2])
+{
+  VertexSE2* pose = new VertexSE2;
+  pose->setEstimate(randomSE2(M_PI, 10.));
+  VertexSegment2D* segment = randomSegmentVertex(pose->estimate());
+  int pointNum = sampleUniform() < 0.5 ? 0 : 1;
+  for (int i = 0; i < 2; ++i) {
+    edges[i]->setVertex(0, pose);
+    edges[i]->setVertex(1, segment);
+    edges[i]->setPointNum(pointNum);
+  }
+  edges[0]->setMeasurement(Vector3::Zero());
+  edges[0]->computeError();
+  Vector3 measurement = edges[0]->error() + Vector3(noise(0.1), noise(0.1), noise(0.05));
+  for (int i = 0; i < 2; ++i)
+    edges[i]->setMeasurement(measurement);
+}
+
+void setupSE2Line2D(EdgeSE2Line2D* edges[2])
+{
+  VertexSE2* pose = new VertexSE2;
+  pose->setEstimate(randomSE2(M_PI, 10.));
+  VertexLine2D* line = new VertexLine2D;
+  line->setEstimate(Line2D(Vector2(noise(M_PI), noise(5.))));
+  for (int i = 0; i < 2; ++i) {
+    edges[i]->setVertex(0, pose);
+    edges[i]->setVertex(1, line);
+  }
+  edges[0]->setMeasurement(Line2D(Vector2::Zero()));
+  edges[0]->computeError();
+  Line2D measurement(edges[0]->error() + Vector2(noise(0.05), noise(0.1)));
+  for (int i = 0; i < 2; ++i)
+    edges[i]->setMeasurement(measurement);
+}
+
+void setupLine2DPointXY(EdgeLine2DPointXY* edges[2])
+{
+  VertexLine2D* line = new VertexLine2D;
+  line->setEstimate(Line2D(Vector2(noise(M_PI), noise(5.))));
+  VertexPointXY* point = new VertexPointXY;
+  point->setEstimate(Vector2(noise(5.), noise(5.)));
+  for (int i = 0; i < 2; ++i) {
+    edges[i]->setVertex(0, line);
+    edges[i]->setVertex(1, point);
+  }
+  edges[0]->setMeasurement(0.);
+  edges[0]->computeError();
+  number_t measurement = edges[0]->error()[0] + noise(0.1);
+  for (int i = 0; i < 2; ++i)
+    edges[i]->setMeasurement(measurement);
+}
+
+void setupSE2SensorCalib(EdgeSE2SensorCalib* edges[2])
+{
+  VertexSE2* v1 = new VertexSE2;
+  v1->setEstimate(randomSE2(M_PI, 10.));
+  VertexSE2* v2 = new VertexSE2;
+  v2->setEstimate(v1->estimate() * randomSE2(0.5, 1.));
+  VertexSE2* offset = new VertexSE2;
+  offset->setEstimate(randomSE2(0.5, 0.5));
+  SE2 measurement = (v1->estimate() * offset->estimate()).inverse() * v2->estimate() * offset->estimate() * randomSE2(0.05, 0.1);
+  for (int i = 0; i < 2; ++i) {
+    edges[i]->setVertex(0, v1);
+    edges[i]->setVertex(1, v2);
+    edges[i]->setVertex(2, offset);
+    edges[i]->setMeasurement(measurement);
+  }
+}
+
+void setupSE2OdomDifferentialCalib(EdgeSE2OdomDifferentialCalib* edges[2])
+{
+  VertexSE2* v1 = new VertexSE2;
+  v1->setEstimate(randomSE2(M_PI, 10.));
+  VertexOdomDifferentialParams* params = new VertexOdomDifferentialParams;
+  params->setEstimate(Vector3(1. + noise(0.1), 1. + noise(0.1), sampleUniform(0.4, 0.6)));
+  number_t vl = sampleUniform(0.5, 1.5);
+  // a curved motion, close to a straight one the numeric Jacobian is dominated by round-off
+  number_t curvature = (sampleUniform() < 0.5 ? -1. : 1.) * sampleUniform(0.1, 0.5);
+  number_t vr = (vl * params->estimate()(0) + curvature) / params->estimate()(1);
+  VelocityMeasurement measurement(vl, vr, sampleUniform(0.5, 1.));
+  VelocityMeasurement calibrated(vl * params->estimate()(0), vr * params->estimate()(1), measurement.dt());
+  MotionMeasurement motion = OdomConvert::convertToMotion(calibrated, params->estimate()(2));
+  VertexSE2* v2 = new VertexSE2;
+  v2->setEstimate(v1->estimate() * SE2(motion.measurement()) * randomSE2(0.05, 0.1));
+  for (int i = 0; i < 2; ++i) {
+    edges[i]->setVertex(0, v1);
+    edges[i]->setVertex(1, v2);
+    edges[i]->setVertex(2, params);
+    edges[i]->setMeasurement(measurement);
+  }
+}
+
+void setupSE3Calib(EdgeSE3Calib* edges[2])
+{
+  VertexSE3* v1 = new VertexSE3;
+  v1->setEstimate(randomIsometry3(M_PI, 10.));
+  VertexSE3* v2 = new VertexSE3;
+  v2->setEstimate(v1->estimate() * randomIsometry3(0.5, 1.));
+  VertexSE3* calib = new VertexSE3;
+  calib->setEstimate(randomIsometry3(0.5, 0.5));
+  Isometry3 measurement = (v1->estimate() * calib->estimate()).inverse() * v2->estimate() * calib->estimate() * randomIsometry3(0.05, 0.1);
+  for (int i = 0; i < 2; ++i) {
+    edges[i]->setVertex(0, v1);
+    edges[i]->setVertex(1, v2);
+    edges[i]->setVertex(2, calib);
+    edges[i]->setMeasurement(measurement);
+  }
+}
+
+void setupSE3PlaneSensorCalib(EdgeSE3PlaneSensorCalib* edges[2])
+{
+  VertexSE3* v1 = new VertexSE3;
+  v1->setEstimate(randomIsometry3(M_PI, 10.));
+  VertexSE3* offset = new VertexSE3;
+  offset->setEstimate(randomIsometry3(0.5, 0.5));
+  VertexPlane* plane = new VertexPlane;
+  Vector4 coeffs;
+  coeffs.head<3>() = Vector3::Random().normalized();
+  coeffs(3) = noise(5.);
+  plane->setEstimate(Plane3D(coeffs));
+  Plane3D measurement = (v1->estimate() * offset->estimate()).inverse() * plane->estimate();
+  measurement.oplus(Vector3(noise(0.05), noise(0.05), noise(0.1)));
+  for (int i = 0; i < 2; ++i) {
+    edges[i]->setVertex(0, v1);
+    edges[i]->setVertex(1, plane);
+    edges[i]->setVertex(2, offset);
+    edges[i]->setMeasurement(measurement);
+  }
+}
+
+//! linearize all the edges repeat times, returns the time per edge in microseconds
+double linearize(const vector<OptimizableGraph::Edge*>& edges, JacobianWorkspace& workspace, int repeat)
+{
+  double start = get_monotonic_time();
+  for (int r = 0; r < repeat; ++r) {
+    for (size_t k = 0; k < edges.size(); ++k) {
+      edges[k]->computeError();
+      edges[k]->linearizeOplus(workspace);
+    }
+  }
+  return 1e6 * (get_monotonic_time() - start) / (repeat * edges.size());
+}
+
+/**
+ * compares the analytic with the numeric Jacobian of numEdges random
+ * configurations and measures the time of both linearizations. Returns
+ * false, if the relative difference exceeds the tolerance.
+ */
+template <typename EdgeType, typename NumericBase>
+bool check(const string& name, void (*setup)(EdgeType* edges[2]), int numEdges, int repeat, double tolerance)
+{
+  vector<OptimizableGraph::Edge*> analytic;
+  vector<OptimizableGraph::Edge*> numeric;
+  JacobianWorkspace analyticWorkspace;
+  JacobianWorkspace numericWorkspace;
+  for (int k = 0; k < numEdges; ++k) {
+    EdgeType* edges[2] = {new EdgeType, new NumericEdge<EdgeType, NumericBase>};
+    setup(edges);
+    analytic.push_back(edges[0]);
+    numeric.push_back(edges[1]);
+    analyticWorkspace.updateSize(edges[0]);
+    numericWorkspace.updateSize(edges[1]);
+  }
+  analyticWorkspace.allocate();
+  numericWorkspace.allocate();
+
+  double maxDifference = 0.;
+  for (int k = 0; k < numEdges; ++k) {
+    analytic[k]->computeError();
+    analytic[k]->linearizeOplus(analyticWorkspace);
+    numeric[k]->computeError();
+    numeric[k]->linearizeOplus(numericWorkspace);
+    for (size_t i = 0; i < analytic[k]->vertices().size(); ++i) {
+      const OptimizableGraph::Vertex* v = static_cast<const OptimizableGraph::Vertex*>(analytic[k]->vertex(i));
+      const number_t* a = analyticWorkspace.workspaceForVertex(i);
+      const number_t* n = numericWorkspace.workspaceForVertex(i);
+      int size = analytic[k]->dimension() * v->dimension();
+      // relative to the largest entry of the block, the numeric Jacobian
+      // of the projections is only accurate to a few pixels times 1e-7
+      number_t scale = 1.;
+      for (int j = 0; j < size; ++j)
+        scale = max(scale, fabs(a[j]));
+      for (int j = 0; j < size; ++j)
+        maxDifference = max(maxDifference, fabs(a[j] - n[j]) / scale);
+    }
+  }
+
+  double analyticTime = linearize(analytic, analyticWorkspace, repeat);
+  double numericTime = linearize(numeric, numericWorkspace, repeat);
+  bool ok = maxDifference <= tolerance;
+  cout << left << setw(30) << name << right << fixed
+    << setw(12) << setprecision(3) << analyticTime
+    << setw(12) << setprecision(3) << numericTime
+    << setw(10) << setprecision(1) << numericTime / analyticTime << "x"
+    << setw(14) << scientific << setprecision(2) << maxDifference
+    << (ok ? "" : "  FAILED") << endl;
+
+  for (int k = 0; k < numEdges; ++k) {
+    for (size_t i = 0; i < analytic[k]->vertices().size(); ++i)
+      delete analytic[k]->vertex(i);
+    delete analytic[k];
+    delete numeric[k];
+  }
+  return ok;
+}
+
+int main(int argc, char** argv)
+{
+  int numEdges;
+  int repeat;
+  double tolerance;
+  CommandArgs arg;
+  arg.param("edges", numEdges, 1000, "number of random edges per type");
+  arg.param("repeat", repeat, 20, "how often all the edges are linearized");
+  arg.param("tolerance", tolerance, 1e-5, "max relative difference between the analytic and the numeric Jacobian");
+  arg.parseArgs(argc, argv);
+
+  cout << left << setw(30) << "edge type" << right
+    << setw(12) << "analytic" << setw(12) << "numeric" << setw(11) << "speedup"
+    << setw(14) << "max diff" << endl
+    << setw(30) << "" << setw(24) << "usec per edge" << endl;
+
+  bool ok = true;
+  ok &= check<EdgeSim3ProjectXYZ, BaseBinaryEdge<2, Vector2, VertexSBAPointXYZ, VertexSim3Expmap> >(
+      "EdgeSim3ProjectXYZ", setupSim3ProjectXYZ, numEdges, repeat, tolerance);
+  ok &= check<EdgeInverseSim3ProjectXYZ, BaseBinaryEdge<2, Vector2, VertexSBAPointXYZ, VertexSim3Expmap> >(
+      "EdgeInverseSim3ProjectXYZ", setupInverseSim3ProjectXYZ, numEdges, repeat, tolerance);
+  ok &= check<EdgeSE2PointXYBearing, BaseBinaryEdge<1, number_t, VertexSE2, VertexPointXY> >(
+      "EdgeSE2PointXYBearing", setupSE2PointXYBearing, numEdges, repeat, tolerance);
+  ok &= check<EdgeSE2PointXYCalib, BaseMultiEdge<2, Vector2> >(
+      "EdgeSE2PointXYCalib", setupSE2PointXYCalib, numEdges, repeat, tolerance);
+  ok &= check<EdgeSE2Segment2D, BaseBinaryEdge<4, Vector4, VertexSE2, VertexSegment2D> >(
+      "EdgeSE2Segment2D", setupSE2Segment2D, numEdges, repeat, tolerance);
+  ok &= check<EdgeSE2Segment2DLine, BaseBinaryEdge<2, Vector2, VertexSE2, VertexSegment2D> >(
+      "EdgeSE2Segment2DLine", setupSE2Segment2DLine, numEdges, repeat, tolerance);
+  ok &= check<EdgeSE2Segment2DPointLine, BaseBinaryEdge<3, Vector3, VertexSE2, VertexSegment2D> >(
+      "EdgeSE2Segment2DPointLine", setupSE2Segment2DPointLine, numEdges, repeat, tolerance);
+  ok &= check<EdgeSE2Line2D, BaseBinaryEdge<2, Line2D, VertexSE2, VertexLine2D> >(
+      "EdgeSE2Line2D", setupSE2Line2D, numEdges, repeat, tolerance);
+  ok &= check<EdgeLine2DPointXY, BaseBinaryEdge<1, number_t, VertexLine2D, VertexPointXY> >(
+      "EdgeLine2DPointXY", setupLine2DPointXY, numEdges, repeat, tolerance);
+  ok &= check<EdgeSE2SensorCalib, BaseMultiEdge<3, SE2> >(
+      "EdgeSE2SensorCalib", setupSE2SensorCalib, numEdges, repeat, tolerance);
+  ok &= check<EdgeSE2OdomDifferentialCalib, BaseMultiEdge<3, VelocityMeasurement> >(
+      "EdgeSE2OdomDifferentialCalib", setupSE2OdomDifferentialCalib, numEdges, repeat, tolerance);
+  ok &= check<EdgeSE3Calib, BaseMultiEdge<6, Isometry3> >(
+      "EdgeSE3Calib", setupSE3Calib, numEdges, repeat, tolerance);
+  ok &= check<EdgeSE3PlaneSensorCalib, BaseMultiEdge<3, Plane3D> >(
+      "EdgeSE3PlaneSensorCalib", setupSE3PlaneSensorCalib, numEdges, repeat, tolerance);
+
+  return ok ? 0 : 1;
+}
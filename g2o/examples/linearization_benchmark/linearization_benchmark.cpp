@@ -0,0 +1,279 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <iostream>
+#include <cmath>
+#include <vector>
+
+#include "g2o/core/auto_differentiation.h"
+#include "g2o/core/jacobian_workspace.h"
+#include "g2o/stuff/command_args.h"
+#include "g2o/stuff/sampler.h"
+#include "g2o/stuff/timeutil.h"
+#include "g2o/types/slam2d/edge_se2.h"
+#include "g2o/types/slam2d/edge_se2_pointxy.h"
+
+using namespace std;
+using namespace g2o;
+
+// compares the analytic Jacobians of EdgeSE2 and EdgeSE2PointXY with the
+// numeric differentiation (local copy and backup stack) and with the
+// automatic differentiation of AutoDiffEdge
+
+/**
+ * numeric differentiation, the estimate is perturbed around a local copy
+ */
+template <typename EdgeType>
+class NumericEdge : public EdgeType
+{
+  public:
+    typedef BaseBinaryEdge<EdgeType::Dimension, typename EdgeType::Measurement, typename EdgeType::VertexXiType, typename EdgeType::VertexXjType> NumericBase;
+    using EdgeType::linearizeOplus;
+    virtual void linearizeOplus() { NumericBase::linearizeOplus();}
+};
+
+/**
+ * numeric differentiation by the generic implementation of the vertex based on push() and pop()
+ */
+template <typename EdgeType>
+class NumericStackEdge : public EdgeType
+{
+  public:
+    using EdgeType::linearizeOplus;
+    virtual void linearizeOplus()
+    {
+      const number_t delta = cst(1e-9);
+      typename EdgeType::ErrorVector errorBeforeNumeric = this->_error;
+      OptimizableGraph::Vertex* vi = static_cast<OptimizableGraph::Vertex*>(this->_vertices[0]);
+      OptimizableGraph::Vertex* vj = static_cast<OptimizableGraph::Vertex*>(this->_vertices[1]);
+      vi->OptimizableGraph::Vertex::numericJacobian(this, delta, this->_jacobianOplusXi.data());
+      vj->OptimizableGraph::Vertex::numericJacobian(this, delta, this->_jacobianOplusXj.data());
+      this->_error = errorBeforeNumeric;
+    }
+};
+
+class EdgeSE2AutoDiff : public AutoDiffEdge<EdgeSE2AutoDiff, EdgeSE2>
+{
+  public:
+    template <typename T>
+    bool operator()(const T* xi, const T* xj, T* error) const
+    {
+      using std::cos; using std::sin; using std::atan2;
+      // relative motion from xi to xj
+      T ci = cos(xi[2]);
+      T si = sin(xi[2]);
+      T dx = xj[0] - xi[0];
+      T dy = xj[1] - xi[1];
+      T tx = ci * dx + si * dy;
+      T ty = -si * dx + ci * dy;
+      // expressed in the frame of the measurement
+      const Vector3 m = _measurement.toVector();
+      const number_t cm = std::cos(m[2]);
+      const number_t sm = std::sin(m[2]);
+      error[0] = cm * (tx - m[0]) + sm * (ty - m[1]);
+      error[1] = -sm * (tx - m[0]) + cm * (ty - m[1]);
+      T dtheta = xj[2] - xi[2] - m[2];
+      error[2] = atan2(sin(dtheta), cos(dtheta));
+      return true;
+    }
+};
+
+class EdgeSE2PointXYAutoDiff : public AutoDiffEdge<EdgeSE2PointXYAutoDiff, EdgeSE2PointXY>
+{
+  public:
+    template <typename T>
+    bool operator()(const T* xi, const T* xj, T* error) const
+    {
+      using std::cos; using std::sin;
+      T ci = cos(xi[2]);
+      T si = sin(xi[2]);
+      T dx = xj[0] - xi[0];
+      T dy = xj[1] - xi[1];
+      error[0] = ci * dx + si * dy - _measurement[0];
+      error[1] = -si * dx + ci * dy - _measurement[1];
+      return true;
+    }
+};
+
+struct Problem
+{
+  vector<VertexSE2*> poses;
+  vector<VertexPointXY*> landmarks;
+  vector<pair<int, int> > odometry;
+  vector<pair<int, int> > observations;
+};
+
+template <typename EdgeType>
+vector<OptimizableGraph::Edge*> createOdometryEdges(const Problem& problem)
+{
+  vector<OptimizableGraph::Edge*> edges;
+  for (size_t k = 0; k < problem.odometry.size(); ++k) {
+    EdgeType* e = new EdgeType;
+    VertexSE2* from = problem.poses[problem.odometry[k].first];
+    VertexSE2* to = problem.poses[problem.odometry[k].second];
+    e->setVertex(0, from);
+    e->setVertex(1, to);
+    e->setMeasurement(from->estimate().inverse() * to->estimate() * SE2(0.01, -0.02, 0.005));
+    edges.push_back(e);
+  }
+  return edges;
+}
+
+template <typename EdgeType>
+vector<OptimizableGraph::Edge*> createObservationEdges(const Problem& problem)
+{
+  vector<OptimizableGraph::Edge*> edges;
+  for (size_t k = 0; k < problem.observations.size(); ++k) {
+    EdgeType* e = new EdgeType;
+    VertexSE2* from = problem.poses[problem.observations[k].first];
+    VertexPointXY* to = problem.landmarks[problem.observations[k].second];
+    e->setVertex(0, from);
+    e->setVertex(1, to);
+    e->setMeasurement(from->estimate().inverse() * to->estimate() + Vector2(0.02, -0.01));
+    edges.push_back(e);
+  }
+  return edges;
+}
+
+//! linearize all the edges repeat times, returns the time per edge in microseconds
+double linearize(const vector<OptimizableGraph::Edge*>& edges, JacobianWorkspace& workspace, int repeat)
+{
+  double start = get_monotonic_time();
+  for (int r = 0; r < repeat; ++r) {
+    for (size_t k = 0; k < edges.size(); ++k) {
+      edges[k]->computeError();
+      edges[k]->linearizeOplus(workspace);
+    }
+  }
+  return 1e6 * (get_monotonic_time() - start) / (repeat * edges.size());
+}
+
+//! max absolute difference between the Jacobians of two edges
+template <typename EdgeTypeA, typename EdgeTypeB>
+double jacobianDifference(const EdgeTypeA* a, const EdgeTypeB* b)
+{
+  double diff = (a->jacobianOplusXi() - b->jacobianOplusXi()).cwiseAbs().maxCoeff();
+  return max(diff, (a->jacobianOplusXj() - b->jacobianOplusXj()).cwiseAbs().maxCoeff());
+}
+
+template <typename AnalyticEdge, typename OtherEdge>
+double maxJacobianDifference(const vector<OptimizableGraph::Edge*>& analytic, const vector<OptimizableGraph::Edge*>& other, JacobianWorkspace& workspaceA, JacobianWorkspace& workspaceB)
+{
+  double diff = 0.;
+  for (size_t k = 0; k < analytic.size(); ++k) {
+    analytic[k]->computeError();
+    analytic[k]->linearizeOplus(workspaceA);
+    other[k]->computeError();
+    other[k]->linearizeOplus(workspaceB);
+    diff = max(diff, jacobianDifference(static_cast<AnalyticEdge*>(analytic[k]), static_cast<OtherEdge*>(other[k])));
+  }
+  return diff;
+}
+
+template <typename AnalyticEdge, typename AutoDiffEdgeType>
+void benchmark(const string& name, const vector<OptimizableGraph::Edge*> edges[4], int repeat)
+{
+  const char* labels[4] = {"analytic", "numeric", "numeric (backup stack)", "automatic"};
+  JacobianWorkspace workspace;
+  JacobianWorkspace workspaceOther;
+  for (size_t k = 0; k < edges[0].size(); ++k)
+    workspace.updateSize(edges[0][k]);
+  workspace.allocate();
+  workspaceOther.updateSize(2, AnalyticEdge::Dimension * 3);
+  workspaceOther.allocate();
+
+  cout << name << endl;
+  for (int i = 0; i < 4; ++i) {
+    double usec = linearize(edges[i], workspace, repeat);
+    cout << "  " << labels[i] << ": " << usec << " usec per edge";
+    if (i == 1)
+      cout << ", max difference " << maxJacobianDifference<AnalyticEdge, NumericEdge<AnalyticEdge> >(edges[0], edges[i], workspace, workspaceOther);
+    else if (i == 2)
+      cout << ", max difference " << maxJacobianDifference<AnalyticEdge, NumericStackEdge<AnalyticEdge> >(edges[0], edges[i], workspace, workspaceOther);
+    else if (i == 3)
+      cout << ", max difference " << maxJacobianDifference<AnalyticEdge, AutoDiffEdgeType>(edges[0], edges[i], workspace, workspaceOther);
+    cout << endl;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  int numPoses;
+  int numLandmarks;
+  int repeat;
+  CommandArgs arg;
+  arg.param("poses", numPoses, 10000, "number of poses");
+  arg.param("landmarks", numLandmarks, 1000, "number of landmarks");
+  arg.param("repeat", repeat, 20, "how often all the edges are linearized");
+  arg.parseArgs(argc, argv);
+
+  Problem problem;
+  for (int i = 0; i < numPoses; ++i) {
+    VertexSE2* v = new VertexSE2;
+    v->setId(i);
+    v->setEstimate(SE2(sampleUniform(-50., 50.), sampleUniform(-50., 50.), sampleUniform(-M_PI, M_PI)));
+    problem.poses.push_back(v);
+    if (i > 0)
+      problem.odometry.push_back(make_pair(i - 1, i));
+  }
+  for (int i = 0; i < numLandmarks; ++i) {
+    VertexPointXY* v = new VertexPointXY;
+    v->setId(numPoses + i);
+    v->setEstimate(Vector2(sampleUniform(-50., 50.), sampleUniform(-50., 50.)));
+    problem.landmarks.push_back(v);
+  }
+  for (int i = 0; i < numPoses; ++i)
+    for (int k = 0; k < 4; ++k)
+      problem.observations.push_back(make_pair(i, static_cast<int>(sampleUniform(0., numLandmarks - 1e-6))));
+
+  vector<OptimizableGraph::Edge*> odometry[4] = {
+    createOdometryEdges<EdgeSE2>(problem),
+    createOdometryEdges<NumericEdge<EdgeSE2> >(problem),
+    createOdometryEdges<NumericStackEdge<EdgeSE2> >(problem),
+    createOdometryEdges<EdgeSE2AutoDiff>(problem)
+  };
+  vector<OptimizableGraph::Edge*> observations[4] = {
+    createObservationEdges<EdgeSE2PointXY>(problem),
+    createObservationEdges<NumericEdge<EdgeSE2PointXY> >(problem),
+    createObservationEdges<NumericStackEdge<EdgeSE2PointXY> >(problem),
+    createObservationEdges<EdgeSE2PointXYAutoDiff>(problem)
+  };
+
+  benchmark<EdgeSE2, EdgeSE2AutoDiff>("EdgeSE2", odometry, repeat);
+  benchmark<EdgeSE2PointXY, EdgeSE2PointXYAutoDiff>("EdgeSE2PointXY", observations, repeat);
+
+  for (int i = 0; i < 4; ++i) {
+    for (size_t k = 0; k < odometry[i].size(); ++k)
+      delete odometry[i][k];
+    for (size_t k = 0; k < observations[i].size(); ++k)
+      delete observations[i][k];
+  }
+  for (size_t i = 0; i < problem.poses.size(); ++i)
+    delete problem.poses[i];
+  for (size_t i = 0; i < problem.landmarks.size(); ++i)
+    delete problem.landmarks[i];
+  return 0;
+}
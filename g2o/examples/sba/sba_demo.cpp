@@ -350,6 +350,11 @@ int main(int argc, const char* argv[])
     }
 
     structure_only_ba.calc(points, 10);
+    int numConverged = 0;
+    for (size_t i = 0; i < structure_only_ba.pointStatus().size(); ++i)
+      if (structure_only_ba.pointStatus()[i].result == g2o::StructureOnlySolver<3>::Converged)
+        ++numConverged;
+    cout << numConverged << " of " << points.size() << " points converged" << endl;
   }
 
     cout << endl;
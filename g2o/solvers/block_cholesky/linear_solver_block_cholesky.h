@@ -0,0 +1,961 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_LINEAR_SOLVER_BLOCK_CHOLESKY_H
+#define G2O_LINEAR_SOLVER_BLOCK_CHOLESKY_H
+
+#include <Eigen/Core>
+#include <Eigen/Cholesky>
+#include <Eigen/Sparse>
+#include <Eigen/OrderingMethods>
+
+#include "g2o/core/linear_solver.h"
+#include "g2o/core/marginal_covariance_cholesky.h"
+#include "g2o/core/batch_stats.h"
+#include "g2o/stuff/timeutil.h"
+
+#ifdef G2O_OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace g2o {
+
+/**
+ * \brief supernodal Cholesky solver which works directly on the blocks of the SparseBlockMatrix
+ *
+ * The blocks of A are ordered by AMD and the elimination tree of the block
+ * matrix is postordered. Chains of columns in the tree which share their
+ * non-zero pattern are merged into supernodes and each supernode stores its
+ * part of L as a dense column-major panel. The factorization is left-looking,
+ * the updates from the descendants are dense matrix products which use fixed
+ * size Eigen kernels if the blocks of A have a size known at compile time.
+ *
+ * With OpenMP the independent subtrees of the supernodal tree are distributed
+ * over the threads, the remaining supernodes close to the root are processed
+ * level by level. Each supernode is computed by exactly one thread and its
+ * updates are applied in a fixed order, hence the result does not depend on
+ * the number of threads.
+ *
+ * The symbolic analysis is computed once and re-used until init() is called.
+ * Has no dependencies except Eigen.
+ *
+ * The factor is stored with the scalar type FactorScalar. If it is less
+ * precise than number_t, e.g., float, the memory traffic of the numeric
+ * factorization is halved and the solution is improved by a few steps of
+ * iterative refinement, where the residual of the system is computed with
+ * number_t. If the factorization fails in the lower precision or the
+ * refinement does not reach the tolerance, e.g., for an ill-conditioned
+ * system, the system is solved by a factor in number_t instead. The fall
+ * back sticks until the next init(), i.e., until the structure changes,
+ * since the following systems are likely as ill-conditioned. The
+ * marginals are always computed from a factor in number_t.
+ */
+template <typename MatrixType, typename FactorScalar = number_t>
+class LinearSolverBlockCholesky : public LinearSolver<MatrixType>
+{
+  public:
+    //! size of the blocks of A known at compile time, Eigen::Dynamic for variable sized blocks
+    static const int BlockDim = MatrixType::RowsAtCompileTime == MatrixType::ColsAtCompileTime ? MatrixType::RowsAtCompileTime : Eigen::Dynamic;
+
+    typedef Eigen::SparseMatrix<number_t, Eigen::ColMajor> SparseMatrix;
+    typedef Eigen::Triplet<number_t> Triplet;
+    typedef Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic> PermutationMatrix;
+    typedef Eigen::Matrix<FactorScalar, Eigen::Dynamic, Eigen::Dynamic> FactorMatrix;
+    typedef Eigen::Matrix<FactorScalar, Eigen::Dynamic, 1> FactorVector;
+    typedef Eigen::Map<FactorMatrix> PanelMap;
+
+  public:
+    LinearSolverBlockCholesky() :
+      LinearSolver<MatrixType>(),
+      _init(true), _writeDebug(false), _nnz(0),
+      _maxRefinementIterations(mixedPrecision() ? 3 : 0), _refinementTolerance(cst(1e-10)), _refinementSteps(0),
+      _usedDoubleSolver(false), _doubleFallback(false)
+    {
+    }
+
+    virtual ~LinearSolverBlockCholesky()
+    {
+    }
+
+    virtual bool init()
+    {
+      _init = true;
+      _doubleFallback = false;
+      if (_doubleSolver)
+        _doubleSolver->init();
+      return true;
+    }
+
+    virtual bool initSamePattern()
+    {
+      // the pointers to the blocks of A are collected in each call to solve
+      return true;
+    }
+
+    bool solve(const SparseBlockMatrix<MatrixType>& A, number_t* x, number_t* b)
+    {
+      _usedDoubleSolver = false;
+      if (_doubleFallback) {
+        _usedDoubleSolver = true;
+        return doubleSolver().solve(A, x, b);
+      }
+      if (! computeCholesky(A)) {
+        if (mixedPrecision()) {
+          _usedDoubleSolver = _doubleFallback = true;
+          return doubleSolver().solve(A, x, b);
+        }
+        if (_writeDebug) {
+          std::cerr << "Cholesky failure, writing debug.txt (Hessian loadable by Octave)" << std::endl;
+          A.writeOctave("debug.txt");
+        }
+        return false;
+      }
+
+      const int n = static_cast<int>(_scalarPerm.size());
+      _y.resize(n);
+      for (int k = 0; k < n; ++k)
+        _y(k) = static_cast<FactorScalar>(b[_scalarPerm[k]]);
+      solveForward();
+      solveBackward();
+      for (int k = 0; k < n; ++k)
+        x[_scalarPerm[k]] = _y(k);
+      if (! refine(A, x, b) && mixedPrecision()) {
+        _usedDoubleSolver = _doubleFallback = true;
+        return doubleSolver().solve(A, x, b);
+      }
+      return true;
+    }
+
+    virtual bool solveBlocks(number_t**& blocks, const SparseBlockMatrix<MatrixType>& A)
+    {
+      if (mixedPrecision()) // the marginals would inherit the error of the factor
+        return doubleSolver().solveBlocks(blocks, A);
+      if (! computeCholesky(A)) {
+        std::cerr << "inverse fail (numeric decomposition)" << std::endl;
+        return false;
+      }
+      if (! blocks){
+        blocks = new number_t*[A.rows()];
+        number_t** block = blocks;
+        for (size_t i = 0; i < A.rowBlockIndices().size(); ++i){
+          int dim = A.rowsOfBlock(i) * A.colsOfBlock(i);
+          *block = new number_t[dim];
+          block++;
+        }
+      }
+      MarginalCovarianceCholesky mcc;
+      setCholeskyFactor(mcc);
+      mcc.computeCovariance(blocks, A.rowBlockIndices());
+      return true;
+    }
+
+    virtual bool solvePattern(SparseBlockMatrix<MatrixX>& spinv, const std::vector<std::pair<int, int> >& blockIndices, const SparseBlockMatrix<MatrixType>& A)
+    {
+      if (mixedPrecision())
+        return doubleSolver().solvePattern(spinv, blockIndices, A);
+      if (! computeCholesky(A)) {
+        std::cerr << "inverse fail (numeric decomposition)" << std::endl;
+        return false;
+      }
+      MarginalCovarianceCholesky mcc;
+      setCholeskyFactor(mcc);
+      mcc.computeCovariance(spinv, A.rowBlockIndices(), blockIndices);
+      return true;
+    }
+
+    //! write a debug dump of the system matrix if it is not SPD in solve
+    virtual bool writeDebug() const { return _writeDebug;}
+    virtual void setWriteDebug(bool b) { _writeDebug = b;}
+
+    //! true, if the factor is stored with less precision than number_t
+    static bool mixedPrecision() { return sizeof(FactorScalar) < sizeof(number_t);}
+
+    //! maximum number of iterative refinement steps in solve(), 3 for a mixed precision factor, 0 otherwise
+    int maxRefinementIterations() const { return _maxRefinementIterations;}
+    void setMaxRefinementIterations(int iterations) { _maxRefinementIterations = iterations;}
+    //! refinement stops once the norm of the residual drops below tolerance times the norm of b
+    number_t refinementTolerance() const { return _refinementTolerance;}
+    void setRefinementTolerance(number_t tolerance) { _refinementTolerance = tolerance;}
+    //! refinement steps done in the last call to solve()
+    int refinementSteps() const { return _refinementSteps;}
+    //! true, if the last call to solve() fell back to a factor in number_t
+    bool usedDoubleSolver() const { return _usedDoubleSolver;}
+    //! true, if solve() skips the lower precision factor until the next init() after it failed
+    bool doubleFallback() const { return _doubleFallback;}
+
+    //! number of supernodes of the current symbolic decomposition
+    int numSupernodes() const { return static_cast<int>(_supernodes.size());}
+    //! number of scalar non-zeros of the factor L
+    size_t nonZeros() const { return _nnz;}
+
+  protected:
+    /**
+     * a set of consecutive block columns of L with the same non-zero pattern below the
+     * diagonal. L is stored as a dense column-major panel of numRows x numCols with
+     * the dense triangle on top followed by the rows in _rowBlocks[rowBegin] ... _rowBlocks[rowEnd-1].
+     */
+    struct Supernode
+    {
+      int firstBlock, lastBlock;   ///< block columns [firstBlock, lastBlock) in the permuted order
+      int firstCol, numCols;       ///< scalar columns
+      int numRows;                 ///< scalar rows of the panel including the diagonal part
+      int rowBegin, rowEnd;        ///< the block rows below the diagonal part
+      int parent;                  ///< parent in the supernodal elimination tree, -1 for a root
+      size_t valueOffset;          ///< start of the panel in _values
+    };
+
+    /**
+     * update of a supernode by one of its descendants. The rows of the source panel from
+     * rowOffset onwards contribute, the first numRows of those correspond to the
+     * columns of the target.
+     */
+    struct Update
+    {
+      int source;       ///< the descendant supernode
+      int rowOffset;    ///< first scalar row in the source panel
+      int numRows;      ///< number of scalar rows falling into the columns of the target
+      int rowBlock;     ///< index in _rowBlocks of the first block row
+      int numBlocks;    ///< number of block rows falling into the columns of the target
+    };
+
+    //! a block of A scattered into the panel of a supernode
+    struct Fill
+    {
+      int source;       ///< index in _blocks
+      int row, col;     ///< position in the panel
+      bool transposed;  ///< the block is stored transposed in the upper triangle of A
+    };
+
+    //! per thread workspace of the numeric factorization
+    struct Workspace
+    {
+      explicit Workspace(int numBlocks) : relativeRow(numBlocks, -1) {}
+      FactorMatrix W;
+      std::vector<int> relativeRow; ///< row of a block in the panel of the supernode being computed
+    };
+
+    bool _init;
+    bool _writeDebug;
+    size_t _nnz;
+    int _maxRefinementIterations;
+    number_t _refinementTolerance;
+    int _refinementSteps;
+    bool _usedDoubleSolver;
+    bool _doubleFallback;  ///< the lower precision failed, use the factor in number_t until init()
+    //! factor in number_t for the fall back and the marginals of a mixed precision solver
+    std::unique_ptr<LinearSolverBlockCholesky<MatrixType, number_t> > _doubleSolver;
+
+    std::vector<int> _perm;            ///< _perm[k] is the block of A at position k of the factor
+    std::vector<int> _scalarPerm;      ///< scalar version of _perm
+    std::vector<int> _colBase;         ///< scalar base of the permuted blocks, size numBlocks + 1
+    std::vector<int> _blockSupernode;  ///< supernode of the permuted blocks
+    std::vector<Supernode> _supernodes;
+    std::vector<int> _rowBlocks;       ///< the block rows of the supernodes below their diagonal part
+    std::vector<int> _rowOffsets;      ///< scalar row within the panel for each element of _rowBlocks
+    std::vector<int> _updateBegin;     ///< updates of supernode s are _updates[_updateBegin[s]] ... _updates[_updateBegin[s+1]-1]
+    std::vector<Update> _updates;
+    std::vector<int> _fillBegin;       ///< blocks of A for supernode s are _fill[_fillBegin[s]] ... _fill[_fillBegin[s+1]-1]
+    std::vector<Fill> _fill;
+    std::vector<int> _firstDescendant; ///< the subtree of s consists of the supernodes _firstDescendant[s] ... s
+    std::vector<int> _subtrees;        ///< roots of the subtrees computed by a single thread
+    std::vector<int> _levelBegin;      ///< the supernodes above the subtrees grouped by their level
+    std::vector<int> _levelNodes;
+
+    std::vector<const MatrixType*> _blocks; ///< upper triangular blocks of A in the order of the columns
+    std::vector<FactorScalar> _values; ///< the panels of all supernodes
+    FactorVector _y;
+    FactorVector _tmp;
+    VectorX _residual;
+
+    int numBlocks() const { return static_cast<int>(_blockSupernode.size());}
+    int blockDim(int k) const { return _colBase[k + 1] - _colBase[k];}
+
+    LinearSolverBlockCholesky<MatrixType, number_t>& doubleSolver()
+    {
+      if (! _doubleSolver) {
+        _doubleSolver.reset(new LinearSolverBlockCholesky<MatrixType, number_t>());
+        _doubleSolver->setWriteDebug(_writeDebug);
+      }
+      _doubleSolver->setBatchStatistics(this->batchStatistics());
+      return *_doubleSolver;
+    }
+
+    //! analyze A if needed and compute the numeric factorization
+    bool computeCholesky(const SparseBlockMatrix<MatrixType>& A)
+    {
+      if (_init)
+        computeSymbolicDecomposition(A);
+      _init = false;
+
+      number_t t = get_monotonic_time();
+      collectBlocks(A);
+      bool ok = factorize();
+      G2OBatchStatistics* stats = this->batchStatistics();
+      if (stats) {
+        stats->timeNumericDecomposition = get_monotonic_time() - t;
+        stats->choleskyNNZ = _nnz;
+      }
+      return ok;
+    }
+
+    void collectBlocks(const SparseBlockMatrix<MatrixType>& A)
+    {
+      _blocks.clear();
+      for (size_t c = 0; c < A.blockCols().size(); ++c) {
+        const typename SparseBlockMatrix<MatrixType>::IntBlockMap& column = A.blockCols()[c];
+        for (typename SparseBlockMatrix<MatrixType>::IntBlockMap::const_iterator it = column.begin(); it != column.end(); ++it) {
+          if (it->first > static_cast<int>(c)) // only upper triangle
+            break;
+          _blocks.push_back(it->second);
+        }
+      }
+      assert(_blocks.size() == _fill.size() && "the pattern of A changed without calling init()");
+    }
+
+    /**
+     * compute the ordering, the supernodes and the schedule of the factorization.
+     * Since A has the same pattern in all the iterations, this is done once.
+     */
+    void computeSymbolicDecomposition(const SparseBlockMatrix<MatrixType>& A)
+    {
+      number_t t = get_monotonic_time();
+      const int n = static_cast<int>(A.blockCols().size());
+
+      // the upper triangular block pattern of A
+      std::vector<std::pair<int, int> > pattern;
+      for (int c = 0; c < n; ++c) {
+        const typename SparseBlockMatrix<MatrixType>::IntBlockMap& column = A.blockCols()[c];
+        for (typename SparseBlockMatrix<MatrixType>::IntBlockMap::const_iterator it = column.begin(); it != column.end(); ++it) {
+          if (it->first > c)
+            break;
+          pattern.push_back(std::make_pair(it->first, c));
+        }
+      }
+
+      // fill-reducing ordering of the blocks
+      std::vector<int> perm(n);
+      if (n > 0) {
+        std::vector<Triplet> triplets;
+        triplets.reserve(pattern.size());
+        for (size_t k = 0; k < pattern.size(); ++k)
+          triplets.push_back(Triplet(pattern[k].first, pattern[k].second, 0.));
+        SparseMatrix auxBlockMatrix(n, n);
+        auxBlockMatrix.setFromTriplets(triplets.begin(), triplets.end());
+        SparseMatrix C;
+        C = auxBlockMatrix.selfadjointView<Eigen::Upper>();
+        PermutationMatrix blockP;
+        Eigen::internal::minimum_degree_ordering(C, blockP);
+        for (int k = 0; k < n; ++k)
+          perm[k] = blockP.indices()(k);
+      }
+
+      // elimination tree in the AMD order, postorder it to get contiguous subtrees
+      std::vector<int> lowerBegin, lowerIdx, upperBegin, upperIdx, parent;
+      buildAdjacency(pattern, perm, lowerBegin, lowerIdx, upperBegin, upperIdx);
+      eliminationTree(lowerBegin, lowerIdx, parent);
+      std::vector<int> post;
+      postorder(parent, post);
+      std::vector<int> ipost(n);
+      for (int k = 0; k < n; ++k)
+        ipost[post[k]] = k;
+      _perm.resize(n);
+      std::vector<int> postParent(n);
+      for (int k = 0; k < n; ++k) {
+        _perm[k] = perm[post[k]];
+        postParent[k] = parent[post[k]] < 0 ? -1 : ipost[parent[post[k]]];
+      }
+      parent.swap(postParent);
+      buildAdjacency(pattern, _perm, lowerBegin, lowerIdx, upperBegin, upperIdx);
+
+      _colBase.resize(n + 1);
+      _colBase[0] = 0;
+      for (int k = 0; k < n; ++k)
+        _colBase[k + 1] = _colBase[k] + A.colsOfBlock(_perm[k]);
+      _scalarPerm.resize(_colBase[n]);
+      for (int k = 0, idx = 0; k < n; ++k) {
+        int base = A.colBaseOfBlock(_perm[k]);
+        for (int j = 0; j < blockDim(k); ++j)
+          _scalarPerm[idx++] = base + j;
+      }
+
+      // block pattern of the columns of L, the pattern of a column is the union of the
+      // pattern of A and the patterns of its children in the elimination tree
+      std::vector<int> childBegin, childIdx;
+      children(parent, childBegin, childIdx);
+      std::vector<int> structBegin(n + 1, 0);
+      std::vector<int> structIdx;
+      std::vector<int> marker(n, -1);
+      for (int j = 0; j < n; ++j) {
+        structBegin[j] = static_cast<int>(structIdx.size());
+        marker[j] = j;
+        for (int k = upperBegin[j]; k < upperBegin[j + 1]; ++k) {
+          int i = upperIdx[k];
+          if (marker[i] != j) {
+            marker[i] = j;
+            structIdx.push_back(i);
+          }
+        }
+        for (int k = childBegin[j]; k < childBegin[j + 1]; ++k) {
+          int c = childIdx[k];
+          for (int l = structBegin[c]; l < structBegin[c + 1]; ++l) {
+            int i = structIdx[l];
+            if (marker[i] != j) {
+              marker[i] = j;
+              structIdx.push_back(i);
+            }
+          }
+        }
+        std::sort(structIdx.begin() + structBegin[j], structIdx.end());
+      }
+      structBegin[n] = static_cast<int>(structIdx.size());
+
+      // fundamental supernodes: j is merged with j-1 if it is the only child of j
+      // and the pattern of j-1 is the pattern of j plus j itself
+      _supernodes.clear();
+      _blockSupernode.resize(n);
+      for (int j = 0; j < n; ++j) {
+        bool merge = j > 0 && parent[j - 1] == j && childBegin[j + 1] - childBegin[j] == 1
+          && structBegin[j] - structBegin[j - 1] == structBegin[j + 1] - structBegin[j] + 1;
+        if (! merge) {
+          Supernode s;
+          s.firstBlock = j;
+          _supernodes.push_back(s);
+        }
+        _supernodes.back().lastBlock = j + 1;
+        _blockSupernode[j] = static_cast<int>(_supernodes.size()) - 1;
+      }
+
+      const int ns = static_cast<int>(_supernodes.size());
+      _rowBlocks.clear();
+      _rowOffsets.clear();
+      _nnz = 0;
+      size_t valueOffset = 0;
+      for (int s = 0; s < ns; ++s) {
+        Supernode& sn = _supernodes[s];
+        int last = sn.lastBlock - 1;
+        sn.firstCol = _colBase[sn.firstBlock];
+        sn.numCols = _colBase[sn.lastBlock] - sn.firstCol;
+        sn.numRows = sn.numCols;
+        sn.rowBegin = static_cast<int>(_rowBlocks.size());
+        for (int k = structBegin[last]; k < structBegin[last + 1]; ++k) {
+          _rowBlocks.push_back(structIdx[k]);
+          _rowOffsets.push_back(sn.numRows);
+          sn.numRows += blockDim(structIdx[k]);
+        }
+        sn.rowEnd = static_cast<int>(_rowBlocks.size());
+        sn.parent = parent[last] < 0 ? -1 : _blockSupernode[parent[last]];
+        sn.valueOffset = valueOffset;
+        valueOffset += static_cast<size_t>(sn.numRows) * sn.numCols;
+        _nnz += static_cast<size_t>(sn.numRows) * sn.numCols - static_cast<size_t>(sn.numCols) * (sn.numCols - 1) / 2;
+      }
+      _values.resize(valueOffset);
+
+      computeUpdates();
+      computeFill(pattern);
+      computeSchedule();
+
+      G2OBatchStatistics* stats = this->batchStatistics();
+      if (stats)
+        stats->timeSymbolicDecomposition = get_monotonic_time() - t;
+    }
+
+    //! adjacency of the permuted block pattern, lower lists the smaller and upper the larger neighbors
+    static void buildAdjacency(const std::vector<std::pair<int, int> >& pattern, const std::vector<int>& perm,
+        std::vector<int>& lowerBegin, std::vector<int>& lowerIdx, std::vector<int>& upperBegin, std::vector<int>& upperIdx)
+    {
+      const int n = static_cast<int>(perm.size());
+      std::vector<int> iperm(n);
+      for (int k = 0; k < n; ++k)
+        iperm[perm[k]] = k;
+      lowerBegin.assign(n + 1, 0);
+      upperBegin.assign(n + 1, 0);
+      for (size_t k = 0; k < pattern.size(); ++k) {
+        int i = iperm[pattern[k].first];
+        int j = iperm[pattern[k].second];
+        if (i == j)
+          continue;
+        ++lowerBegin[std::max(i, j) + 1];
+        ++upperBegin[std::min(i, j) + 1];
+      }
+      for (int k = 0; k < n; ++k) {
+        lowerBegin[k + 1] += lowerBegin[k];
+        upperBegin[k + 1] += upperBegin[k];
+      }
+      lowerIdx.resize(lowerBegin[n]);
+      upperIdx.resize(upperBegin[n]);
+      std::vector<int> lowerFill(lowerBegin.begin(), lowerBegin.end() - 1);
+      std::vector<int> upperFill(upperBegin.begin(), upperBegin.end() - 1);
+      for (size_t k = 0; k < pattern.size(); ++k) {
+        int i = iperm[pattern[k].first];
+        int j = iperm[pattern[k].second];
+        if (i == j)
+          continue;
+        lowerIdx[lowerFill[std::max(i, j)]++] = std::min(i, j);
+        upperIdx[upperFill[std::min(i, j)]++] = std::max(i, j);
+      }
+    }
+
+    //! elimination tree by Liu's algorithm with path compression
+    static void eliminationTree(const std::vector<int>& lowerBegin, const std::vector<int>& lowerIdx, std::vector<int>& parent)
+    {
+      const int n = static_cast<int>(lowerBegin.size()) - 1;
+      std::vector<int> ancestor(n, -1);
+      parent.assign(n, -1);
+      for (int k = 0; k < n; ++k) {
+        for (int l = lowerBegin[k]; l < lowerBegin[k + 1]; ++l) {
+          int r = lowerIdx[l];
+          while (ancestor[r] != -1 && ancestor[r] != k) {
+            int next = ancestor[r];
+            ancestor[r] = k;
+            r = next;
+          }
+          if (ancestor[r] == -1) {
+            ancestor[r] = k;
+            parent[r] = k;
+          }
+        }
+      }
+    }
+
+    //! children of each node of the tree in increasing order
+    static void children(const std::vector<int>& parent, std::vector<int>& childBegin, std::vector<int>& childIdx)
+    {
+      const int n = static_cast<int>(parent.size());
+      childBegin.assign(n + 1, 0);
+      for (int k = 0; k < n; ++k)
+        if (parent[k] >= 0)
+          ++childBegin[parent[k] + 1];
+      for (int k = 0; k < n; ++k)
+        childBegin[k + 1] += childBegin[k];
+      childIdx.resize(childBegin[n]);
+      std::vector<int> childFill(childBegin.begin(), childBegin.end() - 1);
+      for (int k = 0; k < n; ++k)
+        if (parent[k] >= 0)
+          childIdx[childFill[parent[k]]++] = k;
+    }
+
+    //! non-recursive depth first postorder of the forest
+    static void postorder(const std::vector<int>& parent, std::vector<int>& post)
+    {
+      const int n = static_cast<int>(parent.size());
+      std::vector<int> childBegin, childIdx;
+      children(parent, childBegin, childIdx);
+      std::vector<int> next(childBegin.begin(), childBegin.end() - 1);
+      std::vector<int> stack;
+      post.clear();
+      post.reserve(n);
+      for (int root = 0; root < n; ++root) {
+        if (parent[root] >= 0)
+          continue;
+        stack.push_back(root);
+        while (! stack.empty()) {
+          int p = stack.back();
+          if (next[p] == childBegin[p + 1]) {
+            stack.pop_back();
+            post.push_back(p);
+          } else {
+            stack.push_back(childIdx[next[p]++]);
+          }
+        }
+      }
+    }
+
+    //! the updates each supernode receives from its descendants, ordered by the descendants
+    void computeUpdates()
+    {
+      const int ns = static_cast<int>(_supernodes.size());
+      _updateBegin.assign(ns + 1, 0);
+      for (int pass = 0; pass < 2; ++pass) {
+        std::vector<int> updateFill(_updateBegin.begin(), _updateBegin.end() - 1);
+        for (int d = 0; d < ns; ++d) {
+          const Supernode& src = _supernodes[d];
+          int k = src.rowBegin;
+          while (k < src.rowEnd) {
+            int target = _blockSupernode[_rowBlocks[k]];
+            int start = k;
+            while (k < src.rowEnd && _blockSupernode[_rowBlocks[k]] == target)
+              ++k;
+            if (pass == 0) {
+              ++_updateBegin[target + 1];
+              continue;
+            }
+            Update& u = _updates[updateFill[target]++];
+            u.source = d;
+            u.rowOffset = _rowOffsets[start];
+            u.numRows = (k < src.rowEnd ? _rowOffsets[k] : src.numRows) - u.rowOffset;
+            u.rowBlock = start;
+            u.numBlocks = k - start;
+          }
+        }
+        if (pass == 0) {
+          for (int s = 0; s < ns; ++s)
+            _updateBegin[s + 1] += _updateBegin[s];
+          _updates.resize(_updateBegin[ns]);
+        }
+      }
+    }
+
+    //! where the blocks of A go in the panels of the supernodes
+    void computeFill(const std::vector<std::pair<int, int> >& pattern)
+    {
+      const int n = numBlocks();
+      const int ns = static_cast<int>(_supernodes.size());
+      std::vector<int> iperm(n);
+      for (int k = 0; k < n; ++k)
+        iperm[_perm[k]] = k;
+      std::vector<Fill> fill(pattern.size());
+      std::vector<int> fillSupernode(pattern.size());
+      _fillBegin.assign(ns + 1, 0);
+      for (size_t k = 0; k < pattern.size(); ++k) {
+        int pr = iperm[pattern[k].first];
+        int pc = iperm[pattern[k].second];
+        int i = std::max(pr, pc);
+        int j = std::min(pr, pc);
+        int s = _blockSupernode[j];
+        const Supernode& sn = _supernodes[s];
+        Fill& f = fill[k];
+        f.source = static_cast<int>(k);
+        f.col = _colBase[j] - sn.firstCol;
+        if (i < sn.lastBlock) {
+          f.row = _colBase[i] - sn.firstCol;
+        } else {
+          std::vector<int>::const_iterator it = std::lower_bound(_rowBlocks.begin() + sn.rowBegin, _rowBlocks.begin() + sn.rowEnd, i);
+          assert(it != _rowBlocks.begin() + sn.rowEnd && *it == i && "block not in the pattern of L");
+          f.row = _rowOffsets[it - _rowBlocks.begin()];
+        }
+        f.transposed = pr <= pc;
+        fillSupernode[k] = s;
+        ++_fillBegin[s + 1];
+      }
+      for (int s = 0; s < ns; ++s)
+        _fillBegin[s + 1] += _fillBegin[s];
+      _fill.resize(fill.size());
+      std::vector<int> fillPos(_fillBegin.begin(), _fillBegin.end() - 1);
+      for (size_t k = 0; k < fill.size(); ++k)
+        _fill[fillPos[fillSupernode[k]]++] = fill[k];
+    }
+
+    /**
+     * subtree-to-thread mapping: subtrees whose work is small compared to the total
+     * work are computed by one thread each, the supernodes above them are grouped
+     * into levels whose supernodes do not depend on each other.
+     */
+    void computeSchedule()
+    {
+      const int ns = static_cast<int>(_supernodes.size());
+      int numThreads = 1;
+#ifdef G2O_OPENMP
+      numThreads = omp_get_max_threads();
+#endif
+      std::vector<double> subtreeWork(ns);
+      _firstDescendant.resize(ns);
+      double totalWork = 0.;
+      for (int s = 0; s < ns; ++s) {
+        const Supernode& sn = _supernodes[s];
+        subtreeWork[s] = static_cast<double>(sn.numCols) * sn.numRows * sn.numRows;
+        _firstDescendant[s] = s;
+      }
+      for (int s = 0; s < ns; ++s) {
+        int p = _supernodes[s].parent;
+        if (p >= 0) {
+          subtreeWork[p] += subtreeWork[s];
+          _firstDescendant[p] = std::min(_firstDescendant[p], _firstDescendant[s]);
+        } else {
+          totalWork += subtreeWork[s];
+        }
+      }
+
+      double threshold = numThreads > 1 ? totalWork / (4. * numThreads) : totalWork;
+      _subtrees.clear();
+      std::vector<int> level(ns, -1);
+      int numLevels = 0;
+      for (int s = 0; s < ns; ++s) {
+        int p = _supernodes[s].parent;
+        if (subtreeWork[s] <= threshold) {
+          if (p < 0 || subtreeWork[p] > threshold)
+            _subtrees.push_back(s);
+          continue;
+        }
+        level[s] = std::max(level[s], 0);
+        numLevels = std::max(numLevels, level[s] + 1);
+        if (p >= 0)
+          level[p] = std::max(level[p], level[s] + 1);
+      }
+      // largest subtrees first for a better load balance
+      std::stable_sort(_subtrees.begin(), _subtrees.end(), SubtreeWorkCompare(subtreeWork));
+
+      _levelBegin.assign(numLevels + 1, 0);
+      for (int s = 0; s < ns; ++s)
+        if (level[s] >= 0)
+          ++_levelBegin[level[s] + 1];
+      for (int l = 0; l < numLevels; ++l)
+        _levelBegin[l + 1] += _levelBegin[l];
+      _levelNodes.resize(_levelBegin[numLevels]);
+      std::vector<int> levelFill(_levelBegin.begin(), _levelBegin.end() - 1);
+      for (int s = 0; s < ns; ++s)
+        if (level[s] >= 0)
+          _levelNodes[levelFill[level[s]]++] = s;
+    }
+
+    struct SubtreeWorkCompare
+    {
+      explicit SubtreeWorkCompare(const std::vector<double>& work) : _work(work) {}
+      bool operator()(int a, int b) const { return _work[a] > _work[b];}
+      const std::vector<double>& _work;
+    };
+
+    //! numeric factorization according to the schedule
+    bool factorize()
+    {
+      bool ok = true;
+#     ifdef G2O_OPENMP
+#     pragma omp parallel if (_subtrees.size() > 1 || _levelNodes.size() > 1)
+      {
+        Workspace workspace(numBlocks());
+#       pragma omp for schedule(dynamic, 1) reduction(&&: ok)
+        for (int i = 0; i < static_cast<int>(_subtrees.size()); ++i) {
+          int root = _subtrees[i];
+          for (int s = _firstDescendant[root]; s <= root; ++s)
+            ok = factorizeSupernode(s, workspace) && ok;
+        }
+        for (size_t l = 0; l + 1 < _levelBegin.size(); ++l) {
+#         pragma omp for schedule(dynamic, 1) reduction(&&: ok)
+          for (int k = _levelBegin[l]; k < _levelBegin[l + 1]; ++k)
+            ok = factorizeSupernode(_levelNodes[k], workspace) && ok;
+        }
+      }
+#     else
+      Workspace workspace(numBlocks());
+      for (int s = 0; s < static_cast<int>(_supernodes.size()); ++s)
+        ok = factorizeSupernode(s, workspace) && ok;
+#     endif
+      return ok;
+    }
+
+    //! assemble the panel of supernode s from A and its descendants and factorize it
+    bool factorizeSupernode(int s, Workspace& workspace)
+    {
+      const Supernode& sn = _supernodes[s];
+      PanelMap L(&_values[sn.valueOffset], sn.numRows, sn.numCols);
+      L.setZero();
+
+      for (int k = _fillBegin[s]; k < _fillBegin[s + 1]; ++k) {
+        const Fill& f = _fill[k];
+        const MatrixType& m = *_blocks[f.source];
+        if (f.transposed)
+          L.template block<BlockDim, BlockDim>(f.row, f.col, m.cols(), m.rows()) = m.transpose().template cast<FactorScalar>();
+        else
+          L.template block<BlockDim, BlockDim>(f.row, f.col, m.rows(), m.cols()) = m.template cast<FactorScalar>();
+      }
+
+      // position of the block rows in the panel
+      for (int b = sn.firstBlock; b < sn.lastBlock; ++b)
+        workspace.relativeRow[b] = _colBase[b] - sn.firstCol;
+      for (int k = sn.rowBegin; k < sn.rowEnd; ++k)
+        workspace.relativeRow[_rowBlocks[k]] = _rowOffsets[k];
+
+      for (int k = _updateBegin[s]; k < _updateBegin[s + 1]; ++k)
+        applyUpdate(_updates[k], L, workspace);
+
+      // dense Cholesky of the diagonal part and triangular solve for the rows below
+      const int w = sn.numCols;
+      const int below = sn.numRows - w;
+      if (BlockDim != Eigen::Dynamic && w == BlockDim) {
+        Eigen::LLT<Eigen::Matrix<FactorScalar, BlockDim, BlockDim> > llt(L.template block<BlockDim, BlockDim>(0, 0, w, w));
+        if (llt.info() != Eigen::Success)
+          return false;
+        L.template block<BlockDim, BlockDim>(0, 0, w, w) = llt.matrixLLT();
+        if (below > 0)
+          llt.matrixU().template solveInPlace<Eigen::OnTheRight>(L.template block<Eigen::Dynamic, BlockDim>(w, 0, below, w));
+      } else {
+        Eigen::Ref<FactorMatrix> diagonal(L.topLeftCorner(w, w));
+        Eigen::LLT<Eigen::Ref<FactorMatrix> > llt(diagonal); // in-place decomposition
+        if (llt.info() != Eigen::Success)
+          return false;
+        if (below > 0)
+          llt.matrixU().template solveInPlace<Eigen::OnTheRight>(L.bottomRows(below));
+      }
+      return true;
+    }
+
+    //! subtract the contribution of a descendant from the panel L of the target
+    void applyUpdate(const Update& u, PanelMap& L, Workspace& workspace)
+    {
+      const Supernode& src = _supernodes[u.source];
+      const FactorScalar* srcValues = &_values[src.valueOffset];
+      const int rows = src.numRows - u.rowOffset;
+      FactorMatrix& W = workspace.W;
+      W.resize(rows, u.numRows);
+      if (BlockDim != Eigen::Dynamic && src.numCols == BlockDim) {
+        Eigen::Map<const Eigen::Matrix<FactorScalar, Eigen::Dynamic, BlockDim> > S(srcValues, src.numRows, BlockDim);
+        W.noalias() = S.middleRows(u.rowOffset, rows) * S.middleRows(u.rowOffset, u.numRows).transpose();
+      } else {
+        Eigen::Map<const FactorMatrix> S(srcValues, src.numRows, src.numCols);
+        W.noalias() = S.middleRows(u.rowOffset, rows) * S.middleRows(u.rowOffset, u.numRows).transpose();
+      }
+
+      // scatter the lower block triangle of W into the panel
+      int wc = 0;
+      for (int k = u.rowBlock; k < u.rowBlock + u.numBlocks; ++k) {
+        const int cb = _rowBlocks[k];
+        const int cdim = blockDim(cb);
+        const int tc = workspace.relativeRow[cb];
+        int wr = wc;
+        for (int l = k; l < src.rowEnd; ++l) {
+          const int rb = _rowBlocks[l];
+          const int rdim = blockDim(rb);
+          L.template block<BlockDim, BlockDim>(workspace.relativeRow[rb], tc, rdim, cdim) -= W.template block<BlockDim, BlockDim>(wr, wc, rdim, cdim);
+          wr += rdim;
+        }
+        wc += cdim;
+      }
+    }
+
+    //! solve L y = y
+    void solveForward()
+    {
+      for (size_t s = 0; s < _supernodes.size(); ++s) {
+        const Supernode& sn = _supernodes[s];
+        Eigen::Map<const FactorMatrix> L(&_values[sn.valueOffset], sn.numRows, sn.numCols);
+        const int w = sn.numCols;
+        const int below = sn.numRows - w;
+        L.topLeftCorner(w, w).template triangularView<Eigen::Lower>().solveInPlace(_y.segment(sn.firstCol, w));
+        if (below == 0)
+          continue;
+        _tmp.noalias() = L.bottomRows(below) * _y.segment(sn.firstCol, w);
+        for (int k = sn.rowBegin; k < sn.rowEnd; ++k) {
+          const int b = _rowBlocks[k];
+          _y.segment(_colBase[b], blockDim(b)) -= _tmp.segment(_rowOffsets[k] - w, blockDim(b));
+        }
+      }
+    }
+
+    //! solve L^T y = y
+    void solveBackward()
+    {
+      for (int s = static_cast<int>(_supernodes.size()) - 1; s >= 0; --s) {
+        const Supernode& sn = _supernodes[s];
+        Eigen::Map<const FactorMatrix> L(&_values[sn.valueOffset], sn.numRows, sn.numCols);
+        const int w = sn.numCols;
+        const int below = sn.numRows - w;
+        if (below > 0) {
+          _tmp.resize(below);
+          for (int k = sn.rowBegin; k < sn.rowEnd; ++k) {
+            const int b = _rowBlocks[k];
+            _tmp.segment(_rowOffsets[k] - w, blockDim(b)) = _y.segment(_colBase[b], blockDim(b));
+          }
+          _y.segment(sn.firstCol, w).noalias() -= L.bottomRows(below).transpose() * _tmp;
+        }
+        L.topLeftCorner(w, w).transpose().template triangularView<Eigen::Upper>().solveInPlace(_y.segment(sn.firstCol, w));
+      }
+    }
+
+    /**
+     * iterative refinement of the solution x of A x = b. The residual is
+     * computed with number_t, the correction is obtained from the factor.
+     * Returns false, if the residual is above the tolerance after the
+     * maximum number of steps.
+     */
+    bool refine(const SparseBlockMatrix<MatrixType>& A, number_t* x, const number_t* b)
+    {
+      _refinementSteps = 0;
+      if (_maxRefinementIterations <= 0)
+        return true;
+      const int n = static_cast<int>(_scalarPerm.size());
+      VectorX::ConstMapType bb(b, n);
+      VectorX::MapType xx(x, n);
+      const number_t threshold = _refinementTolerance * bb.norm();
+      _residual.resize(n);
+      for (int i = 0; ; ++i) {
+        _residual.setZero();
+        number_t* r = _residual.data();
+        A.multiplySymmetricUpperTriangle(r, x);
+        _residual = bb - _residual;
+        number_t residualNorm = _residual.norm();
+        if (residualNorm <= threshold)
+          return true;
+        if (i == _maxRefinementIterations || ! std::isfinite(residualNorm))
+          return false;
+        for (int k = 0; k < n; ++k)
+          _y(k) = static_cast<FactorScalar>(_residual(_scalarPerm[k]));
+        solveForward();
+        solveBackward();
+        for (int k = 0; k < n; ++k)
+          xx(_scalarPerm[k]) += _y(k);
+        ++_refinementSteps;
+      }
+    }
+
+    //! pass the factor as scalar CCS matrix to the marginal covariance computation
+    void setCholeskyFactor(MarginalCovarianceCholesky& mcc)
+    {
+      const int n = static_cast<int>(_scalarPerm.size());
+      _Lp.resize(n + 1);
+      _Li.resize(_nnz);
+      _Lx.resize(_nnz);
+      int nz = 0;
+      for (size_t s = 0; s < _supernodes.size(); ++s) {
+        const Supernode& sn = _supernodes[s];
+        Eigen::Map<const FactorMatrix> L(&_values[sn.valueOffset], sn.numRows, sn.numCols);
+        for (int q = 0; q < sn.numCols; ++q) {
+          _Lp[sn.firstCol + q] = nz;
+          for (int r = q; r < sn.numCols; ++r) {
+            _Li[nz] = sn.firstCol + r;
+            _Lx[nz++] = L(r, q);
+          }
+          for (int k = sn.rowBegin; k < sn.rowEnd; ++k) {
+            const int b = _rowBlocks[k];
+            for (int r = 0; r < blockDim(b); ++r) {
+              _Li[nz] = _colBase[b] + r;
+              _Lx[nz++] = L(_rowOffsets[k] + r, q);
+            }
+          }
+        }
+      }
+      _Lp[n] = nz;
+      _scalarPermInv.resize(n);
+      for (int k = 0; k < n; ++k)
+        _scalarPermInv[_scalarPerm[k]] = k;
+      mcc.setCholeskyFactor(n, _Lp.data(), _Li.data(), _Lx.data(), _scalarPermInv.data());
+    }
+
+    // scalar copy of the factor for computing the marginals
+    std::vector<int> _Lp;
+    std::vector<int> _Li;
+    std::vector<number_t> _Lx;
+    std::vector<int> _scalarPermInv;
+};
+
+} // end namespace
+
+#endif
@@ -0,0 +1,130 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "linear_solver_block_cholesky.h"
+
+#include "g2o/core/block_solver.h"
+#include "g2o/core/solver.h"
+#include "g2o/core/optimization_algorithm_factory.h"
+#include "g2o/core/sparse_optimizer.h"
+
+#include "g2o/core/optimization_algorithm_gauss_newton.h"
+#include "g2o/core/optimization_algorithm_levenberg.h"
+#include "g2o/core/optimization_algorithm_dogleg.h"
+
+#include "g2o/stuff/macros.h"
+
+using namespace std;
+
+namespace g2o {
+
+  namespace
+  {
+    template<int p, int l, typename FactorScalar>
+    std::unique_ptr<BlockSolverBase> AllocateSolver()
+    {
+      std::cerr << "# Using BlockCholesky poseDim " << p << " landMarkDim " << l << " factor precision " << 8 * sizeof(FactorScalar) << " bit" << std::endl;
+      auto linearSolver = g2o::make_unique<LinearSolverBlockCholesky<typename BlockSolverPL<p, l>::PoseMatrixType, FactorScalar>>();
+      return g2o::make_unique<BlockSolverPL<p, l>>(std::move(linearSolver));
+    }
+  }
+
+  /**
+   * helper function for allocating
+   */
+  static OptimizationAlgorithm* createSolver(const std::string& fullSolverName)
+  {
+    static const std::map<std::string, std::function<std::unique_ptr<BlockSolverBase>()>> solver_factories{
+      { "var_blockchol", &AllocateSolver<-1, -1, number_t> },
+      { "fix3_2_blockchol", &AllocateSolver<3, 2, number_t> },
+      { "fix6_3_blockchol", &AllocateSolver<6, 3, number_t> },
+      { "fix7_3_blockchol", &AllocateSolver<7, 3, number_t> },
+      // float factor with iterative refinement
+      { "var_blockchol_mixed", &AllocateSolver<-1, -1, float> },
+      { "fix3_2_blockchol_mixed", &AllocateSolver<3, 2, float> },
+      { "fix6_3_blockchol_mixed", &AllocateSolver<6, 3, float> },
+      { "fix7_3_blockchol_mixed", &AllocateSolver<7, 3, float> },
+    };
+
+    string solverName = fullSolverName.substr(3);
+    auto solverf = solver_factories.find(solverName);
+    if (solverf == solver_factories.end())
+      return nullptr;
+
+    string methodName = fullSolverName.substr(0, 2);
+
+    if (methodName == "gn")
+    {
+      return new OptimizationAlgorithmGaussNewton(solverf->second());
+    }
+    else if (methodName == "lm")
+    {
+      return new OptimizationAlgorithmLevenberg(solverf->second());
+    }
+    else if (methodName == "dl")
+    {
+      return new OptimizationAlgorithmDogleg(solverf->second());
+    }
+
+    return nullptr;
+  }
+
+  class BlockCholeskySolverCreator : public AbstractOptimizationAlgorithmCreator
+  {
+    public:
+      BlockCholeskySolverCreator(const OptimizationAlgorithmProperty& p) : AbstractOptimizationAlgorithmCreator(p) {}
+      virtual OptimizationAlgorithm* construct()
+      {
+        return createSolver(property().name);
+      }
+  };
+
+
+  G2O_REGISTER_OPTIMIZATION_LIBRARY(block_cholesky);
+
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(gn_var_blockchol, new BlockCholeskySolverCreator(OptimizationAlgorithmProperty("gn_var_blockchol", "Gauss-Newton: supernodal block Cholesky solver (variable blocksize)", "BlockCholesky", false, Eigen::Dynamic, Eigen::Dynamic)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(gn_fix3_2_blockchol, new BlockCholeskySolverCreator(OptimizationAlgorithmProperty("gn_fix3_2_blockchol", "Gauss-Newton: supernodal block Cholesky solver (fixed blocksize)", "BlockCholesky", true, 3, 2)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(gn_fix6_3_blockchol, new BlockCholeskySolverCreator(OptimizationAlgorithmProperty("gn_fix6_3_blockchol", "Gauss-Newton: supernodal block Cholesky solver (fixed blocksize)", "BlockCholesky", true, 6, 3)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(gn_fix7_3_blockchol, new BlockCholeskySolverCreator(OptimizationAlgorithmProperty("gn_fix7_3_blockchol", "Gauss-Newton: supernodal block Cholesky solver (fixed blocksize)", "BlockCholesky", true, 7, 3)));
+
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_var_blockchol, new BlockCholeskySolverCreator(OptimizationAlgorithmProperty("lm_var_blockchol", "Levenberg: supernodal block Cholesky solver (variable blocksize)", "BlockCholesky", false, Eigen::Dynamic, Eigen::Dynamic)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_fix3_2_blockchol, new BlockCholeskySolverCreator(OptimizationAlgorithmProperty("lm_fix3_2_blockchol", "Levenberg: supernodal block Cholesky solver (fixed blocksize)", "BlockCholesky", true, 3, 2)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_fix6_3_blockchol, new BlockCholeskySolverCreator(OptimizationAlgorithmProperty("lm_fix6_3_blockchol", "Levenberg: supernodal block Cholesky solver (fixed blocksize)", "BlockCholesky", true, 6, 3)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_fix7_3_blockchol, new BlockCholeskySolverCreator(OptimizationAlgorithmProperty("lm_fix7_3_blockchol", "Levenberg: supernodal block Cholesky solver (fixed blocksize)", "BlockCholesky", true, 7, 3)));
+
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(dl_var_blockchol, new BlockCholeskySolverCreator(OptimizationAlgorithmProperty("dl_var_blockchol", "Dogleg: supernodal block Cholesky solver (variable blocksize)", "BlockCholesky", false, Eigen::Dynamic, Eigen::Dynamic)));
+
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(gn_var_blockchol_mixed, new BlockCholeskySolverCreator(OptimizationAlgorithmProperty("gn_var_blockchol_mixed", "Gauss-Newton: supernodal block Cholesky solver, float factor with iterative refinement (variable blocksize)", "BlockCholesky", false, Eigen::Dynamic, Eigen::Dynamic)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(gn_fix3_2_blockchol_mixed, new BlockCholeskySolverCreator(OptimizationAlgorithmProperty("gn_fix3_2_blockchol_mixed", "Gauss-Newton: supernodal block Cholesky solver, float factor with iterative refinement (fixed blocksize)", "BlockCholesky", true, 3, 2)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(gn_fix6_3_blockchol_mixed, new BlockCholeskySolverCreator(OptimizationAlgorithmProperty("gn_fix6_3_blockchol_mixed", "Gauss-Newton: supernodal block Cholesky solver, float factor with iterative refinement (fixed blocksize)", "BlockCholesky", true, 6, 3)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(gn_fix7_3_blockchol_mixed, new BlockCholeskySolverCreator(OptimizationAlgorithmProperty("gn_fix7_3_blockchol_mixed", "Gauss-Newton: supernodal block Cholesky solver, float factor with iterative refinement (fixed blocksize)", "BlockCholesky", true, 7, 3)));
+
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_var_blockchol_mixed, new BlockCholeskySolverCreator(OptimizationAlgorithmProperty("lm_var_blockchol_mixed", "Levenberg: supernodal block Cholesky solver, float factor with iterative refinement (variable blocksize)", "BlockCholesky", false, Eigen::Dynamic, Eigen::Dynamic)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_fix3_2_blockchol_mixed, new BlockCholeskySolverCreator(OptimizationAlgorithmProperty("lm_fix3_2_blockchol_mixed", "Levenberg: supernodal block Cholesky solver, float factor with iterative refinement (fixed blocksize)", "BlockCholesky", true, 3, 2)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_fix6_3_blockchol_mixed, new BlockCholeskySolverCreator(OptimizationAlgorithmProperty("lm_fix6_3_blockchol_mixed", "Levenberg: supernodal block Cholesky solver, float factor with iterative refinement (fixed blocksize)", "BlockCholesky", true, 6, 3)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_fix7_3_blockchol_mixed, new BlockCholeskySolverCreator(OptimizationAlgorithmProperty("lm_fix7_3_blockchol_mixed", "Levenberg: supernodal block Cholesky solver, float factor with iterative refinement (fixed blocksize)", "BlockCholesky", true, 7, 3)));
+
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(dl_var_blockchol_mixed, new BlockCholeskySolverCreator(OptimizationAlgorithmProperty("dl_var_blockchol_mixed", "Dogleg: supernodal block Cholesky solver, float factor with iterative refinement (variable blocksize)", "BlockCholesky", false, Eigen::Dynamic, Eigen::Dynamic)));
+}
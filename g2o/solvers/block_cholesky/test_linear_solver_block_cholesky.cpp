@@ -0,0 +1,182 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <iostream>
+
+#include <Eigen/Cholesky>
+
+#include "linear_solver_block_cholesky.h"
+
+using namespace std;
+using namespace g2o;
+
+#define CHECK(cond) \
+  if (! (cond)) { \
+    cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << endl; \
+    return 1; \
+  }
+
+/**
+ * random symmetric positive definite block matrix of a chain with a few loop
+ * closures. The edges measure the difference of their blocks, such that the
+ * matrix is singular up to the prior given by regularization on the diagonal.
+ */
+static MatrixX randomSystem(int numBlocks, int blockDim, number_t regularization)
+{
+  const int n = numBlocks * blockDim;
+  MatrixX dense = MatrixX::Zero(n, n);
+  for (int k = 0; k < 3 * numBlocks; ++k) {
+    int i = k % numBlocks;
+    int j = k < numBlocks ? (i + 1) % numBlocks : (i * 7 + k) % numBlocks;
+    if (i == j)
+      continue;
+    MatrixX J(blockDim, 2 * blockDim);
+    J.leftCols(blockDim) = MatrixX::Random(blockDim, blockDim);
+    J.rightCols(blockDim) = -J.leftCols(blockDim);
+    MatrixX H = J.transpose() * J;
+    int bi = i * blockDim, bj = j * blockDim;
+    dense.block(bi, bi, blockDim, blockDim) += H.topLeftCorner(blockDim, blockDim);
+    dense.block(bj, bj, blockDim, blockDim) += H.bottomRightCorner(blockDim, blockDim);
+    dense.block(bi, bj, blockDim, blockDim) += H.topRightCorner(blockDim, blockDim);
+    dense.block(bj, bi, blockDim, blockDim) += H.bottomLeftCorner(blockDim, blockDim);
+  }
+  dense.diagonal().array() += regularization;
+  return dense;
+}
+
+template <typename MatrixType>
+static void fillUpperTriangle(SparseBlockMatrix<MatrixType>& A, const MatrixX& dense, int blockDim)
+{
+  const int numBlocks = dense.rows() / blockDim;
+  for (int c = 0; c < numBlocks; ++c)
+    for (int r = 0; r <= c; ++r) {
+      MatrixX b = dense.block(r * blockDim, c * blockDim, blockDim, blockDim);
+      if (r == c || ! b.isZero())
+        *A.block(r, c, true) = b;
+    }
+}
+
+/**
+ * solve the system by the factor in FactorScalar and compare the solution
+ * and the marginals to a dense decomposition
+ */
+template <typename FactorScalar>
+static int testSolver(number_t regularization, bool expectDoubleSolver)
+{
+  const int numBlocks = 30;
+  const int blockDim = 3;
+  std::vector<int> blockIndices;
+  for (int i = 0; i < numBlocks; ++i)
+    blockIndices.push_back((i + 1) * blockDim);
+  SparseBlockMatrix<Matrix3> A(blockIndices.data(), blockIndices.data(), numBlocks, numBlocks);
+  MatrixX dense = randomSystem(numBlocks, blockDim, regularization);
+  fillUpperTriangle(A, dense, blockDim);
+  const int n = A.rows();
+
+  VectorX b = VectorX::Random(n);
+  VectorX expected = dense.llt().solve(b);
+
+  LinearSolverBlockCholesky<Matrix3, FactorScalar> solver;
+  solver.init();
+  VectorX x = VectorX::Zero(n);
+  CHECK(solver.solve(A, x.data(), b.data()));
+  CHECK(solver.usedDoubleSolver() == expectDoubleSolver);
+  CHECK((x - expected).norm() <= 1e-6 * expected.norm());
+
+  // the marginals are computed in number_t
+  number_t** blocks = 0;
+  CHECK(solver.solveBlocks(blocks, A));
+  MatrixX inverse = dense.inverse();
+  for (int i = 0; i < numBlocks; ++i) {
+    Eigen::Map<Matrix3> marginal(blocks[i]);
+    Matrix3 expectedMarginal = inverse.block<3, 3>(i * blockDim, i * blockDim);
+    CHECK((marginal - expectedMarginal).norm() <= 1e-6 * expectedMarginal.norm());
+    delete[] blocks[i];
+  }
+  delete[] blocks;
+  return 0;
+}
+
+/**
+ * once the float factor failed, the following systems of the same structure
+ * are solved in number_t directly, even if they are well conditioned, until
+ * init() is called
+ */
+static int testStickyFallback()
+{
+  const int numBlocks = 30;
+  const int blockDim = 3;
+  std::vector<int> blockIndices;
+  for (int i = 0; i < numBlocks; ++i)
+    blockIndices.push_back((i + 1) * blockDim);
+  SparseBlockMatrix<Matrix3> A(blockIndices.data(), blockIndices.data(), numBlocks, numBlocks);
+  MatrixX singular = randomSystem(numBlocks, blockDim, 0.);
+  MatrixX illConditioned = singular + 1e-6 * MatrixX::Identity(singular.rows(), singular.cols());
+  MatrixX wellConditioned = singular + MatrixX::Identity(singular.rows(), singular.cols());
+  const int n = singular.rows();
+  VectorX b = VectorX::Random(n);
+  VectorX x = VectorX::Zero(n);
+
+  LinearSolverBlockCholesky<Matrix3, float> solver;
+  solver.init();
+  fillUpperTriangle(A, illConditioned, blockDim);
+  CHECK(solver.solve(A, x.data(), b.data()));
+  CHECK(solver.usedDoubleSolver() && solver.doubleFallback());
+
+  // the float factor would succeed but is skipped
+  fillUpperTriangle(A, wellConditioned, blockDim);
+  CHECK(solver.solve(A, x.data(), b.data()));
+  CHECK(solver.usedDoubleSolver());
+  VectorX expected = wellConditioned.llt().solve(b);
+  CHECK((x - expected).norm() <= 1e-6 * expected.norm());
+
+  // init() gives the float factor another try
+  solver.init();
+  CHECK(! solver.doubleFallback());
+  CHECK(solver.solve(A, x.data(), b.data()));
+  CHECK(! solver.usedDoubleSolver());
+  CHECK((x - expected).norm() <= 1e-6 * expected.norm());
+  return 0;
+}
+
+int main()
+{
+  srand(42);
+  // well conditioned, the float factor converges by refinement
+  if (testSolver<float>(1., false))
+    return 1;
+  // ill-conditioned, the float factor cannot reach the tolerance
+  if (testSolver<float>(1e-6, true))
+    return 1;
+  if (testSolver<number_t>(1., false))
+    return 1;
+  if (testSolver<number_t>(1e-6, false))
+    return 1;
+  if (testStickyFallback())
+    return 1;
+  cerr << "OK" << endl;
+  return 0;
+}
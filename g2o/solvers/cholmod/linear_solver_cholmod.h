@@ -83,6 +83,7 @@ class LinearSolverCholmod : public LinearSolverCCS<MatrixType>
       _blockOrdering = false;
       _cholmodSparse = new CholmodExt();
       _cholmodFactor = 0;
+      _refreshStructure = false;
       cholmod_start(&_cholmodCommon);
 
       // setup ordering strategy
@@ -112,10 +113,18 @@ class LinearSolverCholmod : public LinearSolverCCS<MatrixType>
       return true;
     }
 
+    virtual bool initSamePattern()
+    {
+      // copy the structure of the new matrix but keep the symbolic factorization
+      _refreshStructure = true;
+      return true;
+    }
+
     bool solve(const SparseBlockMatrix<MatrixType>& A, double* x, double* b)
     {
       //cerr << __PRETTY_FUNCTION__ << " using cholmod" << endl;
-      fillCholmodExt(A, _cholmodFactor != 0); // _cholmodFactor used as bool, if not existing will copy the whole structure, otherwise only the values
+      fillCholmodExt(A, _cholmodFactor != 0 && ! _refreshStructure); // _cholmodFactor used as bool, if not existing will copy the whole structure, otherwise only the values
+      _refreshStructure = false;
 
       if (_cholmodFactor == 0) {
         computeSymbolicDecomposition(A);
@@ -144,10 +153,10 @@ class LinearSolverCholmod : public LinearSolverCCS<MatrixType>
       memcpy(x, xcholmod->x, sizeof(double) * bcholmod.nrow); // copy back to our array
       cholmod_free_dense(&xcholmod, &_cholmodCommon);
 
-      G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-      if (globalStats){
-        globalStats->timeNumericDecomposition = get_monotonic_time() - t;
-        globalStats->choleskyNNZ = static_cast<size_t>(_cholmodCommon.method[0].lnz);
+      G2OBatchStatistics* stats = this->batchStatistics();
+      if (stats){
+        stats->timeNumericDecomposition = get_monotonic_time() - t;
+        stats->choleskyNNZ = static_cast<size_t>(_cholmodCommon.method[0].lnz);
       }
 
       return true;
@@ -156,7 +165,8 @@ class LinearSolverCholmod : public LinearSolverCCS<MatrixType>
     bool solveBlocks(double**& blocks, const SparseBlockMatrix<MatrixType>& A)
     {
       //cerr << __PRETTY_FUNCTION__ << " using cholmod" << endl;
-      fillCholmodExt(A, _cholmodFactor != 0); // _cholmodFactor used as bool, if not existing will copy the whole structure, otherwise only the values
+      fillCholmodExt(A, _cholmodFactor != 0 && ! _refreshStructure); // _cholmodFactor used as bool, if not existing will copy the whole structure, otherwise only the values
+      _refreshStructure = false;
 
       if (_cholmodFactor == 0) {
         computeSymbolicDecomposition(A);
@@ -196,9 +206,9 @@ class LinearSolverCholmod : public LinearSolverCCS<MatrixType>
           (double*)_cholmodFactor->x, pinv.data());
       mcc.computeCovariance(blocks, A.rowBlockIndices());
 
-      G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-      if (globalStats) {
-        globalStats->choleskyNNZ = static_cast<size_t>(_cholmodCommon.method[_cholmodCommon.selected].lnz);
+      G2OBatchStatistics* stats = this->batchStatistics();
+      if (stats) {
+        stats->choleskyNNZ = static_cast<size_t>(_cholmodCommon.method[_cholmodCommon.selected].lnz);
       }
 
       return true;
@@ -207,7 +217,8 @@ class LinearSolverCholmod : public LinearSolverCCS<MatrixType>
     virtual bool solvePattern(SparseBlockMatrix<MatrixX>& spinv, const std::vector<std::pair<int, int> >& blockIndices, const SparseBlockMatrix<MatrixType>& A)
     {
       //cerr << __PRETTY_FUNCTION__ << " using cholmod" << endl;
-      fillCholmodExt(A, _cholmodFactor != 0); // _cholmodFactor used as bool, if not existing will copy the whole structure, otherwise only the values
+      fillCholmodExt(A, _cholmodFactor != 0 && ! _refreshStructure); // _cholmodFactor used as bool, if not existing will copy the whole structure, otherwise only the values
+      _refreshStructure = false;
 
       if (_cholmodFactor == 0) {
         computeSymbolicDecomposition(A);
@@ -237,9 +248,9 @@ class LinearSolverCholmod : public LinearSolverCCS<MatrixType>
           (double*)_cholmodFactor->x, pinv.data());
       mcc.computeCovariance(spinv, A.rowBlockIndices(), blockIndices);
 
-      G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-      if (globalStats) {
-        globalStats->choleskyNNZ = static_cast<size_t>(_cholmodCommon.method[_cholmodCommon.selected].lnz);
+      G2OBatchStatistics* stats = this->batchStatistics();
+      if (stats) {
+        stats->choleskyNNZ = static_cast<size_t>(_cholmodCommon.method[_cholmodCommon.selected].lnz);
       }
 
       return true;
@@ -267,6 +278,7 @@ class LinearSolverCholmod : public LinearSolverCCS<MatrixType>
     MatrixStructure _matrixStructure;
     VectorXI _scalarPermutation, _blockPermutation;
     bool _writeDebug;
+    bool _refreshStructure; ///< the pattern of A is known, but its blocks have been re-allocated
 
     void computeSymbolicDecomposition(const SparseBlockMatrix<MatrixType>& A)
     {
@@ -327,9 +339,9 @@ class LinearSolverCholmod : public LinearSolverCCS<MatrixType>
         _cholmodFactor = cholmod_analyze_p(_cholmodSparse, _scalarPermutation.data(), NULL, 0, &_cholmodCommon);
 
       }
-      G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-      if (globalStats)
-        globalStats->timeSymbolicDecomposition = get_monotonic_time() - t;
+      G2OBatchStatistics* stats = this->batchStatistics();
+      if (stats)
+        stats->timeSymbolicDecomposition = get_monotonic_time() - t;
 
       //const int& bestIdx = _cholmodCommon.selected;
       //cerr << "# Number of nonzeros in L: " << (int)_cholmodCommon.method[bestIdx].lnz << " by "
@@ -81,6 +81,7 @@ class LinearSolverCSparse : public LinearSolverCCS<MatrixType>
       _ccsA = new CSparseExt;
       _blockOrdering = true;
       _writeDebug = true;
+      _refreshStructure = false;
     }
 
     virtual ~LinearSolverCSparse()
@@ -103,9 +104,17 @@ class LinearSolverCSparse : public LinearSolverCCS<MatrixType>
       return true;
     }
 
+    virtual bool initSamePattern()
+    {
+      // copy the structure of the new matrix but keep the ordering and the symbolic decomposition
+      _refreshStructure = true;
+      return true;
+    }
+
     bool solve(const SparseBlockMatrix<MatrixType>& A, number_t* x, number_t* b)
     {
-      fillCSparse(A, _symbolicDecomposition != 0);
+      fillCSparse(A, _symbolicDecomposition != 0 && ! _refreshStructure);
+      _refreshStructure = false;
       // perform symbolic cholesky once
       if (_symbolicDecomposition == 0) {
         computeSymbolicDecomposition(A);
@@ -132,17 +141,18 @@ class LinearSolverCSparse : public LinearSolverCCS<MatrixType>
         return false;
       }
 
-      G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-      if (globalStats){
-        globalStats->timeNumericDecomposition = get_monotonic_time() - t;
-        globalStats->choleskyNNZ = static_cast<size_t>(_symbolicDecomposition->lnz);
+      G2OBatchStatistics* stats = this->batchStatistics();
+      if (stats){
+        stats->timeNumericDecomposition = get_monotonic_time() - t;
+        stats->choleskyNNZ = static_cast<size_t>(_symbolicDecomposition->lnz);
       }
 
       return ok != 0;
     }
 
     bool solveBlocks(number_t**& blocks, const SparseBlockMatrix<MatrixType>& A) {
-      fillCSparse(A, _symbolicDecomposition != 0);
+      fillCSparse(A, _symbolicDecomposition != 0 && ! _refreshStructure);
+      _refreshStructure = false;
       // perform symbolic cholesky once
       if (_symbolicDecomposition == 0) {
         computeSymbolicDecomposition(A);
@@ -179,16 +189,17 @@ class LinearSolverCSparse : public LinearSolverCCS<MatrixType>
         std::cerr << "inverse fail (numeric decomposition)" << std::endl;
       }
 
-      G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-      if (globalStats){
-        globalStats->choleskyNNZ = static_cast<size_t>(_symbolicDecomposition->lnz);
+      G2OBatchStatistics* stats = this->batchStatistics();
+      if (stats){
+        stats->choleskyNNZ = static_cast<size_t>(_symbolicDecomposition->lnz);
       }
 
       return ok != 0;
     }
 
     virtual bool solvePattern(SparseBlockMatrix<MatrixX>& spinv, const std::vector<std::pair<int, int> >& blockIndices, const SparseBlockMatrix<MatrixType>& A) {
-      fillCSparse(A, _symbolicDecomposition != 0);
+      fillCSparse(A, _symbolicDecomposition != 0 && ! _refreshStructure);
+      _refreshStructure = false;
       // perform symbolic cholesky once
       if (_symbolicDecomposition == 0) {
         computeSymbolicDecomposition(A);
@@ -216,9 +227,9 @@ class LinearSolverCSparse : public LinearSolverCCS<MatrixType>
         std::cerr << "inverse fail (numeric decomposition)" << std::endl;
       }
 
-      G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-      if (globalStats){
-        globalStats->choleskyNNZ = static_cast<size_t>(_symbolicDecomposition->lnz);
+      G2OBatchStatistics* stats = this->batchStatistics();
+      if (stats){
+        stats->choleskyNNZ = static_cast<size_t>(_symbolicDecomposition->lnz);
       }
 
       return ok != 0;
@@ -242,6 +253,7 @@ class LinearSolverCSparse : public LinearSolverCCS<MatrixType>
     MatrixStructure _matrixStructure;
     VectorXI _scalarPermutation;
     bool _writeDebug;
+    bool _refreshStructure; ///< the pattern of A is known, but its blocks have been re-allocated
 
     void computeSymbolicDecomposition(const SparseBlockMatrix<MatrixType>& A)
     {
@@ -298,9 +310,9 @@ class LinearSolverCSparse : public LinearSolverCCS<MatrixType>
         }
 
       }
-      G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-      if (globalStats){
-        globalStats->timeSymbolicDecomposition = get_monotonic_time() - t;
+      G2OBatchStatistics* stats = this->batchStatistics();
+      if (stats){
+        stats->timeSymbolicDecomposition = get_monotonic_time() - t;
       }
 
       /* std::cerr << "# Number of nonzeros in L: " << (int)_symbolicDecomposition->lnz << " by " */
@@ -89,6 +89,12 @@ class LinearSolverEigen: public LinearSolver<MatrixType>
       return true;
     }
 
+    virtual bool initSamePattern()
+    {
+      // the values are copied from the blocks of A in each call to solve
+      return true;
+    }
+
     bool solve(const SparseBlockMatrix<MatrixType>& A, number_t* x, number_t* b)
     {
       if (_init)
@@ -112,10 +118,10 @@ class LinearSolverEigen: public LinearSolver<MatrixType>
       VectorX::MapType xx(x, _sparseMatrix.cols());
       VectorX::ConstMapType bb(b, _sparseMatrix.cols());
       xx = _cholesky.solve(bb);
-      G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-      if (globalStats) {
-        globalStats->timeNumericDecomposition = get_monotonic_time() - t;
-        globalStats->choleskyNNZ = _cholesky.matrixL().nestedExpression().nonZeros() + _sparseMatrix.cols(); // the elements of D
+      G2OBatchStatistics* stats = this->batchStatistics();
+      if (stats) {
+        stats->timeNumericDecomposition = get_monotonic_time() - t;
+        stats->choleskyNNZ = _cholesky.matrixL().nestedExpression().nonZeros() + _sparseMatrix.cols(); // the elements of D
       }
 
       return true;
@@ -193,9 +199,9 @@ class LinearSolverEigen: public LinearSolver<MatrixType>
         _cholesky.analyzePatternWithPermutation(_sparseMatrix, scalarP);
 
       }
-      G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-      if (globalStats)
-        globalStats->timeSymbolicDecomposition = get_monotonic_time() - t;
+      G2OBatchStatistics* stats = this->batchStatistics();
+      if (stats)
+        stats->timeSymbolicDecomposition = get_monotonic_time() - t;
     }
 
     void fillSparseMatrix(const SparseBlockMatrix<MatrixType>& A, bool onlyValues)
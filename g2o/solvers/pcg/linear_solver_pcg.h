@@ -29,10 +29,13 @@
 
 #include "g2o/core/linear_solver.h"
 #include "g2o/core/batch_stats.h"
+#include "g2o/stuff/macros.h"
 
+#include <iostream>
 #include <vector>
 #include <utility>
 #include<Eigen/Core>
+#include<Eigen/Cholesky>
 //#ifndef EIGEN_USE_NEW_STDVECTOR
 //#define EIGEN_USE_NEW_STDVECTOR
 //#endif
@@ -41,11 +44,30 @@
 namespace g2o {
 
   /**
-   * \brief linear solver using PCG, pre-conditioner is block Jacobi
+   * \brief linear solver using PCG, pre-conditioner is block Jacobi, block SSOR, or incomplete block Cholesky
+   *
+   * Once per structure the pattern of the upper triangular matrix is
+   * expanded into a row index over both triangles, whose entries point
+   * to the blocks of the matrix itself, i.e., the blocks are neither
+   * copied nor stored twice. The entries left of the diagonal apply
+   * the transpose of the block above the diagonal. Hence, the product
+   * with the matrix is computed in parallel row by row without any race
+   * on the destination. If the
+   * BlockSolver applies the Schur complement, the matrix handed to the
+   * solver is the reduced camera system and the block Jacobi
+   * pre-conditioner is the Schur-Jacobi pre-conditioner of bundle
+   * adjustment.
    */
   template <typename MatrixType>
   class LinearSolverPCG : public LinearSolver<MatrixType>
   {
+    public:
+      enum Preconditioner {
+        PC_BLOCK_JACOBI,            ///< inverse of the diagonal blocks
+        PC_BLOCK_SSOR,              ///< symmetric successive over-relaxation of the blocks
+        PC_INCOMPLETE_CHOLESKY      ///< block Cholesky factor restricted to the pattern of the matrix, IC(0)
+      };
+
     public:
       LinearSolverPCG() :
       LinearSolver<MatrixType>()
@@ -55,6 +77,9 @@ namespace g2o {
         _absoluteTolerance = true;
         _residual = -1.0;
         _maxIter = -1;
+        _preconditioner = PC_BLOCK_JACOBI;
+        _relaxation = 1.;
+        _structureValid = false;
       }
 
       virtual ~LinearSolverPCG()
@@ -64,8 +89,7 @@ namespace g2o {
       virtual bool init()
       {
         _residual = -1.0;
-        _indices.clear();
-        _sparseMat.clear();
+        _structureValid = false;
         return true;
       }
 
@@ -84,6 +108,14 @@ namespace g2o {
       bool verbose() const { return _verbose;}
       void setVerbose(bool verbose) { _verbose = verbose;}
 
+      //! the pre-conditioner applied in each iteration
+      Preconditioner preconditioner() const { return _preconditioner;}
+      void setPreconditioner(Preconditioner preconditioner) { _preconditioner = preconditioner;}
+
+      //! relaxation factor omega in (0, 2) of the block SSOR pre-conditioner, 1 yields symmetric Gauss-Seidel
+      number_t relaxation() const { return _relaxation;}
+      void setRelaxation(number_t relaxation) { _relaxation = relaxation;}
+
     protected:
       typedef std::vector< MatrixType, Eigen::aligned_allocator<MatrixType> > MatrixVector;
       typedef std::vector< const MatrixType* > MatrixPtrVector;
@@ -93,16 +125,34 @@ namespace g2o {
       bool _absoluteTolerance;
       bool _verbose;
       int _maxIter;
-
-      MatrixPtrVector _diag;
-      MatrixVector _J;
-
-      std::vector<std::pair<int, int> > _indices;
-      MatrixPtrVector _sparseMat;
-
-      void multDiag(const std::vector<int>& colBlockIndices, MatrixVector& A, const VectorX& src, VectorX& dest);
-      void multDiag(const std::vector<int>& colBlockIndices, MatrixPtrVector& A, const VectorX& src, VectorX& dest);
-      void mult(const std::vector<int>& colBlockIndices, const VectorX& src, VectorX& dest);
+      Preconditioner _preconditioner;
+      number_t _relaxation;
+
+      // row index of the matrix over both triangles, computed once per structure
+      bool _structureValid;
+      std::vector<int> _blockOffsets;   ///< first row of each block row, one extra entry for the dimension
+      MatrixPtrVector _diag;            ///< diagonal blocks of the input matrix
+      MatrixPtrVector _offDiag;         ///< strictly upper blocks of the input matrix
+      std::vector<int> _rowStart;       ///< the entries of row i are _rowStart[i] ... _rowStart[i+1] - 1
+      std::vector<int> _rowDiagonal;    ///< first entry of row i right of the diagonal, the entries left of it are transposed
+      std::vector<int> _blockCol;       ///< block column of each entry
+      std::vector<int> _entryBlock;     ///< the block in _offDiag of each entry
+
+      // pre-conditioners
+      MatrixVector _J;                  ///< inverse of the diagonal blocks
+      MatrixVector _icDiag;             ///< upper triangular diagonal blocks of the incomplete factor U
+      MatrixVector _icBlocks;           ///< strictly upper blocks of U, in the order of _offDiag
+      std::vector<int> _icPosition;     ///< workspace of the incomplete factorization
+
+      bool computeStructure(const SparseBlockMatrix<MatrixType>& A);
+      void computeInverseDiagonal();
+      bool computeIncompleteCholesky(number_t shift);
+
+      void mult(const VectorX& src, VectorX& dest) const;
+      void applyJacobi(const VectorX& src, VectorX& dest) const;
+      void applySSOR(const VectorX& src, VectorX& dest) const;
+      void applyIncompleteCholesky(const VectorX& src, VectorX& dest) const;
+      void applyPreconditioner(Preconditioner preconditioner, const VectorX& src, VectorX& dest) const;
   };
 
 #include "linear_solver_pcg.hpp"
@@ -28,50 +28,57 @@
 
 namespace internal {
 
-#ifdef _MSC_VER
-  // MSVC does not like the template specialization, seems like MSVC applies type conversion
-  // which results in calling a fixed size method (segment<int>) on the dynamically sized matrices
   template<typename MatrixType>
-  void pcg_axy(const MatrixType& A, const VectorX& x, int xoff, VectorX& y, int yoff)
+  inline void pcg_axy(const MatrixType& A, const VectorX& x, int xoff, VectorX& y, int yoff)
   {
-    y.segment(yoff, A.rows()) = A * x.segment(xoff, A.cols());
+    y.segment<MatrixType::RowsAtCompileTime>(yoff, A.rows()) = A * x.segment<MatrixType::ColsAtCompileTime>(xoff, A.cols());
   }
-#else
+
   template<typename MatrixType>
-  inline void pcg_axy(const MatrixType& A, const VectorX& x, int xoff, VectorX& y, int yoff)
+  inline void pcg_axpy(const MatrixType& A, const VectorX& x, int xoff, VectorX& y, int yoff)
   {
-    y.segment<MatrixType::RowsAtCompileTime>(yoff) = A * x.segment<MatrixType::ColsAtCompileTime>(xoff);
+    y.segment<MatrixType::RowsAtCompileTime>(yoff, A.rows()) += A * x.segment<MatrixType::ColsAtCompileTime>(xoff, A.cols());
   }
-  
-  template<>
-  inline void pcg_axy(const MatrixX& A, const VectorX& x, int xoff, VectorX& y, int yoff)
+
+  template<typename MatrixType>
+  inline void pcg_axmy(const MatrixType& A, const VectorX& x, int xoff, VectorX& y, int yoff)
   {
-    y.segment(yoff, A.rows()) = A * x.segment(xoff, A.cols());
+    y.segment<MatrixType::RowsAtCompileTime>(yoff, A.rows()) -= A * x.segment<MatrixType::ColsAtCompileTime>(xoff, A.cols());
   }
-#endif
 
   template<typename MatrixType>
-  inline void pcg_axpy(const MatrixType& A, const VectorX& x, int xoff, VectorX& y, int yoff)
+  inline void pcg_atxpy(const MatrixType& A, const VectorX& x, int xoff, VectorX& y, int yoff)
   {
-    y.segment<MatrixType::RowsAtCompileTime>(yoff) += A * x.segment<MatrixType::ColsAtCompileTime>(xoff);
+    y.segment<MatrixType::ColsAtCompileTime>(yoff, A.cols()) += A.transpose() * x.segment<MatrixType::RowsAtCompileTime>(xoff, A.rows());
   }
 
-  template<>
-  inline void pcg_axpy(const MatrixX& A, const VectorX& x, int xoff, VectorX& y, int yoff)
+  template<typename MatrixType>
+  inline void pcg_atxmy(const MatrixType& A, const VectorX& x, int xoff, VectorX& y, int yoff)
   {
-    y.segment(yoff, A.rows()) += A * x.segment(xoff, A.cols());
+    y.segment<MatrixType::ColsAtCompileTime>(yoff, A.cols()) -= A.transpose() * x.segment<MatrixType::RowsAtCompileTime>(xoff, A.rows());
   }
 
+  //! y = alpha * A * y on the segment starting at off
   template<typename MatrixType>
-  inline void pcg_atxpy(const MatrixType& A, const VectorX& x, int xoff, VectorX& y, int yoff)
+  inline void pcg_scale_ay(const MatrixType& A, number_t alpha, VectorX& y, int off)
+  {
+    y.segment<MatrixType::RowsAtCompileTime>(off, A.rows()) = alpha * A * y.segment<MatrixType::ColsAtCompileTime>(off, A.cols());
+  }
+
+  //! solve U^T x = y in place for an upper triangular U
+  template<typename MatrixType>
+  inline void pcg_utsolve(const MatrixType& U, VectorX& y, int off)
   {
-    y.segment<MatrixType::ColsAtCompileTime>(yoff) += A.transpose() * x.segment<MatrixType::RowsAtCompileTime>(xoff);
+    typename VectorX::template FixedSegmentReturnType<MatrixType::RowsAtCompileTime>::Type ys = y.segment<MatrixType::RowsAtCompileTime>(off, U.rows());
+    U.transpose().template triangularView<Eigen::Lower>().solveInPlace(ys);
   }
 
-  template<>
-  inline void pcg_atxpy(const MatrixX& A, const VectorX& x, int xoff, VectorX& y, int yoff)
+  //! solve U x = y in place for an upper triangular U
+  template<typename MatrixType>
+  inline void pcg_usolve(const MatrixType& U, VectorX& y, int off)
   {
-    y.segment(yoff, A.cols()) += A.transpose() * x.segment(xoff, A.rows());
+    typename VectorX::template FixedSegmentReturnType<MatrixType::RowsAtCompileTime>::Type ys = y.segment<MatrixType::RowsAtCompileTime>(off, U.rows());
+    U.template triangularView<Eigen::Upper>().solveInPlace(ys);
   }
 }
 // helpers end
@@ -79,31 +86,27 @@ namespace internal {
 template <typename MatrixType>
 bool LinearSolverPCG<MatrixType>::solve(const SparseBlockMatrix<MatrixType>& A, number_t* x, number_t* b)
 {
-  const bool indexRequired = _indices.size() == 0;
-  _diag.clear();
-  _J.clear();
-
-  // put the block matrix once in a linear structure, makes mult faster
-  int colIdx = 0;
-  for (size_t i = 0; i < A.blockCols().size(); ++i){
-    const typename SparseBlockMatrix<MatrixType>::IntBlockMap& col = A.blockCols()[i];
-    if (col.size() > 0) {
-      typename SparseBlockMatrix<MatrixType>::IntBlockMap::const_iterator it;
-      for (it = col.begin(); it != col.end(); ++it) {
-        if (it->first == (int)i) { // only the upper triangular block is needed
-          _diag.push_back(it->second);
-          _J.push_back(it->second->inverse());
-          break;
-        }
-        if (indexRequired) {
-          _indices.push_back(std::make_pair(it->first > 0 ? A.rowBlockIndices()[it->first-1] : 0, colIdx));
-          _sparseMat.push_back(it->second);
-        }
+  if (! _structureValid) {
+    if (! computeStructure(A))
+      return false;
+    _structureValid = true;
+  }
 
-      }
+  Preconditioner preconditioner = _preconditioner;
+  if (preconditioner == PC_INCOMPLETE_CHOLESKY) {
+    // IC(0) may break down for a matrix which is not diagonally dominant,
+    // retry with a shifted diagonal before giving up
+    bool factorized = false;
+    for (number_t shift = 0.; ! factorized && shift < 1.; shift = shift > 0. ? 10. * shift : cst(1e-3))
+      factorized = computeIncompleteCholesky(shift);
+    if (! factorized) {
+      if (_verbose)
+        std::cerr << "incomplete Cholesky failed, using block Jacobi" << std::endl;
+      preconditioner = PC_BLOCK_JACOBI;
     }
-    colIdx = A.colBlockIndices()[i];
   }
+  if (preconditioner != PC_INCOMPLETE_CHOLESKY)
+    computeInverseDiagonal();
 
   int n = A.rows();
   assert(n > 0 && "Hessian has 0 rows/cols");
@@ -117,7 +120,7 @@ bool LinearSolverPCG<MatrixType>::solve(const SparseBlockMatrix<MatrixType>& A,
   s.setZero(n);
 
   r = bvec;
-  multDiag(A.colBlockIndices(), _J, r, d);
+  applyPreconditioner(preconditioner, r, d);
   number_t dn = r.dot(d);
   number_t d0 = _tolerance * dn;
 
@@ -127,6 +130,8 @@ bool LinearSolverPCG<MatrixType>::solve(const SparseBlockMatrix<MatrixType>& A,
   }
 
   int maxIter = _maxIter < 0 ? A.rows() : _maxIter;
+  // the recursively updated residual drifts from the true one, hence recompute it every now and then
+  const int residualUpdateInterval = 50;
 
   int iteration;
   for (iteration = 0; iteration < maxIter; ++iteration) {
@@ -134,12 +139,16 @@ bool LinearSolverPCG<MatrixType>::solve(const SparseBlockMatrix<MatrixType>& A,
       std::cerr << "residual[" << iteration << "]: " << dn << std::endl;
     if (dn <= d0)
       break;  // done
-    mult(A.colBlockIndices(), d, q);
+    mult(d, q);
     number_t a = dn / d.dot(q);
     xvec += a*d;
-    // TODO: reset residual here every 50 iterations
-    r -= a*q;
-    multDiag(A.colBlockIndices(), _J, r, s);
+    if ((iteration + 1) % residualUpdateInterval == 0) {
+      mult(xvec, q);
+      r = bvec - q;
+    } else {
+      r -= a*q;
+    }
+    applyPreconditioner(preconditioner, r, s);
     number_t dold = dn;
     dn = r.dot(s);
     number_t ba = dn / dold;
@@ -147,51 +156,223 @@ bool LinearSolverPCG<MatrixType>::solve(const SparseBlockMatrix<MatrixType>& A,
   }
   //std::cerr << "residual[" << iteration << "]: " << dn << std::endl;
   _residual = 0.5 * dn;
-  G2OBatchStatistics* globalStats = G2OBatchStatistics::globalStats();
-  if (globalStats) {
-    globalStats->iterationsLinearSolver = iteration;
+  G2OBatchStatistics* stats = this->batchStatistics();
+  if (stats) {
+    stats->iterationsLinearSolver = iteration;
   }
 
   return true;
 }
 
 template <typename MatrixType>
-void LinearSolverPCG<MatrixType>::multDiag(const std::vector<int>& colBlockIndices, MatrixVector& A, const VectorX& src, VectorX& dest)
+bool LinearSolverPCG<MatrixType>::computeStructure(const SparseBlockMatrix<MatrixType>& A)
 {
-  int row = 0;
-  for (size_t i = 0; i < A.size(); ++i) {
-    internal::pcg_axy(A[i], src, row, dest, row);
-    row = colBlockIndices[i];
+  const int numBlocks = static_cast<int>(A.blockCols().size());
+  _blockOffsets.resize(numBlocks + 1);
+  _blockOffsets[0] = 0;
+  for (int i = 0; i < numBlocks; ++i)
+    _blockOffsets[i + 1] = A.colBlockIndices()[i];
+
+  // gather the blocks column by column, only the upper triangular part is stored in A
+  _diag.assign(numBlocks, static_cast<const MatrixType*>(0));
+  _offDiag.clear();
+  std::vector<int> sourceRow;
+  std::vector<int> columnStart(numBlocks + 1);
+  for (int i = 0; i < numBlocks; ++i) {
+    columnStart[i] = static_cast<int>(_offDiag.size());
+    const typename SparseBlockMatrix<MatrixType>::IntBlockMap& col = A.blockCols()[i];
+    for (typename SparseBlockMatrix<MatrixType>::IntBlockMap::const_iterator it = col.begin(); it != col.end(); ++it) {
+      if (it->first > i)
+        break;
+      if (it->first == i) {
+        _diag[i] = it->second;
+      } else {
+        _offDiag.push_back(it->second);
+        sourceRow.push_back(it->first);
+      }
+    }
+    if (! _diag[i]) {
+      std::cerr << __PRETTY_FUNCTION__ << ": missing diagonal block " << i << std::endl;
+      return false;
+    }
+  }
+  columnStart[numBlocks] = static_cast<int>(_offDiag.size());
+
+  // block (r, c) is an entry in the upper part of row r and, transposed, in the lower part of row c.
+  // Visiting the columns in increasing order keeps each row sorted by the column.
+  std::vector<int> upperCount(numBlocks, 0);
+  for (size_t k = 0; k < sourceRow.size(); ++k)
+    ++upperCount[sourceRow[k]];
+  _rowStart.resize(numBlocks + 1);
+  _rowDiagonal.resize(numBlocks);
+  _rowStart[0] = 0;
+  for (int i = 0; i < numBlocks; ++i) {
+    _rowDiagonal[i] = _rowStart[i] + columnStart[i + 1] - columnStart[i];
+    _rowStart[i + 1] = _rowDiagonal[i] + upperCount[i];
+  }
+  const int numEntries = _rowStart[numBlocks];
+  _blockCol.resize(numEntries);
+  _entryBlock.resize(numEntries);
+  std::vector<int> upperFill(_rowDiagonal);
+  for (int c = 0; c < numBlocks; ++c) {
+    int lowerFill = _rowStart[c];
+    for (int k = columnStart[c]; k < columnStart[c + 1]; ++k) {
+      const int r = sourceRow[k];
+      const int upper = upperFill[r]++;
+      const int lower = lowerFill++;
+      _blockCol[upper] = c;
+      _blockCol[lower] = r;
+      _entryBlock[upper] = k;
+      _entryBlock[lower] = k;
+    }
   }
+
+  _J.clear();
+  _icDiag.clear();
+  _icBlocks.clear();
+  return true;
 }
 
 template <typename MatrixType>
-void LinearSolverPCG<MatrixType>::multDiag(const std::vector<int>& colBlockIndices, MatrixPtrVector& A, const VectorX& src, VectorX& dest)
+void LinearSolverPCG<MatrixType>::computeInverseDiagonal()
 {
-  int row = 0;
-  for (size_t i = 0; i < A.size(); ++i) {
-    internal::pcg_axy(*A[i], src, row, dest, row);
-    row = colBlockIndices[i];
+  const int numBlocks = static_cast<int>(_diag.size());
+  _J.resize(numBlocks);
+# ifdef G2O_OPENMP
+# pragma omp parallel for default (shared) if (numBlocks > 100)
+# endif
+  for (int i = 0; i < numBlocks; ++i)
+    _J[i] = _diag[i]->inverse();
+}
+
+template <typename MatrixType>
+bool LinearSolverPCG<MatrixType>::computeIncompleteCholesky(number_t shift)
+{
+  const int numBlocks = static_cast<int>(_diag.size());
+  _icDiag.resize(numBlocks);
+  _icBlocks.resize(_offDiag.size());
+  _icPosition.assign(numBlocks, -1);
+
+  // left-looking by block rows, row k of the factor U is computed from the rows above
+  // which have an entry in column k. Fill-in outside the pattern of A is dropped.
+  MatrixType D;
+  for (int k = 0; k < numBlocks; ++k) {
+    D = *_diag[k];
+    if (shift > 0.)
+      D.diagonal() *= 1. + shift;
+    for (int p = _rowDiagonal[k]; p < _rowStart[k + 1]; ++p) {
+      _icBlocks[_entryBlock[p]] = *_offDiag[_entryBlock[p]];
+      _icPosition[_blockCol[p]] = _entryBlock[p];
+    }
+
+    for (int q = _rowStart[k]; q < _rowDiagonal[k]; ++q) {
+      const int i = _blockCol[q];
+      const MatrixType& Uik = _icBlocks[_entryBlock[q]];
+      D.noalias() -= Uik.transpose() * Uik;
+      for (int t = _rowDiagonal[i]; t < _rowStart[i + 1]; ++t) {
+        const int j = _blockCol[t];
+        if (j <= k || _icPosition[j] < 0)
+          continue;
+        _icBlocks[_icPosition[j]].noalias() -= Uik.transpose() * _icBlocks[_entryBlock[t]];
+      }
+    }
+
+    Eigen::LLT<MatrixType> llt(D);
+    for (int p = _rowDiagonal[k]; p < _rowStart[k + 1]; ++p)
+      _icPosition[_blockCol[p]] = -1;
+    if (llt.info() != Eigen::Success)
+      return false;
+    _icDiag[k] = llt.matrixU();
+    for (int p = _rowDiagonal[k]; p < _rowStart[k + 1]; ++p)
+      _icDiag[k].transpose().template triangularView<Eigen::Lower>().solveInPlace(_icBlocks[_entryBlock[p]]);
+  }
+  return true;
+}
+
+template <typename MatrixType>
+void LinearSolverPCG<MatrixType>::mult(const VectorX& src, VectorX& dest) const
+{
+  // each block row of dest is computed by a single thread
+  const int numBlocks = static_cast<int>(_diag.size());
+# ifdef G2O_OPENMP
+# pragma omp parallel for default (shared) schedule(dynamic, 64) if (numBlocks > 100)
+# endif
+  for (int i = 0; i < numBlocks; ++i) {
+    const int destOffset = _blockOffsets[i];
+    internal::pcg_axy(*_diag[i], src, destOffset, dest, destOffset);
+    for (int p = _rowStart[i]; p < _rowDiagonal[i]; ++p)
+      internal::pcg_atxpy(*_offDiag[_entryBlock[p]], src, _blockOffsets[_blockCol[p]], dest, destOffset);
+    for (int p = _rowDiagonal[i]; p < _rowStart[i + 1]; ++p)
+      internal::pcg_axpy(*_offDiag[_entryBlock[p]], src, _blockOffsets[_blockCol[p]], dest, destOffset);
+  }
+}
+
+template <typename MatrixType>
+void LinearSolverPCG<MatrixType>::applyJacobi(const VectorX& src, VectorX& dest) const
+{
+  const int numBlocks = static_cast<int>(_J.size());
+# ifdef G2O_OPENMP
+# pragma omp parallel for default (shared) if (numBlocks > 1000)
+# endif
+  for (int i = 0; i < numBlocks; ++i)
+    internal::pcg_axy(_J[i], src, _blockOffsets[i], dest, _blockOffsets[i]);
+}
+
+template <typename MatrixType>
+void LinearSolverPCG<MatrixType>::applySSOR(const VectorX& src, VectorX& dest) const
+{
+  // M = 1 / (w (2-w)) (D + w L) D^-1 (D + w U)
+  const int numBlocks = static_cast<int>(_J.size());
+  const number_t w = _relaxation;
+  dest = src;
+  for (int k = 0; k < numBlocks; ++k) {
+    const int off = _blockOffsets[k];
+    for (int p = _rowStart[k]; p < _rowDiagonal[k]; ++p)
+      internal::pcg_atxmy(*_offDiag[_entryBlock[p]], dest, _blockOffsets[_blockCol[p]], dest, off);
+    internal::pcg_scale_ay(_J[k], w, dest, off);
+  }
+  for (int k = 0; k < numBlocks; ++k)
+    internal::pcg_scale_ay(*_diag[k], (2. - w) / w, dest, _blockOffsets[k]);
+  for (int k = numBlocks - 1; k >= 0; --k) {
+    const int off = _blockOffsets[k];
+    for (int p = _rowDiagonal[k]; p < _rowStart[k + 1]; ++p)
+      internal::pcg_axmy(*_offDiag[_entryBlock[p]], dest, _blockOffsets[_blockCol[p]], dest, off);
+    internal::pcg_scale_ay(_J[k], w, dest, off);
+  }
+}
+
+template <typename MatrixType>
+void LinearSolverPCG<MatrixType>::applyIncompleteCholesky(const VectorX& src, VectorX& dest) const
+{
+  // solve U^T U dest = src by forward and backward substitution
+  const int numBlocks = static_cast<int>(_icDiag.size());
+  dest = src;
+  for (int k = 0; k < numBlocks; ++k) {
+    const int off = _blockOffsets[k];
+    for (int p = _rowStart[k]; p < _rowDiagonal[k]; ++p)
+      internal::pcg_atxmy(_icBlocks[_entryBlock[p]], dest, _blockOffsets[_blockCol[p]], dest, off);
+    internal::pcg_utsolve(_icDiag[k], dest, off);
+  }
+  for (int k = numBlocks - 1; k >= 0; --k) {
+    const int off = _blockOffsets[k];
+    for (int p = _rowDiagonal[k]; p < _rowStart[k + 1]; ++p)
+      internal::pcg_axmy(_icBlocks[_entryBlock[p]], dest, _blockOffsets[_blockCol[p]], dest, off);
+    internal::pcg_usolve(_icDiag[k], dest, off);
   }
 }
 
 template <typename MatrixType>
-void LinearSolverPCG<MatrixType>::mult(const std::vector<int>& colBlockIndices, const VectorX& src, VectorX& dest)
+void LinearSolverPCG<MatrixType>::applyPreconditioner(Preconditioner preconditioner, const VectorX& src, VectorX& dest) const
 {
-  // first multiply with the diagonal
-  multDiag(colBlockIndices, _diag, src, dest);
-
-  // now multiply with the upper triangular block
-  for (size_t i = 0; i < _sparseMat.size(); ++i) {
-    const int& srcOffset = _indices[i].second;
-    const int& destOffsetT = srcOffset;
-    const int& destOffset = _indices[i].first;
-    const int& srcOffsetT = destOffset;
-
-    const typename SparseBlockMatrix<MatrixType>::SparseMatrixBlock* a = _sparseMat[i];
-    // destVec += *a * srcVec (according to the sub-vector parts)
-    internal::pcg_axpy(*a, src, srcOffset, dest, destOffset);
-    // destVec += *a.transpose() * srcVec (according to the sub-vector parts)
-    internal::pcg_atxpy(*a, src, srcOffsetT, dest, destOffsetT);
+  switch (preconditioner) {
+    case PC_BLOCK_SSOR:
+      applySSOR(src, dest);
+      break;
+    case PC_INCOMPLETE_CHOLESKY:
+      applyIncompleteCholesky(src, dest);
+      break;
+    default:
+      applyJacobi(src, dest);
+      break;
   }
 }
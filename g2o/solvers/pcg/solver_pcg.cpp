@@ -40,23 +40,36 @@ namespace g2o
 {
   namespace
   {
-    template<int p, int l>
+    template<int p, int l, int preconditioner>
     std::unique_ptr<g2o::Solver> AllocateSolver()
     {
       std::cerr << "# Using PCG poseDim " << p << " landMarkDim " << l << std::endl;
 
-      return g2o::make_unique<BlockSolverPL<p, l>>(
-        g2o::make_unique<LinearSolverPCG<typename BlockSolverPL<p, l>::PoseMatrixType>>());
+      typedef LinearSolverPCG<typename BlockSolverPL<p, l>::PoseMatrixType> PCGSolverType;
+      auto linearSolver = g2o::make_unique<PCGSolverType>();
+      linearSolver->setPreconditioner(static_cast<typename PCGSolverType::Preconditioner>(preconditioner));
+      return g2o::make_unique<BlockSolverPL<p, l>>(std::move(linearSolver));
     }
   }
 
   static OptimizationAlgorithm* createSolver(const std::string& fullSolverName)
   {
+    static const int jacobi = LinearSolverPCG<MatrixX>::PC_BLOCK_JACOBI;
+    static const int ssor = LinearSolverPCG<MatrixX>::PC_BLOCK_SSOR;
+    static const int ic = LinearSolverPCG<MatrixX>::PC_INCOMPLETE_CHOLESKY;
     static const std::map<std::string, std::function<std::unique_ptr<g2o::Solver>()>> solver_factories{
-        { "pcg", &AllocateSolver<-1, -1> },
-        { "pcg3_2", &AllocateSolver<3, 2> },
-        { "pcg6_3", &AllocateSolver<6, 3> },
-        { "pcg7_3", &AllocateSolver<7, 3> },
+        { "pcg", &AllocateSolver<-1, -1, jacobi> },
+        { "pcg3_2", &AllocateSolver<3, 2, jacobi> },
+        { "pcg6_3", &AllocateSolver<6, 3, jacobi> },
+        { "pcg7_3", &AllocateSolver<7, 3, jacobi> },
+        { "pcg_ssor", &AllocateSolver<-1, -1, ssor> },
+        { "pcg3_2_ssor", &AllocateSolver<3, 2, ssor> },
+        { "pcg6_3_ssor", &AllocateSolver<6, 3, ssor> },
+        { "pcg7_3_ssor", &AllocateSolver<7, 3, ssor> },
+        { "pcg_ic", &AllocateSolver<-1, -1, ic> },
+        { "pcg3_2_ic", &AllocateSolver<3, 2, ic> },
+        { "pcg6_3_ic", &AllocateSolver<6, 3, ic> },
+        { "pcg7_3_ic", &AllocateSolver<7, 3, ic> },
     };
 
     string solverName = fullSolverName.substr(3);
@@ -96,4 +109,21 @@ namespace g2o
   G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_pcg3_2, new PCGSolverCreator(OptimizationAlgorithmProperty("lm_pcg3_2", "Levenberg: PCG solver using block-Jacobi pre-conditioner (fixed blocksize)", "PCG", true, 3, 2)));
   G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_pcg6_3, new PCGSolverCreator(OptimizationAlgorithmProperty("lm_pcg6_3", "Levenberg: PCG solver using block-Jacobi pre-conditioner (fixed blocksize)", "PCG", true, 6, 3)));
   G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_pcg7_3, new PCGSolverCreator(OptimizationAlgorithmProperty("lm_pcg7_3", "Levenberg: PCG solver using block-Jacobi pre-conditioner (fixed blocksize)", "PCG", true, 7, 3)));
+
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(gn_pcg_ssor, new PCGSolverCreator(OptimizationAlgorithmProperty("gn_pcg_ssor", "Gauss-Newton: PCG solver using block SSOR pre-conditioner (variable blocksize)", "PCG", false, Eigen::Dynamic, Eigen::Dynamic)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(gn_pcg3_2_ssor, new PCGSolverCreator(OptimizationAlgorithmProperty("gn_pcg3_2_ssor", "Gauss-Newton: PCG solver using block SSOR pre-conditioner (fixed blocksize)", "PCG", true, 3, 2)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(gn_pcg6_3_ssor, new PCGSolverCreator(OptimizationAlgorithmProperty("gn_pcg6_3_ssor", "Gauss-Newton: PCG solver using block SSOR pre-conditioner (fixed blocksize)", "PCG", true, 6, 3)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(gn_pcg7_3_ssor, new PCGSolverCreator(OptimizationAlgorithmProperty("gn_pcg7_3_ssor", "Gauss-Newton: PCG solver using block SSOR pre-conditioner (fixed blocksize)", "PCG", true, 7, 3)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_pcg_ssor, new PCGSolverCreator(OptimizationAlgorithmProperty("lm_pcg_ssor", "Levenberg: PCG solver using block SSOR pre-conditioner (variable blocksize)", "PCG", false, Eigen::Dynamic, Eigen::Dynamic)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_pcg3_2_ssor, new PCGSolverCreator(OptimizationAlgorithmProperty("lm_pcg3_2_ssor", "Levenberg: PCG solver using block SSOR pre-conditioner (fixed blocksize)", "PCG", true, 3, 2)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_pcg6_3_ssor, new PCGSolverCreator(OptimizationAlgorithmProperty("lm_pcg6_3_ssor", "Levenberg: PCG solver using block SSOR pre-conditioner (fixed blocksize)", "PCG", true, 6, 3)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_pcg7_3_ssor, new PCGSolverCreator(OptimizationAlgorithmProperty("lm_pcg7_3_ssor", "Levenberg: PCG solver using block SSOR pre-conditioner (fixed blocksize)", "PCG", true, 7, 3)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(gn_pcg_ic, new PCGSolverCreator(OptimizationAlgorithmProperty("gn_pcg_ic", "Gauss-Newton: PCG solver using incomplete block Cholesky pre-conditioner (variable blocksize)", "PCG", false, Eigen::Dynamic, Eigen::Dynamic)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(gn_pcg3_2_ic, new PCGSolverCreator(OptimizationAlgorithmProperty("gn_pcg3_2_ic", "Gauss-Newton: PCG solver using incomplete block Cholesky pre-conditioner (fixed blocksize)", "PCG", true, 3, 2)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(gn_pcg6_3_ic, new PCGSolverCreator(OptimizationAlgorithmProperty("gn_pcg6_3_ic", "Gauss-Newton: PCG solver using incomplete block Cholesky pre-conditioner (fixed blocksize)", "PCG", true, 6, 3)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(gn_pcg7_3_ic, new PCGSolverCreator(OptimizationAlgorithmProperty("gn_pcg7_3_ic", "Gauss-Newton: PCG solver using incomplete block Cholesky pre-conditioner (fixed blocksize)", "PCG", true, 7, 3)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_pcg_ic, new PCGSolverCreator(OptimizationAlgorithmProperty("lm_pcg_ic", "Levenberg: PCG solver using incomplete block Cholesky pre-conditioner (variable blocksize)", "PCG", false, Eigen::Dynamic, Eigen::Dynamic)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_pcg3_2_ic, new PCGSolverCreator(OptimizationAlgorithmProperty("lm_pcg3_2_ic", "Levenberg: PCG solver using incomplete block Cholesky pre-conditioner (fixed blocksize)", "PCG", true, 3, 2)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_pcg6_3_ic, new PCGSolverCreator(OptimizationAlgorithmProperty("lm_pcg6_3_ic", "Levenberg: PCG solver using incomplete block Cholesky pre-conditioner (fixed blocksize)", "PCG", true, 6, 3)));
+  G2O_REGISTER_OPTIMIZATION_ALGORITHM(lm_pcg7_3_ic, new PCGSolverCreator(OptimizationAlgorithmProperty("lm_pcg7_3_ic", "Levenberg: PCG solver using incomplete block Cholesky pre-conditioner (fixed blocksize)", "PCG", true, 7, 3)));
 }
@@ -0,0 +1,116 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <iostream>
+
+#include <Eigen/Cholesky>
+
+#include "g2o/stuff/misc.h"
+#include "linear_solver_pcg.h"
+
+using namespace std;
+using namespace g2o;
+
+/**
+ * solve a random symmetric positive definite block system whose upper
+ * triangle is given by the sparse block matrix and compare the result of
+ * PCG to a dense Cholesky decomposition
+ */
+template <typename MatrixType>
+int testPCG(int blockDim, typename LinearSolverPCG<MatrixType>::Preconditioner preconditioner)
+{
+  const int numBlocks = 40;
+  std::vector<int> blockIndices;
+  for (int i = 0; i < numBlocks; ++i)
+    blockIndices.push_back((i + 1) * blockDim);
+  SparseBlockMatrix<MatrixType> A(blockIndices.data(), blockIndices.data(), numBlocks, numBlocks);
+  const int n = A.rows();
+
+  // J^T J of a random sparse Jacobian, a chain and a few loop closures
+  MatrixX dense = MatrixX::Zero(n, n);
+  for (int k = 0; k < 3 * numBlocks; ++k) {
+    int i = k % numBlocks;
+    int j = k < numBlocks ? (i + 1) % numBlocks : (i * 7 + k) % numBlocks;
+    if (i == j)
+      continue;
+    MatrixX J = MatrixX::Random(blockDim, 2 * blockDim);
+    MatrixX H = J.transpose() * J;
+    int bi = i * blockDim, bj = j * blockDim;
+    dense.block(bi, bi, blockDim, blockDim) += H.topLeftCorner(blockDim, blockDim);
+    dense.block(bj, bj, blockDim, blockDim) += H.bottomRightCorner(blockDim, blockDim);
+    dense.block(bi, bj, blockDim, blockDim) += H.topRightCorner(blockDim, blockDim);
+    dense.block(bj, bi, blockDim, blockDim) += H.bottomLeftCorner(blockDim, blockDim);
+  }
+  dense.diagonal().array() += 1.;
+  for (int c = 0; c < numBlocks; ++c)
+    for (int r = 0; r <= c; ++r) {
+      MatrixX b = dense.block(r * blockDim, c * blockDim, blockDim, blockDim);
+      if (r == c || ! b.isZero())
+        *A.block(r, c, true) = b;
+    }
+
+  VectorX b = VectorX::Random(n);
+  VectorX expected = dense.llt().solve(b);
+
+  LinearSolverPCG<MatrixType> solver;
+  solver.setPreconditioner(preconditioner);
+  solver.setTolerance(cst(1e-24));
+  solver.setAbsoluteTolerance(false);
+  solver.init();
+  VectorX x(n);
+  // solve twice, the second call re-uses the row index
+  for (int k = 0; k < 2; ++k) {
+    x.setZero();
+    if (! solver.solve(A, x.data(), b.data())) {
+      cerr << "solve failed" << endl;
+      return 1;
+    }
+    number_t error = (x - expected).norm() / expected.norm();
+    if (error > 1e-6) {
+      cerr << "preconditioner " << preconditioner << " block dimension " << blockDim << ": error " << error << endl;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int main()
+{
+  typedef LinearSolverPCG<Matrix3> SolverPCG3;
+  typedef LinearSolverPCG<MatrixX> SolverPCGX;
+  srand(42);
+  int failures = 0;
+  failures += testPCG<Matrix3>(3, SolverPCG3::PC_BLOCK_JACOBI);
+  failures += testPCG<Matrix3>(3, SolverPCG3::PC_BLOCK_SSOR);
+  failures += testPCG<Matrix3>(3, SolverPCG3::PC_INCOMPLETE_CHOLESKY);
+  failures += testPCG<MatrixX>(6, SolverPCGX::PC_BLOCK_JACOBI);
+  failures += testPCG<MatrixX>(6, SolverPCGX::PC_BLOCK_SSOR);
+  failures += testPCG<MatrixX>(6, SolverPCGX::PC_INCOMPLETE_CHOLESKY);
+  if (failures)
+    return 1;
+  cerr << "OK" << endl;
+  return 0;
+}
@@ -153,9 +153,8 @@ namespace g2o {
     HyperDijkstra hyperDijkstra(_optimizer);
     hyperDijkstra.shortestPaths(root, &uniformCost);
 
-    HyperDijkstra::computeTree(hyperDijkstra.adjacencyMap());
     ThetaTreeAction thetaTreeAction(thetaGuess.data());
-    HyperDijkstra::visitAdjacencyMap(hyperDijkstra.adjacencyMap(), &thetaTreeAction);
+    hyperDijkstra.visitTree(&thetaTreeAction);
 
     // construct for the orientation
     for (SparseOptimizer::EdgeContainer::const_iterator it = _optimizer->activeEdges().begin(); it != _optimizer->activeEdges().end(); ++it) {
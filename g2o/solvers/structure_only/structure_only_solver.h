@@ -28,6 +28,9 @@
 #ifndef G2O_STRUCTURE_ONLY_SOLVER_H
 #define G2O_STRUCTURE_ONLY_SOLVER_H
 
+#include <unordered_set>
+
+#include "g2o/config.h"
 #include "g2o/core/base_vertex.h"
 #include "g2o/core/base_binary_edge.h"
 #include "g2o/core/optimization_algorithm.h"
@@ -69,127 +72,62 @@ class StructureOnlySolver : public OptimizationAlgorithm
       return calc(_points, 1);
     }
 
+    //! outcome of the refinement of a single point by calc()
+    enum PointResult {
+      Converged,      ///< the gradient vanished
+      MaxIterations,  ///< performed the maximum number of iterations
+      NoProgress,     ///< the damping did not yield a decrease of chi2
+      Skipped         ///< the point is fixed
+    };
+
+    //! the state of a single point after calc()
+    struct PointStatus {
+      number_t initialChi2;
+      number_t chi2;
+      int iterations;
+      PointResult result;
+    };
+
+    /**
+     * refine the given points by an LM on each point. The points are
+     * processed in parallel, hence they must be independent given the
+     * remaining vertices, i.e., an edge must not connect two of the points.
+     * The remaining vertices are fixed while calc() runs.
+     */
     OptimizationAlgorithm::SolverResult calc(OptimizableGraph::VertexContainer& vertices, int num_iters, int num_max_trials=10)
     {
+      // fix the other vertices once for all the points, the threads thus
+      // never modify a vertex which is shared among the points
+      std::unordered_set<OptimizableGraph::Vertex*> pointSet(vertices.begin(), vertices.end());
+      OptimizableGraph::VertexContainer fixedVertices;
       JacobianWorkspace auxWorkspace;
-      auxWorkspace.updateSize(2, 50);
-      auxWorkspace.allocate();
-
       for (OptimizableGraph::VertexContainer::iterator it_v=vertices.begin(); it_v!=vertices.end(); ++it_v) {
-        bool stop = false;
-        g2o::OptimizableGraph::Vertex* v = dynamic_cast<OptimizableGraph::Vertex*>(*it_v);
-        assert(v->dimension() == PointDoF);
-        g2o::HyperGraph::EdgeSet& track = v->edges();
-        assert(track.size()>=2);
-        number_t chi2 = 0;
-        // TODO make these parameters
-        number_t mu = cst(0.01);
-        number_t nu = 2;
-
+        g2o::HyperGraph::EdgeSet& track = (*it_v)->edges();
         for (g2o::HyperGraph::EdgeSet::iterator it_t=track.begin(); it_t!=track.end(); ++it_t) {
-          g2o::OptimizableGraph::Edge* e = dynamic_cast<g2o::OptimizableGraph::Edge *>(*it_t);
-          e->computeError();
-          chi2 += e->chi2();
-        }
-
-        if (v->fixed() == false) {
-          Eigen::Matrix<number_t, PointDoF, PointDoF, Eigen::ColMajor> H_pp;
-          H_pp.resize(v->dimension(), v->dimension());
-          v->mapHessianMemory(H_pp.data());
-          for (int i_g = 0; i_g < num_iters; ++i_g) {
-            H_pp.setZero();
-            v->clearQuadraticForm();
-
-            g2o::HyperGraph::EdgeSet& track = v->edges();
-            assert(track.size()>=1);
-
-            for (g2o::HyperGraph::EdgeSet::iterator it_t=track.begin(); it_t!=track.end(); ++it_t) {
-              g2o::OptimizableGraph::Edge* e = dynamic_cast<g2o::OptimizableGraph::Edge *>(*it_t);
-
-              // fix all the other vertices and remember their fix value
-#ifdef WINDOWS
-              std::vector<bool> remember_fix_status(e->vertices().size());
-#else
-              bool remember_fix_status[e->vertices().size()];
-#endif
-              for (size_t k = 0; k < e->vertices().size(); ++k) {
-                OptimizableGraph::Vertex* otherV = static_cast<OptimizableGraph::Vertex*>(e->vertex(k));
-                if (otherV != v) {
-                  remember_fix_status[k] = otherV->fixed();
-                  otherV->setFixed(true);
-                }
-              }
-
-              // build the matrix
-              e->computeError();
-              e->linearizeOplus(auxWorkspace);
-              e->constructQuadraticForm();
-
-              // Restore frame's initial fixed() values
-              for (size_t k = 0; k < e->vertices().size(); ++k) {
-                OptimizableGraph::Vertex* otherV = static_cast<g2o::OptimizableGraph::Vertex*>(e->vertex(k));
-                if (otherV != v) {
-                  otherV->setFixed(remember_fix_status[k]);
-                }
-              }
-            }
-
-            Eigen::Map<Eigen::Matrix<number_t,PointDoF,1,Eigen::ColMajor> > b(v->bData(), v->dimension());
-
-            if (b.norm()<0.001) {
-              stop = true;
-              break;
+          g2o::HyperGraph::Edge* e = *it_t;
+          auxWorkspace.updateSize(e);
+          for (size_t k = 0; k < e->vertices().size(); ++k) {
+            OptimizableGraph::Vertex* otherV = static_cast<OptimizableGraph::Vertex*>(e->vertex(k));
+            if (otherV && ! otherV->fixed() && pointSet.find(otherV) == pointSet.end()) {
+              otherV->setFixed(true);
+              fixedVertices.push_back(otherV);
             }
-
-            int trial=0;
-            do {
-              Eigen::Matrix<number_t,PointDoF,PointDoF,Eigen::ColMajor> H_pp_mu = H_pp;
-              H_pp_mu.diagonal().array() += mu;
-              Eigen::LDLT<Eigen::Matrix<number_t,PointDoF,PointDoF,Eigen::ColMajor> > chol_H_pp(H_pp_mu);
-              bool goodStep = false;
-              if (chol_H_pp.isPositive()) {
-                Eigen::Matrix<number_t,PointDoF,1,Eigen::ColMajor> delta_p = chol_H_pp.solve(b);
-                v->push();
-                v->oplus(delta_p.data());
-                number_t new_chi2 = 0;
-                for (g2o::HyperGraph::EdgeSet::iterator it_t=track.begin(); it_t!=track.end(); ++it_t) {
-                  g2o::OptimizableGraph::Edge* e = dynamic_cast<g2o::OptimizableGraph::Edge *>(*it_t);
-                  e->computeError();
-                  new_chi2 += e->chi2();
-                }
-                assert(g2o_isnan(new_chi2)==false && "Chi is NaN");
-                number_t rho = (chi2 - new_chi2);
-                if (rho > 0 && g2o_isfinite(new_chi2)) {
-                  goodStep = true;
-                  chi2 = new_chi2;
-                  v->discardTop();
-                } else {
-                  goodStep = false;
-                  v->pop();
-                }
-              }
-
-              // update the damping factor based on the result of the last increment
-              if (goodStep) {
-                mu *= cst(1./3.);
-                nu = 2.;
-                trial=0;
-                break;
-              } else {
-                mu *= nu;
-                nu *= 2.;
-                ++trial;
-                if (trial >= num_max_trials) {
-                  stop=true;
-                  break;
-                }
-              }
-            } while(!stop);
-            if (stop)
-              break;
           }
         }
       }
+      auxWorkspace.allocate();
+
+      _pointStatus.resize(vertices.size());
+      const int numPoints = static_cast<int>(vertices.size());
+#     ifdef G2O_OPENMP
+#     pragma omp parallel for default (shared) firstprivate(auxWorkspace) schedule(dynamic, 64) if (numPoints > 100)
+#     endif
+      for (int i = 0; i < numPoints; ++i)
+        refinePoint(vertices[i], auxWorkspace, num_iters, num_max_trials, _pointStatus[i]);
+
+      // restore the initial fixed() values of the other vertices
+      for (size_t i = 0; i < fixedVertices.size(); ++i)
+        fixedVertices[i]->setFixed(false);
       return OK;
     }
 
@@ -210,13 +148,117 @@ class StructureOnlySolver : public OptimizationAlgorithm
 
     virtual bool updateStructure(const std::vector<HyperGraph::Vertex*>& , const HyperGraph::EdgeSet& ) { return true;}
 
+    virtual bool removeFromStructure(const std::vector<HyperGraph::Vertex*>& , const HyperGraph::EdgeSet& ) { return true;}
+
     //! return the points of the optimization problem
     OptimizableGraph::VertexContainer& points() { return _points;}
     const OptimizableGraph::VertexContainer& points() const { return _points;}
 
+    //! the state of the points in the last call to calc(), in the order of the points passed to calc()
+    const std::vector<PointStatus>& pointStatus() const { return _pointStatus;}
+
   protected:
+    //! LM on a single point, all the other vertices of its edges are fixed
+    void refinePoint(OptimizableGraph::Vertex* v, JacobianWorkspace& auxWorkspace, int num_iters, int num_max_trials, PointStatus& status)
+    {
+      assert(v->dimension() == PointDoF);
+      g2o::HyperGraph::EdgeSet& track = v->edges();
+      assert(track.size()>=2);
+      number_t chi2 = 0;
+      // TODO make these parameters
+      number_t mu = cst(0.01);
+      number_t nu = 2;
+
+      for (g2o::HyperGraph::EdgeSet::iterator it_t=track.begin(); it_t!=track.end(); ++it_t) {
+        g2o::OptimizableGraph::Edge* e = static_cast<g2o::OptimizableGraph::Edge *>(*it_t);
+        e->computeError();
+        chi2 += e->chi2();
+      }
+      status.initialChi2 = chi2;
+      status.chi2 = chi2;
+      status.iterations = 0;
+      status.result = Skipped;
+      if (v->fixed())
+        return;
+
+      status.result = MaxIterations;
+      Eigen::Matrix<number_t, PointDoF, PointDoF, Eigen::ColMajor> H_pp;
+      v->mapHessianMemory(H_pp.data());
+      for (int i_g = 0; i_g < num_iters; ++i_g) {
+        H_pp.setZero();
+        v->clearQuadraticForm();
+
+        // build the matrix
+        for (g2o::HyperGraph::EdgeSet::iterator it_t=track.begin(); it_t!=track.end(); ++it_t) {
+          g2o::OptimizableGraph::Edge* e = static_cast<g2o::OptimizableGraph::Edge *>(*it_t);
+          e->computeError();
+          e->linearizeOplus(auxWorkspace);
+          e->constructQuadraticForm();
+        }
+
+        Eigen::Map<Eigen::Matrix<number_t,PointDoF,1,Eigen::ColMajor> > b(v->bData());
+
+        if (b.norm()<0.001) {
+          status.result = Converged;
+          break;
+        }
+
+        bool stop = false;
+        int trial=0;
+        do {
+          Eigen::Matrix<number_t,PointDoF,PointDoF,Eigen::ColMajor> H_pp_mu = H_pp;
+          H_pp_mu.diagonal().array() += mu;
+          Eigen::LDLT<Eigen::Matrix<number_t,PointDoF,PointDoF,Eigen::ColMajor> > chol_H_pp(H_pp_mu);
+          bool goodStep = false;
+          if (chol_H_pp.isPositive()) {
+            Eigen::Matrix<number_t,PointDoF,1,Eigen::ColMajor> delta_p = chol_H_pp.solve(b);
+            v->push();
+            v->oplus(delta_p.data());
+            number_t new_chi2 = 0;
+            for (g2o::HyperGraph::EdgeSet::iterator it_t=track.begin(); it_t!=track.end(); ++it_t) {
+              g2o::OptimizableGraph::Edge* e = static_cast<g2o::OptimizableGraph::Edge *>(*it_t);
+              e->computeError();
+              new_chi2 += e->chi2();
+            }
+            assert(g2o_isnan(new_chi2)==false && "Chi is NaN");
+            number_t rho = (chi2 - new_chi2);
+            if (rho > 0 && g2o_isfinite(new_chi2)) {
+              goodStep = true;
+              chi2 = new_chi2;
+              v->discardTop();
+            } else {
+              goodStep = false;
+              v->pop();
+            }
+          }
+
+          // update the damping factor based on the result of the last increment
+          if (goodStep) {
+            mu *= cst(1./3.);
+            nu = 2.;
+            trial=0;
+            break;
+          } else {
+            mu *= nu;
+            nu *= 2.;
+            ++trial;
+            if (trial >= num_max_trials) {
+              status.result = NoProgress;
+              stop=true;
+              break;
+            }
+          }
+        } while(!stop);
+        status.iterations = i_g + 1;
+        status.chi2 = chi2;
+        if (stop)
+          break;
+      }
+    }
+
     bool _verbose;
     OptimizableGraph::VertexContainer _points;
+    std::vector<PointStatus> _pointStatus;
 };
 
 }
@@ -0,0 +1,164 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 H. Strasdat
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "batch_edge_kernel_six_dof_expmap.h"
+
+namespace g2o {
+
+namespace {
+  //! the intrinsics stored in the edge
+  inline void cameraIntrinsics(const EdgeSE3ProjectXYZ* e, number_t& fx, number_t& fy, number_t& cx, number_t& cy) {
+    fx = e->fx;
+    fy = e->fy;
+    cx = e->cx;
+    cy = e->cy;
+  }
+
+  //! the intrinsics of the CameraParameters of the edge
+  inline void cameraIntrinsics(const EdgeProjectXYZ2UV* e, number_t& fx, number_t& fy, number_t& cx, number_t& cy) {
+    const CameraParameters* cam = static_cast<const CameraParameters*>(e->parameter(0));
+    fx = cam->focal_length;
+    fy = cam->focal_length;
+    cx = cam->principle_point[0];
+    cy = cam->principle_point[1];
+  }
+}
+
+template <typename E>
+void BaseBatchEdgeKernelProjectXYZ<E>::gatherCamera(int chunk, Lanes& u, Lanes& v, Lanes& fx, Lanes& fy, Lanes& cx, Lanes& cy) const {
+  for (int l = 0; l < Base::LaneWidth; ++l) {
+    const E* e = this->edge(this->laneEdge(chunk, l));
+    u[l] = e->measurement()[0];
+    v[l] = e->measurement()[1];
+    cameraIntrinsics(e, fx[l], fy[l], cx[l], cy[l]);
+  }
+}
+
+template <typename E>
+void BaseBatchEdgeKernelProjectXYZ<E>::gather(int chunk, Lanes* R, Lanes& x, Lanes& y, Lanes& z) const {
+  Lanes qx, qy, qz, qw, tx, ty, tz, px, py, pz;
+  for (int l = 0; l < Base::LaneWidth; ++l) {
+    const int k = this->laneEdge(chunk, l);
+    const SE3Quat& T = this->_vertexXj[k]->estimate();
+    const Vector3& p = this->_vertexXi[k]->estimate();
+    qx[l] = T.rotation().x();
+    qy[l] = T.rotation().y();
+    qz[l] = T.rotation().z();
+    qw[l] = T.rotation().w();
+    tx[l] = T.translation().x();
+    ty[l] = T.translation().y();
+    tz[l] = T.translation().z();
+    px[l] = p.x();
+    py[l] = p.y();
+    pz[l] = p.z();
+  }
+  // column major rotation matrix of the unit quaternion
+  R[0] = 1 - 2 * (qy * qy + qz * qz);
+  R[1] = 2 * (qx * qy + qz * qw);
+  R[2] = 2 * (qx * qz - qy * qw);
+  R[3] = 2 * (qx * qy - qz * qw);
+  R[4] = 1 - 2 * (qx * qx + qz * qz);
+  R[5] = 2 * (qy * qz + qx * qw);
+  R[6] = 2 * (qx * qz + qy * qw);
+  R[7] = 2 * (qy * qz - qx * qw);
+  R[8] = 1 - 2 * (qx * qx + qy * qy);
+  x = R[0] * px + R[3] * py + R[6] * pz + tx;
+  y = R[1] * px + R[4] * py + R[7] * pz + ty;
+  z = R[2] * px + R[5] * py + R[8] * pz + tz;
+}
+
+template <typename E>
+void BaseBatchEdgeKernelProjectXYZ<E>::computeErrors() {
+# ifdef G2O_OPENMP
+# pragma omp parallel for default (shared) if (this->numChunks() > 50)
+# endif
+  for (int chunk = 0; chunk < this->numChunks(); ++chunk) {
+    Lanes R[9], x, y, z, u, v, fx, fy, cx, cy;
+    gather(chunk, R, x, y, z);
+    gatherCamera(chunk, u, v, fx, fy, cx, cy);
+    const Lanes eu = u - (fx * x / z + cx);
+    const Lanes ev = v - (fy * y / z + cy);
+    for (int l = 0; l < this->validLanes(chunk); ++l) {
+      Vector2& error = this->edge(chunk * Base::LaneWidth + l)->error();
+      error[0] = eu[l];
+      error[1] = ev[l];
+    }
+  }
+}
+
+template <typename E>
+void BaseBatchEdgeKernelProjectXYZ<E>::linearizeOplus() {
+# ifdef G2O_OPENMP
+# pragma omp parallel for default (shared) if (this->numChunks() > 50)
+# endif
+  for (int chunk = 0; chunk < this->numChunks(); ++chunk) {
+    Lanes R[9], x, y, z, u, v, fx, fy, cx, cy;
+    gather(chunk, R, x, y, z);
+    gatherCamera(chunk, u, v, fx, fy, cx, cy);
+    const Lanes iz = z.inverse();
+    const Lanes xz = x * iz;
+    const Lanes yz = y * iz;
+    const Lanes fxz = fx * iz;
+    const Lanes fyz = fy * iz;
+
+    // point, -1/z * [fx 0 -x/z*fx; 0 fy -y/z*fy] * R
+    Lanes ji[6];
+    for (int c = 0; c < 3; ++c) {
+      ji[2 * c] = -fxz * (R[3 * c] - xz * R[3 * c + 2]);
+      ji[2 * c + 1] = -fyz * (R[3 * c + 1] - yz * R[3 * c + 2]);
+    }
+    // pose, column major
+    Lanes jj[12];
+    jj[0] = xz * yz * fx;
+    jj[1] = (1 + yz * yz) * fy;
+    jj[2] = -(1 + xz * xz) * fx;
+    jj[3] = -xz * yz * fy;
+    jj[4] = yz * fx;
+    jj[5] = -xz * fy;
+    jj[6] = -fxz;
+    jj[7] = Lanes::Zero();
+    jj[8] = Lanes::Zero();
+    jj[9] = -fyz;
+    jj[10] = xz * fxz;
+    jj[11] = yz * fyz;
+
+    for (int l = 0; l < this->validLanes(chunk); ++l) {
+      const int k = chunk * Base::LaneWidth + l;
+      number_t* jacobianXi = this->jacobianXi(k);
+      number_t* jacobianXj = this->jacobianXj(k);
+      for (int i = 0; i < 6; ++i)
+        jacobianXi[i] = ji[i][l];
+      for (int i = 0; i < 12; ++i)
+        jacobianXj[i] = jj[i][l];
+      this->mapJacobians(k);
+    }
+  }
+}
+
+template class BaseBatchEdgeKernelProjectXYZ<EdgeSE3ProjectXYZ>;
+template class BaseBatchEdgeKernelProjectXYZ<EdgeProjectXYZ2UV>;
+
+} // end namespace
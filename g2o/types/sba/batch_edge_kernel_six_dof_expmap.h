@@ -0,0 +1,71 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 H. Strasdat
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_BATCH_EDGE_KERNEL_SIX_DOF_EXPMAP_H
+#define G2O_BATCH_EDGE_KERNEL_SIX_DOF_EXPMAP_H
+
+#include "g2o/core/batch_edge_kernel.h"
+#include "types_six_dof_expmap.h"
+#include "g2o_types_sba_api.h"
+
+namespace g2o {
+
+/**
+ * \brief evaluates the projection of points into a pinhole camera in chunks,
+ * see BatchEdgeKernel. The measurements and the intrinsics are gathered from
+ * the edges in each call, the latter by the overloads of cameraIntrinsics().
+ */
+template <typename E>
+class BaseBatchEdgeKernelProjectXYZ : public BaseBatchEdgeKernel<E> {
+ public:
+  typedef BaseBatchEdgeKernel<E> Base;
+  typedef typename Base::Lanes Lanes;
+
+  virtual void computeErrors();
+  virtual void linearizeOplus();
+
+ protected:
+  //! the rotation of the camera and the point in the camera frame for the chunk
+  void gather(int chunk, Lanes* R, Lanes& x, Lanes& y, Lanes& z) const;
+  //! the measurements and the intrinsics of the edges of the chunk
+  void gatherCamera(int chunk, Lanes& u, Lanes& v, Lanes& fx, Lanes& fy, Lanes& cx, Lanes& cy) const;
+};
+
+/**
+ * \brief batch kernel for EdgeSE3ProjectXYZ
+ */
+class G2O_TYPES_SBA_API BatchEdgeKernelSE3ProjectXYZ : public BaseBatchEdgeKernelProjectXYZ<EdgeSE3ProjectXYZ> {
+};
+
+/**
+ * \brief batch kernel for EdgeProjectXYZ2UV, the intrinsics are taken from the CameraParameters
+ */
+class G2O_TYPES_SBA_API BatchEdgeKernelProjectXYZ2UV : public BaseBatchEdgeKernelProjectXYZ<EdgeProjectXYZ2UV> {
+};
+
+} // end namespace
+
+#endif
@@ -0,0 +1,154 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+
+#include "g2o/core/optimizable_graph.h"
+#include "batch_edge_kernel_six_dof_expmap.h"
+
+using namespace std;
+using namespace g2o;
+
+#define CHECK(cond) \
+  if (! (cond)) { \
+    cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << endl; \
+    return 1; \
+  }
+
+/**
+ * evaluate the edges by the kernel and compare the errors and the Jacobians
+ * to the ones computed by the edges
+ */
+template <typename EdgeType>
+static int compareToEdges(BatchEdgeKernel& kernel, const std::vector<EdgeType*>& edges)
+{
+  kernel.computeErrors();
+  kernel.linearizeOplus();
+  for (size_t k = 0; k < edges.size(); ++k) {
+    EdgeType* e = edges[k];
+    Vector2 error = e->error();
+    typename EdgeType::JacobianXiOplusType Ji = e->jacobianOplusXi();
+    typename EdgeType::JacobianXjOplusType Jj = e->jacobianOplusXj();
+    CHECK(e->jacobianOplusXi().data() == kernel.jacobianData(k, 0));
+    CHECK(e->jacobianOplusXj().data() == kernel.jacobianData(k, 1));
+    e->computeError();
+    e->linearizeOplus();
+    CHECK((error - e->error()).norm() < 1e-9 * (1 + error.norm()));
+    CHECK((Ji - e->jacobianOplusXi()).norm() < 1e-9 * (1 + Ji.norm()));
+    CHECK((Jj - e->jacobianOplusXj()).norm() < 1e-9 * (1 + Jj.norm()));
+  }
+  return 0;
+}
+
+//! points in front of a few cameras, each point observed by one edge
+template <typename EdgeType>
+static void createGraph(OptimizableGraph& graph, std::vector<EdgeType*>& edges, std::vector<OptimizableGraph::Edge*>& kernelEdges)
+{
+  const int numCameras = 3;
+  for (int i = 0; i < numCameras; ++i) {
+    VertexSE3Expmap* v = new VertexSE3Expmap;
+    v->setId(i);
+    v->setEstimate(SE3Quat(Quaternion(AngleAxis(0.1 * i, Vector3::UnitY())), Vector3(i, 0, 0)));
+    graph.addVertex(v);
+  }
+  const int numEdges = 4 * BatchEdgeKernel::LaneWidth + 3;
+  for (int k = 0; k < numEdges; ++k) {
+    VertexSBAPointXYZ* p = new VertexSBAPointXYZ;
+    p->setId(numCameras + k);
+    p->setEstimate(Vector3::Random() + Vector3(0, 0, 5));
+    graph.addVertex(p);
+    EdgeType* e = new EdgeType;
+    e->setVertex(0, p);
+    e->setVertex(1, graph.vertex(k % numCameras));
+    e->setMeasurement(Vector2::Random() * 100);
+    e->setInformation(Matrix2::Identity());
+    edges.push_back(e);
+    kernelEdges.push_back(e);
+  }
+}
+
+static int testSE3ProjectXYZ()
+{
+  OptimizableGraph graph;
+  std::vector<EdgeSE3ProjectXYZ*> edges;
+  std::vector<OptimizableGraph::Edge*> kernelEdges;
+  createGraph(graph, edges, kernelEdges);
+  for (size_t k = 0; k < edges.size(); ++k) {
+    edges[k]->fx = 500 + k;
+    edges[k]->fy = 510 + k;
+    edges[k]->cx = 320;
+    edges[k]->cy = 240;
+    graph.addEdge(edges[k]);
+  }
+
+  BatchEdgeKernelSE3ProjectXYZ kernel;
+  kernel.setEdges(kernelEdges);
+  if (compareToEdges(kernel, edges))
+    return 1;
+
+  // the kernel follows the changes of the measurements and the intrinsics
+  for (size_t k = 0; k < edges.size(); ++k) {
+    edges[k]->setMeasurement(Vector2::Random() * 100);
+    edges[k]->fx = 400 - k;
+    edges[k]->cy = 200;
+  }
+  return compareToEdges(kernel, edges);
+}
+
+static int testProjectXYZ2UV()
+{
+  OptimizableGraph graph;
+  CameraParameters* cam = new CameraParameters(500, Vector2(320, 240), 0);
+  cam->setId(0);
+  graph.addParameter(cam);
+  std::vector<EdgeProjectXYZ2UV*> edges;
+  std::vector<OptimizableGraph::Edge*> kernelEdges;
+  createGraph(graph, edges, kernelEdges);
+  for (size_t k = 0; k < edges.size(); ++k) {
+    edges[k]->setParameterId(0, 0);
+    graph.addEdge(edges[k]);
+  }
+
+  BatchEdgeKernelProjectXYZ2UV kernel;
+  kernel.setEdges(kernelEdges);
+  if (compareToEdges(kernel, edges))
+    return 1;
+
+  // the kernel follows the changes of the camera
+  cam->focal_length = 300;
+  cam->principle_point = Vector2(100, 50);
+  return compareToEdges(kernel, edges);
+}
+
+int main()
+{
+  srand(42);
+  if (testSE3ProjectXYZ())
+    return 1;
+  if (testProjectXYZ2UV())
+    return 1;
+  cerr << "OK" << endl;
+  return 0;
+}
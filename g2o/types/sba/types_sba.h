@@ -28,6 +28,7 @@
 #define G2O_SBA_TYPES
 
 #include "g2o/core/base_vertex.h"
+#include "g2o/core/auto_differentiation_traits.h"
 #include "g2o/core/base_binary_edge.h"
 #include "g2o/core/base_multi_edge.h"
 #include "sbacam.h"
@@ -151,8 +152,30 @@ class G2O_TYPES_SBA_API VertexIntrinsics : public BaseVertex<4, Eigen::Matrix<nu
       Eigen::Map<const Vector3> v(update);
       _estimate += v;
     }
+
+    virtual bool setEstimateDataImpl(const number_t* est){
+      _estimate = Eigen::Map<const Vector3>(est);
+      return true;
+    }
+
+    virtual bool getEstimateData(number_t* est) const{
+      Eigen::Map<Vector3> v(est);
+      v = _estimate;
+      return true;
+    }
+
+    virtual int estimateDimension() const {
+      return 3;
+    }
+
+    virtual bool localDifference(const number_t* est, number_t* delta) const {
+      Eigen::Map<Vector3> d(delta);
+      d = _estimate - Eigen::Map<const Vector3>(est);
+      return true;
+    }
 };
 
+ template <> struct AutoDiffOplusIsAddition<VertexSBAPointXYZ> { static const bool value = true; };
 
 // monocular projection
 // first two args are the measurement type, second two the connection classes
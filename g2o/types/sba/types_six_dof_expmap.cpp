@@ -25,6 +25,7 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "types_six_dof_expmap.h"
+#include "batch_edge_kernel_six_dof_expmap.h"
 
 #include "g2o/core/factory.h"
 #include "g2o/stuff/macros.h"
@@ -49,6 +50,9 @@ G2O_REGISTER_TYPE(EDGE_STEREO_SE3_PROJECT_XYZ:EXPMAP, EdgeStereoSE3ProjectXYZ);
 G2O_REGISTER_TYPE(EDGE_STEREO_SE3_PROJECT_XYZONLYPOSE:EXPMAP, EdgeStereoSE3ProjectXYZOnlyPose);
 G2O_REGISTER_TYPE(PARAMS_CAMERAPARAMETERS, CameraParameters);
 
+G2O_REGISTER_BATCH_EDGE_KERNEL(EdgeProjectXYZ2UV, BatchEdgeKernelProjectXYZ2UV);
+G2O_REGISTER_BATCH_EDGE_KERNEL(EdgeSE3ProjectXYZ, BatchEdgeKernelSE3ProjectXYZ);
+
 G2O_REGISTER_ACTION(VertexSE3ExpmapWriteGnuplotAction);
 G2O_REGISTER_ACTION(EdgeSE3ExpmapWriteGnuplotAction);
 #ifdef G2O_HAVE_OPENGL
@@ -100,6 +100,31 @@ public:
     Eigen::Map<const Vector6> update(update_);
     setEstimate(SE3Quat::exp(update)*estimate());
   }
+
+  virtual bool setEstimateDataImpl(const number_t* est){
+    Eigen::Map<const Vector7> v(est);
+    _estimate.fromVector(v);
+    return true;
+  }
+
+  virtual bool getEstimateData(number_t* est) const{
+    Eigen::Map<Vector7> v(est);
+    v = _estimate.toVector();
+    return true;
+  }
+
+  virtual int estimateDimension() const {
+    return 7;
+  }
+
+  //! the inverse of oplusImpl(), i.e., the increment applied from the left
+  virtual bool localDifference(const number_t* est, number_t* delta) const {
+    SE3Quat x0;
+    x0.fromVector(Eigen::Map<const Vector7>(est));
+    Eigen::Map<Vector6> d(delta);
+    d = (_estimate * x0.inverse()).log();
+    return true;
+  }
 };
 
 /**
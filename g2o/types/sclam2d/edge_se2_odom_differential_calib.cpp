@@ -26,6 +26,8 @@
 
 #include "edge_se2_odom_differential_calib.h"
 
+#include "g2o/types/slam2d/se2_gradients.h"
+
 #ifdef G2O_HAVE_OPENGL
 #include "g2o/stuff/opengl_wrapper.h"
 #endif
@@ -62,6 +64,42 @@ namespace g2o {
     return os.good();
   }
 
+#ifndef NUMERIC_JACOBIAN_TWO_D_TYPES
+  void EdgeSE2OdomDifferentialCalib::linearizeOplus()
+  {
+    const VertexSE2* v1                        = static_cast<const VertexSE2*>(_vertices[0]);
+    const VertexSE2* v2                        = static_cast<const VertexSE2*>(_vertices[1]);
+    const VertexOdomDifferentialParams* params = static_cast<const VertexOdomDifferentialParams*>(_vertices[2]);
+    const SE2& x1                              = v1->estimate();
+    const SE2& x2                              = v2->estimate();
+
+    VelocityMeasurement calibratedVelocityMeasurment(measurement().vl() * params->estimate()(0),
+        measurement().vr() * params->estimate()(1),
+        measurement().dt());
+    MotionMeasurement mm = OdomConvert::convertToMotion(calibratedVelocityMeasurment, params->estimate()(2));
+    SE2 Ku_ij;
+    Ku_ij.fromVector(mm.measurement());
+    SE2 invKu_ij = Ku_ij.inverse();
+    SE2 invX1 = x1.inverse();
+    SE2 motion = invX1 * x2;
+
+    // delta = Ku_ij^-1 * (x1^-1 * x2)
+    Matrix3 dInvKu, dMotion, dInvX1, dX2, dKu, dX1;
+    internal::computeSE2CompositionGradient(dInvKu, dMotion, invKu_ij, motion);
+    internal::computeSE2CompositionGradient(dInvX1, dX2, invX1, x2);
+    internal::computeSE2InverseGradient(dKu, Ku_ij);
+    internal::computeSE2InverseGradient(dX1, x1);
+
+    Matrix3 dParams = OdomConvert::convertToMotionJacobian(calibratedVelocityMeasurment, params->estimate()(2));
+    dParams.col(0) *= measurement().vl();
+    dParams.col(1) *= measurement().vr();
+
+    _jacobianOplus[0] = dMotion * dInvX1 * dX1;
+    _jacobianOplus[1] = dMotion * dX2;
+    _jacobianOplus[2] = dInvKu * dKu * dParams;
+  }
+#endif
+
 #ifdef G2O_HAVE_OPENGL
   EdgeSE2OdomDifferentialCalibDrawAction::EdgeSE2OdomDifferentialCalibDrawAction() :
     DrawAction(typeid(EdgeSE2OdomDifferentialCalib).name())
@@ -25,6 +25,8 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "edge_se2_sensor_calib.h"
+
+#include "g2o/types/slam2d/se2_gradients.h"
 #ifdef G2O_HAVE_OPENGL
 #include "g2o/stuff/opengl_wrapper.h"
 #endif
@@ -76,6 +78,37 @@ namespace g2o {
     return os.good();
   }
 
+#ifndef NUMERIC_JACOBIAN_TWO_D_TYPES
+  void EdgeSE2SensorCalib::linearizeOplus()
+  {
+    const VertexSE2* v1          = static_cast<const VertexSE2*>(_vertices[0]);
+    const VertexSE2* v2          = static_cast<const VertexSE2*>(_vertices[1]);
+    const VertexSE2* laserOffset = static_cast<const VertexSE2*>(_vertices[2]);
+    const SE2& x1 = v1->estimate();
+    const SE2& x2 = v2->estimate();
+    const SE2& offset = laserOffset->estimate();
+    SE2 laser1 = x1 * offset;
+    SE2 laser2 = x2 * offset;
+    SE2 invLaser1 = laser1.inverse();
+    SE2 laserMotion = invLaser1 * laser2;
+
+    // delta = Z^-1 * (laser1^-1 * laser2) with laser_i = x_i * offset
+    Matrix3 dMeasurement, dLaserMotion, dInvLaser1, dLaser2, dLaser1;
+    internal::computeSE2CompositionGradient(dMeasurement, dLaserMotion, _inverseMeasurement, laserMotion);
+    internal::computeSE2CompositionGradient(dInvLaser1, dLaser2, invLaser1, laser2);
+    internal::computeSE2InverseGradient(dLaser1, laser1);
+    Matrix3 dX1, dOffset1, dX2, dOffset2;
+    internal::computeSE2CompositionGradient(dX1, dOffset1, x1, offset);
+    internal::computeSE2CompositionGradient(dX2, dOffset2, x2, offset);
+
+    Matrix3 d1 = dLaserMotion * dInvLaser1 * dLaser1;
+    Matrix3 d2 = dLaserMotion * dLaser2;
+    _jacobianOplus[0] = d1 * dX1;
+    _jacobianOplus[1] = d2 * dX2;
+    _jacobianOplus[2] = d1 * dOffset1 + d2 * dOffset2;
+  }
+#endif
+
 #ifdef G2O_HAVE_OPENGL
   EdgeSE2SensorCalibDrawAction::EdgeSE2SensorCalibDrawAction() : 
     DrawAction(typeid(EdgeSE2SensorCalib).name())
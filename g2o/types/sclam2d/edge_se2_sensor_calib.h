@@ -68,6 +68,10 @@ namespace g2o {
       }
       virtual void initialEstimate(const OptimizableGraph::VertexSet& from, OptimizableGraph::Vertex* to);
 
+#ifndef NUMERIC_JACOBIAN_TWO_D_TYPES
+      virtual void linearizeOplus();
+#endif
+
       virtual bool read(std::istream& is);
       virtual bool write(std::ostream& os) const;
 
@@ -116,4 +116,30 @@ namespace g2o {
 
   }
 
+  Matrix3 OdomConvert::convertToMotionJacobian(const VelocityMeasurement& v, number_t l)
+  {
+    Matrix3 J;
+    number_t sum = v.vl() + v.vr();
+    number_t diff = v.vr() - v.vl();
+    number_t dt = v.dt();
+    if (fabs(diff) > 1e-7) {
+      number_t R = l * 0.5 * (sum / diff);
+      number_t theta = diff / l * dt;
+      number_t s = std::sin(theta);
+      number_t c = std::cos(theta);
+      // x = R sin(theta), y = R (1 - cos(theta))
+      Vector3 dR(l * v.vr() / (diff * diff), -l * v.vl() / (diff * diff), 0.5 * sum / diff);
+      Vector3 dTheta(-dt / l, dt / l, -theta / l);
+      J.row(0) = s * dR.transpose() + R * c * dTheta.transpose();
+      J.row(1) = (1. - c) * dR.transpose() + R * s * dTheta.transpose();
+      J.row(2) = dTheta.transpose();
+    } else {
+      number_t dy = 0.25 * sum * dt * dt / l;
+      J << 0.5 * dt, 0.5 * dt, 0.,
+           -dy, dy, 0.,
+           -dt / l, dt / l, 0.;
+    }
+    return J;
+  }
+
 } // end namespace
@@ -96,6 +96,12 @@ namespace g2o {
     public:
       static VelocityMeasurement convertToVelocity(const MotionMeasurement& m);
       static MotionMeasurement convertToMotion(const VelocityMeasurement& vi, number_t l = 1.0);
+      /**
+       * Jacobian of convertToMotion(), i.e., the derivative of (x, y,
+       * theta) w.r.t. (vl, vr, l). For a straight motion the limit of
+       * the derivative of the curved motion is returned.
+       */
+      static Matrix3 convertToMotionJacobian(const VelocityMeasurement& vi, number_t l = 1.0);
   };
 
 } // end namespace
@@ -202,47 +202,76 @@ bool EdgeInverseSim3ProjectXYZ::write(std::ostream &os) const {
   return os.good();
 }
 
-//  void EdgeSim3ProjectXYZ::linearizeOplus()
-//  {
-//    VertexSim3Expmap * vj = static_cast<VertexSim3Expmap *>(_vertices[1]);
-//    Sim3 T = vj->estimate();
-
-//    VertexPointXYZ* vi = static_cast<VertexPointXYZ*>(_vertices[0]);
-//    Vector3 xyz = vi->estimate();
-//    Vector3 xyz_trans = T.map(xyz);
-
-//    number_t x = xyz_trans[0];
-//    number_t y = xyz_trans[1];
-//    number_t z = xyz_trans[2];
-//    number_t z_2 = z*z;
-
-//    Matrix<number_t,2,3,Eigen::ColMajor> tmp;
-//    tmp(0,0) = _focal_length(0);
-//    tmp(0,1) = 0;
-//    tmp(0,2) = -x/z*_focal_length(0);
-
-//    tmp(1,0) = 0;
-//    tmp(1,1) = _focal_length(1);
-//    tmp(1,2) = -y/z*_focal_length(1);
-
-//    _jacobianOplusXi =  -1./z * tmp * T.rotation().toRotationMatrix();
-
-//    _jacobianOplusXj(0,0) =  x*y/z_2 * _focal_length(0);
-//    _jacobianOplusXj(0,1) = -(1+(x*x/z_2)) *_focal_length(0);
-//    _jacobianOplusXj(0,2) = y/z *_focal_length(0);
-//    _jacobianOplusXj(0,3) = -1./z *_focal_length(0);
-//    _jacobianOplusXj(0,4) = 0;
-//    _jacobianOplusXj(0,5) = x/z_2 *_focal_length(0);
-//    _jacobianOplusXj(0,6) = 0; // scale is ignored
-
-
-//    _jacobianOplusXj(1,0) = (1+y*y/z_2) *_focal_length(1);
-//    _jacobianOplusXj(1,1) = -x*y/z_2 *_focal_length(1);
-//    _jacobianOplusXj(1,2) = -x/z *_focal_length(1);
-//    _jacobianOplusXj(1,3) = 0;
-//    _jacobianOplusXj(1,4) = -1./z *_focal_length(1);
-//    _jacobianOplusXj(1,5) = y/z_2 *_focal_length(1);
-//    _jacobianOplusXj(1,6) = 0; // scale is ignored
-//  }
+void EdgeSim3ProjectXYZ::linearizeOplus()
+{
+  const VertexSim3Expmap* vj = static_cast<const VertexSim3Expmap*>(_vertices[1]);
+  const VertexSBAPointXYZ* vi = static_cast<const VertexSBAPointXYZ*>(_vertices[0]);
+  const Sim3& T = vj->estimate();
+  const Vector3 xyz_trans = T.map(vi->estimate());
+
+  number_t x = xyz_trans[0];
+  number_t y = xyz_trans[1];
+  number_t z = xyz_trans[2];
+  number_t invz = 1. / z;
+
+  // derivative of the projection, the error is obs - proj
+  Eigen::Matrix<number_t, 2, 3, Eigen::ColMajor> tmp;
+  tmp(0,0) = vj->_focal_length1[0] * invz;
+  tmp(0,1) = 0;
+  tmp(0,2) = -x * invz * invz * vj->_focal_length1[0];
+  tmp(1,0) = 0;
+  tmp(1,1) = vj->_focal_length1[1] * invz;
+  tmp(1,2) = -y * invz * invz * vj->_focal_length1[1];
+
+  _jacobianOplusXi = -tmp * (T.scale() * T.rotation().toRotationMatrix());
+
+  // the update is applied from the left, hence the transformed point
+  // moves by omega x p + upsilon + sigma * p
+  Eigen::Matrix<number_t, 3, 7, Eigen::ColMajor> dp;
+  dp.block<3,3>(0,0) = -skew(xyz_trans);
+  dp.block<3,3>(0,3).setIdentity();
+  if (vj->_fix_scale)
+    dp.col(6).setZero();
+  else
+    dp.col(6) = xyz_trans;
+  _jacobianOplusXj = -tmp * dp;
+}
+
+void EdgeInverseSim3ProjectXYZ::linearizeOplus()
+{
+  const VertexSim3Expmap* vj = static_cast<const VertexSim3Expmap*>(_vertices[1]);
+  const VertexSBAPointXYZ* vi = static_cast<const VertexSBAPointXYZ*>(_vertices[0]);
+  const Sim3& T = vj->estimate();
+  const Vector3& xyz = vi->estimate();
+  const Vector3 xyz_trans = T.inverse().map(xyz);
+
+  number_t x = xyz_trans[0];
+  number_t y = xyz_trans[1];
+  number_t z = xyz_trans[2];
+  number_t invz = 1. / z;
+
+  Eigen::Matrix<number_t, 2, 3, Eigen::ColMajor> tmp;
+  tmp(0,0) = vj->_focal_length2[0] * invz;
+  tmp(0,1) = 0;
+  tmp(0,2) = -x * invz * invz * vj->_focal_length2[0];
+  tmp(1,0) = 0;
+  tmp(1,1) = vj->_focal_length2[1] * invz;
+  tmp(1,2) = -y * invz * invz * vj->_focal_length2[1];
+
+  // linear part of the inverse transformation
+  const Matrix3 invSR = (1. / T.scale()) * T.rotation().toRotationMatrix().transpose();
+  Eigen::Matrix<number_t, 2, 3, Eigen::ColMajor> tmpInvSR = tmp * invSR;
+  _jacobianOplusXi = -tmpInvSR;
+
+  // S^-1 * exp(-delta) * xyz
+  Eigen::Matrix<number_t, 3, 7, Eigen::ColMajor> dp;
+  dp.block<3,3>(0,0) = skew(xyz);
+  dp.block<3,3>(0,3) = -Matrix3::Identity();
+  if (vj->_fix_scale)
+    dp.col(6).setZero();
+  else
+    dp.col(6) = -xyz;
+  _jacobianOplusXj = -tmpInvSR * dp;
+}
 
 } // end namespace
@@ -155,7 +155,7 @@ class G2O_TYPES_SIM3_API EdgeSim3ProjectXYZ : public  BaseBinaryEdge<2, Vector2,
       _error = obs-v1->cam_map1(project(v1->estimate().map(v2->estimate())));
     }
 
-   // virtual void linearizeOplus();
+    virtual void linearizeOplus();
 
 };
 
@@ -175,7 +175,7 @@ class G2O_TYPES_SIM3_API EdgeInverseSim3ProjectXYZ : public BaseBinaryEdge<2, Ve
     _error = obs - v1->cam_map2(project(v1->estimate().inverse().map(v2->estimate())));
   }
 
-  // virtual void linearizeOplus();
+  virtual void linearizeOplus();
 
 };
 
@@ -0,0 +1,120 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "batch_edge_kernel_se2.h"
+
+#include "g2o/stuff/misc.h"
+
+namespace g2o {
+
+  namespace {
+    //! normalize the angles to [-pi, pi)
+    inline BatchEdgeKernel::Lanes normalizeTheta(const BatchEdgeKernel::Lanes& theta)
+    {
+      const number_t twoPi = 2 * const_pi();
+      return theta - twoPi * ((theta + const_pi()) / twoPi).floor();
+    }
+  }
+
+  void BatchEdgeKernelSE2::gather(int chunk, Lanes& ci, Lanes& si, Lanes& lx, Lanes& ly, Lanes& theta,
+      Lanes& txm, Lanes& tym, Lanes& thetam) const
+  {
+    Lanes thetai, dx, dy;
+    for (int l = 0; l < LaneWidth; ++l) {
+      const int k = laneEdge(chunk, l);
+      const SE2& xi = _vertexXi[k]->estimate();
+      const SE2& xj = _vertexXj[k]->estimate();
+      const SE2& inverseMeasurement = edge(k)->inverseMeasurement();
+      txm[l] = inverseMeasurement.translation().x();
+      tym[l] = inverseMeasurement.translation().y();
+      thetam[l] = inverseMeasurement.rotation().angle();
+      thetai[l] = xi.rotation().angle();
+      theta[l] = xj.rotation().angle();
+      dx[l] = xj.translation().x() - xi.translation().x();
+      dy[l] = xj.translation().y() - xi.translation().y();
+    }
+    ci = thetai.cos();
+    si = thetai.sin();
+    lx = ci * dx + si * dy;
+    ly = ci * dy - si * dx;
+    theta -= thetai;
+  }
+
+  void BatchEdgeKernelSE2::computeErrors()
+  {
+#   ifdef G2O_OPENMP
+#   pragma omp parallel for default (shared) if (numChunks() > 50)
+#   endif
+    for (int chunk = 0; chunk < numChunks(); ++chunk) {
+      Lanes ci, si, lx, ly, theta, txm, tym, thetam;
+      gather(chunk, ci, si, lx, ly, theta, txm, tym, thetam);
+      const Lanes cm = thetam.cos();
+      const Lanes sm = thetam.sin();
+      const Lanes ex = txm + cm * lx - sm * ly;
+      const Lanes ey = tym + sm * lx + cm * ly;
+      const Lanes et = normalizeTheta(thetam + normalizeTheta(theta));
+      for (int l = 0; l < validLanes(chunk); ++l) {
+        Vector3& error = edge(chunk * LaneWidth + l)->error();
+        error[0] = ex[l];
+        error[1] = ey[l];
+        error[2] = et[l];
+      }
+    }
+  }
+
+  void BatchEdgeKernelSE2::linearizeOplus()
+  {
+#   ifdef G2O_OPENMP
+#   pragma omp parallel for default (shared) if (numChunks() > 50)
+#   endif
+    for (int chunk = 0; chunk < numChunks(); ++chunk) {
+      Lanes ci, si, lx, ly, theta, txm, tym, thetam;
+      gather(chunk, ci, si, lx, ly, theta, txm, tym, thetam);
+      const Lanes cm = thetam.cos();
+      const Lanes sm = thetam.sin();
+      // the rotational part of Jj is R_m R_i^T, the one of Ji its negative
+      const Lanes a00 = cm * ci + sm * si;
+      const Lanes a01 = cm * si - sm * ci;
+      const Lanes a10 = sm * ci - cm * si;
+      const Lanes a11 = sm * si + cm * ci;
+      const Lanes b0 = cm * ly + sm * lx;
+      const Lanes b1 = sm * ly - cm * lx;
+      for (int l = 0; l < validLanes(chunk); ++l) {
+        const int k = chunk * LaneWidth + l;
+        number_t* ji = jacobianXi(k);
+        number_t* jj = jacobianXj(k);
+        ji[0] = -a00[l]; ji[3] = -a01[l]; ji[6] = b0[l];
+        ji[1] = -a10[l]; ji[4] = -a11[l]; ji[7] = b1[l];
+        ji[2] = 0;       ji[5] = 0;       ji[8] = -1;
+        jj[0] = a00[l];  jj[3] = a01[l];  jj[6] = 0;
+        jj[1] = a10[l];  jj[4] = a11[l];  jj[7] = 0;
+        jj[2] = 0;       jj[5] = 0;       jj[8] = 1;
+        mapJacobians(k);
+      }
+    }
+  }
+
+} // end namespace
@@ -74,6 +74,11 @@ namespace g2o {
 
       virtual int measurementDimension() const {return 3;}
 
+      virtual bool plainDataFormat() const { return true;}
+
+      //! the inverse of the measurement, kept up to date by setMeasurement()
+      const SE2& inverseMeasurement() const { return _inverseMeasurement;}
+
       virtual bool setMeasurementFromState() {
         const VertexSE2* v1 = static_cast<const VertexSE2*>(_vertices[0]);
         const VertexSE2* v2 = static_cast<const VertexSE2*>(_vertices[1]);
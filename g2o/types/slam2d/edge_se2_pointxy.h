@@ -62,6 +62,8 @@ namespace g2o {
       
       virtual int measurementDimension() const {return 2;}
 
+      virtual bool plainDataFormat() const { return true;}
+
       virtual bool setMeasurementFromState(){
         const VertexSE2* v1 = static_cast<const VertexSE2*>(_vertices[0]);
         const VertexPointXY* l2 = static_cast<const VertexPointXY*>(_vertices[1]);
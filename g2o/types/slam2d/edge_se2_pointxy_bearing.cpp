@@ -65,6 +65,29 @@ namespace g2o {
     return os.good();
   }
 
+#ifndef NUMERIC_JACOBIAN_TWO_D_TYPES
+  void EdgeSE2PointXYBearing::linearizeOplus()
+  {
+    const VertexSE2* vi     = static_cast<const VertexSE2*>(_vertices[0]);
+    const VertexPointXY* vj = static_cast<const VertexPointXY*>(_vertices[1]);
+    const Matrix2 Rt = vi->estimate().rotation().toRotationMatrix().transpose();
+    Vector2 delta = Rt * (vj->estimate() - vi->estimate().translation());
+    number_t invDist2 = 1. / delta.squaredNorm();
+
+    // derivative of the bearing w.r.t. the point in the robot frame
+    Eigen::Matrix<number_t, 1, 2> dAngle;
+    dAngle << -delta.y() * invDist2, delta.x() * invDist2;
+    Eigen::Matrix<number_t, 1, 2> dAngleRt = dAngle * Rt;
+
+    // the error is measurement - angle, rotating the robot by theta
+    // decreases the bearing by theta
+    _jacobianOplusXi(0, 0) = dAngleRt(0);
+    _jacobianOplusXi(0, 1) = dAngleRt(1);
+    _jacobianOplusXi(0, 2) = 1.;
+    _jacobianOplusXj = -dAngleRt;
+  }
+#endif
+
 
   EdgeSE2PointXYBearingWriteGnuplotAction::EdgeSE2PointXYBearingWriteGnuplotAction(): WriteGnuplotAction(typeid(EdgeSE2PointXYBearing).name()){}
 
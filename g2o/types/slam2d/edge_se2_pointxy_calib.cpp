@@ -25,6 +25,7 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "edge_se2_pointxy_calib.h"
+#include "se2_gradients.h"
 
 namespace g2o {
 
@@ -60,4 +61,28 @@ namespace g2o {
     return os.good();
   }
 
+#ifndef NUMERIC_JACOBIAN_TWO_D_TYPES
+  void EdgeSE2PointXYCalib::linearizeOplus()
+  {
+    const VertexSE2* v1     = static_cast<const VertexSE2*>(_vertices[0]);
+    const VertexPointXY* l2 = static_cast<const VertexPointXY*>(_vertices[1]);
+    const VertexSE2* calib  = static_cast<const VertexSE2*>(_vertices[2]);
+    const SE2 sensor = v1->estimate() * calib->estimate();
+    const Matrix2 Rt = sensor.rotation().toRotationMatrix().transpose();
+    Vector2 delta = Rt * (l2->estimate() - sensor.translation());
+
+    // derivative of the landmark in the sensor frame w.r.t. the sensor pose
+    Eigen::Matrix<number_t, 2, 3> dSensor;
+    dSensor.leftCols<2>() = -Rt;
+    dSensor(0, 2) =  delta.y();
+    dSensor(1, 2) = -delta.x();
+
+    Matrix3 dPose, dCalib;
+    internal::computeSE2CompositionGradient(dPose, dCalib, v1->estimate(), calib->estimate());
+    _jacobianOplus[0] = dSensor * dPose;
+    _jacobianOplus[1] = Rt;
+    _jacobianOplus[2] = dSensor * dCalib;
+  }
+#endif
+
 } // end namespace
@@ -0,0 +1,69 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_SE2_GRADIENTS_H
+#define G2O_SE2_GRADIENTS_H
+
+#include "se2.h"
+
+namespace g2o {
+  namespace internal {
+
+    /**
+     * Jacobians of the composition C = A * B with respect to A and B.
+     * All the transformations are parameterized by (x, y, theta), i.e.,
+     * the parameterization VertexSE2 applies its increments to.
+     */
+    inline void computeSE2CompositionGradient(Matrix3& dA, Matrix3& dB, const SE2& A, const SE2& B)
+    {
+      const Matrix2 Ra = A.rotation().toRotationMatrix();
+      const Vector2 Rtb = Ra * B.translation();
+      dA.setIdentity();
+      dA(0, 2) = -Rtb.y();
+      dA(1, 2) =  Rtb.x();
+      dB.setIdentity();
+      dB.topLeftCorner<2, 2>() = Ra;
+    }
+
+    /**
+     * Jacobian of the inverse I = A^-1 with respect to A, in the (x, y,
+     * theta) parameterization.
+     */
+    inline void computeSE2InverseGradient(Matrix3& dA, const SE2& A)
+    {
+      const Matrix2 RaT = A.rotation().toRotationMatrix().transpose();
+      const Vector2 ti = -(RaT * A.translation());
+      dA.setZero();
+      dA.topLeftCorner<2, 2>() = -RaT;
+      dA(0, 2) =  ti.y();
+      dA(1, 2) = -ti.x();
+      dA(2, 2) = -1.;
+    }
+
+  } // end namespace internal
+} // end namespace
+
+#endif
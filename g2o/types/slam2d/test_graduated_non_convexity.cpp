@@ -0,0 +1,111 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdlib>
+#include <iostream>
+
+#include "g2o/core/block_solver.h"
+#include "g2o/core/graduated_non_convexity.h"
+#include "g2o/core/optimization_algorithm_gauss_newton.h"
+#include "g2o/core/robust_kernel_impl.h"
+#include "g2o/core/sparse_optimizer.h"
+#include "g2o/solvers/dense/linear_solver_dense.h"
+#include "types_slam2d.h"
+
+using namespace std;
+using namespace g2o;
+
+#define CHECK(cond) \
+  if (! (cond)) { \
+    cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << endl; \
+    return 1; \
+  }
+
+static number_t uniform(number_t lo, number_t hi)
+{
+  return lo + (hi - lo) * rand() / static_cast<number_t>(RAND_MAX);
+}
+
+/**
+ * a point observed by priors, a third of them are gross outliers. Least
+ * squares ends up far away from the point, GNC with the Geman-McClure
+ * kernel recovers it and tells the outliers by their weight.
+ */
+int main()
+{
+  const Vector2 point(1., 2.);
+  const int numMeasurements = 60;
+
+  SparseOptimizer optimizer;
+  std::unique_ptr<BlockSolverX> blockSolver(new BlockSolverX(g2o::make_unique<LinearSolverDense<BlockSolverX::PoseMatrixType>>()));
+  optimizer.setAlgorithm(new OptimizationAlgorithmGaussNewton(std::move(blockSolver)));
+
+  VertexPointXY* v = new VertexPointXY;
+  v->setId(0);
+  v->setEstimate(Vector2(0., 0.));
+  optimizer.addVertex(v);
+
+  srand(17);
+  for (int i = 0; i < numMeasurements; ++i) {
+    EdgeXYPrior* e = new EdgeXYPrior;
+    e->setVertex(0, v);
+    if (i % 3 == 0)
+      e->setMeasurement(Vector2(uniform(10., 50.), uniform(-50., -10.)));
+    else
+      e->setMeasurement(point + Vector2(uniform(-0.1, 0.1), uniform(-0.1, 0.1)));
+    e->setInformation(Matrix2::Identity() * 100.);
+    optimizer.addEdge(e);
+  }
+
+  // least squares is dragged towards the outliers
+  optimizer.initializeOptimization();
+  optimizer.optimize(5);
+  CHECK((v->estimate() - point).norm() > 5.);
+
+  for (HyperGraph::EdgeSet::iterator it = optimizer.edges().begin(); it != optimizer.edges().end(); ++it) {
+    RobustKernelGemanMcClure* kernel = new RobustKernelGemanMcClure;
+    kernel->setDelta(10.);
+    static_cast<OptimizableGraph::Edge*>(*it)->setRobustKernel(kernel);
+  }
+  optimizer.initializeOptimization();
+
+  GraduatedNonConvexity gnc(&optimizer);
+  CHECK(gnc.optimize() > 0);
+  CHECK(gnc.stages() > 1);
+  CHECK((v->estimate() - point).norm() < 0.05);
+
+  CHECK(gnc.robustEdges().size() == (size_t) numMeasurements);
+  CHECK(gnc.weights().size() == (size_t) numMeasurements);
+  for (size_t i = 0; i < gnc.robustEdges().size(); ++i) {
+    const EdgeXYPrior* e = static_cast<const EdgeXYPrior*>(gnc.robustEdges()[i]);
+    CHECK(e->robustKernel()->delta() == 10.);
+    bool isOutlier = (e->measurement() - point).norm() > 1.;
+    CHECK(isOutlier ? gnc.weights()[i] < 0.01 : gnc.weights()[i] > 0.5);
+  }
+
+  cerr << "OK" << endl;
+  return 0;
+}
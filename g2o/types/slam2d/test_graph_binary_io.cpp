@@ -0,0 +1,159 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+
+#include <sstream>
+
+#include "g2o/core/graph_binary_io.h"
+#include "g2o/core/optimizable_graph.h"
+#include "types_slam2d.h"
+
+using namespace std;
+using namespace g2o;
+
+#define CHECK(cond) \
+  if (! (cond)) { \
+    cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << endl; \
+    return 1; \
+  }
+
+static Matrix3 randomInformation()
+{
+  Matrix3 A = Matrix3::Random();
+  return A * A.transpose() + Matrix3::Identity();
+}
+
+int main()
+{
+  srand(42);
+  OptimizableGraph graph;
+  const int numPoses = 10;
+  for (int i = 0; i < numPoses; ++i) {
+    VertexSE2* v = new VertexSE2;
+    v->setId(i);
+    Vector3 p = Vector3::Random();
+    v->setEstimate(SE2(p[0], p[1], p[2]));
+    v->setFixed(i == 0);
+    graph.addVertex(v);
+  }
+  VertexPointXY* l = new VertexPointXY;
+  l->setId(numPoses);
+  l->setEstimate(Vector2(1., 2.));
+  graph.addVertex(l);
+  for (int i = 1; i < numPoses; ++i) {
+    EdgeSE2* e = new EdgeSE2;
+    e->setVertex(0, graph.vertex(i - 1));
+    e->setVertex(1, graph.vertex(i));
+    Vector3 m = Vector3::Random();
+    e->setMeasurement(SE2(m[0], m[1], m[2]));
+    e->setInformation(randomInformation());
+    graph.addEdge(e);
+  }
+  EdgeSE2PointXY* lm = new EdgeSE2PointXY;
+  lm->setVertex(0, graph.vertex(1));
+  lm->setVertex(1, l);
+  lm->setMeasurement(Vector2(0.5, -0.5));
+  graph.addEdge(lm);
+  // not opted in to the plain data format, written as text
+  EdgeSE2Prior* prior = new EdgeSE2Prior;
+  prior->setVertex(0, graph.vertex(2));
+  prior->setMeasurement(SE2(1., 2., 0.3));
+  graph.addEdge(prior);
+
+  stringstream binary;
+  CHECK(graph.saveBinary(binary));
+  CHECK(GraphBinaryReader::isBinary(binary));
+  CHECK(binary.tellg() == streampos(0));
+
+  // the loaded graph agrees with the saved one
+  OptimizableGraph loaded;
+  CHECK(loaded.load(binary));
+  CHECK(loaded.vertices().size() == graph.vertices().size());
+  CHECK(loaded.edges().size() == graph.edges().size());
+  for (int i = 0; i < numPoses; ++i) {
+    VertexSE2* a = static_cast<VertexSE2*>(graph.vertex(i));
+    VertexSE2* b = dynamic_cast<VertexSE2*>(loaded.vertex(i));
+    CHECK(b);
+    CHECK((a->estimate().toVector() - b->estimate().toVector()).norm() < 1e-12);
+    CHECK(a->fixed() == b->fixed());
+  }
+  VertexPointXY* loadedLandmark = dynamic_cast<VertexPointXY*>(loaded.vertex(numPoses));
+  CHECK(loadedLandmark && loadedLandmark->estimate() == l->estimate());
+  int numPriors = 0;
+  for (HyperGraph::EdgeSet::const_iterator it = loaded.edges().begin(); it != loaded.edges().end(); ++it) {
+    if (EdgeSE2* b = dynamic_cast<EdgeSE2*>(*it)) {
+      EdgeSE2* a = 0;
+      for (HyperGraph::EdgeSet::const_iterator jt = graph.vertex(b->vertices()[0]->id())->edges().begin(); jt != graph.vertex(b->vertices()[0]->id())->edges().end(); ++jt) {
+        EdgeSE2* c = dynamic_cast<EdgeSE2*>(*jt);
+        if (c && c->vertices()[1]->id() == b->vertices()[1]->id())
+          a = c;
+      }
+      CHECK(a);
+      CHECK((a->measurement().toVector() - b->measurement().toVector()).norm() < 1e-12);
+      CHECK((a->information() - b->information()).norm() < 1e-12);
+    } else if (EdgeSE2Prior* b = dynamic_cast<EdgeSE2Prior*>(*it)) {
+      CHECK((b->measurement().toVector() - prior->measurement().toVector()).norm() < 1e-12);
+      ++numPriors;
+    }
+  }
+  CHECK(numPriors == 1);
+
+  // an edge to a vertex not in the file
+  stringstream partial;
+  {
+    GraphBinaryWriter writer(graph, partial);
+    writer.writeVertex(graph.vertex(0));
+    for (HyperGraph::EdgeSet::const_iterator it = graph.vertex(0)->edges().begin(); it != graph.vertex(0)->edges().end(); ++it)
+      writer.writeEdge(static_cast<OptimizableGraph::Edge*>(*it));
+    CHECK(writer.finish());
+  }
+  OptimizableGraph withoutEdges;
+  CHECK(withoutEdges.load(partial, false));
+  CHECK(withoutEdges.vertices().size() == 1);
+  CHECK(withoutEdges.edges().size() == 0);
+  partial.clear();
+  partial.seekg(0);
+  OptimizableGraph withEdges;
+  CHECK(withEdges.load(partial, true));
+  CHECK(withEdges.vertices().size() == 2);
+  CHECK(withEdges.edges().size() == 1);
+  EdgeSE2* e = static_cast<EdgeSE2*>(*withEdges.edges().begin());
+  VertexSE2* created = dynamic_cast<VertexSE2*>(withEdges.vertex(1));
+  CHECK(created);
+  SE2 expected = static_cast<VertexSE2*>(withEdges.vertex(0))->estimate() * e->measurement();
+  CHECK((created->estimate().toVector() - expected.toVector()).norm() < 1e-12);
+
+  // only the first byte agrees with the magic
+  string text = binary.str();
+  text[3] = 'X';
+  stringstream corrupted(text);
+  CHECK(! GraphBinaryReader::isBinary(corrupted));
+  CHECK(corrupted.tellg() == streampos(0));
+  CHECK(corrupted.peek() == static_cast<unsigned char>(binary_graph::magic[0]));
+
+  cerr << "OK" << endl;
+  return 0;
+}
@@ -0,0 +1,207 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+
+#include "g2o/core/block_solver.h"
+#include "g2o/core/edge_marginalization_prior.h"
+#include "g2o/core/marginalizer.h"
+#include "g2o/core/optimization_algorithm_gauss_newton.h"
+#include "g2o/core/sparse_optimizer.h"
+#include "g2o/solvers/dense/linear_solver_dense.h"
+#include "types_slam2d.h"
+
+using namespace std;
+using namespace g2o;
+
+#define CHECK(cond) \
+  if (! (cond)) { \
+    cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << endl; \
+    return 1; \
+  }
+
+typedef std::map<int, VectorX> Estimates;
+
+static Estimates estimates(const SparseOptimizer& optimizer)
+{
+  Estimates result;
+  for (HyperGraph::VertexIDMap::const_iterator it = optimizer.vertices().begin(); it != optimizer.vertices().end(); ++it) {
+    OptimizableGraph::Vertex* v = static_cast<OptimizableGraph::Vertex*>(it->second);
+    VectorX x(v->estimateDimension());
+    v->getEstimateData(x.data());
+    result[v->id()] = x;
+  }
+  return result;
+}
+
+static void setEstimates(SparseOptimizer& optimizer, const Estimates& x)
+{
+  for (Estimates::const_iterator it = x.begin(); it != x.end(); ++it) {
+    OptimizableGraph::Vertex* v = optimizer.vertex(it->first);
+    if (v)
+      v->setEstimateData(it->second.data());
+  }
+}
+
+static number_t noise(number_t sigma)
+{
+  return sigma * (2. * rand() / static_cast<number_t>(RAND_MAX) - 1.);
+}
+
+static void setupOptimizer(SparseOptimizer& optimizer)
+{
+  std::unique_ptr<BlockSolverX> blockSolver(new BlockSolverX(g2o::make_unique<LinearSolverDense<BlockSolverX::PoseMatrixType>>()));
+  optimizer.setAlgorithm(new OptimizationAlgorithmGaussNewton(std::move(blockSolver)));
+}
+
+/**
+ * the points are connected by relative measurements, hence the problem is
+ * linear and the remaining points have the same optimum after
+ * marginalizing some of them at an arbitrary estimate
+ */
+int testLinear()
+{
+  SparseOptimizer optimizer;
+  setupOptimizer(optimizer);
+  const int numPoints = 8;
+  for (int i = 0; i < numPoints; ++i) {
+    VertexPointXY* v = new VertexPointXY;
+    v->setId(i);
+    v->setEstimate(Vector2(i + noise(0.5), noise(0.5)));
+    v->setFixed(i == 0);
+    optimizer.addVertex(v);
+  }
+  srand(23);
+  for (int i = 0; i < numPoints; ++i) {
+    for (int j = i + 1; j < numPoints && j <= i + 3; ++j) {
+      EdgePointXY* e = new EdgePointXY;
+      e->setVertex(0, optimizer.vertex(i));
+      e->setVertex(1, optimizer.vertex(j));
+      e->setMeasurement(Vector2(j - i + noise(0.1), noise(0.1)));
+      e->setInformation(Matrix2::Identity() * (1. + i));
+      optimizer.addEdge(e);
+    }
+  }
+  const Estimates initial = estimates(optimizer);
+  optimizer.initializeOptimization();
+  optimizer.optimize(3);
+  const Estimates expected = estimates(optimizer);
+
+  setEstimates(optimizer, initial);
+  optimizer.initializeOptimization();
+  Marginalizer marginalizer(&optimizer);
+  HyperGraph::VertexSet vset;
+  vset.insert(optimizer.vertex(2));
+  vset.insert(optimizer.vertex(3));
+  CHECK(marginalizer.marginalize(vset));
+  CHECK(optimizer.vertex(2) == 0);
+  CHECK(optimizer.vertex(3) == 0);
+  CHECK(optimizer.vertices().size() == (size_t) numPoints - 2);
+
+  // the prior connects the non-fixed neighbors of the marginalized points
+  EdgeMarginalizationPrior* prior = marginalizer.prior();
+  CHECK(prior != 0);
+  CHECK(prior->vertices().size() == 4);
+  for (size_t i = 0; i < prior->vertices().size(); ++i) {
+    int id = prior->vertex(i)->id();
+    CHECK(id == 1 || id == 4 || id == 5 || id == 6);
+  }
+
+  optimizer.optimize(3, true);
+  const Estimates result = estimates(optimizer);
+  for (Estimates::const_iterator it = result.begin(); it != result.end(); ++it)
+    CHECK((it->second - expected.find(it->first)->second).lpNorm<Eigen::Infinity>() < 1e-6);
+
+  // the reduced graph can be re-initialized as well
+  setEstimates(optimizer, initial);
+  optimizer.initializeOptimization();
+  optimizer.optimize(3);
+  const Estimates batch = estimates(optimizer);
+  for (Estimates::const_iterator it = batch.begin(); it != batch.end(); ++it)
+    CHECK((it->second - expected.find(it->first)->second).lpNorm<Eigen::Infinity>() < 1e-6);
+  return 0;
+}
+
+/**
+ * a pose graph which is marginalized at its optimum stays at the optimum
+ */
+int testPoseGraph()
+{
+  SparseOptimizer optimizer;
+  setupOptimizer(optimizer);
+  const int numPoses = 10;
+  srand(29);
+  SE2 pose;
+  for (int i = 0; i < numPoses; ++i) {
+    VertexSE2* v = new VertexSE2;
+    v->setId(i);
+    v->setEstimate(pose * SE2(noise(0.2), noise(0.2), noise(0.1)));
+    v->setFixed(i == 0);
+    optimizer.addVertex(v);
+    pose = pose * SE2(1., 0., 0.3);
+  }
+  for (int i = 0; i < numPoses; ++i) {
+    for (int j = i + 1; j < numPoses && j <= i + 2; ++j) {
+      EdgeSE2* e = new EdgeSE2;
+      e->setVertex(0, optimizer.vertex(i));
+      e->setVertex(1, optimizer.vertex(j));
+      SE2 delta = (j == i + 1) ? SE2(1., 0., 0.3) : SE2(1., 0., 0.3) * SE2(1., 0., 0.3);
+      e->setMeasurement(delta * SE2(noise(0.05), noise(0.05), noise(0.02)));
+      e->setInformation(Matrix3::Identity() * 100.);
+      optimizer.addEdge(e);
+    }
+  }
+  optimizer.initializeOptimization();
+  optimizer.optimize(10);
+  const Estimates expected = estimates(optimizer);
+
+  Marginalizer marginalizer(&optimizer);
+  HyperGraph::VertexSet vset;
+  vset.insert(optimizer.vertex(1));
+  vset.insert(optimizer.vertex(2));
+  CHECK(marginalizer.marginalize(vset));
+  CHECK(marginalizer.prior() != 0);
+  CHECK(marginalizer.prior()->vertices().size() == 2);
+  CHECK(marginalizer.prior()->dimension() == 6);
+
+  optimizer.initializeOptimization();
+  optimizer.optimize(5);
+  const Estimates result = estimates(optimizer);
+  CHECK(result.size() == (size_t) numPoses - 2);
+  for (Estimates::const_iterator it = result.begin(); it != result.end(); ++it)
+    CHECK((it->second - expected.find(it->first)->second).lpNorm<Eigen::Infinity>() < 1e-6);
+  return 0;
+}
+
+int main()
+{
+  if (testLinear() || testPoseGraph())
+    return 1;
+  cerr << "OK" << endl;
+  return 0;
+}
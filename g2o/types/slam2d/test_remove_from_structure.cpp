@@ -0,0 +1,240 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+
+#include <map>
+
+#include "g2o/core/block_solver.h"
+#include "g2o/core/optimization_algorithm_gauss_newton.h"
+#include "g2o/core/sparse_optimizer.h"
+#include "g2o/solvers/dense/linear_solver_dense.h"
+#include "types_slam2d.h"
+
+using namespace std;
+using namespace g2o;
+
+#define CHECK(cond) \
+  if (! (cond)) { \
+    cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << endl; \
+    return 1; \
+  }
+
+typedef std::map<int, VectorX> Estimates;
+
+//! exposes the number of blocks the arenas of the Hessian hold
+class InspectableBlockSolver : public BlockSolverX
+{
+  public:
+    explicit InspectableBlockSolver(std::unique_ptr<LinearSolverType> linearSolver) :
+      BlockSolverX(std::move(linearSolver))
+    {}
+
+    size_t numArenaBlocks() const
+    {
+      size_t result = _Hpp->arena()->numBlocks();
+      if (_doSchur)
+        result += _Hschur->arena()->numBlocks() + _Hll->arena()->numBlocks() + _Hpl->arena()->numBlocks();
+      return result;
+    }
+};
+
+static Estimates estimates(const SparseOptimizer& optimizer)
+{
+  Estimates result;
+  for (HyperGraph::VertexIDMap::const_iterator it = optimizer.vertices().begin(); it != optimizer.vertices().end(); ++it) {
+    OptimizableGraph::Vertex* v = static_cast<OptimizableGraph::Vertex*>(it->second);
+    VectorX x(v->estimateDimension());
+    v->getEstimateData(x.data());
+    result[v->id()] = x;
+  }
+  return result;
+}
+
+static void setEstimates(SparseOptimizer& optimizer, const Estimates& x)
+{
+  for (Estimates::const_iterator it = x.begin(); it != x.end(); ++it)
+    optimizer.vertex(it->first)->setEstimateData(it->second.data());
+}
+
+/**
+ * remove vertices from an initialized optimizer and compare the next iteration
+ * to the one of an optimizer which builds the structure from scratch.
+ */
+static int testRemove(bool schur)
+{
+  SparseOptimizer optimizer;
+  typedef BlockSolverX BlockSolverType;
+  std::unique_ptr<BlockSolverType> blockSolver(new BlockSolverType(g2o::make_unique<LinearSolverDense<BlockSolverType::PoseMatrixType>>()));
+  blockSolver->setSchur(schur);
+  optimizer.setAlgorithm(new OptimizationAlgorithmGaussNewton(std::move(blockSolver)));
+
+  const int numPoses = 10;
+  const int numLandmarks = 4;
+  for (int i = 0; i < numPoses; ++i) {
+    VertexSE2* v = new VertexSE2;
+    v->setId(i);
+    v->setEstimate(SE2(i + 0.1 * sin(i), 0.1 * cos(i), 0.05 * i));
+    v->setFixed(i == 0);
+    optimizer.addVertex(v);
+  }
+  for (int i = 0; i < numPoses; ++i) {
+    for (int j = i + 1; j < std::min(i + 3, numPoses); ++j) {
+      EdgeSE2* e = new EdgeSE2;
+      e->setVertex(0, optimizer.vertex(i));
+      e->setVertex(1, optimizer.vertex(j));
+      e->setMeasurement(SE2(j - i, 0., 0.));
+      e->setInformation(Matrix3::Identity());
+      optimizer.addEdge(e);
+    }
+  }
+  for (int l = 0; l < numLandmarks; ++l) {
+    VertexPointXY* v = new VertexPointXY;
+    v->setId(numPoses + l);
+    v->setEstimate(Vector2(2. * l + 0.3, 1. + 0.1 * l));
+    v->setMarginalized(schur);
+    optimizer.addVertex(v);
+    for (int i = 2 * l; i < std::min(2 * l + 4, numPoses); ++i) {
+      EdgeSE2PointXY* e = new EdgeSE2PointXY;
+      e->setVertex(0, optimizer.vertex(i));
+      e->setVertex(1, v);
+      e->setMeasurement(Vector2(2. * l - i, 1.));
+      e->setInformation(Matrix2::Identity());
+      optimizer.addEdge(e);
+    }
+  }
+  optimizer.initializeOptimization();
+  CHECK(optimizer.optimize(1) == 1);
+
+  // a pose in the middle, the last pose and a landmark
+  CHECK(optimizer.removeVertex(optimizer.vertex(4)));
+  CHECK(optimizer.removeVertex(optimizer.vertex(numPoses - 1)));
+  CHECK(optimizer.removeVertex(optimizer.vertex(numPoses + 1)));
+  CHECK(optimizer.indexMapping().size() == static_cast<size_t>(numPoses - 3 + numLandmarks - 1));
+  Estimates before = estimates(optimizer);
+  // online, otherwise the first iteration rebuilds the structure
+  CHECK(optimizer.optimize(1, true) == 1);
+  Estimates online = estimates(optimizer);
+
+  setEstimates(optimizer, before);
+  optimizer.initializeOptimization();
+  CHECK(optimizer.optimize(1) == 1);
+  Estimates rebuilt = estimates(optimizer);
+  CHECK(online.size() == rebuilt.size());
+  for (Estimates::const_iterator it = online.begin(); it != online.end(); ++it)
+    CHECK((it->second - rebuilt[it->first]).norm() < 1e-9);
+  return 0;
+}
+
+/**
+ * slide a window over a chain of poses and landmarks by adding a pose and a
+ * landmark to the initialized optimizer and removing the oldest ones. The
+ * arena has to reuse the blocks of the removed vertices.
+ */
+static int testSlidingWindow(bool schur)
+{
+  SparseOptimizer optimizer;
+  InspectableBlockSolver* blockSolver = new InspectableBlockSolver(g2o::make_unique<LinearSolverDense<BlockSolverX::PoseMatrixType>>());
+  CHECK(blockSolver->arenaStorage());
+  optimizer.setAlgorithm(new OptimizationAlgorithmGaussNewton(std::unique_ptr<BlockSolverX>(blockSolver)));
+
+  const int landmarkOffset = 1000;
+  const int windowSize = 5;
+  const int numCycles = 20;
+  size_t numBlocksAfterFirstCycle = 0;
+  for (int n = 0; n < windowSize + numCycles; ++n) {
+    HyperGraph::VertexSet vset;
+    HyperGraph::EdgeSet eset;
+    VertexSE2* pose = new VertexSE2;
+    pose->setId(n);
+    pose->setEstimate(SE2(n + 0.1 * sin(n), 0.1 * cos(n), 0.01 * n));
+    optimizer.addVertex(pose);
+    vset.insert(pose);
+    EdgeSE2Prior* prior = new EdgeSE2Prior;
+    prior->setVertex(0, pose);
+    prior->setMeasurement(SE2(n, 0., 0.));
+    prior->setInformation(0.01 * Matrix3::Identity());
+    optimizer.addEdge(prior);
+    eset.insert(prior);
+    if (n > 0) {
+      EdgeSE2* odom = new EdgeSE2;
+      odom->setVertex(0, optimizer.vertex(n - 1));
+      odom->setVertex(1, pose);
+      odom->setMeasurement(SE2(1., 0., 0.));
+      odom->setInformation(Matrix3::Identity());
+      optimizer.addEdge(odom);
+      eset.insert(odom);
+    }
+    VertexPointXY* landmark = new VertexPointXY;
+    landmark->setId(landmarkOffset + n);
+    landmark->setEstimate(Vector2(n + 0.2, 1.1));
+    landmark->setMarginalized(schur);
+    optimizer.addVertex(landmark);
+    vset.insert(landmark);
+    // the new pose observes its own landmark and the one of the previous pose
+    for (int l = std::max(n - 1, 0); l <= n; ++l) {
+      EdgeSE2PointXY* obs = new EdgeSE2PointXY;
+      obs->setVertex(0, pose);
+      obs->setVertex(1, optimizer.vertex(landmarkOffset + l));
+      obs->setMeasurement(Vector2(l - n, 1.));
+      obs->setInformation(Matrix2::Identity());
+      optimizer.addEdge(obs);
+      eset.insert(obs);
+    }
+
+    if (n == 0)
+      optimizer.initializeOptimization();
+    else
+      CHECK(optimizer.updateInitialization(vset, eset));
+    // online, i.e., the structure is updated instead of being rebuilt
+    CHECK(optimizer.optimize(1, n > 0) == 1);
+
+    if (n < windowSize - 1)
+      continue;
+    const int oldest = n - windowSize + 1;
+    CHECK(optimizer.removeVertex(optimizer.vertex(oldest)));
+    CHECK(optimizer.removeVertex(optimizer.vertex(landmarkOffset + oldest)));
+    CHECK(optimizer.indexMapping().size() == static_cast<size_t>(2 * (windowSize - 1)));
+    if (n == windowSize)
+      numBlocksAfterFirstCycle = blockSolver->numArenaBlocks();
+    else if (n > windowSize)
+      CHECK(blockSolver->numArenaBlocks() == numBlocksAfterFirstCycle);
+  }
+  return 0;
+}
+
+int main()
+{
+  if (testRemove(true))
+    return 1;
+  if (testRemove(false))
+    return 1;
+  if (testSlidingWindow(true))
+    return 1;
+  if (testSlidingWindow(false))
+    return 1;
+  cerr << "OK" << endl;
+  return 0;
+}
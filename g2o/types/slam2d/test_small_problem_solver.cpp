@@ -0,0 +1,113 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "g2o/core/small_problem_solver.h"
+#include "types_slam2d.h"
+
+using namespace std;
+using namespace g2o;
+
+#define CHECK(cond) \
+  if (! (cond)) { \
+    cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << endl; \
+    return 1; \
+  }
+
+/**
+ * each problem is a point with priors, its solution is the mean of the
+ * measurements weighted by their information
+ */
+int main()
+{
+  typedef SmallProblemSolver<VertexPointXY> Solver;
+  const int numProblems = 50;
+  std::vector<Solver::Problem> problems(numProblems);
+  std::vector<Vector2> expected(numProblems);
+  srand(31);
+  for (int p = 0; p < numProblems; ++p) {
+    VertexPointXY* v = new VertexPointXY;
+    v->setId(p);
+    v->setEstimate(Vector2(100., -100.));
+    problems[p].vertex = v;
+    Matrix2 informationSum = Matrix2::Zero();
+    Vector2 weightedSum = Vector2::Zero();
+    for (int k = 0; k < 3 + p % 4; ++k) {
+      EdgeXYPrior* e = new EdgeXYPrior;
+      e->setVertex(0, v);
+      Vector2 measurement = Vector2::Random() * 10.;
+      Matrix2 information = Matrix2::Identity() * (1. + k);
+      information(0, 1) = information(1, 0) = 0.5;
+      e->setMeasurement(measurement);
+      e->setInformation(information);
+      problems[p].edges.push_back(e);
+      informationSum += information;
+      weightedSum += information * measurement;
+    }
+    expected[p] = informationSum.ldlt().solve(weightedSum);
+
+    // an edge on another level is ignored
+    EdgeXYPrior* e = new EdgeXYPrior;
+    e->setVertex(0, v);
+    e->setMeasurement(Vector2(1000., 1000.));
+    e->setInformation(Matrix2::Identity());
+    e->setLevel(1);
+    problems[p].edges.push_back(e);
+  }
+  problems[0].vertex->setFixed(true);
+
+  Solver solver;
+  solver.solve(problems);
+  CHECK(problems[0].vertex->estimate() == Vector2(100., -100.));
+  CHECK(problems[0].iterations == 0);
+  for (int p = 1; p < numProblems; ++p) {
+    CHECK(problems[p].iterations > 0);
+    CHECK((problems[p].vertex->estimate() - expected[p]).norm() < 1e-6);
+    // the chi2 of the weighted mean is the minimum
+    number_t chi2 = 0.;
+    for (size_t k = 0; k + 1 < problems[p].edges.size(); ++k) {
+      problems[p].edges[k]->computeError();
+      chi2 += problems[p].edges[k]->chi2();
+    }
+    CHECK(std::abs(problems[p].chi2 - chi2) < 1e-6);
+  }
+
+  // a single problem gives the same result
+  problems[1].vertex->setEstimate(Vector2(-50., 50.));
+  solver.solve(problems[1]);
+  CHECK((problems[1].vertex->estimate() - expected[1]).norm() < 1e-6);
+
+  for (int p = 0; p < numProblems; ++p) {
+    for (size_t k = 0; k < problems[p].edges.size(); ++k)
+      delete problems[p].edges[k];
+    delete problems[p].vertex;
+  }
+  cerr << "OK" << endl;
+  return 0;
+}
@@ -53,6 +53,8 @@ namespace g2o {
   G2O_REGISTER_TYPE(EDGE_SE2_LOTSOFXY, EdgeSE2LotsOfXY);
   G2O_REGISTER_TYPE(EDGE_PRIOR_XY, EdgeXYPrior);
 
+  G2O_REGISTER_BATCH_EDGE_KERNEL(EdgeSE2, BatchEdgeKernelSE2);
+
  
   G2O_REGISTER_ACTION(VertexSE2WriteGnuplotAction);
   G2O_REGISTER_ACTION(VertexPointXYWriteGnuplotAction);
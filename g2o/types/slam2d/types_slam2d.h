@@ -43,5 +43,6 @@
 #include "edge_se2_twopointsxy.h"
 #include "edge_se2_lotsofxy.h"
 #include "edge_xy_prior.h"
+#include "batch_edge_kernel_se2.h"
 
 #endif
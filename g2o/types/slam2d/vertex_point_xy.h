@@ -30,6 +30,7 @@
 #include "g2o_types_slam2d_api.h"
 #include "g2o/config.h"
 #include "g2o/core/base_vertex.h"
+#include "g2o/core/auto_differentiation_traits.h"
 #include "g2o/core/hyper_graph_action.h"
 
 #include <Eigen/Core>
@@ -62,6 +63,8 @@ namespace g2o {
         return 2;
       }
 
+      virtual bool plainDataFormat() const { return true;}
+
       virtual bool setMinimalEstimateDataImpl(const number_t* est){
         return setEstimateData(est);
       }
@@ -80,11 +83,19 @@ namespace g2o {
         _estimate[1] += update[1];
       }
 
+      virtual bool localDifference(const number_t* est, number_t* delta) const {
+        delta[0] = _estimate[0] - est[0];
+        delta[1] = _estimate[1] - est[1];
+        return true;
+      }
+
       virtual bool read(std::istream& is);
       virtual bool write(std::ostream& os) const;
 
   };
 
+  template <> struct AutoDiffOplusIsAddition<VertexPointXY> { static const bool value = true; };
+
   class G2O_TYPES_SLAM2D_API VertexPointXYWriteGnuplotAction: public WriteGnuplotAction {
   public:
     VertexPointXYWriteGnuplotAction();
@@ -29,6 +29,7 @@
 
 #include "g2o/config.h"
 #include "g2o/core/base_vertex.h"
+#include "g2o/core/auto_differentiation_traits.h"
 #include "g2o/core/hyper_graph_action.h"
 #include "se2.h"
 #include "g2o_types_slam2d_api.h"
@@ -70,6 +71,8 @@ namespace g2o {
       
       virtual int estimateDimension() const { return 3; }
 
+      virtual bool plainDataFormat() const { return true;}
+
       virtual bool setMinimalEstimateDataImpl(const number_t* est){
         return setEstimateData(est);
       }
@@ -80,11 +83,20 @@ namespace g2o {
       
       virtual int minimalEstimateDimension() const { return 3; }
 
+      virtual bool localDifference(const number_t* est, number_t* delta) const {
+        delta[0] = _estimate.translation().x() - est[0];
+        delta[1] = _estimate.translation().y() - est[1];
+        delta[2] = normalize_theta(_estimate.rotation().angle() - est[2]);
+        return true;
+      }
+
       virtual bool read(std::istream& is);
       virtual bool write(std::ostream& os) const;
 
   };
 
+  template <> struct AutoDiffOplusIsAddition<VertexSE2> { static const bool value = true; };
+
   class G2O_TYPES_SLAM2D_API VertexSE2WriteGnuplotAction: public WriteGnuplotAction {
   public:
     VertexSE2WriteGnuplotAction();
@@ -77,34 +77,32 @@ namespace g2o {
     }
   }
 
-// #ifndef NUMERIC_JACOBIAN_TWO_D_TYPES
-//   void EdgeSE2Line2D::linearizeOplus()
-//   {
-//     const VertexSE2* vi     = static_cast<const VertexSE2*>(_vertices[0]);
-//     const VertexLine2D* vj = static_cast<const VertexLine2D*>(_vertices[1]);
-//     const number_t& x1        = vi->estimate().translation()[0];
-//     const number_t& y1        = vi->estimate().translation()[1];
-//     const number_t& th1       = vi->estimate().rotation().angle();
-//     const number_t& x2        = vj->estimate()[0];
-//     const number_t& y2        = vj->estimate()[1];
-
-//     number_t aux_1 = cos(th1) ;
-//     number_t aux_2 = -aux_1 ;
-//     number_t aux_3 = sin(th1) ;
-
-//     _jacobianOplusXi( 0 , 0 ) = aux_2 ;
-//     _jacobianOplusXi( 0 , 1 ) = -aux_3 ;
-//     _jacobianOplusXi( 0 , 2 ) = aux_1*y2-aux_1*y1-aux_3*x2+aux_3*x1 ;
-//     _jacobianOplusXi( 1 , 0 ) = aux_3 ;
-//     _jacobianOplusXi( 1 , 1 ) = aux_2 ;
-//     _jacobianOplusXi( 1 , 2 ) = -aux_3*y2+aux_3*y1-aux_1*x2+aux_1*x1 ;
-
-//     _jacobianOplusXj( 0 , 0 ) = aux_1 ;
-//     _jacobianOplusXj( 0 , 1 ) = aux_3 ;
-//     _jacobianOplusXj( 1 , 0 ) = -aux_3 ;
-//     _jacobianOplusXj( 1 , 1 ) = aux_1 ;
-//   }
-// #endif
+#ifndef NUMERIC_JACOBIAN_TWO_D_TYPES
+  void EdgeSE2Line2D::linearizeOplus()
+  {
+    const VertexSE2* vi     = static_cast<const VertexSE2*>(_vertices[0]);
+    const VertexLine2D* vj = static_cast<const VertexLine2D*>(_vertices[1]);
+    SE2 iT = vi->estimate().inverse();
+    number_t theta = vj->theta() + iT.rotation().angle();
+    Vector2 n(std::cos(theta), std::sin(theta));
+    Vector2 nPerp(-n.y(), n.x());
+    Vector2 nRt = iT.rotation().toRotationMatrix().transpose() * n;
+
+    // the distance of the robot to the line does not depend on the
+    // heading of the robot
+    _jacobianOplusXi(0,0) = 0.;
+    _jacobianOplusXi(0,1) = 0.;
+    _jacobianOplusXi(0,2) = -1.;
+    _jacobianOplusXi(1,0) = -nRt.x();
+    _jacobianOplusXi(1,1) = -nRt.y();
+    _jacobianOplusXi(1,2) = 0.;
+
+    _jacobianOplusXj(0,0) = 1.;
+    _jacobianOplusXj(0,1) = 0.;
+    _jacobianOplusXj(1,0) = nPerp.dot(iT.translation());
+    _jacobianOplusXj(1,1) = 1.;
+  }
+#endif
 
 //   EdgeSE2Line2DWriteGnuplotAction::EdgeSE2Line2DWriteGnuplotAction(): WriteGnuplotAction(typeid(EdgeSE2Line2D).name()){}
 
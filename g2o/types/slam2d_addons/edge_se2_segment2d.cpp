@@ -80,34 +80,28 @@ namespace g2o {
     }
   }
 
-// #ifndef NUMERIC_JACOBIAN_TWO_D_TYPES
-//   void EdgeSE2Segment2D::linearizeOplus()
-//   {
-//     const VertexSE2* vi     = static_cast<const VertexSE2*>(_vertices[0]);
-//     const VertexSegment2D* vj = static_cast<const VertexSegment2D*>(_vertices[1]);
-//     const number_t& x1        = vi->estimate().translation()[0];
-//     const number_t& y1        = vi->estimate().translation()[1];
-//     const number_t& th1       = vi->estimate().rotation().angle();
-//     const number_t& x2        = vj->estimate()[0];
-//     const number_t& y2        = vj->estimate()[1];
-
-//     number_t aux_1 = cos(th1) ;
-//     number_t aux_2 = -aux_1 ;
-//     number_t aux_3 = sin(th1) ;
-
-//     _jacobianOplusXi( 0 , 0 ) = aux_2 ;
-//     _jacobianOplusXi( 0 , 1 ) = -aux_3 ;
-//     _jacobianOplusXi( 0 , 2 ) = aux_1*y2-aux_1*y1-aux_3*x2+aux_3*x1 ;
-//     _jacobianOplusXi( 1 , 0 ) = aux_3 ;
-//     _jacobianOplusXi( 1 , 1 ) = aux_2 ;
-//     _jacobianOplusXi( 1 , 2 ) = -aux_3*y2+aux_3*y1-aux_1*x2+aux_1*x1 ;
-
-//     _jacobianOplusXj( 0 , 0 ) = aux_1 ;
-//     _jacobianOplusXj( 0 , 1 ) = aux_3 ;
-//     _jacobianOplusXj( 1 , 0 ) = -aux_3 ;
-//     _jacobianOplusXj( 1 , 1 ) = aux_1 ;
-//   }
-// #endif
+#ifndef NUMERIC_JACOBIAN_TWO_D_TYPES
+  void EdgeSE2Segment2D::linearizeOplus()
+  {
+    const VertexSE2* vi     = static_cast<const VertexSE2*>(_vertices[0]);
+    const VertexSegment2D* vj = static_cast<const VertexSegment2D*>(_vertices[1]);
+    const Matrix2 Rt = vi->estimate().rotation().toRotationMatrix().transpose();
+    const Vector2& t = vi->estimate().translation();
+    Vector2 predP1 = Rt * (vj->estimateP1() - t);
+    Vector2 predP2 = Rt * (vj->estimateP2() - t);
+
+    _jacobianOplusXi.block<2,2>(0,0) = -Rt;
+    _jacobianOplusXi(0,2) =  predP1.y();
+    _jacobianOplusXi(1,2) = -predP1.x();
+    _jacobianOplusXi.block<2,2>(2,0) = -Rt;
+    _jacobianOplusXi(2,2) =  predP2.y();
+    _jacobianOplusXi(3,2) = -predP2.x();
+
+    _jacobianOplusXj.setZero();
+    _jacobianOplusXj.block<2,2>(0,0) = Rt;
+    _jacobianOplusXj.block<2,2>(2,2) = Rt;
+  }
+#endif
 
 //   EdgeSE2Segment2DWriteGnuplotAction::EdgeSE2Segment2DWriteGnuplotAction(): WriteGnuplotAction(typeid(EdgeSE2Segment2D).name()){}
 
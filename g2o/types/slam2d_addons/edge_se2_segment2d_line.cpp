@@ -68,4 +68,45 @@ namespace g2o {
     return os.good();
   }
 
+#ifndef NUMERIC_JACOBIAN_TWO_D_TYPES
+  void EdgeSE2Segment2DLine::linearizeOplus()
+  {
+    const VertexSE2* vi     = static_cast<const VertexSE2*>(_vertices[0]);
+    const VertexSegment2D* vj = static_cast<const VertexSegment2D*>(_vertices[1]);
+    const Matrix2 Rt = vi->estimate().rotation().toRotationMatrix().transpose();
+    const Vector2& t = vi->estimate().translation();
+    Vector2 predP1 = Rt * (vj->estimateP1() - t);
+    Vector2 predP2 = Rt * (vj->estimateP2() - t);
+    Vector2 dP = predP2 - predP1;
+    number_t invLength2 = 1. / dP.squaredNorm();
+    number_t invLength = std::sqrt(invLength2);
+    Vector2 normal(dP.y() * invLength, -dP.x() * invLength);
+    Vector2 midPoint = (predP1 + predP2) * .5;
+
+    // derivatives of the line parameters w.r.t. the end points in the robot frame
+    Eigen::Matrix<number_t, 1, 2> dTheta(-dP.y() * invLength2, dP.x() * invLength2);
+    Matrix2 K;
+    K << 0., 1., -1., 0.;
+    Eigen::Matrix<number_t, 1, 2> dRhoNormal = midPoint.transpose() * (Matrix2::Identity() - normal * normal.transpose()) * K * invLength;
+    Eigen::Matrix<number_t, 2, 2> dP1, dP2;
+    dP1.row(0) = -dTheta;
+    dP1.row(1) = .5 * normal.transpose() - dRhoNormal;
+    dP2.row(0) = dTheta;
+    dP2.row(1) = .5 * normal.transpose() + dRhoNormal;
+
+    // derivatives of the end points in the robot frame w.r.t. the robot pose
+    Eigen::Matrix<number_t, 2, 3> dPose1, dPose2;
+    dPose1.leftCols<2>() = -Rt;
+    dPose1(0,2) =  predP1.y();
+    dPose1(1,2) = -predP1.x();
+    dPose2.leftCols<2>() = -Rt;
+    dPose2(0,2) =  predP2.y();
+    dPose2(1,2) = -predP2.x();
+
+    _jacobianOplusXi = dP1 * dPose1 + dP2 * dPose2;
+    _jacobianOplusXj.block<2,2>(0,0) = dP1 * Rt;
+    _jacobianOplusXj.block<2,2>(0,2) = dP2 * Rt;
+  }
+#endif
+
 } // end namespace
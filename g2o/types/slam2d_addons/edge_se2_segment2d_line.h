@@ -96,9 +96,9 @@ namespace g2o {
       G2O_TYPES_SLAM2D_ADDONS_API virtual bool write(std::ostream& os) const;
 
 
-/* #ifndef NUMERIC_JACOBIAN_TWO_D_TYPES */
-/*       virtual void linearizeOplus(); */
-/* #endif */
+#ifndef NUMERIC_JACOBIAN_TWO_D_TYPES
+      G2O_TYPES_SLAM2D_ADDONS_API virtual void linearizeOplus();
+#endif
   };
 
 /*   class G2O_TYPES_SLAM2D_ADDONS_API EdgeSE2Segment2DLineWriteGnuplotAction: public WriteGnuplotAction { */
@@ -71,4 +71,34 @@ namespace g2o {
     return os.good();
   }
 
+#ifndef NUMERIC_JACOBIAN_TWO_D_TYPES
+  void EdgeSE2Segment2DPointLine::linearizeOplus()
+  {
+    const VertexSE2* vi     = static_cast<const VertexSE2*>(_vertices[0]);
+    const VertexSegment2D* vj = static_cast<const VertexSegment2D*>(_vertices[1]);
+    const Matrix2 Rt = vi->estimate().rotation().toRotationMatrix().transpose();
+    const Vector2& t = vi->estimate().translation();
+    Vector2 predP1 = Rt * (vj->estimateP1() - t);
+    Vector2 predP2 = Rt * (vj->estimateP2() - t);
+    Vector2 dP = predP2 - predP1;
+    number_t invLength2 = 1. / dP.squaredNorm();
+    const Vector2& pt = (_pointNum==0) ? predP1 : predP2;
+
+    // the orientation of the segment does not depend on the robot position
+    Eigen::Matrix<number_t, 1, 2> dTheta(-dP.y() * invLength2, dP.x() * invLength2);
+    Eigen::Matrix<number_t, 1, 2> dThetaRt = dTheta * Rt;
+    _jacobianOplusXi.block<2,2>(0,0) = -Rt;
+    _jacobianOplusXi(0,2) =  pt.y();
+    _jacobianOplusXi(1,2) = -pt.x();
+    _jacobianOplusXi(2,0) = 0.;
+    _jacobianOplusXi(2,1) = 0.;
+    _jacobianOplusXi(2,2) = -1.;
+
+    _jacobianOplusXj.setZero();
+    _jacobianOplusXj.block<2,2>(0, 2 * _pointNum) = Rt;
+    _jacobianOplusXj.block<1,2>(2,0) = -dThetaRt;
+    _jacobianOplusXj.block<1,2>(2,2) = dThetaRt;
+  }
+#endif
+
 } // end namespace
@@ -0,0 +1,123 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, H. Strasdat, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "batch_edge_kernel_se3.h"
+#include "isometry3d_gradients.h"
+
+namespace g2o {
+
+  namespace {
+    typedef BatchEdgeKernel::Lanes Lanes;
+
+    //! C = A * B for isometries stored column major as rotation followed by translation
+    inline void compose(Lanes* C, const Lanes* A, const Lanes* B)
+    {
+      for (int c = 0; c < 3; ++c)
+        for (int r = 0; r < 3; ++r)
+          C[r + 3 * c] = A[r] * B[3 * c] + A[r + 3] * B[3 * c + 1] + A[r + 6] * B[3 * c + 2];
+      for (int r = 0; r < 3; ++r)
+        C[9 + r] = A[r] * B[9] + A[r + 3] * B[10] + A[r + 6] * B[11] + A[9 + r];
+    }
+
+    //! C = A^-1 * B
+    inline void composeInverse(Lanes* C, const Lanes* A, const Lanes* B)
+    {
+      for (int c = 0; c < 3; ++c)
+        for (int r = 0; r < 3; ++r)
+          C[r + 3 * c] = A[3 * r] * B[3 * c] + A[3 * r + 1] * B[3 * c + 1] + A[3 * r + 2] * B[3 * c + 2];
+      const Lanes dx = B[9] - A[9];
+      const Lanes dy = B[10] - A[10];
+      const Lanes dz = B[11] - A[11];
+      for (int r = 0; r < 3; ++r)
+        C[9 + r] = A[3 * r] * dx + A[3 * r + 1] * dy + A[3 * r + 2] * dz;
+    }
+  }
+
+  void BatchEdgeKernelSE3::computeErrors()
+  {
+#   ifdef G2O_OPENMP
+#   pragma omp parallel for default (shared) if (numChunks() > 50)
+#   endif
+    for (int chunk = 0; chunk < numChunks(); ++chunk) {
+      Lanes Xi[12], Xj[12], Z[12], B[12], E[12];
+      for (int l = 0; l < LaneWidth; ++l) {
+        const int k = laneEdge(chunk, l);
+        const Isometry3::MatrixType& xi = _vertexXi[k]->estimate().matrix();
+        const Isometry3::MatrixType& xj = _vertexXj[k]->estimate().matrix();
+        const Isometry3::MatrixType& z = edge(k)->inverseMeasurement().matrix();
+        for (int c = 0; c < 4; ++c)
+          for (int r = 0; r < 3; ++r) {
+            Xi[r + 3 * c][l] = xi(r, c);
+            Xj[r + 3 * c][l] = xj(r, c);
+            Z[r + 3 * c][l] = z(r, c);
+          }
+      }
+      composeInverse(B, Xi, Xj);
+      compose(E, Z, B);
+
+      // compact quaternion of the rotation, the lanes with a non-positive trace take the other branches
+      const Lanes trace = E[0] + E[4] + E[8];
+      const Lanes t = (trace.max(0) + 1).sqrt();
+      const Lanes w = cst(0.5) * t;
+      const Lanes s = cst(0.5) / t;
+      const Lanes qx = (E[5] - E[7]) * s;
+      const Lanes qy = (E[6] - E[2]) * s;
+      const Lanes qz = (E[1] - E[3]) * s;
+      const Lanes invNorm = (w * w + qx * qx + qy * qy + qz * qz).rsqrt();
+      for (int l = 0; l < validLanes(chunk); ++l) {
+        Vector6& error = edge(chunk * LaneWidth + l)->error();
+        error[0] = E[9][l];
+        error[1] = E[10][l];
+        error[2] = E[11][l];
+        if (trace[l] > 0) {
+          error[3] = qx[l] * invNorm[l];
+          error[4] = qy[l] * invNorm[l];
+          error[5] = qz[l] * invNorm[l];
+        } else {
+          Matrix3 R;
+          for (int i = 0; i < 9; ++i)
+            R.data()[i] = E[i][l];
+          error.tail<3>() = internal::toCompactQuaternion(R);
+        }
+      }
+    }
+  }
+
+  void BatchEdgeKernelSE3::linearizeOplus()
+  {
+#   ifdef G2O_OPENMP
+#   pragma omp parallel for default (shared) if (size() > 50)
+#   endif
+    for (int k = 0; k < size(); ++k) {
+      EdgeSE3::JacobianXiOplusType Ji(jacobianXi(k));
+      EdgeSE3::JacobianXjOplusType Jj(jacobianXj(k));
+      Isometry3 E;
+      internal::computeEdgeSE3Gradient(E, Ji, Jj, edge(k)->measurement(), _vertexXi[k]->estimate(), _vertexXj[k]->estimate());
+      mapJacobians(k);
+    }
+  }
+
+} // end namespace
@@ -0,0 +1,53 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, H. Strasdat, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef G2O_BATCH_EDGE_KERNEL_SE3_H
+#define G2O_BATCH_EDGE_KERNEL_SE3_H
+
+#include "edge_se3.h"
+#include "g2o/core/batch_edge_kernel.h"
+#include "g2o_types_slam3d_api.h"
+
+namespace g2o {
+
+  /**
+   * \brief evaluates EdgeSE3 in chunks, see BatchEdgeKernel
+   *
+   * The relative transformations and the errors are computed on the
+   * chunks, the Jacobians are computed edge by edge into the memory of the
+   * kernel, since the derivative of the quaternion depends on the branch
+   * taken for the conversion of the rotation matrix.
+   */
+  class G2O_TYPES_SLAM3D_API BatchEdgeKernelSE3 : public BaseBatchEdgeKernel<EdgeSE3>
+  {
+    public:
+      virtual void computeErrors();
+      virtual void linearizeOplus();
+  };
+
+} // end namespace
+
+#endif
@@ -71,6 +71,9 @@ namespace g2o {
 
       virtual int measurementDimension() const {return 7;}
 
+      //! the inverse of the measurement, kept up to date by setMeasurement()
+      const Isometry3& inverseMeasurement() const { return _inverseMeasurement;}
+
       virtual bool setMeasurementFromState() ;
 
       virtual number_t initialEstimatePossible(const OptimizableGraph::VertexSet& /*from*/, 
@@ -0,0 +1,118 @@
+// g2o - General Graph Optimization
+// Copyright (C) 2011 R. Kuemmerle, G. Grisetti, W. Burgard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <iostream>
+
+#include "g2o/stuff/misc.h"
+#include "batch_edge_kernel_se3.h"
+
+using namespace std;
+using namespace g2o;
+
+#define CHECK(cond) \
+  if (! (cond)) { \
+    cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << endl; \
+    return 1; \
+  }
+
+static Isometry3 randomIsometry3()
+{
+  Vector3 rotAxisAngle = Vector3::Random();
+  AngleAxis rotation(rotAxisAngle.norm(), rotAxisAngle.normalized());
+  Isometry3 result = (Isometry3)rotation.toRotationMatrix();
+  result.translation() = Vector3::Random();
+  return result;
+}
+
+/**
+ * evaluate the edges by the kernel and compare the errors and the Jacobians
+ * to the ones computed by the edges
+ */
+static int compareToEdges(BatchEdgeKernel& kernel, const std::vector<EdgeSE3*>& edges)
+{
+  kernel.computeErrors();
+  kernel.linearizeOplus();
+  for (size_t k = 0; k < edges.size(); ++k) {
+    EdgeSE3* e = edges[k];
+    Vector6 error = e->error();
+    EdgeSE3::JacobianXiOplusType Ji = e->jacobianOplusXi();
+    EdgeSE3::JacobianXjOplusType Jj = e->jacobianOplusXj();
+    // the Jacobians of the edge are mapped to the memory of the kernel
+    CHECK(e->jacobianOplusXi().data() == kernel.jacobianData(k, 0));
+    CHECK(e->jacobianOplusXj().data() == kernel.jacobianData(k, 1));
+    e->computeError();
+    e->linearizeOplus();
+    CHECK((error - e->error()).norm() < 1e-9);
+    CHECK((Ji - e->jacobianOplusXi()).norm() < 1e-9);
+    CHECK((Jj - e->jacobianOplusXj()).norm() < 1e-9);
+  }
+  return 0;
+}
+
+int main()
+{
+  srand(42);
+  // not a multiple of the lane width, the last chunk is padded
+  const int numEdges = 3 * BatchEdgeKernel::LaneWidth + 5;
+  std::vector<VertexSE3*> vertices;
+  for (int i = 0; i <= numEdges; ++i) {
+    VertexSE3* v = new VertexSE3;
+    v->setId(i);
+    v->setEstimate(randomIsometry3());
+    vertices.push_back(v);
+  }
+  std::vector<EdgeSE3*> edges;
+  std::vector<OptimizableGraph::Edge*> kernelEdges;
+  for (int i = 0; i < numEdges; ++i) {
+    EdgeSE3* e = new EdgeSE3;
+    e->setVertex(0, vertices[i]);
+    e->setVertex(1, vertices[i + 1]);
+    e->setMeasurement(randomIsometry3());
+    e->setInformation(EdgeSE3::InformationType::Identity());
+    edges.push_back(e);
+    kernelEdges.push_back(e);
+  }
+
+  BatchEdgeKernelSE3 kernel;
+  kernel.setEdges(kernelEdges);
+  CHECK(kernel.size() == numEdges);
+  if (compareToEdges(kernel, edges))
+    return 1;
+
+  // the kernel follows the changes of the estimates and the measurements
+  for (size_t i = 0; i < vertices.size(); ++i)
+    vertices[i]->setEstimate(randomIsometry3());
+  for (size_t k = 0; k < edges.size(); ++k)
+    edges[k]->setMeasurement(randomIsometry3());
+  if (compareToEdges(kernel, edges))
+    return 1;
+
+  for (size_t k = 0; k < edges.size(); ++k)
+    delete edges[k];
+  for (size_t i = 0; i < vertices.size(); ++i)
+    delete vertices[i];
+  cerr << "OK" << endl;
+  return 0;
+}
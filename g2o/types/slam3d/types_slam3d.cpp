@@ -26,6 +26,7 @@ namespace g2o {
 
   G2O_REGISTER_TYPE(VERTEX_SE3:QUAT, VertexSE3);
   G2O_REGISTER_TYPE(EDGE_SE3:QUAT, EdgeSE3);
+  G2O_REGISTER_BATCH_EDGE_KERNEL(EdgeSE3, BatchEdgeKernelSE3);
   G2O_REGISTER_TYPE(VERTEX_TRACKXYZ, VertexPointXYZ);
 
   G2O_REGISTER_TYPE(PARAMS_SE3OFFSET, ParameterSE3Offset);
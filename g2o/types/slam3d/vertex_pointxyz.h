@@ -29,6 +29,7 @@
 
 #include "g2o_types_slam3d_api.h"
 #include "g2o/core/base_vertex.h"
+#include "g2o/core/auto_differentiation_traits.h"
 #include "g2o/core/hyper_graph_action.h"
 
 namespace g2o {
@@ -66,6 +67,8 @@ namespace g2o {
         return 3;
       }
 
+      virtual bool plainDataFormat() const { return true;}
+
       virtual bool setMinimalEstimateDataImpl(const number_t* est){
         _estimate = Eigen::Map<const Vector3>(est);
         return true;
@@ -81,8 +84,16 @@ namespace g2o {
         return 3;
       }
 
+      virtual bool localDifference(const number_t* est, number_t* delta) const {
+        Eigen::Map<Vector3> d(delta);
+        d = _estimate - Eigen::Map<const Vector3>(est);
+        return true;
+      }
+
   };
 
+  template <> struct AutoDiffOplusIsAddition<VertexPointXYZ> { static const bool value = true; };
+
   class G2O_TYPES_SLAM3D_API VertexPointXYZWriteGnuplotAction: public WriteGnuplotAction
   {
     public:
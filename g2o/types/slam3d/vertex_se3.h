@@ -79,6 +79,8 @@ namespace g2o {
         return 7;
       }
 
+      virtual bool plainDataFormat() const { return true;}
+
       virtual bool setMinimalEstimateDataImpl(const number_t* est){
         Eigen::Map<const Vector6> v(est);
         _estimate = internal::fromVectorMQT(v);
@@ -95,6 +97,14 @@ namespace g2o {
         return 6;
       }
 
+      //! the inverse of oplusImpl(), i.e., the increment in the frame of the given estimate
+      virtual bool localDifference(const number_t* est, number_t* delta) const {
+        Eigen::Map<const Vector7> v(est);
+        Eigen::Map<Vector6> d(delta);
+        d = internal::toVectorMQT(internal::fromVectorQT(v).inverse() * _estimate);
+        return true;
+      }
+
       /**
        * update the position of this vertex. The update is in the form
        * (x,y,z,qx,qy,qz) whereas (x,y,z) represents the translational update
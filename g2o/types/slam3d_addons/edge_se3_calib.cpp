@@ -25,6 +25,7 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "edge_se3_calib.h"
+#include "g2o/types/slam3d/isometry3d_gradients.h"
 
 namespace g2o {
 
@@ -76,4 +77,26 @@ namespace g2o {
     return true;
   }
 
+#ifndef NUMERIC_JACOBIAN_THREE_D_TYPES
+  void EdgeSE3Calib::linearizeOplus()
+  {
+    const VertexSE3* v1 = static_cast<const VertexSE3*>(_vertices[0]);
+    const VertexSE3* v2 = static_cast<const VertexSE3*>(_vertices[1]);
+    const VertexSE3* calib  = static_cast<const VertexSE3*>(_vertices[2]);
+    const Isometry3& c = calib->estimate();
+    Isometry3 E;
+    Eigen::Matrix<number_t, 6, 6> J1 = Eigen::Matrix<number_t, 6, 6>::Zero();
+    Eigen::Matrix<number_t, 6, 6> J2 = Eigen::Matrix<number_t, 6, 6>::Zero();
+    // the poses enter like the offsets of EdgeSE3Offset
+    internal::computeEdgeSE3Gradient(E, J1, J2, _measurement, v1->estimate(), v2->estimate(), c, c);
+    _jacobianOplus[0] = J1;
+    _jacobianOplus[1] = J2;
+    // E = Z^-1 * c^-1 * (v1^-1 * v2 * c), i.e., the calibration is
+    // perturbed on both sides of the relative motion
+    internal::computeEdgeSE3Gradient(E, J1, J2, _measurement, c, v1->estimate().inverse() * v2->estimate() * c,
+        Isometry3::Identity(), Isometry3::Identity());
+    _jacobianOplus[2] = J1 + J2;
+  }
+#endif
+
 } // end namespace
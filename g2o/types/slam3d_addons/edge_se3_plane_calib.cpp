@@ -34,6 +34,22 @@ namespace g2o
   using namespace std;
   using namespace Eigen;
 
+#ifndef NUMERIC_JACOBIAN_THREE_D_TYPES
+  namespace {
+    //! derivative of (azimuth, elevation) of a vector w.r.t. the vector
+    inline Eigen::Matrix<number_t, 2, 3> azimuthElevationGradient(const Vector3& v)
+    {
+      number_t rho2 = v.head<2>().squaredNorm();
+      number_t rho = std::sqrt(rho2);
+      number_t norm2 = rho2 + v.z() * v.z();
+      Eigen::Matrix<number_t, 2, 3> J;
+      J << -v.y() / rho2, v.x() / rho2, 0,
+           -v.x() * v.z() / (rho * norm2), -v.y() * v.z() / (rho * norm2), rho / norm2;
+      return J;
+    }
+  }
+#endif
+
   EdgeSE3PlaneSensorCalib::EdgeSE3PlaneSensorCalib() :
     BaseMultiEdge<3, Plane3D>()
   {
@@ -67,6 +83,58 @@ namespace g2o
     return os.good();
   }
 
+#ifndef NUMERIC_JACOBIAN_THREE_D_TYPES
+  void EdgeSE3PlaneSensorCalib::linearizeOplus()
+  {
+    const VertexSE3* v1            = static_cast<const VertexSE3*>(_vertices[0]);
+    const VertexPlane* planeVertex = static_cast<const VertexPlane*>(_vertices[1]);
+    const VertexSE3* offset        = static_cast<const VertexSE3*>(_vertices[2]);
+    const Plane3D& plane           = planeVertex->estimate();
+    const Isometry3 sensor         = v1->estimate() * offset->estimate();
+    const Matrix3 Rx               = v1->estimate().linear();
+    const Matrix3 Rc               = offset->estimate().linear();
+    const Vector3 np               = plane.normal();
+    const Vector3 npX              = Rx.transpose() * np;
+    const Vector3 nl               = sensor.linear().transpose() * np;
+
+    // derivative of the local plane (normal, distance) w.r.t. the vertices,
+    // the VertexSE3 increment rotates by twice the imaginary part of the quaternion
+    Eigen::Matrix<number_t, 4, 6> dPose = Eigen::Matrix<number_t, 4, 6>::Zero();
+    dPose.block<3,3>(0,3) = 2 * Rc.transpose() * skew(npX);
+    dPose.block<1,3>(3,0) = -npX.transpose();
+    dPose.block<1,3>(3,3) = 2 * npX.transpose() * skew(offset->estimate().translation());
+
+    Eigen::Matrix<number_t, 4, 6> dOffset = Eigen::Matrix<number_t, 4, 6>::Zero();
+    dOffset.block<3,3>(0,3) = 2 * skew(nl);
+    dOffset.block<1,3>(3,0) = -nl.transpose();
+
+    // the plane increment moves the normal along the 2nd and 3rd axis of its rotation
+    Eigen::Matrix<number_t, 3, 2> tangent = Plane3D::rotation(np).rightCols<2>();
+    Eigen::Matrix<number_t, 4, 3> dPlane = Eigen::Matrix<number_t, 4, 3>::Zero();
+    dPlane.block<3,2>(0,0) = sensor.linear().transpose() * tangent;
+    dPlane.block<1,2>(3,0) = -sensor.translation().transpose() * tangent;
+    dPlane(3,2) = 1.;
+
+    // derivative of the error w.r.t. the local plane, the measured normal is
+    // expressed in the frame given by rotation(nl) = Rz(azimuth) * Ry(-elevation)
+    number_t azimuth = Plane3D::azimuth(nl);
+    number_t elevation = Plane3D::elevation(nl);
+    Matrix3 Rye = AngleAxis(elevation, Vector3::UnitY()).toRotationMatrix();
+    Vector3 nmAz = AngleAxis(-azimuth, Vector3::UnitZ()) * _measurement.normal();
+    Vector3 n = Rye * nmAz;
+    Eigen::Matrix<number_t, 3, 2> dnAzEl;
+    dnAzEl.col(0) = -Rye * Vector3::UnitZ().cross(nmAz);
+    dnAzEl.col(1) = Vector3::UnitY().cross(n);
+    Eigen::Matrix<number_t, 3, 4> dError = Eigen::Matrix<number_t, 3, 4>::Zero();
+    dError.block<2,3>(0,0) = azimuthElevationGradient(n) * dnAzEl * azimuthElevationGradient(nl);
+    dError(2,3) = 1.;
+
+    _jacobianOplus[0] = dError * dPose;
+    _jacobianOplus[1] = dError * dPlane;
+    _jacobianOplus[2] = dError * dOffset;
+  }
+#endif
+
 
 #ifdef G2O_HAVE_OPENGL
 
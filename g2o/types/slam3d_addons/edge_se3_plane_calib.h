@@ -59,6 +59,10 @@ namespace g2o {
 	_measurement = m;
       }
 
+#ifndef NUMERIC_JACOBIAN_THREE_D_TYPES
+      virtual void linearizeOplus();
+#endif
+
       virtual bool read(std::istream& is);
       virtual bool write(std::ostream& os) const;
 